@@ -1513,6 +1513,22 @@ int ACAP_FILE_Init(void) {
     return 1;
 }
 
+int ACAP_FILE_Set_Path(const char* path) {
+    if (!path || !path[0]) {
+        LOG_WARN("Invalid file root\n");
+        return 0;
+    }
+
+    size_t len = strlen(path);
+    const char* slash = path[len - 1] == '/' ? "" : "/";
+    if (snprintf(ACAP_FILE_Path, sizeof(ACAP_FILE_Path), "%s%s", path, slash) >= sizeof(ACAP_FILE_Path)) {
+        LOG_WARN("Path too long\n");
+        ACAP_FILE_Path[0] = 0;
+        return 0;
+    }
+    return 1;
+}
+
 FILE* ACAP_FILE_Open(const char* filepath, const char* mode) {
     if (!filepath ) {
         LOG_WARN("Invalid parameters for file operation\n");
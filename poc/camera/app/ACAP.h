@@ -108,6 +108,7 @@ int		ACAP_EVENTS_Unsubscribe(int id);
  * File Operations
  *-----------------------------------------------------*/
 const char* ACAP_FILE_AppPath(void);
+int 		ACAP_FILE_Set_Path(const char* path);	/* Override the package root (host tools) */
 FILE* 		ACAP_FILE_Open(const char* filepath, const char* mode);
 int 		ACAP_FILE_Delete(const char* filepath);
 cJSON* 		ACAP_FILE_Read(const char* filepath);
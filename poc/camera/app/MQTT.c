@@ -45,6 +45,7 @@ typedef void (*MQTTAsync_freeMessage_func)(MQTTAsync_message**);
 typedef void (*MQTTAsync_destroy_func)(MQTTAsync*);
 typedef void (*MQTTAsync_free_func)(void* ptr);	
 typedef void (*MQTTAsync_setConnected_func)(MQTTAsync handle, void* context, MQTTAsync_connected* co);
+typedef int (*MQTTAsync_getPendingTokens_func)(MQTTAsync handle, MQTTAsync_token** tokens);
 static struct {
     MQTTAsync_create_func create;
     MQTTAsync_connect_func connect;
@@ -58,6 +59,7 @@ static struct {
     MQTTAsync_freeMessage_func freeMessage;
 	MQTTAsync_free_func free;
 	MQTTAsync_setConnected_func setConnected;
+    MQTTAsync_getPendingTokens_func getPendingTokens;
     MQTTAsync_destroy_func destroy;
 } mqtt;
 
@@ -363,6 +365,25 @@ MQTT_Publish(const char *topic, const char *payload, int qos, int retained) {
     return (rc == MQTTASYNC_SUCCESS);
 }
 
+int
+MQTT_Pending_Count(void) {
+    if (!mqtt_client || !mqtt.getPendingTokens) {
+        return 0;
+    }
+
+    MQTTAsync_token* tokens = NULL;
+    if (mqtt.getPendingTokens(mqtt_client, &tokens) != MQTTASYNC_SUCCESS || !tokens) {
+        return 0;
+    }
+
+    int count = 0;
+    while (tokens[count] != -1) {
+        count++;
+    }
+    mqtt.free(tokens);
+    return count;
+}
+
 int
 MQTT_Publish_JSON(const char *topic, cJSON *payload, int qos, int retained) {
 
@@ -405,7 +426,7 @@ MQTT_Publish_JSON(const char *topic, cJSON *payload, int qos, int retained) {
     
     if (json) {
         result = MQTT_Publish(topic, json, qos, retained);
-        free(json);
+        cJSON_free(json);
     } else {
         LOG_WARN("%s: Failed to serialize JSON\n", __func__);
     }
@@ -519,6 +540,7 @@ MQTT_Load_Library() {
     LOAD_SYMBOL(freeMessage)
 	LOAD_SYMBOL(free)
 	LOAD_SYMBOL(setConnected)
+    LOAD_SYMBOL(getPendingTokens)
     LOAD_SYMBOL(destroy)
 
     return 1;
@@ -33,6 +33,7 @@ int    MQTT_Publish_JSON( const char *topic, cJSON *payload, int qos, int retain
 int    MQTT_Publish_Binary( const char *topic, int payloadlen, void *payload, int qos, int retained );
 int    MQTT_Subscribe( const char *topic );
 int    MQTT_Unsubscribe( const char *topic );
+int    MQTT_Pending_Count( void );
 
 #ifdef  __cplusplus
   }
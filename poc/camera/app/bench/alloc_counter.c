@@ -0,0 +1,71 @@
+/**
+ * alloc_counter.c
+ *
+ * --wrap targets for the host benchmark (see alloc_counter.h)
+ */
+
+#include "alloc_counter.h"
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t nmemb, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+void* __real_memcpy(void* dest, const void* src, size_t n);
+void* __real_memmove(void* dest, const void* src, size_t n);
+
+static AllocStats g_stats;
+
+static inline void count(uint64_t* counter, uint64_t value) {
+    __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+}
+
+void* __wrap_malloc(size_t size) {
+    count(&g_stats.allocs, 1);
+    count(&g_stats.alloc_bytes, size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t nmemb, size_t size) {
+    count(&g_stats.allocs, 1);
+    count(&g_stats.alloc_bytes, (uint64_t)nmemb * size);
+    return __real_calloc(nmemb, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    count(&g_stats.allocs, 1);
+    count(&g_stats.alloc_bytes, size);
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) count(&g_stats.frees, 1);
+    __real_free(ptr);
+}
+
+void* __wrap_memcpy(void* dest, const void* src, size_t n) {
+    count(&g_stats.copies, 1);
+    count(&g_stats.copy_bytes, n);
+    return __real_memcpy(dest, src, n);
+}
+
+void* __wrap_memmove(void* dest, const void* src, size_t n) {
+    count(&g_stats.copies, 1);
+    count(&g_stats.copy_bytes, n);
+    return __real_memmove(dest, src, n);
+}
+
+void Alloc_Snapshot(AllocStats* stats) {
+    stats->allocs = __atomic_load_n(&g_stats.allocs, __ATOMIC_RELAXED);
+    stats->alloc_bytes = __atomic_load_n(&g_stats.alloc_bytes, __ATOMIC_RELAXED);
+    stats->frees = __atomic_load_n(&g_stats.frees, __ATOMIC_RELAXED);
+    stats->copies = __atomic_load_n(&g_stats.copies, __ATOMIC_RELAXED);
+    stats->copy_bytes = __atomic_load_n(&g_stats.copy_bytes, __ATOMIC_RELAXED);
+}
+
+void* Alloc_Raw_Realloc(void* ptr, size_t size) {
+    return __real_realloc(ptr, size);
+}
+
+void Alloc_Raw_Free(void* ptr) {
+    __real_free(ptr);
+}
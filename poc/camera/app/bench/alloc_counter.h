@@ -0,0 +1,43 @@
+/**
+ * alloc_counter.h
+ *
+ * Heap and copy counters for the Axis I.S. host benchmark
+ * The bench links with -Wl,--wrap for malloc, calloc, realloc, free,
+ * memcpy and memmove, so every call made from the application objects is
+ * counted. Calls made inside glib, libcurl or libc itself are not.
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint64_t allocs;            // malloc + calloc + realloc calls
+    uint64_t alloc_bytes;
+    uint64_t frees;
+    uint64_t copies;            // memcpy + memmove calls
+    uint64_t copy_bytes;
+} AllocStats;
+
+/**
+ * Read the counters (totals since process start, all threads)
+ */
+void Alloc_Snapshot(AllocStats* stats);
+
+/**
+ * Uncounted allocation for the bench's own bookkeeping
+ */
+void* Alloc_Raw_Realloc(void* ptr, size_t size);
+void Alloc_Raw_Free(void* ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ALLOC_COUNTER_H */
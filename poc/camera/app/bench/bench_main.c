@@ -0,0 +1,529 @@
+/**
+ * Axis I.S. Host Benchmark
+ *
+ * Runs the real core pipeline (core.c, all registered modules and the
+ * metadata publishing path) on a Linux host, as fast as the frame source
+ * and inference backend allow, and reports throughput as JSON:
+ *
+ *   fps, per-stage p50/p99 from trace spans, heap allocations per frame,
+ *   bytes copied per frame (memcpy/memmove from application code) and the
+ *   per-frame arena high-water mark
+ *
+ * --zero-alloc turns the allocation count into a pass/fail check: the run
+ * exits nonzero if any measured frame reached malloc. Failed frames are
+ * retried and counted ("failed_frames"); 50 in a row end the run with a
+ * nonzero exit and no report.
+ *
+ * --early-release MODE sets core early_release ("off", "copy",
+ * "model_input"); the report's "hold_us" shows how long each source
+ * buffer stayed checked out.
+ *
+ * Frames come from the synthetic or file source (unpaced), inference from
+ * the replay backend (recorded output tensors, optional latency). A camera
+ * capture segment (capture_<n>.axcap) can feed both. DLPU time slicing,
+ * the flight recorder and capture are disabled. Module settings are
+ * read from <root>/settings as on the camera.
+ *
+ * Build:
+ *   make bench                   # null MQTT sink
+ *   make bench MQTT=mosquitto    # publish to a local broker
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "cJSON.h"
+#include "ACAP.h"
+#include "MQTT.h"
+#include "core.h"
+#include "trace.h"
+#include "alloc_counter.h"
+#ifndef BENCH_MQTT_MOSQUITTO
+#include "mqtt_null.h"
+#endif
+
+#define BENCH_MAX_STAGES 32
+#define BENCH_MAX_FAILURES 50           // Failed frames in a row before giving up
+
+/* External: Frame publisher callback for MQTT messages */
+extern void frame_request_callback(const char* topic, const char* payload);
+
+/* Span durations collected for one stage name */
+typedef struct {
+    const char* name;
+    int32_t* samples;
+    size_t count;
+    size_t capacity;
+} StageSamples;
+
+typedef struct {
+    int frames;
+    int warmup;
+    const char* source;
+    const char* input;
+    const char* tensors;
+    int latency_ms;
+    int perf;
+    int zero_alloc;
+    const char* early_release;
+    const char* broker;
+    int port;
+    const char* root;
+    const char* out;
+} BenchOptions;
+
+static StageSamples g_stages[BENCH_MAX_STAGES];
+static int g_stage_count = 0;
+static int g_measuring = 0;
+static int g_failed_frames = 0;
+static volatile int g_mqtt_state = 0;
+
+/**
+ * Trace observer - runs on the pipeline thread only
+ * Storage grows through the uncounted allocator so bookkeeping does not
+ * show up in the allocation figures
+ */
+static void on_span(const char* name, int64_t start_us, int32_t dur_us, void* user_data) {
+    if (!g_measuring) return;
+
+    StageSamples* stage = NULL;
+    for (int i = 0; i < g_stage_count; i++) {
+        if (g_stages[i].name == name || strcmp(g_stages[i].name, name) == 0) {
+            stage = &g_stages[i];
+            break;
+        }
+    }
+    if (!stage) {
+        if (g_stage_count >= BENCH_MAX_STAGES) return;
+        stage = &g_stages[g_stage_count++];
+        stage->name = name;
+    }
+
+    if (stage->count == stage->capacity) {
+        size_t capacity = stage->capacity ? stage->capacity * 2 : 1024;
+        int32_t* grown = (int32_t*)Alloc_Raw_Realloc(stage->samples, capacity * sizeof(int32_t));
+        if (!grown) return;
+        stage->samples = grown;
+        stage->capacity = capacity;
+    }
+    stage->samples[stage->count++] = dur_us;
+}
+
+static int compare_int32(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Nearest-rank percentile of sorted samples
+ */
+static int32_t percentile(const int32_t* sorted, size_t count, int pct) {
+    size_t rank = (count * (size_t)pct + 99) / 100;
+    if (rank == 0) rank = 1;
+    return sorted[rank - 1];
+}
+
+static cJSON* stage_report(void) {
+    cJSON* stages = cJSON_CreateObject();
+    for (int i = 0; i < g_stage_count; i++) {
+        StageSamples* stage = &g_stages[i];
+        if (stage->count == 0) continue;
+
+        qsort(stage->samples, stage->count, sizeof(int32_t), compare_int32);
+        double sum = 0;
+        for (size_t j = 0; j < stage->count; j++) sum += stage->samples[j];
+
+        cJSON* s = cJSON_CreateObject();
+        cJSON_AddNumberToObject(s, "count", (double)stage->count);
+        cJSON_AddNumberToObject(s, "p50_us", percentile(stage->samples, stage->count, 50));
+        cJSON_AddNumberToObject(s, "p99_us", percentile(stage->samples, stage->count, 99));
+        cJSON_AddNumberToObject(s, "mean_us", sum / (double)stage->count);
+        cJSON_AddNumberToObject(s, "max_us", stage->samples[stage->count - 1]);
+        cJSON_AddItemToObject(stages, stage->name, s);
+    }
+    return stages;
+}
+
+static void on_mqtt_state(int state) {
+    g_mqtt_state = state;
+}
+
+static void set_item(cJSON* object, const char* key, cJSON* value) {
+    if (cJSON_GetObjectItem(object, key)) {
+        cJSON_ReplaceItemInObject(object, key, value);
+    } else {
+        cJSON_AddItemToObject(object, key, value);
+    }
+}
+
+static cJSON* get_object(cJSON* parent, const char* key) {
+    cJSON* object = cJSON_GetObjectItem(parent, key);
+    if (!cJSON_IsObject(object)) {
+        object = cJSON_CreateObject();
+        set_item(parent, key, object);
+    }
+    return object;
+}
+
+/**
+ * Core configuration: settings/core.json with the benchmark overrides
+ */
+static cJSON* build_config(const BenchOptions* opt) {
+    cJSON* config = ACAP_FILE_Read("settings/core.json");
+    if (!config) config = cJSON_CreateObject();
+
+    set_item(config, "trace_enabled", cJSON_CreateTrue());
+    set_item(config, "perf_counters_enabled", cJSON_CreateBool(opt->perf));
+    set_item(config, "dlpu_time_slicing", cJSON_CreateFalse());
+
+    cJSON* source = get_object(config, "frame_source");
+    set_item(source, "type", cJSON_CreateString(opt->source));
+    set_item(source, "path", cJSON_CreateString(opt->input ? opt->input : ""));
+    set_item(source, "loop", cJSON_CreateTrue());
+    set_item(source, "paced", cJSON_CreateFalse());
+
+    cJSON* inference = get_object(config, "inference");
+    set_item(inference, "backend", cJSON_CreateString("replay"));
+    set_item(inference, "replay_path", cJSON_CreateString(opt->tensors ? opt->tensors : ""));
+    set_item(inference, "latency_ms", cJSON_CreateNumber(opt->latency_ms));
+
+    cJSON* flight = get_object(config, "flight_recorder");
+    set_item(flight, "enabled", cJSON_CreateFalse());
+
+    cJSON* capture = get_object(config, "capture");
+    set_item(capture, "enabled", cJSON_CreateFalse());
+
+    if (opt->early_release) {
+        cJSON* early = get_object(config, "early_release");
+        set_item(early, "mode", cJSON_CreateString(opt->early_release));
+    }
+
+    return config;
+}
+
+static int remove_entry(const char* path, const struct stat* st, int flag, struct FTW* ftw) {
+    remove(path);
+    return 0;
+}
+
+/**
+ * Scratch package root: settings/ links to the real settings, localdata/
+ * is private so the run never writes into the source tree
+ */
+static int make_root(const BenchOptions* opt, char* root, size_t size) {
+    char settings[PATH_MAX];
+    char path[PATH_MAX];
+
+    snprintf(path, sizeof(path), "%s/settings", opt->root);
+    if (!realpath(path, settings)) {
+        fprintf(stderr, "bench: No settings directory under %s\n", opt->root);
+        return 0;
+    }
+
+    snprintf(root, size, "/tmp/axis_is_bench.XXXXXX");
+    if (!mkdtemp(root)) {
+        perror("bench: mkdtemp");
+        return 0;
+    }
+
+    snprintf(path, sizeof(path), "%s/settings", root);
+    if (symlink(settings, path) != 0) {
+        perror("bench: symlink");
+        return 0;
+    }
+    snprintf(path, sizeof(path), "%s/localdata", root);
+    mkdir(path, 0755);
+
+    return ACAP_FILE_Set_Path(root);
+}
+
+#ifdef BENCH_MQTT_MOSQUITTO
+/**
+ * Point MQTT.c at the local broker and wait for the connection
+ */
+static int connect_broker(const BenchOptions* opt) {
+    cJSON* settings = cJSON_CreateObject();
+    char port[16];
+    snprintf(port, sizeof(port), "%d", opt->port);
+    cJSON_AddStringToObject(settings, "address", opt->broker);
+    cJSON_AddStringToObject(settings, "port", port);
+    cJSON_AddStringToObject(settings, "clientId", "axis-is-bench");
+    cJSON_AddStringToObject(settings, "user", "");
+    cJSON_AddStringToObject(settings, "password", "");
+    cJSON_AddFalseToObject(settings, "tls");
+    cJSON_AddStringToObject(settings, "preTopic", "");
+    cJSON_AddTrueToObject(settings, "connect");
+    int written = ACAP_FILE_Write("localdata/mqtt.json", settings);
+    cJSON_Delete(settings);
+    if (!written) return 0;
+
+    if (!MQTT_Init(on_mqtt_state, frame_request_callback)) return 0;
+
+    for (int i = 0; i < 500 && g_mqtt_state != MQTT_CONNECTED; i++) {
+        usleep(10000);
+    }
+    if (g_mqtt_state != MQTT_CONNECTED) {
+        fprintf(stderr, "bench: No MQTT connection to %s:%d\n", opt->broker, opt->port);
+        return 0;
+    }
+    return 1;
+}
+#endif
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --frames N        Measured frames (default 500)\n"
+        "  --warmup N        Frames run before measuring (default 50)\n"
+        "  --source TYPE     synthetic | file (default synthetic)\n"
+        "  --input PATH      Y4M, raw NV12 or capture segment for --source file\n"
+        "  --tensors PATH    Recorded output tensors (flat file or capture segment)\n"
+        "  --latency-ms N    Simulated inference latency (default 0)\n"
+        "  --perf            Enable perf_event_open counters\n"
+        "  --zero-alloc      Fail if the measured frames make any heap allocation\n"
+        "  --early-release M off | copy | model_input (default from settings)\n"
+        "  --broker HOST     MQTT broker for MQTT=mosquitto builds (default localhost)\n"
+        "  --port N          MQTT broker port (default 1883)\n"
+        "  --root DIR        Directory holding settings/ (default .)\n"
+        "  --out PATH        Write the JSON report here instead of stdout\n",
+        prog);
+}
+
+static int parse_options(int argc, char** argv, BenchOptions* opt) {
+    static const struct option longopts[] = {
+        { "frames", required_argument, NULL, 'n' },
+        { "warmup", required_argument, NULL, 'w' },
+        { "source", required_argument, NULL, 's' },
+        { "input", required_argument, NULL, 'i' },
+        { "tensors", required_argument, NULL, 't' },
+        { "latency-ms", required_argument, NULL, 'l' },
+        { "perf", no_argument, NULL, 'p' },
+        { "zero-alloc", no_argument, NULL, 'z' },
+        { "early-release", required_argument, NULL, 'e' },
+        { "broker", required_argument, NULL, 'b' },
+        { "port", required_argument, NULL, 'P' },
+        { "root", required_argument, NULL, 'r' },
+        { "out", required_argument, NULL, 'o' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    *opt = (BenchOptions){
+        .frames = 500, .warmup = 50, .source = "synthetic",
+        .broker = "localhost", .port = 1883, .root = "."
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'n': opt->frames = atoi(optarg); break;
+            case 'w': opt->warmup = atoi(optarg); break;
+            case 's': opt->source = optarg; break;
+            case 'i': opt->input = optarg; break;
+            case 't': opt->tensors = optarg; break;
+            case 'l': opt->latency_ms = atoi(optarg); break;
+            case 'p': opt->perf = 1; break;
+            case 'z': opt->zero_alloc = 1; break;
+            case 'e': opt->early_release = optarg; break;
+            case 'b': opt->broker = optarg; break;
+            case 'P': opt->port = atoi(optarg); break;
+            case 'r': opt->root = optarg; break;
+            case 'o': opt->out = optarg; break;
+            default: return 0;
+        }
+    }
+
+    if (opt->frames <= 0 || opt->warmup < 0) return 0;
+    if (strcmp(opt->source, "synthetic") != 0 && strcmp(opt->source, "file") != 0) return 0;
+    if (strcmp(opt->source, "file") == 0 && !opt->input) return 0;
+    return 1;
+}
+
+/**
+ * Run up to n frames
+ * @return Frames processed, stops early at end of input; -1 after
+ *         BENCH_MAX_FAILURES failed frames in a row
+ */
+static int run_frames(CoreContext* core, int n) {
+    int done = 0;
+    int failures = 0;
+    while (done < n) {
+        if (core_process_frame(core) != 0) {
+            if (core->source->eof) break;
+            g_failed_frames++;
+            if (++failures >= BENCH_MAX_FAILURES) {
+                fprintf(stderr, "bench: %d frames failed in a row (%d failed in total), giving up\n",
+                        failures, g_failed_frames);
+                return -1;
+            }
+            continue;
+        }
+        failures = 0;
+        done++;
+    }
+    return done;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parse_options(argc, argv, &opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    char root[PATH_MAX] = "";
+    CoreContext* core = NULL;
+    int rc = 1;
+
+    // Pipeline logging goes to stdout; keep stdout for the report only
+    fflush(stdout);
+    FILE* report_out = fdopen(dup(STDOUT_FILENO), "w");
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+
+    if (!make_root(&opt, root, sizeof(root))) goto out;
+
+#ifdef BENCH_MQTT_MOSQUITTO
+    const char* sink = "mosquitto";
+    if (!connect_broker(&opt)) goto out;
+#else
+    const char* sink = "null";
+    MQTT_Init(on_mqtt_state, frame_request_callback);
+#endif
+
+    if (core_init_with_config(&core, build_config(&opt)) != 0) {
+        fprintf(stderr, "bench: Core initialization failed\n");
+        goto out;
+    }
+    if (!core->larod) {
+        fprintf(stderr, "bench: Replay backend failed to open\n");
+        goto out;
+    }
+    if (core_discover_modules(core) < 0 || core_start(core) != 0) {
+        fprintf(stderr, "bench: Module startup failed\n");
+        goto out;
+    }
+
+    Trace_Set_Observer(on_span, NULL);
+
+    if (run_frames(core, opt.warmup) < 0) goto out;
+    g_failed_frames = 0;
+
+    AllocStats before, after;
+#ifndef BENCH_MQTT_MOSQUITTO
+    uint64_t mqtt_messages, mqtt_bytes, mqtt_messages_before, mqtt_bytes_before;
+    MQTT_Null_Stats(&mqtt_messages_before, &mqtt_bytes_before);
+#endif
+
+    g_measuring = 1;
+    Alloc_Snapshot(&before);
+    int64_t start_us = Trace_Now_Us();
+    int frames = run_frames(core, opt.frames);
+    int64_t elapsed_us = Trace_Now_Us() - start_us;
+    Alloc_Snapshot(&after);
+    g_measuring = 0;
+
+#ifdef BENCH_MQTT_MOSQUITTO
+    // Let queued messages reach the broker; not part of the timed run
+    int64_t drain_start_us = Trace_Now_Us();
+    for (int i = 0; i < 500 && MQTT_Pending_Count() > 0; i++) {
+        usleep(10000);
+    }
+    int64_t drain_us = Trace_Now_Us() - drain_start_us;
+#else
+    MQTT_Null_Stats(&mqtt_messages, &mqtt_bytes);
+    mqtt_messages -= mqtt_messages_before;
+    mqtt_bytes -= mqtt_bytes_before;
+#endif
+
+    if (frames < 0) goto out;
+    if (frames == 0) {
+        fprintf(stderr, "bench: No frames processed\n");
+        goto out;
+    }
+
+    double per_frame = 1.0 / (double)frames;
+    cJSON* report = cJSON_CreateObject();
+    cJSON_AddStringToObject(report, "source", opt.source);
+    cJSON_AddStringToObject(report, "backend", core->larod->backend.ops->name);
+    cJSON_AddNumberToObject(report, "latency_ms", opt.latency_ms);
+    cJSON_AddNumberToObject(report, "warmup", opt.warmup);
+    cJSON_AddNumberToObject(report, "frames", frames);
+    cJSON_AddNumberToObject(report, "failed_frames", g_failed_frames);
+    cJSON_AddNumberToObject(report, "elapsed_s", (double)elapsed_us / 1e6);
+    cJSON_AddNumberToObject(report, "fps", elapsed_us > 0 ? frames * 1e6 / (double)elapsed_us : 0);
+    cJSON_AddItemToObject(report, "stages", stage_report());
+    cJSON_AddNumberToObject(report, "allocs_per_frame", (double)(after.allocs - before.allocs) * per_frame);
+    cJSON_AddNumberToObject(report, "alloc_bytes_per_frame",
+                            (double)(after.alloc_bytes - before.alloc_bytes) * per_frame);
+    cJSON_AddNumberToObject(report, "copies_per_frame", (double)(after.copies - before.copies) * per_frame);
+    cJSON_AddNumberToObject(report, "bytes_copied_per_frame",
+                            (double)(after.copy_bytes - before.copy_bytes) * per_frame);
+    cJSON_AddItemToObject(report, "arena", Arena_Stats_JSON(core->arena));
+
+    cJSON* hold = cJSON_CreateObject();
+    cJSON_AddNumberToObject(hold, "avg", core->hold_frames ? (double)core->hold_us_total / core->hold_frames : 0);
+    cJSON_AddNumberToObject(hold, "max", (double)core->hold_us_max);
+    cJSON_AddItemToObject(report, "hold_us", hold);
+
+    cJSON* mqtt = cJSON_CreateObject();
+    cJSON_AddStringToObject(mqtt, "sink", sink);
+#ifdef BENCH_MQTT_MOSQUITTO
+    cJSON_AddNumberToObject(mqtt, "drain_ms", drain_us / 1000.0);
+    cJSON_AddNumberToObject(mqtt, "pending", MQTT_Pending_Count());
+#else
+    cJSON_AddNumberToObject(mqtt, "messages", (double)mqtt_messages);
+    cJSON_AddNumberToObject(mqtt, "bytes_per_message", mqtt_messages ? (double)mqtt_bytes / mqtt_messages : 0);
+#endif
+    cJSON_AddItemToObject(report, "mqtt", mqtt);
+
+    if (opt.perf) {
+        cJSON_AddItemToObject(report, "perf", Perf_Stats_JSON());
+    }
+
+    char* text = cJSON_Print(report);
+    cJSON_Delete(report);
+    if (text) {
+        FILE* f = opt.out ? fopen(opt.out, "w") : report_out;
+        if (f) {
+            fprintf(f, "%s\n", text);
+            if (f != report_out) fclose(f);
+            rc = 0;
+        } else {
+            perror("bench: Cannot write report");
+        }
+        free(text);
+    }
+
+    // Steady state must not touch the heap once warmup has sized everything
+    if (opt.zero_alloc && after.allocs != before.allocs) {
+        fprintf(stderr, "bench: %llu heap allocations in %d measured frames\n",
+                (unsigned long long)(after.allocs - before.allocs), frames);
+        rc = 1;
+    }
+
+out:
+    Trace_Set_Observer(NULL, NULL);
+    if (core) {
+        core_stop(core);
+        core_cleanup(core);
+    }
+    MQTT_Cleanup();
+    for (int i = 0; i < g_stage_count; i++) {
+        Alloc_Raw_Free(g_stages[i].samples);
+    }
+    if (root[0]) {
+        nftw(root, remove_entry, 8, FTW_DEPTH | FTW_PHYS);
+    }
+    if (report_out) fclose(report_out);
+    return rc;
+}
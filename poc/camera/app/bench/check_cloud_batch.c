@@ -0,0 +1,175 @@
+/**
+ * Cloud batcher check: cache hits outlive the frame they were submitted in
+ *
+ * A module submits from process(), with the frame arena current, and the
+ * cached answer is delivered later from the main loop. The answer must be
+ * heap memory: the test submits a cache hit inside a frame (with the
+ * metadata JSON scope open, the worst case), ends the frame, overwrites
+ * the whole arena in a second frame, and only then lets the answer be
+ * delivered.
+ *
+ * The cache is preloaded from a persisted file, so no call is made; the
+ * batch url points at a closed port.
+ *
+ * Build and run:
+ *   make check
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <jpeglib.h>
+#include <glib.h>
+
+#include "cJSON.h"
+#include "ACAP.h"
+#include "frame_arena.h"
+#include "http_client.h"
+#include "cloud_batch.h"
+#include "cloud_cache.h"
+
+#define CHECK_ARENA_SIZE (64 * 1024)
+
+static int g_failures = 0;
+static int g_delivered = 0;
+static char g_text[64];
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while (0)
+
+/* Small gradient test image */
+static size_t make_jpeg(unsigned char** out) {
+    const int w = 160, h = 120;
+    unsigned char* rgb = malloc((size_t)w * h * 3);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            unsigned char* p = rgb + ((size_t)y * w + x) * 3;
+            p[0] = (unsigned char)(x * 255 / w);
+            p[1] = (unsigned char)(y * 255 / h);
+            p[2] = (unsigned char)((x + y) & 0xFF);
+        }
+    }
+
+    struct jpeg_compress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+    unsigned long size = 0;
+    cinfo.err = jpeg_std_error(&jerr);
+    jpeg_create_compress(&cinfo);
+    *out = NULL;
+    jpeg_mem_dest(&cinfo, out, &size);
+    cinfo.image_width = w;
+    cinfo.image_height = h;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_start_compress(&cinfo, TRUE);
+    while (cinfo.next_scanline < cinfo.image_height) {
+        JSAMPROW row = rgb + (size_t)cinfo.next_scanline * w * 3;
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    free(rgb);
+    return size;
+}
+
+/* Persisted cache file holding one answer for the image */
+static int write_cache(uint64_t hash) {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+
+    cJSON* file = cJSON_CreateObject();
+    cJSON_AddNumberToObject(file, "version", 1);
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddStringToObject(entry, "prompt_id", "plate");
+    cJSON_AddStringToObject(entry, "hash", hex);
+    cJSON_AddNumberToObject(entry, "stored", (double)time(NULL));
+    cJSON* response = cJSON_AddObjectToObject(entry, "response");
+    cJSON_AddStringToObject(response, "text", "ABC123");
+    cJSON_AddItemToArray(cJSON_AddArrayToObject(file, "entries"), entry);
+    int written = ACAP_FILE_Write("localdata/cloud_cache.json", file);
+    cJSON_Delete(file);
+    return written;
+}
+
+static void on_result(const cJSON* result, int ok, void* user) {
+    g_delivered++;
+    CHECK(ok);
+    cJSON* text = cJSON_GetObjectItem(result, "text");
+    snprintf(g_text, sizeof(g_text), "%s", cJSON_IsString(text) ? text->valuestring : "");
+}
+
+int main(void) {
+    char root[] = "/tmp/axis_is_check.XXXXXX";
+    char path[64];
+    if (!mkdtemp(root)) {
+        perror("check: mkdtemp");
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/localdata", root);
+    mkdir(path, 0755);
+    if (!ACAP_FILE_Set_Path(root)) return 1;
+
+    // Hooks cJSON into the arena, as the core does at start
+    FrameArena* arena = Arena_Create(CHECK_ARENA_SIZE);
+    CHECK(arena != NULL);
+
+    unsigned char* jpeg = NULL;
+    size_t jpeg_size = make_jpeg(&jpeg);
+    uint64_t hash = 0;
+    CHECK(CloudCache_Hash(jpeg, jpeg_size, &hash));
+    CHECK(write_cache(hash));
+
+    HttpClient* http = Http_Init(NULL);
+    cJSON* config = cJSON_Parse("{\"url\": \"http://127.0.0.1:9/batch\", \"cache\": {\"persist\": true}}");
+    CloudBatch* cb = CloudBatch_Create(config, http);
+    CHECK(cb != NULL);
+
+    // Submit from inside a frame
+    Arena_Begin_Frame(arena);
+    int json_scope = Arena_JSON_Begin();
+    CHECK(CloudBatch_Submit(cb, "plate", "Read the plate", jpeg, jpeg_size, on_result, NULL));
+    Arena_JSON_End(json_scope);
+    Arena_End_Frame(arena);
+    CHECK(g_delivered == 0);
+
+    // Next frame overwrites everything the first one could have used
+    Arena_Begin_Frame(arena);
+    void* clobber = Arena_Malloc(CHECK_ARENA_SIZE / 2);
+    if (clobber) memset(clobber, 0xA5, CHECK_ARENA_SIZE / 2);
+    Arena_End_Frame(arena);
+
+    for (int i = 0; i < 100 && !g_delivered; i++) {
+        g_main_context_iteration(NULL, FALSE);
+    }
+    CHECK(g_delivered == 1);
+    CHECK(strcmp(g_text, "ABC123") == 0);
+
+    cJSON* stats = CloudBatch_Stats_JSON(cb);
+    cJSON* cached = cJSON_GetObjectItem(stats, "cached");
+    CHECK(cJSON_IsNumber(cached) && cached->valueint == 1);
+    cJSON_Delete(stats);
+
+    CloudBatch_Destroy(cb);
+    cJSON_Delete(config);
+    Http_Cleanup(http);
+    free(jpeg);
+    Arena_Destroy(arena);
+
+    snprintf(path, sizeof(path), "%s/localdata/cloud_cache.json", root);
+    remove(path);
+    snprintf(path, sizeof(path), "%s/localdata", root);
+    rmdir(path);
+    rmdir(root);
+
+    printf("check_cloud_batch: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,221 @@
+/**
+ * Result cache check: hit, stale and evict on synthetic luma crops
+ *
+ * Two 320x240 luma frames stand in for the camera: the left half falls in
+ * brightness from left to right, the right half rises, so a crop from
+ * either half has a fixed difference hash (all ones, all zeros). The
+ * second frame adds a checkerboard at thumbnail-cell scale - the same
+ * object, seen sharper.
+ *
+ * Build and run:
+ *   make check
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cJSON.h"
+#include "result_cache.h"
+
+#define FRAME_WIDTH 320
+#define FRAME_HEIGHT 240
+#define SECOND 1000000LL
+
+static int g_failures = 0;
+static uint8_t g_smooth[FRAME_WIDTH * FRAME_HEIGHT];
+static uint8_t g_sharp[FRAME_WIDTH * FRAME_HEIGHT];
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while (0)
+
+static void make_frames(void) {
+    for (int y = 0; y < FRAME_HEIGHT; y++) {
+        for (int x = 0; x < FRAME_WIDTH; x++) {
+            int v = x < FRAME_WIDTH / 2 ? 230 - x : 40 + (x - FRAME_WIDTH / 2);
+            int texture = ((x / 2 + y / 2) & 1) ? 30 : -30;
+            g_smooth[y * FRAME_WIDTH + x] = (uint8_t)v;
+            g_sharp[y * FRAME_WIDTH + x] = (uint8_t)(v + texture < 0 ? 0 : v + texture > 255 ? 255 : v + texture);
+        }
+    }
+}
+
+static CacheKey key_of(const uint8_t* frame, int x, int y, int w, int h, int class_id) {
+    FrameView luma = { .data = frame, .size = sizeof(g_smooth), .width = FRAME_WIDTH,
+                       .height = FRAME_HEIGHT, .stride = FRAME_WIDTH };
+    int pixels[4] = { x, y, w, h };
+    CacheKey key;
+    ResultCache_Key(&luma, pixels, &key);
+    key.class_id = class_id;
+    return key;
+}
+
+static CacheStatus lookup(ResultCache* cache, const CacheKey* key, int64_t now_us, int* entry,
+                          const char** label) {
+    const CascadeResult* results = NULL;
+    int count = 0;
+    int32_t age_ms = 0;
+    CacheStatus status = ResultCache_Lookup(cache, key, now_us, entry, &results, &count, &age_ms);
+    *label = status == RESULT_CACHE_HIT && count > 0 ? results[0].label : "";
+    return status;
+}
+
+static void store(ResultCache* cache, int entry, const CacheKey* key, int64_t now_us, const char* text) {
+    CascadeResult result;
+    memset(&result, 0, sizeof(result));
+    result.confidence = 0.9f;
+    snprintf(result.label, sizeof(result.label), "%s", text);
+    ResultCache_Store(cache, entry, key, now_us, &result, 1);
+}
+
+static double stat(ResultCache* cache, const char* name) {
+    cJSON* stats = ResultCache_Stats_JSON(cache);
+    cJSON* item = cJSON_GetObjectItem(stats, name);
+    double value = cJSON_IsNumber(item) ? item->valuedouble : -1;
+    cJSON_Delete(stats);
+    return value;
+}
+
+static void check_keys(void) {
+    CacheKey a = key_of(g_smooth, 20, 20, 64, 64, 2);
+    CacheKey a_moved = key_of(g_smooth, 26, 24, 64, 64, 2);
+    CacheKey a_sharp = key_of(g_sharp, 20, 20, 64, 64, 2);
+    CacheKey b = key_of(g_smooth, 200, 20, 64, 64, 2);
+
+    CHECK(a.hash == ~0ull);
+    CHECK(b.hash == 0);
+    CHECK(__builtin_popcountll(a.hash ^ a_moved.hash) <= 10);
+    CHECK(__builtin_popcountll(a.hash ^ a_sharp.hash) <= 10);
+    CHECK(a_sharp.sharpness > a.sharpness * 1.3f);
+    CHECK(a.track == -1);
+}
+
+static void check_hit_and_stale(void) {
+    cJSON* config = cJSON_Parse("{\"entries\": 8, \"max_age_ms\": 5000}");
+    ResultCache* cache = ResultCache_Create(config);
+    cJSON_Delete(config);
+    CHECK(cache != NULL);
+    if (!cache) return;
+
+    const char* label;
+    int entry;
+    int64_t now = 100 * SECOND;
+    CacheKey a = key_of(g_smooth, 20, 20, 64, 64, 2);
+
+    // First sight: miss, run the model, store
+    CHECK(lookup(cache, &a, now, &entry, &label) == RESULT_CACHE_MISS && entry == -1);
+    store(cache, entry, &a, now, "ABC123");
+    ResultCache_End_Frame(cache);
+
+    // Next frame, moved a little: hit
+    CacheKey moved = key_of(g_smooth, 26, 24, 64, 64, 2);
+    CHECK(lookup(cache, &moved, now + SECOND / 10, &entry, &label) == RESULT_CACHE_HIT);
+    CHECK(strcmp(label, "ABC123") == 0);
+    // Each entry matches one object per frame
+    CHECK(lookup(cache, &moved, now + SECOND / 10, &entry, &label) == RESULT_CACHE_MISS);
+    ResultCache_End_Frame(cache);
+
+    // Other class, other look, or the same look too far away: miss
+    CacheKey other_class = key_of(g_smooth, 26, 24, 64, 64, 7);
+    CacheKey other_look = key_of(g_smooth, 200, 20, 64, 64, 2);
+    CacheKey far = key_of(g_smooth, 20, 170, 64, 64, 2);
+    CHECK(far.hash == a.hash);
+    CHECK(lookup(cache, &other_class, now + SECOND / 5, &entry, &label) == RESULT_CACHE_MISS);
+    CHECK(lookup(cache, &other_look, now + SECOND / 5, &entry, &label) == RESULT_CACHE_MISS);
+    CHECK(lookup(cache, &far, now + SECOND / 5, &entry, &label) == RESULT_CACHE_MISS);
+    ResultCache_End_Frame(cache);
+
+    // Crop grew (closer to the camera): stale, rerun stores into the same entry
+    CacheKey grown = key_of(g_smooth, 10, 10, 100, 100, 2);
+    CHECK(grown.hash == a.hash);
+    CHECK(lookup(cache, &grown, now + SECOND / 2, &entry, &label) == RESULT_CACHE_STALE);
+    CHECK(entry >= 0);
+    int grown_entry = entry;
+    store(cache, entry, &grown, now + SECOND / 2, "ABC128");
+    ResultCache_End_Frame(cache);
+    CHECK(lookup(cache, &grown, now + SECOND, &entry, &label) == RESULT_CACHE_HIT);
+    CHECK(entry == grown_entry && strcmp(label, "ABC128") == 0);
+    ResultCache_End_Frame(cache);
+
+    // Same crop, sharper: stale
+    CacheKey sharp = key_of(g_sharp, 10, 10, 100, 100, 2);
+    CHECK(lookup(cache, &sharp, now + 2 * SECOND, &entry, &label) == RESULT_CACHE_STALE);
+    store(cache, entry, &sharp, now + 2 * SECOND, "ABC128");
+    ResultCache_End_Frame(cache);
+
+    // Results expire max_age_ms after they were computed
+    CHECK(lookup(cache, &sharp, now + 6 * SECOND, &entry, &label) == RESULT_CACHE_HIT);
+    ResultCache_End_Frame(cache);
+    CHECK(lookup(cache, &sharp, now + 8 * SECOND, &entry, &label) == RESULT_CACHE_STALE);
+    ResultCache_End_Frame(cache);
+
+    // A tracked object matches by track id whatever it looks like
+    CacheKey tracked = key_of(g_smooth, 200, 120, 64, 64, 2);
+    tracked.track = 5;
+    CHECK(lookup(cache, &tracked, now, &entry, &label) == RESULT_CACHE_MISS);
+    store(cache, entry, &tracked, now, "XYZ");
+    ResultCache_End_Frame(cache);
+    CacheKey retracked = key_of(g_smooth, 20, 20, 64, 64, 2);
+    retracked.track = 5;
+    CHECK(lookup(cache, &retracked, now + SECOND / 10, &entry, &label) == RESULT_CACHE_HIT);
+    CHECK(strcmp(label, "XYZ") == 0);
+    ResultCache_End_Frame(cache);
+
+    CHECK(stat(cache, "expired") == 1);
+    CHECK(stat(cache, "refreshed") == 2);
+    ResultCache_Destroy(cache);
+}
+
+static void check_evict(void) {
+    cJSON* config = cJSON_Parse("{\"entries\": 2}");
+    ResultCache* cache = ResultCache_Create(config);
+    cJSON_Delete(config);
+    CHECK(cache != NULL);
+    if (!cache) return;
+
+    const char* label;
+    int entry;
+    int64_t now = 100 * SECOND;
+    CacheKey a = key_of(g_smooth, 20, 20, 64, 64, 2);
+    CacheKey b = key_of(g_smooth, 200, 20, 64, 64, 2);
+    CacheKey c = key_of(g_smooth, 20, 20, 64, 64, 3);
+
+    lookup(cache, &a, now, &entry, &label);
+    store(cache, entry, &a, now, "A");
+    lookup(cache, &b, now + 1, &entry, &label);
+    store(cache, entry, &b, now + 1, "B");
+    ResultCache_End_Frame(cache);
+
+    // A seen again, so B is the one seen longest ago when C arrives
+    CHECK(lookup(cache, &a, now + 2, &entry, &label) == RESULT_CACHE_HIT);
+    CHECK(lookup(cache, &c, now + 2, &entry, &label) == RESULT_CACHE_MISS);
+    store(cache, entry, &c, now + 2, "C");
+    ResultCache_End_Frame(cache);
+
+    CHECK(stat(cache, "evictions") == 1);
+    CHECK(stat(cache, "entries") == 2);
+    CHECK(lookup(cache, &b, now + 3, &entry, &label) == RESULT_CACHE_MISS);
+    CHECK(lookup(cache, &a, now + 3, &entry, &label) == RESULT_CACHE_HIT && strcmp(label, "A") == 0);
+    CHECK(lookup(cache, &c, now + 3, &entry, &label) == RESULT_CACHE_HIT && strcmp(label, "C") == 0);
+    ResultCache_Destroy(cache);
+
+    // Disabled
+    config = cJSON_Parse("{\"enabled\": false}");
+    CHECK(ResultCache_Create(config) == NULL);
+    cJSON_Delete(config);
+}
+
+int main(void) {
+    make_frames();
+    check_keys();
+    check_hit_and_stale();
+    check_evict();
+
+    printf("check_result_cache: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * ROI mask check: even-odd polygon fill and the detection anchor
+ *
+ * Builds masks from config JSON as the detection module does and probes
+ * them with small boxes through Roi_Allows(): a concave polygon must leave
+ * its notch out, a self-intersecting one its doubly covered part, an
+ * exclude polygon cuts a hole, and the bottom anchor tests where a box
+ * stands rather than its centre.
+ *
+ * Build and run:
+ *   make check
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cJSON.h"
+#include "roi_mask.h"
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while (0)
+
+static RoiMask* make_mask(const char* json) {
+    cJSON* config = cJSON_Parse(json);
+    RoiMask* roi = Roi_Init(config);
+    cJSON_Delete(config);
+    return roi;
+}
+
+/* Small box centred at x, y */
+static int allows(const RoiMask* roi, float x, float y) {
+    Detection det = { .class_id = 0, .confidence = 1.0f, .x = x, .y = y,
+                      .width = 0.02f, .height = 0.02f };
+    return Roi_Allows(roi, &det);
+}
+
+static void check_concave(void) {
+    // U shape: the notch between the arms is outside
+    RoiMask* roi = make_mask("{\"include\": [[[0.1, 0.1], [0.9, 0.1], [0.9, 0.9], [0.7, 0.9],"
+                             " [0.7, 0.3], [0.3, 0.3], [0.3, 0.9], [0.1, 0.9]]]}");
+    CHECK(roi != NULL);
+    CHECK(allows(roi, 0.5f, 0.2f));         // Base
+    CHECK(allows(roi, 0.2f, 0.6f));         // Left arm
+    CHECK(allows(roi, 0.8f, 0.6f));         // Right arm
+    CHECK(!allows(roi, 0.5f, 0.6f));        // Notch
+    CHECK(!allows(roi, 0.95f, 0.5f));       // Outside
+    CHECK(!allows(roi, 0.5f, 0.95f));
+
+    float crop[4];
+    CHECK(Roi_Crop(roi, crop));
+    CHECK(crop[0] == 0.1f && crop[1] == 0.1f);
+    Roi_Cleanup(roi);
+}
+
+static void check_self_intersecting(void) {
+    // Bow tie: two triangles meeting at the centre, nothing above or below it
+    RoiMask* roi = make_mask("{\"include\": [[[0.1, 0.1], [0.9, 0.9], [0.9, 0.1], [0.1, 0.9]]]}");
+    CHECK(roi != NULL);
+    CHECK(allows(roi, 0.2f, 0.5f));
+    CHECK(allows(roi, 0.8f, 0.5f));
+    CHECK(!allows(roi, 0.5f, 0.2f));
+    CHECK(!allows(roi, 0.5f, 0.8f));
+    Roi_Cleanup(roi);
+
+    // Pentagram drawn point to point: even-odd leaves the inner pentagon out
+    roi = make_mask("{\"include\": [[[0.5, 0.1], [0.735, 0.824], [0.12, 0.376],"
+                    " [0.88, 0.376], [0.265, 0.824]]]}");
+    CHECK(roi != NULL);
+    CHECK(!allows(roi, 0.5f, 0.52f));       // Centre
+    CHECK(allows(roi, 0.5f, 0.22f));        // Top point
+    CHECK(allows(roi, 0.2f, 0.4f));         // Left point
+    CHECK(!allows(roi, 0.1f, 0.9f));
+    Roi_Cleanup(roi);
+}
+
+static void check_exclude(void) {
+    // No include: the whole frame except a hole
+    RoiMask* roi = make_mask("{\"exclude\": [[[0.4, 0.4], [0.6, 0.4], [0.6, 0.6], [0.4, 0.6]]]}");
+    CHECK(roi != NULL);
+    CHECK(!allows(roi, 0.5f, 0.5f));
+    CHECK(allows(roi, 0.2f, 0.5f));
+    CHECK(allows(roi, 0.0f, 0.0f));
+    CHECK(allows(roi, 1.0f, 1.0f));
+    float crop[4];
+    CHECK(!Roi_Crop(roi, crop));            // Whole frame, nothing to crop
+    Roi_Cleanup(roi);
+
+    // Invalid polygons build no mask
+    CHECK(make_mask("{\"include\": [[[0.1, 0.1], [0.9, 0.1]]]}") == NULL);
+    CHECK(make_mask("{}") == NULL);
+}
+
+static void check_anchor(void) {
+    // Only the lower half counts; a tall box centred above it stands in it
+    const char* lower = "[[[0.0, 0.5], [1.0, 0.5], [1.0, 1.0], [0.0, 1.0]]]";
+    char json[256];
+    Detection person = { .class_id = 0, .confidence = 1.0f, .x = 0.5f, .y = 0.35f,
+                         .width = 0.1f, .height = 0.4f };
+
+    snprintf(json, sizeof(json), "{\"include\": %s}", lower);
+    RoiMask* roi = make_mask(json);
+    CHECK(roi != NULL);
+    CHECK(!Roi_Allows(roi, &person));
+    Roi_Cleanup(roi);
+
+    snprintf(json, sizeof(json), "{\"include\": %s, \"anchor\": \"bottom\"}", lower);
+    roi = make_mask(json);
+    CHECK(roi != NULL);
+    CHECK(Roi_Allows(roi, &person));
+    person.y = 0.2f;                        // Feet at 0.4, above the area
+    CHECK(!Roi_Allows(roi, &person));
+    Roi_Cleanup(roi);
+
+    // No mask lets everything through
+    CHECK(Roi_Allows(NULL, &person));
+}
+
+int main(void) {
+    check_concave();
+    check_self_intersecting();
+    check_exclude();
+    check_anchor();
+
+    printf("check_roi_mask: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/**
+ * Tiling check: grid layout and the NMS that merges tile detections
+ *
+ * layout() and suppress() are pure functions of the tiling state, so the
+ * check includes tiling.c (as the micro-benchmark shims do) and drives
+ * them directly; no frame, model or larod context is needed.
+ *
+ * Build and run:
+ *   make check
+ */
+
+#include "../tiling.c"
+
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        g_failures++; \
+    } \
+} while (0)
+
+static Tiling make_tiling(int cols, int rows, int tile_size, float overlap) {
+    Tiling tiling;
+    memset(&tiling, 0, sizeof(tiling));
+    tiling.cols = cols;
+    tiling.rows = rows;
+    tiling.tile_size = tile_size;
+    tiling.overlap = overlap;
+    tiling.nms_iou = 0.5f;
+    tiling.nms_ios = 0.8f;
+    return tiling;
+}
+
+static Detection box(int class_id, float confidence, float x, float y, float w, float h) {
+    Detection det = { .class_id = class_id, .confidence = confidence,
+                      .x = x, .y = y, .width = w, .height = h };
+    return det;
+}
+
+/* Tiles cover the region, touch its edges and overlap at least as configured */
+static void check_grid(const Tiling* tiling, const int region[4], int cols, int rows) {
+    CHECK(tiling->tile_count == cols * rows);
+    CHECK(tiling->tile_count <= TILING_MAX_TILES);
+    if (tiling->tile_count != cols * rows) return;
+
+    const Tile* first = &tiling->tiles[0];
+    const Tile* last = &tiling->tiles[tiling->tile_count - 1];
+    int size = first->box[2];
+    CHECK(first->box[0] == region[0]);
+    CHECK(first->box[1] == region[1]);
+    CHECK(last->box[0] + size == region[0] + region[2]);
+    CHECK(last->box[1] + size == region[1] + region[3]);
+
+    for (int i = 0; i < tiling->tile_count; i++) {
+        const Tile* tile = &tiling->tiles[i];
+        CHECK(tile->box[2] == size && tile->box[3] == size);
+        CHECK(tile->box[0] >= region[0] && tile->box[0] + size <= region[0] + region[2]);
+        CHECK(tile->box[1] >= region[1] && tile->box[1] + size <= region[1] + region[3]);
+        // Right and lower neighbours
+        if (i % cols + 1 < cols) {
+            int shared = tile->box[0] + size - tiling->tiles[i + 1].box[0];
+            CHECK(shared >= (int)(tiling->overlap * (float)size));
+        }
+        if (i + cols < tiling->tile_count) {
+            int shared = tile->box[1] + size - tiling->tiles[i + cols].box[1];
+            CHECK(shared >= (int)(tiling->overlap * (float)size));
+        }
+    }
+}
+
+static void check_layout(void) {
+    // Fixed odd grid over an offset region: the middle column sits centred
+    const int region[4] = { 100, 60, 1901, 1081 };
+    Tiling tiling = make_tiling(3, 3, 640, 0.2f);
+    layout(&tiling, region);
+    check_grid(&tiling, region, 3, 3);
+    if (tiling.tile_count == 9) {
+        int size = tiling.tiles[0].box[2];
+        int centre = tiling.tiles[4].box[0] + size / 2;
+        CHECK(abs(centre - (region[0] + region[2] / 2)) <= 1);
+    }
+
+    // Automatic grid at the model size, 1920x1080 with 20% overlap: 4x2
+    const int full[4] = { 0, 0, 1920, 1080 };
+    tiling = make_tiling(0, 0, 640, 0.2f);
+    layout(&tiling, full);
+    check_grid(&tiling, full, 4, 2);
+
+    // Too many small tiles: they grow until the grid fits
+    tiling = make_tiling(0, 0, 64, 0.2f);
+    layout(&tiling, full);
+    CHECK(tiling.tile_count > 0 && tiling.tile_count <= TILING_MAX_TILES);
+
+    // A fixed column count over the limit still leaves one row
+    tiling = make_tiling(TILING_MAX_TILES + 3, 0, 64, 0.2f);
+    layout(&tiling, full);
+    CHECK(tiling.tile_count == TILING_MAX_TILES);
+}
+
+static void check_suppress(void) {
+    Tiling tiling = make_tiling(0, 0, 640, 0.2f);
+    Detection d[8];
+
+    // IoU: same object seen twice, the more confident one stays
+    d[0] = box(0, 0.6f, 0.50f, 0.50f, 0.20f, 0.20f);
+    d[1] = box(0, 0.9f, 0.51f, 0.50f, 0.20f, 0.20f);
+    int kept = suppress(&tiling, d, 2);
+    CHECK(kept == 1);
+    CHECK(kept == 1 && d[0].confidence == 0.9f);
+
+    // Other class at the same place is a different object
+    d[0] = box(0, 0.9f, 0.50f, 0.50f, 0.20f, 0.20f);
+    d[1] = box(2, 0.8f, 0.50f, 0.50f, 0.20f, 0.20f);
+    CHECK(suppress(&tiling, d, 2) == 2);
+
+    // IoS: half of an object cut by a tile edge, inside the whole one.
+    // IoU is 0.4 (under nms_iou), intersection over the smaller is 1
+    d[0] = box(0, 0.9f, 0.40f, 0.50f, 0.20f, 0.20f);
+    d[1] = box(0, 0.7f, 0.46f, 0.50f, 0.08f, 0.20f);
+    CHECK(suppress(&tiling, d, 2) == 1);
+    tiling.nms_ios = 1.1f;
+    d[0] = box(0, 0.9f, 0.40f, 0.50f, 0.20f, 0.20f);
+    d[1] = box(0, 0.7f, 0.46f, 0.50f, 0.08f, 0.20f);
+    CHECK(suppress(&tiling, d, 2) == 2);
+    tiling.nms_ios = 0.8f;
+
+    // Touching boxes do not suppress each other
+    d[0] = box(0, 0.9f, 0.30f, 0.50f, 0.20f, 0.20f);
+    d[1] = box(0, 0.8f, 0.50f, 0.50f, 0.20f, 0.20f);
+    CHECK(suppress(&tiling, d, 2) == 2);
+
+    // One person across two overlapping tiles plus the full-frame pass, and
+    // a second person elsewhere: two detections remain, highest first
+    d[0] = box(0, 0.55f, 0.502f, 0.40f, 0.060f, 0.200f);    // Full frame
+    d[1] = box(0, 0.80f, 0.500f, 0.40f, 0.062f, 0.198f);    // Left tile, whole
+    d[2] = box(0, 0.65f, 0.515f, 0.40f, 0.031f, 0.198f);    // Right tile, cut at its edge
+    d[3] = box(0, 0.70f, 0.200f, 0.70f, 0.050f, 0.150f);
+    kept = suppress(&tiling, d, 4);
+    CHECK(kept == 2);
+    CHECK(kept == 2 && d[0].confidence == 0.80f && d[1].confidence == 0.70f);
+}
+
+int main(void) {
+    check_layout();
+    check_suppress();
+
+    printf("check_tiling: %s\n", g_failures ? "FAILED" : "ok");
+    return g_failures ? 1 : 0;
+}
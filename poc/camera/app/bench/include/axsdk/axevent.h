@@ -0,0 +1,68 @@
+/**
+ * axevent.h (host stand-in)
+ *
+ * Subset of the axevent API used by ACAP.c, for the host benchmark build.
+ * Key/value sets can be built; declaring, subscribing and sending fail.
+ */
+
+#ifndef BENCH_AXEVENT_H
+#define BENCH_AXEVENT_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _AXEvent AXEvent;
+typedef struct _AXEventHandler AXEventHandler;
+typedef struct _AXEventKeyValueSet AXEventKeyValueSet;
+typedef struct _AXEventElementItem AXEventElementItem;
+
+typedef enum {
+    AX_VALUE_TYPE_INT,
+    AX_VALUE_TYPE_BOOL,
+    AX_VALUE_TYPE_DOUBLE,
+    AX_VALUE_TYPE_STRING,
+    AX_VALUE_TYPE_ELEMENT,
+    AX_VALUE_TYPE_UNDEFINED
+} AXEventValueType;
+
+typedef void (*AXSubscriptionCallback)(guint subscription, AXEvent* event, gpointer user_data);
+typedef void (*AXDeclarationCompleteCallback)(guint declaration, gpointer user_data);
+
+AXEventHandler* ax_event_handler_new(void);
+void ax_event_handler_free(AXEventHandler* handler);
+gboolean ax_event_handler_declare(AXEventHandler* handler, AXEventKeyValueSet* key_value_set,
+                                  gboolean stateless, guint* declaration,
+                                  AXDeclarationCompleteCallback callback, gpointer user_data,
+                                  GError** error);
+gboolean ax_event_handler_undeclare(AXEventHandler* handler, guint declaration, GError** error);
+gboolean ax_event_handler_send_event(AXEventHandler* handler, guint declaration, AXEvent* event,
+                                     GError** error);
+gboolean ax_event_handler_subscribe(AXEventHandler* handler, AXEventKeyValueSet* key_value_set,
+                                    guint* subscription, AXSubscriptionCallback callback,
+                                    gpointer user_data, GError** error);
+gboolean ax_event_handler_unsubscribe(AXEventHandler* handler, guint subscription, GError** error);
+
+AXEventKeyValueSet* ax_event_key_value_set_new(void);
+void ax_event_key_value_set_free(AXEventKeyValueSet* key_value_set);
+gboolean ax_event_key_value_set_add_key_value(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                              const gchar* name_space, gconstpointer value,
+                                              AXEventValueType value_type, GError** error);
+gboolean ax_event_key_value_set_add_nice_names(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                               const gchar* name_space, const gchar* key_nice_name,
+                                               const gchar* value_nice_name, GError** error);
+gboolean ax_event_key_value_set_mark_as_source(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                               const gchar* name_space, GError** error);
+gboolean ax_event_key_value_set_mark_as_data(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                             const gchar* name_space, GError** error);
+gboolean ax_event_key_value_set_mark_as_user_defined(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                                     const gchar* name_space, const gchar* user_tag,
+                                                     GError** error);
+
+AXEvent* ax_event_new2(AXEventKeyValueSet* key_value_set, GDateTime* time_stamp);
+void ax_event_free(AXEvent* event);
+const AXEventKeyValueSet* ax_event_get_key_value_set(AXEvent* event);
+
+G_END_DECLS
+
+#endif /* BENCH_AXEVENT_H */
@@ -0,0 +1,45 @@
+/**
+ * fcgi_stdio.h (host stand-in)
+ *
+ * FastCGI request API used by ACAP.c, for the host benchmark build. The
+ * benchmark never starts the HTTP thread, so every call simply fails.
+ * Unlike the real header, stdio is not redirected.
+ */
+
+#ifndef BENCH_FCGI_STDIO_H
+#define BENCH_FCGI_STDIO_H
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FCGX_Stream FCGX_Stream;
+typedef char** FCGX_ParamArray;
+
+typedef struct FCGX_Request {
+    int requestId;
+    int role;
+    FCGX_Stream* in;
+    FCGX_Stream* out;
+    FCGX_Stream* err;
+    char** envp;
+    int listen_sock;
+} FCGX_Request;
+
+int FCGX_Init(void);
+int FCGX_OpenSocket(const char* path, int backlog);
+int FCGX_InitRequest(FCGX_Request* request, int sock, int flags);
+int FCGX_Accept_r(FCGX_Request* request);
+void FCGX_Finish_r(FCGX_Request* request);
+void FCGX_Free(FCGX_Request* request, int close);
+char* FCGX_GetParam(const char* name, FCGX_ParamArray envp);
+int FCGX_GetStr(char* str, int n, FCGX_Stream* stream);
+int FCGX_PutStr(const char* str, int n, FCGX_Stream* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_FCGI_STDIO_H */
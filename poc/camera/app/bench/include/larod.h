@@ -0,0 +1,106 @@
+/**
+ * larod.h (host stand-in)
+ *
+ * Subset of the larod v3 API used by the Axis I.S. POC, for the host
+ * benchmark build. Every call fails with "larod not available on host";
+ * the benchmark drives inference through the replay backend instead.
+ */
+
+#ifndef BENCH_LAROD_H
+#define BENCH_LAROD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LAROD_TENSOR_MAX_LEN 12
+
+#define LAROD_FD_PROP_READWRITE (1UL << 0)
+#define LAROD_FD_PROP_MAP (1UL << 1)
+#define LAROD_FD_PROP_DMABUF (1UL << 2)
+
+typedef struct larodConnection larodConnection;
+typedef struct larodModel larodModel;
+typedef struct larodTensor larodTensor;
+typedef struct larodDevice larodDevice;
+typedef struct larodJobRequest larodJobRequest;
+typedef struct larodMap larodMap;
+
+typedef enum {
+    LAROD_ERROR_NONE = 0,
+    LAROD_ERROR_JOB = -1,
+    LAROD_ERROR_LOAD_MODEL = -2,
+    LAROD_ERROR_FD = -3,
+    LAROD_ERROR_MODEL_NOT_FOUND = -4,
+    LAROD_ERROR_PERMISSION = -5,
+    LAROD_ERROR_CONNECTION = -6
+} larodErrorCode;
+
+typedef struct {
+    larodErrorCode code;
+    const char* msg;
+} larodError;
+
+typedef enum {
+    LAROD_ACCESS_INVALID,
+    LAROD_ACCESS_PRIVATE,
+    LAROD_ACCESS_PUBLIC
+} larodAccess;
+
+typedef struct {
+    size_t dims[LAROD_TENSOR_MAX_LEN];
+    size_t len;
+} larodTensorDims;
+
+bool larodConnect(larodConnection** conn, larodError** error);
+bool larodDisconnect(larodConnection** conn, larodError** error);
+void larodClearError(larodError** error);
+
+larodDevice** larodListDevices(larodConnection* conn, size_t* num_devices, larodError** error);
+const char* larodGetDeviceName(const larodDevice* dev, larodError** error);
+const larodDevice* larodGetDevice(const larodConnection* conn, const char* name, uint32_t instance,
+                                  larodError** error);
+
+larodModel* larodLoadModel(larodConnection* conn, int fd, const larodDevice* dev, larodAccess access,
+                           const char* name, const larodMap* params, larodError** error);
+bool larodDestroyModel(larodModel** model);
+
+larodTensor** larodAllocModelInputs(larodConnection* conn, const larodModel* model, uint32_t fd_prop_flags,
+                                    size_t* num_tensors, larodMap* params, larodError** error);
+larodTensor** larodAllocModelOutputs(larodConnection* conn, const larodModel* model, uint32_t fd_prop_flags,
+                                     size_t* num_tensors, larodMap* params, larodError** error);
+larodTensor** larodCreateModelInputs(const larodModel* model, size_t* num_tensors, larodError** error);
+larodTensor** larodCreateModelOutputs(const larodModel* model, size_t* num_tensors, larodError** error);
+bool larodDestroyTensors(larodConnection* conn, larodTensor*** tensors, size_t num_tensors, larodError** error);
+int larodGetTensorFd(const larodTensor* tensor, larodError** error);
+bool larodGetTensorFdSize(const larodTensor* tensor, size_t* size, larodError** error);
+bool larodSetTensorFd(larodTensor* tensor, int fd, larodError** error);
+bool larodSetTensorFdOffset(larodTensor* tensor, int64_t offset, larodError** error);
+const larodTensorDims* larodGetTensorDims(const larodTensor* tensor, larodError** error);
+
+larodJobRequest* larodCreateJobRequest(const larodModel* model, larodTensor** inputs, size_t num_inputs,
+                                       larodTensor** outputs, size_t num_outputs, larodMap* params,
+                                       larodError** error);
+bool larodSetJobRequestInputs(larodJobRequest* req, larodTensor** tensors, size_t num_tensors, larodError** error);
+bool larodSetJobRequestOutputs(larodJobRequest* req, larodTensor** tensors, size_t num_tensors, larodError** error);
+bool larodSetJobRequestParams(larodJobRequest* req, const larodMap* params, larodError** error);
+bool larodRunJob(larodConnection* conn, const larodJobRequest* req, larodError** error);
+void larodDestroyJobRequest(larodJobRequest** req);
+
+larodMap* larodCreateMap(larodError** error);
+void larodDestroyMap(larodMap** map);
+bool larodMapSetStr(larodMap* map, const char* key, const char* value, larodError** error);
+bool larodMapSetInt(larodMap* map, const char* key, int64_t value, larodError** error);
+bool larodMapSetIntArr2(larodMap* map, const char* key, int64_t value0, int64_t value1, larodError** error);
+bool larodMapSetIntArr4(larodMap* map, const char* key, int64_t value0, int64_t value1, int64_t value2,
+                        int64_t value3, larodError** error);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCH_LAROD_H */
@@ -0,0 +1,20 @@
+/**
+ * vdo-buffer.h (host stand-in)
+ */
+
+#ifndef BENCH_VDO_BUFFER_H
+#define BENCH_VDO_BUFFER_H
+
+#include "vdo-types.h"
+
+G_BEGIN_DECLS
+
+gpointer vdo_buffer_get_data(VdoBuffer* self);
+VdoFrame* vdo_buffer_get_frame(VdoBuffer* self);
+gsize vdo_buffer_get_capacity(VdoBuffer* self);
+gint vdo_buffer_get_fd(VdoBuffer* self);
+gint64 vdo_buffer_get_offset(VdoBuffer* self);
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_BUFFER_H */
@@ -0,0 +1,18 @@
+/**
+ * vdo-channel.h (host stand-in)
+ */
+
+#ifndef BENCH_VDO_CHANNEL_H
+#define BENCH_VDO_CHANNEL_H
+
+#include "vdo-map.h"
+
+G_BEGIN_DECLS
+
+VdoChannel* vdo_channel_get(guint channel_nbr, GError** error);
+VdoResolutionSet* vdo_channel_get_resolutions(VdoChannel* self, const VdoMap* filter, GError** error);
+VdoMap* vdo_channel_get_info(VdoChannel* self, GError** error);
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_CHANNEL_H */
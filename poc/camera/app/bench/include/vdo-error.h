@@ -0,0 +1,16 @@
+/**
+ * vdo-error.h (host stand-in)
+ */
+
+#ifndef BENCH_VDO_ERROR_H
+#define BENCH_VDO_ERROR_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gboolean vdo_error_is_expected(GError** error);
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_ERROR_H */
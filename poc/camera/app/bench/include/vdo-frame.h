@@ -0,0 +1,18 @@
+/**
+ * vdo-frame.h (host stand-in)
+ */
+
+#ifndef BENCH_VDO_FRAME_H
+#define BENCH_VDO_FRAME_H
+
+#include "vdo-buffer.h"
+
+G_BEGIN_DECLS
+
+guint64 vdo_frame_get_timestamp(VdoFrame* self);
+gsize vdo_frame_get_size(VdoFrame* self);
+guint vdo_frame_get_sequence_nbr(VdoFrame* self);
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_FRAME_H */
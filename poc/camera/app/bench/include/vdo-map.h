@@ -0,0 +1,20 @@
+/**
+ * vdo-map.h (host stand-in)
+ */
+
+#ifndef BENCH_VDO_MAP_H
+#define BENCH_VDO_MAP_H
+
+#include "vdo-types.h"
+
+G_BEGIN_DECLS
+
+VdoMap* vdo_map_new(void);
+void vdo_map_set_uint32(VdoMap* self, const gchar* name, guint32 value);
+void vdo_map_set_string(VdoMap* self, const gchar* name, const gchar* value);
+void vdo_map_set_boolean(VdoMap* self, const gchar* name, gboolean value);
+guint32 vdo_map_get_uint32(const VdoMap* self, const gchar* name, guint32 def);
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_MAP_H */
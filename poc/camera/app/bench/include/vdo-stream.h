@@ -0,0 +1,23 @@
+/**
+ * vdo-stream.h (host stand-in)
+ */
+
+#ifndef BENCH_VDO_STREAM_H
+#define BENCH_VDO_STREAM_H
+
+#include "vdo-map.h"
+#include "vdo-buffer.h"
+#include "vdo-frame.h"
+
+G_BEGIN_DECLS
+
+VdoStream* vdo_stream_new(VdoMap* settings, gpointer user_data, GError** error);
+gboolean vdo_stream_start(VdoStream* self, GError** error);
+void vdo_stream_stop(VdoStream* self);
+VdoBuffer* vdo_stream_get_buffer(VdoStream* self, GError** error);
+gboolean vdo_stream_buffer_unref(VdoStream* self, VdoBuffer** buffer, GError** error);
+VdoMap* vdo_stream_get_info(VdoStream* self, GError** error);
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_STREAM_H */
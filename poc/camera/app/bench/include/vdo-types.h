@@ -0,0 +1,48 @@
+/**
+ * vdo-types.h (host stand-in)
+ *
+ * Subset of the ACAP SDK VDO types used by the Axis I.S. POC, for the
+ * host benchmark build. Signatures follow the SDK headers.
+ */
+
+#ifndef BENCH_VDO_TYPES_H
+#define BENCH_VDO_TYPES_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+typedef enum {
+    VDO_FORMAT_NONE = -1,
+    VDO_FORMAT_H264 = 0,
+    VDO_FORMAT_H265,
+    VDO_FORMAT_JPEG,
+    VDO_FORMAT_YUV,
+    VDO_FORMAT_BAYER,
+    VDO_FORMAT_IVS,
+    VDO_FORMAT_RAW,
+    VDO_FORMAT_RGBA,
+    VDO_FORMAT_RGB,
+    VDO_FORMAT_PLANAR_RGB
+} VdoFormat;
+
+typedef struct _VdoBuffer VdoBuffer;
+typedef struct _VdoStream VdoStream;
+typedef struct _VdoMap VdoMap;
+typedef struct _VdoFrame VdoFrame;
+typedef struct _VdoChannel VdoChannel;
+
+typedef struct {
+    guint width;
+    guint height;
+} VdoResolution;
+
+typedef struct {
+    gsize count;
+    VdoResolution resolutions[];
+} VdoResolutionSet;
+
+G_END_DECLS
+
+#endif /* BENCH_VDO_TYPES_H */
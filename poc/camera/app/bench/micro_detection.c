@@ -0,0 +1,30 @@
+/**
+ * micro_detection.c
+ *
+ * detection_module.c with its scene hash and motion kernels exposed to the
+ * micro-benchmarks
+ */
+
+#include "../detection_module.c"
+#include "micro_kernels.h"
+
+uint32_t Micro_Scene_Hash(const unsigned char* data, size_t size) {
+    uint32_t hash = 0;
+    compute_scene_hash(data, size, &hash);
+    return hash;
+}
+
+void* Micro_Motion_New(void) {
+    return calloc(1, sizeof(DetectionState));
+}
+
+float Micro_Motion_Score(void* state, const unsigned char* frame_data, size_t size) {
+    return compute_motion_score((DetectionState*)state, frame_data, size);
+}
+
+void Micro_Motion_Free(void* state) {
+    DetectionState* s = (DetectionState*)state;
+    if (!s) return;
+    free(s->last_frame_data);
+    free(s);
+}
@@ -0,0 +1,37 @@
+/**
+ * micro_kernels.h
+ *
+ * Entry points into file-static per-frame kernels for the Axis I.S.
+ * micro-benchmarks. Each micro_*.c shim includes the translation unit that
+ * owns the kernel and forwards to it, so the benchmark times the exact
+ * code that ships without widening the application's interfaces.
+ */
+
+#ifndef MICRO_KERNELS_H
+#define MICRO_KERNELS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "larod_handler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* larod_handler.c */
+void Micro_Parse_Yolo(LarodContext* ctx, const float* output_data, Detection* detections, int* num_detections);
+
+/* detection_module.c */
+uint32_t Micro_Scene_Hash(const unsigned char* data, size_t size);
+void* Micro_Motion_New(void);
+float Micro_Motion_Score(void* state, const unsigned char* frame_data, size_t size);
+void Micro_Motion_Free(void* state);
+
+/* frame_publisher.c */
+char* Micro_Base64_Publisher(const unsigned char* data, size_t length, size_t* output_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MICRO_KERNELS_H */
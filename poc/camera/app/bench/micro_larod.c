@@ -0,0 +1,12 @@
+/**
+ * micro_larod.c
+ *
+ * larod_handler.c with its YOLO decoder exposed to the micro-benchmarks
+ */
+
+#include "../larod_handler.c"
+#include "micro_kernels.h"
+
+void Micro_Parse_Yolo(LarodContext* ctx, const float* output_data, Detection* detections, int* num_detections) {
+    parse_yolo_output(ctx, output_data, detections, num_detections);
+}
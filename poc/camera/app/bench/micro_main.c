@@ -0,0 +1,683 @@
+/**
+ * Axis I.S. Micro-Benchmarks
+ *
+ * Times the per-frame kernels in isolation on fixed inputs at several sizes:
+ *
+ *   parse_yolo_output        YOLOv5n output decode (by anchors above threshold)
+ *   scene_hash, motion       detection module frame kernels (by resolution)
+ *   base64 (publisher/utils) both base64 encoders (by input size)
+ *   jpeg (views/utils)       frame view cache and module_utils JPEG encoders
+ *   rgb_views                NV12 to RGB at model size (by source resolution)
+ *   metadata_publish         core_api_publish_metadata (by detection count)
+ *   mqtt_publish_json        MQTT_Publish_JSON payload building (null sink)
+ *
+ * Frames come from the synthetic frame source, or from a recording with
+ * --input. Output tensors are generated with a fixed seed, or taken from a
+ * replay recording with --tensors.
+ *
+ * Each case is warmed up, calibrated so one repetition lasts --rep-ms, then
+ * timed over --reps repetitions; min and median time per call are
+ * reported. --json writes a baseline, --compare diffs against one.
+ *
+ * Usage (from the app directory):
+ *   make microbench
+ *   make -C bench micro && bench/obj-micro/axis_is_micro --json > baseline.json
+ *   make microbench MICRO_ARGS="--compare baseline.json --filter jpeg"
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <getopt.h>
+
+#include "cJSON.h"
+#include "MQTT.h"
+#include "core.h"
+#include "module.h"
+#include "detection_slot.h"
+#include "frame_source.h"
+#include "inference_backend.h"
+#include "micro_kernels.h"
+
+#define MICRO_MAX_CASES 64
+#define MICRO_MAX_REPS 101
+#define MICRO_MAX_DETECTIONS 128
+#define MICRO_SEED 0x2545F491u
+
+typedef void (*MicroFn)(void* arg);
+
+typedef struct {
+    char kernel[32];
+    char size[32];
+    size_t bytes;               // Input bytes per call, 0 when throughput is meaningless
+    MicroFn fn;
+    void* arg;
+
+    long iterations;            // Calls per repetition
+    double min_ns;              // Per call
+    double median_ns;
+} MicroCase;
+
+typedef struct {
+    int reps;
+    int warmup_ms;
+    int rep_ms;
+    const char* filter;
+    const char* input;
+    const char* tensors;
+    const char* compare;
+    int json;
+} MicroOptions;
+
+/* YOLO decode input */
+typedef struct {
+    LarodContext ctx;
+    const float* tensor;
+    Detection detections[MICRO_MAX_DETECTIONS];
+    int count;
+} YoloArg;
+
+/* Two consecutive NV12 frames, used alternately */
+typedef struct {
+    unsigned char* frames[2];
+    unsigned char* ycc;         // Interleaved 3-byte pixels for encode_jpeg()
+    FrameViews* views;
+    size_t size;
+    int width;
+    int height;
+    int next;
+    void* motion;
+} FrameArg;
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+} BufferArg;
+
+typedef struct {
+    CoreContext* core;
+    MetadataFrame* meta;
+    int slot;
+    cJSON* payload;
+} MetadataArg;
+
+static MicroCase g_cases[MICRO_MAX_CASES];
+static int g_case_count = 0;
+static volatile uint64_t g_sink = 0;
+static uint32_t g_rng = MICRO_SEED;
+
+static uint32_t rng_next(void) {
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+static float rng_unit(void) {
+    return (float)(rng_next() >> 8) / 16777216.0f;
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void add_case(const char* kernel, const char* size, size_t bytes, MicroFn fn, void* arg) {
+    if (g_case_count >= MICRO_MAX_CASES || !arg) return;
+    MicroCase* c = &g_cases[g_case_count++];
+    snprintf(c->kernel, sizeof(c->kernel), "%s", kernel);
+    snprintf(c->size, sizeof(c->size), "%s", size);
+    c->bytes = bytes;
+    c->fn = fn;
+    c->arg = arg;
+}
+
+/*------------------------------------------------------------------
+ * Kernels
+ *------------------------------------------------------------------*/
+
+static void run_yolo(void* arg) {
+    YoloArg* a = (YoloArg*)arg;
+    Micro_Parse_Yolo(&a->ctx, a->tensor, a->detections, &a->count);
+    g_sink += (uint64_t)a->count;
+}
+
+static void run_scene_hash(void* arg) {
+    FrameArg* a = (FrameArg*)arg;
+    g_sink += Micro_Scene_Hash(a->frames[a->next], a->size);
+    a->next ^= 1;
+}
+
+static void run_motion(void* arg) {
+    FrameArg* a = (FrameArg*)arg;
+    g_sink += (uint64_t)(Micro_Motion_Score(a->motion, a->frames[a->next], a->size) * 1000.0f);
+    a->next ^= 1;
+}
+
+static void run_base64_publisher(void* arg) {
+    BufferArg* a = (BufferArg*)arg;
+    size_t length = 0;
+    char* encoded = Micro_Base64_Publisher(a->data, a->size, &length);
+    if (encoded) g_sink += (unsigned char)encoded[length / 2];
+    free(encoded);
+}
+
+static void run_base64_utils(void* arg) {
+    BufferArg* a = (BufferArg*)arg;
+    char* encoded = NULL;
+    if (encode_base64((const char*)a->data, a->size, &encoded) == 0) {
+        g_sink += (unsigned char)encoded[0];
+    }
+    free(encoded);
+}
+
+/* A new frame per call, so every request is a cache miss */
+static void run_jpeg_views(void* arg) {
+    FrameArg* a = (FrameArg*)arg;
+    FrameView view;
+    Views_Begin_Frame(a->views, a->frames[a->next], VIEWS_FORMAT_NV12, a->width, a->height);
+    if (Views_JPEG(a->views, 85, &view)) g_sink += view.size;
+    Views_End_Frame(a->views);
+    a->next ^= 1;
+}
+
+static void run_rgb_views(void* arg) {
+    FrameArg* a = (FrameArg*)arg;
+    FrameView view;
+    Views_Begin_Frame(a->views, a->frames[a->next], VIEWS_FORMAT_NV12, a->width, a->height);
+    if (Views_RGB(a->views, 640, 640, &view)) g_sink += view.data[0];
+    Views_End_Frame(a->views);
+    a->next ^= 1;
+}
+
+static void run_jpeg_utils(void* arg) {
+    FrameArg* a = (FrameArg*)arg;
+    char* jpeg = NULL;
+    size_t size = 0;
+    if (encode_jpeg(a->ycc, a->width, a->height, VDO_FORMAT_YUV, &jpeg, &size) == 0) {
+        g_sink += size;
+    }
+    free(jpeg);
+}
+
+static void run_metadata_publish(void* arg) {
+    MetadataArg* a = (MetadataArg*)arg;
+    core_api_publish_metadata(a->core, a->meta);
+}
+
+static void run_mqtt_publish_json(void* arg) {
+    MetadataArg* a = (MetadataArg*)arg;
+    g_sink += (uint64_t)MQTT_Publish_JSON("axis-is/camera/micro/metadata", a->payload, 0, 0);
+}
+
+/*------------------------------------------------------------------
+ * Inputs
+ *------------------------------------------------------------------*/
+
+/**
+ * Output tensor with `hits` anchors above threshold, spread evenly
+ * Everything else is low-confidence noise, as in a real frame
+ */
+static float* make_tensor(int hits) {
+    size_t floats = INFERENCE_DEFAULT_OUTPUT_BYTES / sizeof(float);
+    float* tensor = (float*)malloc(floats * sizeof(float));
+    if (!tensor) return NULL;
+
+    g_rng = MICRO_SEED;
+    for (int i = 0; i < 25200; i++) {
+        float* anchor = &tensor[i * 85];
+        anchor[0] = rng_unit() * 640.0f;
+        anchor[1] = rng_unit() * 640.0f;
+        anchor[2] = 8.0f + rng_unit() * 120.0f;
+        anchor[3] = 8.0f + rng_unit() * 120.0f;
+        anchor[4] = rng_unit() * 0.05f;
+        for (int c = 0; c < 80; c++) {
+            anchor[5 + c] = rng_unit() * 0.1f;
+        }
+    }
+    for (int h = 0; h < hits; h++) {
+        float* anchor = &tensor[(size_t)h * (25200 / hits) * 85];
+        anchor[4] = 0.9f;
+        anchor[5 + (h % 80)] = 0.8f;
+    }
+    return tensor;
+}
+
+/**
+ * First output tensor of a replay recording
+ */
+static float* load_tensor(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "micro: Cannot open %s\n", path);
+        return NULL;
+    }
+    float* tensor = (float*)malloc(INFERENCE_DEFAULT_OUTPUT_BYTES);
+    if (tensor && fread(tensor, 1, INFERENCE_DEFAULT_OUTPUT_BYTES, file) != INFERENCE_DEFAULT_OUTPUT_BYTES) {
+        fprintf(stderr, "micro: %s holds no complete output tensor\n", path);
+        free(tensor);
+        tensor = NULL;
+    }
+    fclose(file);
+    return tensor;
+}
+
+static YoloArg* make_yolo_arg(const float* tensor) {
+    YoloArg* a = (YoloArg*)calloc(1, sizeof(YoloArg));
+    if (!a) return NULL;
+    a->ctx.confidence_threshold = 0.25f;
+    a->tensor = tensor;
+    return a;
+}
+
+/**
+ * Two consecutive frames from a frame source
+ * @param path Recording, or NULL for the synthetic source at width x height
+ */
+static FrameArg* make_frames(const char* path, int width, int height) {
+    cJSON* config = cJSON_CreateObject();
+    cJSON_AddStringToObject(config, "type", path ? "file" : "synthetic");
+    if (path) cJSON_AddStringToObject(config, "path", path);
+    cJSON_AddTrueToObject(config, "loop");
+    cJSON_AddFalseToObject(config, "paced");
+
+    FrameSource* source = FrameSource_Init(config, width, height, 30);
+    cJSON_Delete(config);
+    if (!source) return NULL;
+
+    FrameArg* a = (FrameArg*)calloc(1, sizeof(FrameArg));
+    if (!a) {
+        FrameSource_Cleanup(source);
+        return NULL;
+    }
+    a->width = (int)source->width;
+    a->height = (int)source->height;
+
+    for (int i = 0; i < 2; i++) {
+        SourceFrame frame;
+        if (!FrameSource_Get_Frame(source, &frame)) break;
+        a->size = frame.size;
+        a->frames[i] = (unsigned char*)malloc(frame.size);
+        if (a->frames[i]) memcpy(a->frames[i], frame.data, frame.size);
+        FrameSource_Release_Frame(source, &frame);
+    }
+    FrameSource_Cleanup(source);
+
+    // encode_jpeg() takes 3-byte pixels: expand NV12 to interleaved YCbCr
+    size_t pixels = (size_t)a->width * a->height;
+    a->ycc = (unsigned char*)malloc(pixels * 3);
+    a->motion = Micro_Motion_New();
+    a->views = Views_Create();
+    if (!a->frames[0] || !a->frames[1] || !a->ycc || !a->motion || !a->views) {
+        fprintf(stderr, "micro: Failed to prepare %dx%d frames\n", width, height);
+        return NULL;
+    }
+    const unsigned char* y_plane = a->frames[0];
+    const unsigned char* uv_plane = a->frames[0] + pixels;
+    for (int y = 0; y < a->height; y++) {
+        for (int x = 0; x < a->width; x++) {
+            size_t i = (size_t)y * a->width + x;
+            size_t uv = (size_t)(y / 2) * a->width + (x & ~1);
+            a->ycc[i * 3 + 0] = y_plane[i];
+            a->ycc[i * 3 + 1] = uv_plane[uv];
+            a->ycc[i * 3 + 2] = uv_plane[uv + 1];
+        }
+    }
+
+    // Prime the motion kernel with the first frame
+    Micro_Motion_Score(a->motion, a->frames[1], a->size);
+    return a;
+}
+
+static BufferArg* make_buffer(size_t size) {
+    BufferArg* a = (BufferArg*)calloc(1, sizeof(BufferArg));
+    if (!a) return NULL;
+    a->data = (unsigned char*)malloc(size);
+    if (!a->data) {
+        free(a);
+        return NULL;
+    }
+    g_rng = MICRO_SEED;
+    for (size_t i = 0; i < size; i++) a->data[i] = (unsigned char)rng_next();
+    a->size = size;
+    return a;
+}
+
+/**
+ * Metadata frame as the detection module leaves it, and the payload
+ * core_api_publish_metadata builds from it
+ */
+static MetadataArg* make_metadata(int detections) {
+    MetadataArg* a = (MetadataArg*)calloc(1, sizeof(MetadataArg));
+    if (!a) return NULL;
+
+    a->core = (CoreContext*)calloc(1, sizeof(CoreContext));
+    a->meta = metadata_create();
+    if (!a->core || !a->meta) return NULL;
+
+    a->core->config = cJSON_CreateObject();
+    cJSON_AddStringToObject(a->core->config, "camera_id", "axis-camera-001");
+    pthread_mutex_init(&a->core->metadata_mutex, NULL);
+
+    a->core->blackboard = Blackboard_Create();
+    a->meta->blackboard = a->core->blackboard;
+    a->slot = Blackboard_Register(a->core->blackboard, "detection", sizeof(DetectionSlot),
+                                  detection_fields, BB_FIELD_COUNT(detection_fields));
+    if (a->slot < 0) return NULL;
+
+    g_rng = MICRO_SEED;
+    a->meta->timestamp_us = 1700000000000000LL;
+    a->meta->sequence = 4242;
+    a->meta->motion_score = 0.125f;
+    a->meta->scene_hash = rng_next();
+    for (int i = 0; i < detections; i++) {
+        Detection det = {
+            .class_id = (int)(rng_next() % 80),
+            .confidence = 0.25f + rng_unit() * 0.75f,
+            .x = rng_unit(), .y = rng_unit(),
+            .width = rng_unit() * 0.2f, .height = rng_unit() * 0.2f
+        };
+        metadata_add_detection(a->meta, det);
+    }
+
+    Blackboard_Begin_Frame(a->meta->blackboard);
+    DetectionSlot* slot = (DetectionSlot*)Blackboard_Write(a->meta->blackboard, a->slot);
+    slot->inference_time_ms = 42;
+    slot->num_detections = detections;
+    slot->confidence_threshold = 0.25f;
+    slot->ml_enabled = 1;
+
+    core_api_publish_metadata(a->core, a->meta);
+    a->payload = core_get_latest_metadata(a->core);
+    return a->payload ? a : NULL;
+}
+
+/*------------------------------------------------------------------
+ * Runner
+ *------------------------------------------------------------------*/
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static void measure(MicroCase* c, const MicroOptions* opt) {
+    // Warmup, also estimating the cost of one call
+    long calls = 0;
+    int64_t start = now_ns();
+    int64_t elapsed;
+    do {
+        c->fn(c->arg);
+        calls++;
+        elapsed = now_ns() - start;
+    } while (elapsed < (int64_t)opt->warmup_ms * 1000000);
+
+    double per_call = (double)elapsed / (double)calls;
+    c->iterations = (long)((double)opt->rep_ms * 1e6 / per_call);
+    if (c->iterations < 1) c->iterations = 1;
+
+    double samples[MICRO_MAX_REPS];
+    for (int r = 0; r < opt->reps; r++) {
+        start = now_ns();
+        for (long i = 0; i < c->iterations; i++) {
+            c->fn(c->arg);
+        }
+        samples[r] = (double)(now_ns() - start) / (double)c->iterations;
+    }
+
+    qsort(samples, opt->reps, sizeof(double), compare_double);
+    c->min_ns = samples[0];
+    c->median_ns = samples[opt->reps / 2];
+}
+
+/**
+ * Median of the same kernel/size in a baseline report, 0 if absent
+ */
+static double baseline_median(cJSON* baseline, const MicroCase* c) {
+    cJSON* item;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(baseline, "cases")) {
+        cJSON* kernel = cJSON_GetObjectItem(item, "kernel");
+        cJSON* size = cJSON_GetObjectItem(item, "size");
+        cJSON* median = cJSON_GetObjectItem(item, "median_ns");
+        if (cJSON_IsString(kernel) && cJSON_IsString(size) && cJSON_IsNumber(median) &&
+            strcmp(kernel->valuestring, c->kernel) == 0 && strcmp(size->valuestring, c->size) == 0) {
+            return median->valuedouble;
+        }
+    }
+    return 0;
+}
+
+static void print_table(const MicroOptions* opt, cJSON* baseline) {
+    printf("%-24s %-12s %12s %12s %10s%s\n", "kernel", "size", "min_us", "median_us", "MB/s",
+           baseline ? "     vs base" : "");
+    for (int i = 0; i < g_case_count; i++) {
+        MicroCase* c = &g_cases[i];
+        if (c->iterations == 0) continue;
+
+        char rate[16] = "-";
+        if (c->bytes) {
+            snprintf(rate, sizeof(rate), "%.1f", (double)c->bytes / c->median_ns * 1e3);
+        }
+        printf("%-24s %-12s %12.3f %12.3f %10s", c->kernel, c->size, c->min_ns / 1e3, c->median_ns / 1e3, rate);
+        if (baseline) {
+            double base = baseline_median(baseline, c);
+            if (base > 0) {
+                printf("   %+8.1f%%", (c->median_ns - base) / base * 100.0);
+            } else {
+                printf("   %9s", "new");
+            }
+        }
+        printf("\n");
+    }
+}
+
+static void print_json(const MicroOptions* opt) {
+    cJSON* report = cJSON_CreateObject();
+    cJSON_AddNumberToObject(report, "reps", opt->reps);
+    cJSON_AddNumberToObject(report, "rep_ms", opt->rep_ms);
+    cJSON* cases = cJSON_AddArrayToObject(report, "cases");
+    for (int i = 0; i < g_case_count; i++) {
+        MicroCase* c = &g_cases[i];
+        if (c->iterations == 0) continue;
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "kernel", c->kernel);
+        cJSON_AddStringToObject(item, "size", c->size);
+        cJSON_AddNumberToObject(item, "bytes", (double)c->bytes);
+        cJSON_AddNumberToObject(item, "iterations", (double)c->iterations);
+        cJSON_AddNumberToObject(item, "min_ns", c->min_ns);
+        cJSON_AddNumberToObject(item, "median_ns", c->median_ns);
+        cJSON_AddItemToArray(cases, item);
+    }
+
+    char* text = cJSON_Print(report);
+    if (text) {
+        printf("%s\n", text);
+        free(text);
+    }
+    cJSON_Delete(report);
+}
+
+static cJSON* load_baseline(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "micro: Cannot open baseline %s\n", path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* text = size > 0 ? (char*)malloc((size_t)size + 1) : NULL;
+    cJSON* baseline = NULL;
+    if (text && fread(text, 1, (size_t)size, file) == (size_t)size) {
+        text[size] = 0;
+        baseline = cJSON_Parse(text);
+    }
+    if (!baseline) fprintf(stderr, "micro: Invalid baseline %s\n", path);
+    free(text);
+    fclose(file);
+    return baseline;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --reps N          Timed repetitions per case (default 15, max %d)\n"
+        "  --warmup-ms N     Warmup per case (default 50)\n"
+        "  --rep-ms N        Target duration of one repetition (default 20)\n"
+        "  --filter TEXT     Only run kernels whose name contains TEXT\n"
+        "  --input PATH      Also run the frame kernels on a Y4M or NV12 recording\n"
+        "  --tensors PATH    Also decode the first tensor of a replay recording\n"
+        "  --json            Print a JSON baseline instead of the table\n"
+        "  --compare PATH    Show median change against a JSON baseline\n",
+        prog, MICRO_MAX_REPS);
+}
+
+static int parse_options(int argc, char** argv, MicroOptions* opt) {
+    static const struct option longopts[] = {
+        { "reps", required_argument, NULL, 'r' },
+        { "warmup-ms", required_argument, NULL, 'w' },
+        { "rep-ms", required_argument, NULL, 'm' },
+        { "filter", required_argument, NULL, 'f' },
+        { "input", required_argument, NULL, 'i' },
+        { "tensors", required_argument, NULL, 't' },
+        { "json", no_argument, NULL, 'j' },
+        { "compare", required_argument, NULL, 'c' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    *opt = (MicroOptions){ .reps = 15, .warmup_ms = 50, .rep_ms = 20 };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "h", longopts, NULL)) != -1) {
+        switch (c) {
+            case 'r': opt->reps = atoi(optarg); break;
+            case 'w': opt->warmup_ms = atoi(optarg); break;
+            case 'm': opt->rep_ms = atoi(optarg); break;
+            case 'f': opt->filter = optarg; break;
+            case 'i': opt->input = optarg; break;
+            case 't': opt->tensors = optarg; break;
+            case 'j': opt->json = 1; break;
+            case 'c': opt->compare = optarg; break;
+            default: return 0;
+        }
+    }
+    return opt->reps > 0 && opt->reps <= MICRO_MAX_REPS && opt->warmup_ms >= 0 && opt->rep_ms > 0;
+}
+
+int main(int argc, char** argv) {
+    MicroOptions opt;
+    if (!parse_options(argc, argv, &opt)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // Kernels log through printf; keep stdout for the results
+    fflush(stdout);
+    FILE* results = fdopen(dup(STDOUT_FILENO), "w");
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    if (!results) return 1;
+
+    static const int hits[] = { 0, 10, 100, 1000 };
+    for (size_t i = 0; i < sizeof(hits) / sizeof(hits[0]); i++) {
+        char size[32];
+        snprintf(size, sizeof(size), "%d hits", hits[i]);
+        float* tensor = make_tensor(hits[i]);
+        add_case("parse_yolo_output", size, INFERENCE_DEFAULT_OUTPUT_BYTES, run_yolo,
+                 tensor ? make_yolo_arg(tensor) : NULL);
+    }
+    // Class filter as deployed: people and road vehicles only
+    static const int deployed_classes[] = { 0, 1, 2, 3, 5, 7 };
+    float* masked_tensor = make_tensor(100);
+    YoloArg* masked = masked_tensor ? make_yolo_arg(masked_tensor) : NULL;
+    if (masked) {
+        Larod_Set_Classes(&masked->ctx, deployed_classes,
+                          (int)(sizeof(deployed_classes) / sizeof(deployed_classes[0])), NULL);
+    }
+    add_case("parse_yolo_output", "100 hits, 6 classes", INFERENCE_DEFAULT_OUTPUT_BYTES, run_yolo, masked);
+    if (opt.tensors) {
+        float* tensor = load_tensor(opt.tensors);
+        add_case("parse_yolo_output", "recorded", INFERENCE_DEFAULT_OUTPUT_BYTES, run_yolo,
+                 tensor ? make_yolo_arg(tensor) : NULL);
+    }
+
+    static const struct { int width, height; const char* label; } resolutions[] = {
+        { 320, 240, "320x240" },
+        { 640, 640, "640x640" },
+        { 1280, 720, "1280x720" },
+        { 1920, 1080, "1920x1080" }
+    };
+    int resolution_count = (int)(sizeof(resolutions) / sizeof(resolutions[0]));
+    for (int i = 0; i <= resolution_count; i++) {
+        FrameArg* frames;
+        const char* label;
+        if (i < resolution_count) {
+            frames = make_frames(NULL, resolutions[i].width, resolutions[i].height);
+            label = resolutions[i].label;
+        } else if (opt.input) {
+            frames = make_frames(opt.input, 0, 0);
+            label = "recorded";
+        } else {
+            break;
+        }
+        if (!frames) continue;
+
+        size_t pixels = (size_t)frames->width * frames->height;
+        add_case("scene_hash", label, frames->size, run_scene_hash, frames);
+        add_case("motion", label, frames->size, run_motion, frames);
+        add_case("jpeg_views", label, pixels, run_jpeg_views, frames);
+        add_case("rgb_views", label, pixels, run_rgb_views, frames);
+        add_case("jpeg_utils", label, pixels * 3, run_jpeg_utils, frames);
+    }
+
+    static const struct { size_t bytes; const char* label; } buffers[] = {
+        { 1024, "1KiB" },
+        { 32 * 1024, "32KiB" },
+        { 256 * 1024, "256KiB" }
+    };
+    for (size_t i = 0; i < sizeof(buffers) / sizeof(buffers[0]); i++) {
+        BufferArg* buffer = make_buffer(buffers[i].bytes);
+        add_case("base64_publisher", buffers[i].label, buffers[i].bytes, run_base64_publisher, buffer);
+        add_case("base64_utils", buffers[i].label, buffers[i].bytes, run_base64_utils, buffer);
+    }
+
+    static const int detections[] = { 0, 10, 100 };
+    for (size_t i = 0; i < sizeof(detections) / sizeof(detections[0]); i++) {
+        char size[32];
+        snprintf(size, sizeof(size), "%d dets", detections[i]);
+        MetadataArg* meta = make_metadata(detections[i]);
+        add_case("metadata_publish", size, 0, run_metadata_publish, meta);
+        add_case("mqtt_publish_json", size, 0, run_mqtt_publish_json, meta);
+    }
+
+    for (int i = 0; i < g_case_count; i++) {
+        MicroCase* c = &g_cases[i];
+        if (opt.filter && !strstr(c->kernel, opt.filter)) continue;
+        fprintf(stderr, "micro: %s %s\n", c->kernel, c->size);
+        measure(c, &opt);
+    }
+
+    // Results go to the saved stdout
+    fflush(stdout);
+    dup2(fileno(results), STDOUT_FILENO);
+    fclose(results);
+
+    if (opt.json) {
+        print_json(&opt);
+    } else {
+        cJSON* baseline = opt.compare ? load_baseline(opt.compare) : NULL;
+        print_table(&opt, baseline);
+        cJSON_Delete(baseline);
+    }
+    return 0;
+}
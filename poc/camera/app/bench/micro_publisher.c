@@ -0,0 +1,12 @@
+/**
+ * micro_publisher.c
+ *
+ * frame_publisher.c with its base64 encoder exposed to the micro-benchmarks
+ */
+
+#include "../frame_publisher.c"
+#include "micro_kernels.h"
+
+char* Micro_Base64_Publisher(const unsigned char* data, size_t length, size_t* output_length) {
+    return base64_encode(data, length, output_length);
+}
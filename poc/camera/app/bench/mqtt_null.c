@@ -0,0 +1,74 @@
+/**
+ * mqtt_null.c
+ *
+ * Null MQTT sink for the Axis I.S. host benchmark (see mqtt_null.h)
+ * Linked instead of MQTT.c when building with MQTT=null.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "MQTT.h"
+#include "mqtt_null.h"
+
+static uint64_t g_messages = 0;
+static uint64_t g_bytes = 0;
+
+int MQTT_Init(MQTT_Callback_Connection stateCallback, MQTT_Callback_Message messageCallback) {
+    if (stateCallback) stateCallback(MQTT_CONNECTED);
+    return 1;
+}
+
+void MQTT_Cleanup() {
+}
+
+cJSON* MQTT_Settings() {
+    return NULL;
+}
+
+int MQTT_Publish(const char* topic, const char* payload, int qos, int retained) {
+    if (!topic || !payload) return 0;
+    __atomic_fetch_add(&g_messages, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_bytes, strlen(payload), __ATOMIC_RELAXED);
+    return 1;
+}
+
+int MQTT_Publish_JSON(const char* topic, cJSON* payload, int qos, int retained) {
+    if (!payload) return 0;
+
+    // Same duplicate + serialize work as MQTT.c
+    cJSON* publish = cJSON_Duplicate(payload, 1);
+    if (!publish) return 0;
+
+    char* json = cJSON_PrintUnformatted(publish);
+    int result = 0;
+    if (json) {
+        result = MQTT_Publish(topic, json, qos, retained);
+        cJSON_free(json);
+    }
+    cJSON_Delete(publish);
+    return result;
+}
+
+int MQTT_Publish_Binary(const char* topic, int payloadlen, void* payload, int qos, int retained) {
+    if (!topic || !payload || payloadlen <= 0) return 0;
+    __atomic_fetch_add(&g_messages, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_bytes, (uint64_t)payloadlen, __ATOMIC_RELAXED);
+    return 1;
+}
+
+int MQTT_Subscribe(const char* topic) {
+    return 1;
+}
+
+int MQTT_Unsubscribe(const char* topic) {
+    return 1;
+}
+
+int MQTT_Pending_Count(void) {
+    return 0;
+}
+
+void MQTT_Null_Stats(uint64_t* messages, uint64_t* bytes) {
+    *messages = __atomic_load_n(&g_messages, __ATOMIC_RELAXED);
+    *bytes = __atomic_load_n(&g_bytes, __ATOMIC_RELAXED);
+}
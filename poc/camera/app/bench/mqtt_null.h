@@ -0,0 +1,27 @@
+/**
+ * mqtt_null.h
+ *
+ * Null MQTT sink for the Axis I.S. host benchmark
+ * Implements MQTT.h without a broker: payloads are built and serialized
+ * exactly as MQTT.c does, then counted and dropped.
+ */
+
+#ifndef MQTT_NULL_H
+#define MQTT_NULL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Messages and payload bytes "published" since start
+ */
+void MQTT_Null_Stats(uint64_t* messages, uint64_t* bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MQTT_NULL_H */
@@ -0,0 +1,110 @@
+/**
+ * standin_axevent.c
+ *
+ * Host stand-in for libaxevent
+ * There is no event daemon on the host: handlers cannot be created and
+ * declare/subscribe/send fail. Key/value sets and events are empty
+ * allocations so ACAP.c's build-then-free paths stay balanced.
+ */
+
+#include "axsdk/axevent.h"
+
+#define STANDIN_ERROR g_quark_from_static_string("bench-axevent-standin")
+
+struct _AXEventKeyValueSet {
+    int unused;
+};
+
+struct _AXEvent {
+    AXEventKeyValueSet* set;    // Own copy, as ax_event_new2() copies the caller's set
+};
+
+static gboolean fail(GError** error) {
+    g_set_error(error, STANDIN_ERROR, 0, "axevent not available on host");
+    return FALSE;
+}
+
+AXEventHandler* ax_event_handler_new(void) {
+    return NULL;
+}
+
+void ax_event_handler_free(AXEventHandler* handler) {
+}
+
+gboolean ax_event_handler_declare(AXEventHandler* handler, AXEventKeyValueSet* key_value_set,
+                                  gboolean stateless, guint* declaration,
+                                  AXDeclarationCompleteCallback callback, gpointer user_data,
+                                  GError** error) {
+    return fail(error);
+}
+
+gboolean ax_event_handler_undeclare(AXEventHandler* handler, guint declaration, GError** error) {
+    return fail(error);
+}
+
+gboolean ax_event_handler_send_event(AXEventHandler* handler, guint declaration, AXEvent* event,
+                                     GError** error) {
+    return fail(error);
+}
+
+gboolean ax_event_handler_subscribe(AXEventHandler* handler, AXEventKeyValueSet* key_value_set,
+                                    guint* subscription, AXSubscriptionCallback callback,
+                                    gpointer user_data, GError** error) {
+    return fail(error);
+}
+
+gboolean ax_event_handler_unsubscribe(AXEventHandler* handler, guint subscription, GError** error) {
+    return fail(error);
+}
+
+AXEventKeyValueSet* ax_event_key_value_set_new(void) {
+    return g_new0(AXEventKeyValueSet, 1);
+}
+
+void ax_event_key_value_set_free(AXEventKeyValueSet* key_value_set) {
+    g_free(key_value_set);
+}
+
+gboolean ax_event_key_value_set_add_key_value(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                              const gchar* name_space, gconstpointer value,
+                                              AXEventValueType value_type, GError** error) {
+    return TRUE;
+}
+
+gboolean ax_event_key_value_set_add_nice_names(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                               const gchar* name_space, const gchar* key_nice_name,
+                                               const gchar* value_nice_name, GError** error) {
+    return TRUE;
+}
+
+gboolean ax_event_key_value_set_mark_as_source(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                               const gchar* name_space, GError** error) {
+    return TRUE;
+}
+
+gboolean ax_event_key_value_set_mark_as_data(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                             const gchar* name_space, GError** error) {
+    return TRUE;
+}
+
+gboolean ax_event_key_value_set_mark_as_user_defined(AXEventKeyValueSet* key_value_set, const gchar* key,
+                                                     const gchar* name_space, const gchar* user_tag,
+                                                     GError** error) {
+    return TRUE;
+}
+
+AXEvent* ax_event_new2(AXEventKeyValueSet* key_value_set, GDateTime* time_stamp) {
+    AXEvent* event = g_new0(AXEvent, 1);
+    event->set = ax_event_key_value_set_new();
+    return event;
+}
+
+void ax_event_free(AXEvent* event) {
+    if (!event) return;
+    ax_event_key_value_set_free(event->set);
+    g_free(event);
+}
+
+const AXEventKeyValueSet* ax_event_get_key_value_set(AXEvent* event) {
+    return event ? event->set : NULL;
+}
@@ -0,0 +1,44 @@
+/**
+ * standin_fcgi.c
+ *
+ * Host stand-in for libfcgi
+ * The benchmark never calls ACAP() so the HTTP thread does not run; these
+ * only satisfy the linker and fail if reached.
+ */
+
+#include <stddef.h>
+#include "fcgi_stdio.h"
+
+int FCGX_Init(void) {
+    return -1;
+}
+
+int FCGX_OpenSocket(const char* path, int backlog) {
+    return -1;
+}
+
+int FCGX_InitRequest(FCGX_Request* request, int sock, int flags) {
+    return -1;
+}
+
+int FCGX_Accept_r(FCGX_Request* request) {
+    return -1;
+}
+
+void FCGX_Finish_r(FCGX_Request* request) {
+}
+
+void FCGX_Free(FCGX_Request* request, int close) {
+}
+
+char* FCGX_GetParam(const char* name, FCGX_ParamArray envp) {
+    return NULL;
+}
+
+int FCGX_GetStr(char* str, int n, FCGX_Stream* stream) {
+    return 0;
+}
+
+int FCGX_PutStr(const char* str, int n, FCGX_Stream* stream) {
+    return -1;
+}
@@ -0,0 +1,182 @@
+/**
+ * standin_larod.c
+ *
+ * Host stand-in for liblarod
+ * Connecting fails with "larod not available on host"; select the replay
+ * (or tflite) inference backend instead. The remaining entry points fail
+ * the same way so a partially initialized caller still unwinds cleanly.
+ */
+
+#include <stdlib.h>
+#include "larod.h"
+
+static void set_unavailable(larodError** error) {
+    if (!error) return;
+    larodError* e = (larodError*)calloc(1, sizeof(larodError));
+    if (!e) return;
+    e->code = LAROD_ERROR_CONNECTION;
+    e->msg = "larod not available on host";
+    *error = e;
+}
+
+bool larodConnect(larodConnection** conn, larodError** error) {
+    *conn = NULL;
+    set_unavailable(error);
+    return false;
+}
+
+bool larodDisconnect(larodConnection** conn, larodError** error) {
+    if (conn) *conn = NULL;
+    return true;
+}
+
+void larodClearError(larodError** error) {
+    if (!error || !*error) return;
+    free(*error);
+    *error = NULL;
+}
+
+larodDevice** larodListDevices(larodConnection* conn, size_t* num_devices, larodError** error) {
+    *num_devices = 0;
+    set_unavailable(error);
+    return NULL;
+}
+
+const char* larodGetDeviceName(const larodDevice* dev, larodError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+const larodDevice* larodGetDevice(const larodConnection* conn, const char* name, uint32_t instance,
+                                  larodError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+larodModel* larodLoadModel(larodConnection* conn, int fd, const larodDevice* dev, larodAccess access,
+                           const char* name, const larodMap* params, larodError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+bool larodDestroyModel(larodModel** model) {
+    if (model) *model = NULL;
+    return true;
+}
+
+larodTensor** larodAllocModelInputs(larodConnection* conn, const larodModel* model, uint32_t fd_prop_flags,
+                                    size_t* num_tensors, larodMap* params, larodError** error) {
+    *num_tensors = 0;
+    set_unavailable(error);
+    return NULL;
+}
+
+larodTensor** larodAllocModelOutputs(larodConnection* conn, const larodModel* model, uint32_t fd_prop_flags,
+                                     size_t* num_tensors, larodMap* params, larodError** error) {
+    *num_tensors = 0;
+    set_unavailable(error);
+    return NULL;
+}
+
+larodTensor** larodCreateModelInputs(const larodModel* model, size_t* num_tensors, larodError** error) {
+    *num_tensors = 0;
+    set_unavailable(error);
+    return NULL;
+}
+
+larodTensor** larodCreateModelOutputs(const larodModel* model, size_t* num_tensors, larodError** error) {
+    *num_tensors = 0;
+    set_unavailable(error);
+    return NULL;
+}
+
+bool larodDestroyTensors(larodConnection* conn, larodTensor*** tensors, size_t num_tensors, larodError** error) {
+    if (tensors) *tensors = NULL;
+    return true;
+}
+
+int larodGetTensorFd(const larodTensor* tensor, larodError** error) {
+    set_unavailable(error);
+    return -1;
+}
+
+bool larodGetTensorFdSize(const larodTensor* tensor, size_t* size, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodSetTensorFd(larodTensor* tensor, int fd, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodSetTensorFdOffset(larodTensor* tensor, int64_t offset, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+const larodTensorDims* larodGetTensorDims(const larodTensor* tensor, larodError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+larodJobRequest* larodCreateJobRequest(const larodModel* model, larodTensor** inputs, size_t num_inputs,
+                                       larodTensor** outputs, size_t num_outputs, larodMap* params,
+                                       larodError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+bool larodSetJobRequestInputs(larodJobRequest* req, larodTensor** tensors, size_t num_tensors, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodSetJobRequestOutputs(larodJobRequest* req, larodTensor** tensors, size_t num_tensors, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodSetJobRequestParams(larodJobRequest* req, const larodMap* params, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodRunJob(larodConnection* conn, const larodJobRequest* req, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+void larodDestroyJobRequest(larodJobRequest** req) {
+    if (req) *req = NULL;
+}
+
+larodMap* larodCreateMap(larodError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+void larodDestroyMap(larodMap** map) {
+    if (map) *map = NULL;
+}
+
+bool larodMapSetStr(larodMap* map, const char* key, const char* value, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodMapSetInt(larodMap* map, const char* key, int64_t value, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodMapSetIntArr2(larodMap* map, const char* key, int64_t value0, int64_t value1, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
+
+bool larodMapSetIntArr4(larodMap* map, const char* key, int64_t value0, int64_t value1, int64_t value2,
+                        int64_t value3, larodError** error) {
+    set_unavailable(error);
+    return false;
+}
@@ -0,0 +1,115 @@
+/**
+ * standin_vdo.c
+ *
+ * Host stand-in for libvdostream
+ * Stream creation fails with "VDO not available on host" so the pipeline
+ * has to run from a file or synthetic frame source. VdoMap is a plain
+ * GObject so callers can g_object_unref() it as on the camera.
+ */
+
+#include <glib-object.h>
+#include "vdo-stream.h"
+#include "vdo-channel.h"
+#include "vdo-error.h"
+
+#define STANDIN_ERROR g_quark_from_static_string("bench-vdo-standin")
+
+static void set_unavailable(GError** error) {
+    g_set_error(error, STANDIN_ERROR, 0, "VDO not available on host");
+}
+
+VdoMap* vdo_map_new(void) {
+    return (VdoMap*)g_object_new(G_TYPE_OBJECT, NULL);
+}
+
+void vdo_map_set_uint32(VdoMap* self, const gchar* name, guint32 value) {
+}
+
+void vdo_map_set_string(VdoMap* self, const gchar* name, const gchar* value) {
+}
+
+void vdo_map_set_boolean(VdoMap* self, const gchar* name, gboolean value) {
+}
+
+guint32 vdo_map_get_uint32(const VdoMap* self, const gchar* name, guint32 def) {
+    return def;
+}
+
+VdoStream* vdo_stream_new(VdoMap* settings, gpointer user_data, GError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+gboolean vdo_stream_start(VdoStream* self, GError** error) {
+    set_unavailable(error);
+    return FALSE;
+}
+
+void vdo_stream_stop(VdoStream* self) {
+}
+
+VdoBuffer* vdo_stream_get_buffer(VdoStream* self, GError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+gboolean vdo_stream_buffer_unref(VdoStream* self, VdoBuffer** buffer, GError** error) {
+    set_unavailable(error);
+    return FALSE;
+}
+
+VdoMap* vdo_stream_get_info(VdoStream* self, GError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+gpointer vdo_buffer_get_data(VdoBuffer* self) {
+    return NULL;
+}
+
+VdoFrame* vdo_buffer_get_frame(VdoBuffer* self) {
+    return NULL;
+}
+
+gsize vdo_buffer_get_capacity(VdoBuffer* self) {
+    return 0;
+}
+
+gint vdo_buffer_get_fd(VdoBuffer* self) {
+    return -1;
+}
+
+gint64 vdo_buffer_get_offset(VdoBuffer* self) {
+    return 0;
+}
+
+guint64 vdo_frame_get_timestamp(VdoFrame* self) {
+    return 0;
+}
+
+gsize vdo_frame_get_size(VdoFrame* self) {
+    return 0;
+}
+
+guint vdo_frame_get_sequence_nbr(VdoFrame* self) {
+    return 0;
+}
+
+VdoChannel* vdo_channel_get(guint channel_nbr, GError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+VdoResolutionSet* vdo_channel_get_resolutions(VdoChannel* self, const VdoMap* filter, GError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+VdoMap* vdo_channel_get_info(VdoChannel* self, GError** error) {
+    set_unavailable(error);
+    return NULL;
+}
+
+gboolean vdo_error_is_expected(GError** error) {
+    return FALSE;
+}
@@ -0,0 +1,415 @@
+/**
+ * best_shot.c
+ *
+ * Best-shot selection implementation for Axis I.S. POC
+ *
+ * Score = (sharpness_weight * s / (s + sharpness_ref)
+ *          + size_weight * min(1, crop pixels / stored pixels)
+ *          + confidence_weight * confidence) * edge factor
+ * The sharpness term is at most sharpness_weight, so a sighting whose score
+ * could not beat the best even when perfectly sharp is never measured.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "best_shot.h"
+#include "jpeg_encoder.h"
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BEST_SHOT_NEON 1
+#endif
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define BEST_SHOT_MAX_CLASSES 16
+#define SHARPNESS_MAX_ROWS 128          // Rows sampled per measurement
+
+typedef enum {
+    SLOT_FREE = 0,
+    SLOT_OPEN,                          // Collecting sightings
+    SLOT_DONE                           // Uploaded at max_event_ms, waiting for it to leave
+} SlotState;
+
+typedef struct {
+    SlotState state;
+    int matched;                        // Sighted this frame
+    int track;
+    int class_id;
+    float box[4];                       // Last sighting, for matching
+    int64_t first_us;
+    int64_t last_us;
+    int sightings;
+
+    // Best sighting so far
+    int have;
+    float score;
+    float sharpness;
+    float confidence;
+    float best_box[4];
+    int frame_id;
+    int64_t timestamp_us;
+    unsigned int width;
+    unsigned int height;
+    uint8_t* rgb;                       // Pool slot, max_width * max_height * 3
+} Slot;
+
+struct BestShot {
+    int crop;
+    int classes[BEST_SHOT_MAX_CLASSES];
+    int class_count;
+    float min_confidence;
+    float margin;
+    int max_objects;
+    unsigned int max_width;
+    unsigned int max_height;
+    int64_t leave_us;
+    int64_t max_event_us;
+    int min_sightings;
+    float match_iou;
+    float sharpness_weight;
+    float size_weight;
+    float confidence_weight;
+    float sharpness_ref;
+    float edge_penalty;
+    int jpeg_quality;
+
+    BestShotUploadFn upload;
+    void* user;
+
+    Slot* slots;
+    uint8_t* pool;
+    JpegBuffer jpeg;                    // Encode buffer, reused
+
+    // Statistics
+    uint64_t objects;
+    uint64_t sightings;
+    uint64_t measured;                  // Sharpness computed
+    uint64_t skipped;                   // Could not win, not measured
+    uint64_t copies;                    // New best stored
+    uint64_t uploads;
+    uint64_t too_short;                 // Closed under min_sightings
+    uint64_t dropped;                   // No free slot
+    uint64_t encode_failures;
+};
+
+float BestShot_Sharpness(const uint8_t* luma, unsigned int stride, int x, int y, int width, int height) {
+    if (!luma || width < 3 || height < 3) return 0.0f;
+
+    int64_t sum = 0;
+    int64_t sum_sq = 0;
+    int64_t count = 0;
+    int step = (height - 2 + SHARPNESS_MAX_ROWS - 1) / SHARPNESS_MAX_ROWS;
+    for (int r = y + 1; r < y + height - 1; r += step) {
+        const uint8_t* up = luma + (size_t)(r - 1) * stride + x;
+        const uint8_t* row = up + stride;
+        const uint8_t* down = row + stride;
+        int c = 1;
+#ifdef BEST_SHOT_NEON
+        int32x4_t vsum = vdupq_n_s32(0);
+        int64x2_t vsq = vdupq_n_s64(0);
+        for (; c + 8 < width; c += 8) {
+            uint16x8_t around = vaddl_u8(vld1_u8(up + c), vld1_u8(down + c));
+            around = vaddw_u8(around, vld1_u8(row + c - 1));
+            around = vaddw_u8(around, vld1_u8(row + c + 1));
+            int16x8_t centre = vreinterpretq_s16_u16(vshll_n_u8(vld1_u8(row + c), 2));
+            int16x8_t lap = vsubq_s16(centre, vreinterpretq_s16_u16(around));
+            vsum = vpadalq_s16(vsum, lap);
+            vsq = vpadalq_s32(vsq, vmull_s16(vget_low_s16(lap), vget_low_s16(lap)));
+            vsq = vpadalq_s32(vsq, vmull_s16(vget_high_s16(lap), vget_high_s16(lap)));
+        }
+        sum += vaddvq_s32(vsum);
+        sum_sq += vaddvq_s64(vsq);
+#endif
+        for (; c < width - 1; c++) {
+            int lap = 4 * row[c] - up[c] - down[c] - row[c - 1] - row[c + 1];
+            sum += lap;
+            sum_sq += lap * lap;
+        }
+        count += width - 2;
+    }
+
+    double mean = (double)sum / (double)count;
+    return (float)((double)sum_sq / (double)count - mean * mean);
+}
+
+BestShot* BestShot_Create(cJSON* config, BestShotUploadFn upload, void* user) {
+    if (!config || !upload) return NULL;
+    if (!module_config_get_bool(config, "enabled", true)) return NULL;
+
+    BestShot* bs = (BestShot*)calloc(1, sizeof(BestShot));
+    if (!bs) {
+        LOG_ERR("BestShot: Failed to allocate context\n");
+        return NULL;
+    }
+
+    bs->crop = strcmp(module_config_get_string(config, "image", "crop"), "frame") != 0;
+    bs->min_confidence = module_config_get_float(config, "min_confidence", 0.5f);
+    bs->margin = module_config_get_float(config, "margin", 0.1f);
+    bs->max_objects = module_config_get_int(config, "max_objects", 4);
+    int max_width = module_config_get_int(config, "max_width", 480);
+    int max_height = module_config_get_int(config, "max_height", 480);
+    bs->leave_us = (int64_t)module_config_get_int(config, "leave_ms", 1500) * 1000;
+    bs->max_event_us = (int64_t)module_config_get_int(config, "max_event_ms", 30000) * 1000;
+    bs->min_sightings = module_config_get_int(config, "min_sightings", 3);
+    bs->match_iou = module_config_get_float(config, "match_iou", 0.3f);
+    bs->sharpness_weight = module_config_get_float(config, "sharpness_weight", 0.5f);
+    bs->size_weight = module_config_get_float(config, "size_weight", 0.3f);
+    bs->confidence_weight = module_config_get_float(config, "confidence_weight", 0.2f);
+    bs->sharpness_ref = module_config_get_float(config, "sharpness_ref", 100.0f);
+    bs->edge_penalty = module_config_get_float(config, "edge_penalty", 0.6f);
+    bs->jpeg_quality = module_config_get_int(config, "jpeg_quality", 85);
+    bs->upload = upload;
+    bs->user = user;
+
+    if (bs->max_objects < 1) bs->max_objects = 1;
+    if (max_width < 16) max_width = 16;
+    if (max_height < 16) max_height = 16;
+    bs->max_width = (unsigned int)max_width & ~1u;
+    bs->max_height = (unsigned int)max_height & ~1u;
+    if (bs->margin < 0.0f) bs->margin = 0.0f;
+    if (bs->sharpness_ref <= 0.0f) bs->sharpness_ref = 100.0f;
+    if (bs->jpeg_quality < 1 || bs->jpeg_quality > 100) bs->jpeg_quality = 85;
+
+    cJSON* item;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(config, "classes")) {
+        if (cJSON_IsNumber(item) && bs->class_count < BEST_SHOT_MAX_CLASSES) {
+            bs->classes[bs->class_count++] = item->valueint;
+        }
+    }
+
+    size_t slot_bytes = (size_t)bs->max_width * bs->max_height * 3;
+    bs->slots = (Slot*)calloc((size_t)bs->max_objects, sizeof(Slot));
+    bs->pool = (uint8_t*)malloc(slot_bytes * (size_t)bs->max_objects);
+    if (!bs->slots || !bs->pool) {
+        LOG_ERR("BestShot: Failed to allocate %d x %zu byte pool\n", bs->max_objects, slot_bytes);
+        BestShot_Destroy(bs);
+        return NULL;
+    }
+    for (int i = 0; i < bs->max_objects; i++) bs->slots[i].rgb = bs->pool + slot_bytes * (size_t)i;
+
+    LOG("BestShot: %d object(s), %s up to %ux%u, leave after %lldms (%zu KB pool)\n",
+        bs->max_objects, bs->crop ? "crops" : "frames", bs->max_width, bs->max_height,
+        (long long)(bs->leave_us / 1000), slot_bytes * (size_t)bs->max_objects / 1024);
+    return bs;
+}
+
+static int selects(const BestShot* bs, const Detection* det) {
+    if (det->confidence < bs->min_confidence) return 0;
+    if (bs->class_count == 0) return 1;
+    for (int i = 0; i < bs->class_count; i++) {
+        if (bs->classes[i] == det->class_id) return 1;
+    }
+    return 0;
+}
+
+static float iou(const float a[4], const float b[4]) {
+    float x0 = a[0] - a[2] / 2.0f > b[0] - b[2] / 2.0f ? a[0] - a[2] / 2.0f : b[0] - b[2] / 2.0f;
+    float y0 = a[1] - a[3] / 2.0f > b[1] - b[3] / 2.0f ? a[1] - a[3] / 2.0f : b[1] - b[3] / 2.0f;
+    float x1 = a[0] + a[2] / 2.0f < b[0] + b[2] / 2.0f ? a[0] + a[2] / 2.0f : b[0] + b[2] / 2.0f;
+    float y1 = a[1] + a[3] / 2.0f < b[1] + b[3] / 2.0f ? a[1] + a[3] / 2.0f : b[1] + b[3] / 2.0f;
+    if (x1 <= x0 || y1 <= y0) return 0.0f;
+    float inter = (x1 - x0) * (y1 - y0);
+    return inter / (a[2] * a[3] + b[2] * b[3] - inter);
+}
+
+/**
+ * Object the sighting continues, else a free slot for a new one
+ */
+static Slot* match(BestShot* bs, int track, const Detection* det, const float box[4]) {
+    Slot* best = NULL;
+    float best_iou = bs->match_iou;
+    Slot* free_slot = NULL;
+    for (int i = 0; i < bs->max_objects; i++) {
+        Slot* slot = &bs->slots[i];
+        if (slot->state == SLOT_FREE) {
+            if (!free_slot) free_slot = slot;
+            continue;
+        }
+        if (slot->matched || slot->track != track || slot->class_id != det->class_id) continue;
+        if (track >= 0) return slot;
+        float overlap = iou(slot->box, box);
+        if (overlap >= best_iou) {
+            best = slot;
+            best_iou = overlap;
+        }
+    }
+    if (best) return best;
+    if (!free_slot) return NULL;
+
+    memset(free_slot, 0, offsetof(Slot, rgb));
+    free_slot->state = SLOT_OPEN;
+    free_slot->track = track;
+    free_slot->class_id = det->class_id;
+    bs->objects++;
+    return free_slot;
+}
+
+/**
+ * Scale width x height to fit the stored image limit (never up)
+ */
+static void fit(const BestShot* bs, int width, int height, unsigned int* out_width,
+                unsigned int* out_height) {
+    float scale = 1.0f;
+    if ((unsigned int)width > bs->max_width) scale = (float)bs->max_width / (float)width;
+    if ((float)height * scale > (float)bs->max_height) scale = (float)bs->max_height / (float)height;
+    *out_width = (unsigned int)((float)width * scale) & ~1u;
+    *out_height = (unsigned int)((float)height * scale) & ~1u;
+    if (*out_width < 2) *out_width = 2;
+    if (*out_height < 2) *out_height = 2;
+}
+
+void BestShot_Offer(BestShot* bs, FrameData* frame, int track, const Detection* det) {
+    if (!bs || !frame || !det || !frame->views || !selects(bs, det)) return;
+
+    float box[4] = { det->x, det->y, det->width, det->height };
+    Slot* slot = match(bs, track, det, box);
+    if (!slot) {
+        bs->dropped++;
+        return;
+    }
+    slot->matched = 1;
+    memcpy(slot->box, box, sizeof(box));
+    if (slot->sightings++ == 0) slot->first_us = frame->timestamp_us;
+    slot->last_us = frame->timestamp_us;
+    bs->sightings++;
+    if (slot->state == SLOT_DONE) return;
+
+    // Crop in frame pixels
+    float width = det->width * (1.0f + 2.0f * bs->margin);
+    float height = det->height * (1.0f + 2.0f * bs->margin);
+    int x0 = (int)((det->x - width / 2.0f) * (float)frame->width);
+    int y0 = (int)((det->y - height / 2.0f) * (float)frame->height);
+    int x1 = (int)((det->x + width / 2.0f) * (float)frame->width + 0.5f);
+    int y1 = (int)((det->y + height / 2.0f) * (float)frame->height + 0.5f);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > (int)frame->width) x1 = (int)frame->width;
+    if (y1 > (int)frame->height) y1 = (int)frame->height;
+    if (x1 - x0 < 4 || y1 - y0 < 4) return;
+
+    // Boxes touching the frame edge are likely cut off
+    const float edge = 0.005f;
+    float factor = det->x - det->width / 2.0f < edge || det->y - det->height / 2.0f < edge ||
+                   det->x + det->width / 2.0f > 1.0f - edge || det->y + det->height / 2.0f > 1.0f - edge
+                   ? bs->edge_penalty : 1.0f;
+    float size = (float)(x1 - x0) * (float)(y1 - y0) / ((float)bs->max_width * (float)bs->max_height);
+    if (size > 1.0f) size = 1.0f;
+    float partial = bs->size_weight * size + bs->confidence_weight * det->confidence;
+
+    if (slot->have && (partial + bs->sharpness_weight) * factor <= slot->score) {
+        bs->skipped++;
+        return;
+    }
+
+    // Sharpness on the finest luma the frame still has
+    FrameView luma;
+    if (!Views_Luma(frame->views, &luma)) return;
+    float sx = (float)luma.width / (float)frame->width;
+    float sy = (float)luma.height / (float)frame->height;
+    float sharpness = BestShot_Sharpness(luma.data, luma.stride, (int)((float)x0 * sx), (int)((float)y0 * sy),
+                                         (int)((float)(x1 - x0) * sx), (int)((float)(y1 - y0) * sy));
+    bs->measured++;
+    float score = (bs->sharpness_weight * sharpness / (sharpness + bs->sharpness_ref) + partial) * factor;
+    if (slot->have && score <= slot->score) return;
+
+    // New best - copy it into the slot (not possible after an early release)
+    unsigned int out_width, out_height;
+    FrameView image;
+    if (bs->crop) {
+        fit(bs, x1 - x0, y1 - y0, &out_width, &out_height);
+        if (!Views_Crop(frame->views, x0, y0, x1 - x0, y1 - y0, out_width, out_height, 1, &image)) return;
+    } else {
+        fit(bs, (int)frame->width, (int)frame->height, &out_width, &out_height);
+        if (!Views_RGB(frame->views, out_width, out_height, &image)) return;
+    }
+    size_t row_bytes = (size_t)image.width * 3;
+    for (unsigned int r = 0; r < image.height; r++) {
+        memcpy(slot->rgb + r * row_bytes, image.data + (size_t)r * image.stride, row_bytes);
+    }
+
+    slot->have = 1;
+    slot->score = score;
+    slot->sharpness = sharpness;
+    slot->confidence = det->confidence;
+    memcpy(slot->best_box, box, sizeof(box));
+    slot->frame_id = frame->frame_id;
+    slot->timestamp_us = frame->timestamp_us;
+    slot->width = image.width;
+    slot->height = image.height;
+    bs->copies++;
+}
+
+static size_t encode(BestShot* bs, const Slot* slot) {
+    JpegImage image = {
+        .width = slot->width, .height = slot->height, .quality = bs->jpeg_quality,
+        .pixels = slot->rgb
+    };
+    return Jpeg_Encode(&image, &bs->jpeg);
+}
+
+static void upload(BestShot* bs, const Slot* slot) {
+    if (!slot->have || slot->sightings < bs->min_sightings) {
+        bs->too_short++;
+        return;
+    }
+    size_t size = encode(bs, slot);
+    if (size == 0) {
+        bs->encode_failures++;
+        LOG_ERR("BestShot: JPEG encoding failed\n");
+        return;
+    }
+
+    BestShotImage image = {
+        .jpeg = bs->jpeg.data, .jpeg_size = size, .width = slot->width, .height = slot->height,
+        .crop = bs->crop, .track = slot->track, .class_id = slot->class_id,
+        .confidence = slot->confidence, .x = slot->best_box[0], .y = slot->best_box[1],
+        .box_width = slot->best_box[2], .box_height = slot->best_box[3],
+        .sharpness = slot->sharpness, .score = slot->score, .frame_id = slot->frame_id,
+        .timestamp_us = slot->timestamp_us, .first_seen_us = slot->first_us,
+        .last_seen_us = slot->last_us, .candidates = slot->sightings
+    };
+    bs->upload(&image, bs->user);
+    bs->uploads++;
+}
+
+void BestShot_End_Frame(BestShot* bs, int64_t now_us) {
+    if (!bs) return;
+    for (int i = 0; i < bs->max_objects; i++) {
+        Slot* slot = &bs->slots[i];
+        slot->matched = 0;
+        if (slot->state == SLOT_FREE) continue;
+
+        if (now_us - slot->last_us > bs->leave_us) {
+            // Left the scene - upload unless already done at max_event_ms
+            if (slot->state == SLOT_OPEN) upload(bs, slot);
+            slot->state = SLOT_FREE;
+        } else if (slot->state == SLOT_OPEN && now_us - slot->first_us > bs->max_event_us) {
+            upload(bs, slot);
+            slot->state = SLOT_DONE;
+        }
+    }
+}
+
+void BestShot_Destroy(BestShot* bs) {
+    if (!bs) return;
+    LOG("BestShot: cleanup: Objects=%llu Uploads=%llu TooShort=%llu Dropped=%llu "
+        "Sightings=%llu Measured=%llu Skipped=%llu Copies=%llu EncodeFailures=%llu\n",
+        (unsigned long long)bs->objects, (unsigned long long)bs->uploads,
+        (unsigned long long)bs->too_short, (unsigned long long)bs->dropped,
+        (unsigned long long)bs->sightings, (unsigned long long)bs->measured,
+        (unsigned long long)bs->skipped, (unsigned long long)bs->copies,
+        (unsigned long long)bs->encode_failures);
+    Jpeg_Buffer_Free(&bs->jpeg);
+    free(bs->pool);
+    free(bs->slots);
+    free(bs);
+}
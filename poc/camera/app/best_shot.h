@@ -0,0 +1,113 @@
+/**
+ * best_shot.h
+ *
+ * Best-shot selection for Axis I.S. POC
+ * Instead of uploading whatever frame is current, keep the best image of
+ * each object seen so far and upload it once the object leaves (or has been
+ * in view for max_event_ms). Candidates are scored by sharpness (variance of
+ * the Laplacian over the box's luma), box size and detection confidence;
+ * boxes touching the frame edge are penalized as likely cut off.
+ *
+ * Only the leading candidate per object is kept, as RGB in a slot of a
+ * fixed pool allocated at creation. Sharpness is only computed for boxes
+ * that could still beat their object's best, and the crop is only copied
+ * when one does.
+ *
+ * Objects are matched by track id when the caller has one, otherwise by
+ * class and box overlap with the previous frame. Pipeline thread only.
+ */
+
+#ifndef BEST_SHOT_H
+#define BEST_SHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+#include "module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct BestShot BestShot;
+
+/* Selected image, handed to the upload callback */
+typedef struct {
+    const uint8_t* jpeg;            // Valid during the callback only
+    size_t jpeg_size;
+    unsigned int width;
+    unsigned int height;
+    int crop;                       // 1: box crop, 0: whole frame
+    int track;                      // Caller's track id, -1 if none
+    int class_id;
+    float confidence;
+    float x, y, box_width, box_height; // Box, frame-normalized centre and size
+    float sharpness;                // Laplacian variance
+    float score;
+    int frame_id;                   // Frame the image is from
+    int64_t timestamp_us;
+    int64_t first_seen_us;
+    int64_t last_seen_us;
+    int candidates;                 // Sightings considered
+} BestShotImage;
+
+typedef void (*BestShotUploadFn)(const BestShotImage* image, void* user);
+
+/**
+ * Create a best-shot selector
+ * @param config "best_shot" object, NULL or "enabled": false for none
+ * @param upload Called with each object's best image when it closes
+ * @return Selector pointer, NULL when disabled or on failure
+ *
+ * Config keys:
+ *   enabled          Select best shots (default true)
+ *   image            "crop" (default) or "frame"
+ *   classes          Class ids to follow (default all)
+ *   min_confidence   Detections below are ignored (default 0.5)
+ *   margin           Grow crops by this fraction per side (default 0.1)
+ *   max_objects      Objects followed at once - pool slots (default 4)
+ *   max_width,       Stored image size limit, scaled to fit (default 480x480)
+ *   max_height
+ *   leave_ms         Object closes when unseen this long (default 1500)
+ *   max_event_ms     Upload after this long in view, then wait for it to
+ *                    leave (default 30000)
+ *   min_sightings    Objects seen fewer times are dropped (default 3)
+ *   match_iou        Box overlap to continue an object (default 0.3)
+ *   sharpness_weight Score weights (defaults 0.5, 0.3, 0.2)
+ *   size_weight
+ *   confidence_weight
+ *   sharpness_ref    Laplacian variance scored 0.5 (default 100)
+ *   edge_penalty     Score factor for boxes touching the frame edge (default 0.6)
+ *   jpeg_quality     Upload quality (default 85)
+ */
+BestShot* BestShot_Create(cJSON* config, BestShotUploadFn upload, void* user);
+
+/**
+ * Offer a detection of the current frame (luma for sharpness, RGB for the
+ * image come from the frame's view cache)
+ * @param track Track id, -1 to match by overlap
+ */
+void BestShot_Offer(BestShot* bs, FrameData* frame, int track, const Detection* det);
+
+/**
+ * End of frame - uploads objects that left or reached max_event_ms
+ * @param now_us Frame timestamp_us
+ */
+void BestShot_End_Frame(BestShot* bs, int64_t now_us);
+
+/**
+ * Free the selector and its pool (open objects are not uploaded)
+ */
+void BestShot_Destroy(BestShot* bs);
+
+/**
+ * Variance of the 4-neighbour Laplacian over a luma region
+ * (NEON on aarch64)
+ */
+float BestShot_Sharpness(const uint8_t* luma, unsigned int stride, int x, int y, int width, int height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BEST_SHOT_H */
@@ -0,0 +1,147 @@
+/**
+ * blackboard.c
+ *
+ * Typed per-frame module blackboard implementation for Axis I.S. POC
+ *
+ * Registration and export run on the pipeline thread (module init happens
+ * before the first frame), so no locking is needed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "blackboard.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+typedef struct {
+    char name[BLACKBOARD_NAME_LEN];
+    void* data;
+    size_t size;
+    const BlackboardField* fields;
+    int field_count;
+} BlackboardSlot;
+
+struct Blackboard {
+    BlackboardSlot slots[BLACKBOARD_MAX_SLOTS];
+    int slot_count;
+    uint32_t written;               // Bit per slot, cleared every frame
+};
+
+Blackboard* Blackboard_Create(void) {
+    Blackboard* bb = (Blackboard*)calloc(1, sizeof(Blackboard));
+    if (!bb) {
+        LOG_ERR("Blackboard: Failed to allocate context\n");
+    }
+    return bb;
+}
+
+void Blackboard_Destroy(Blackboard* bb) {
+    if (!bb) return;
+    for (int i = 0; i < bb->slot_count; i++) {
+        free(bb->slots[i].data);
+    }
+    free(bb);
+}
+
+int Blackboard_Register(Blackboard* bb, const char* name, size_t size,
+                        const BlackboardField* fields, int field_count) {
+    if (!bb || !name || size == 0) return -1;
+
+    if (Blackboard_Find(bb, name) >= 0) {
+        LOG_ERR("Blackboard: Slot '%s' already registered\n", name);
+        return -1;
+    }
+    if (bb->slot_count >= BLACKBOARD_MAX_SLOTS) {
+        LOG_ERR("Blackboard: Too many slots (max %d)\n", BLACKBOARD_MAX_SLOTS);
+        return -1;
+    }
+
+    BlackboardSlot* slot = &bb->slots[bb->slot_count];
+    slot->data = calloc(1, size);
+    if (!slot->data) {
+        LOG_ERR("Blackboard: Failed to allocate slot '%s'\n", name);
+        return -1;
+    }
+    snprintf(slot->name, sizeof(slot->name), "%s", name);
+    slot->size = size;
+    slot->fields = fields;
+    slot->field_count = fields ? field_count : 0;
+
+    return bb->slot_count++;
+}
+
+int Blackboard_Find(Blackboard* bb, const char* name) {
+    if (!bb || !name) return -1;
+    for (int i = 0; i < bb->slot_count; i++) {
+        if (strcmp(bb->slots[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+void Blackboard_Begin_Frame(Blackboard* bb) {
+    if (bb) bb->written = 0;
+}
+
+void* Blackboard_Write(Blackboard* bb, int slot) {
+    if (!bb || slot < 0 || slot >= bb->slot_count) return NULL;
+    bb->written |= 1u << slot;
+    return bb->slots[slot].data;
+}
+
+const void* Blackboard_Read(Blackboard* bb, int slot) {
+    if (!bb || slot < 0 || slot >= bb->slot_count) return NULL;
+    if (!(bb->written & (1u << slot))) return NULL;
+    return bb->slots[slot].data;
+}
+
+static void export_field(cJSON* object, const BlackboardField* field, const uint8_t* base) {
+    const void* value = base + field->offset;
+    switch (field->type) {
+        case BB_FIELD_INT:
+            cJSON_AddNumberToObject(object, field->name, *(const int*)value);
+            break;
+        case BB_FIELD_UINT32:
+            cJSON_AddNumberToObject(object, field->name, *(const uint32_t*)value);
+            break;
+        case BB_FIELD_UINT64:
+            cJSON_AddNumberToObject(object, field->name, (double)*(const uint64_t*)value);
+            break;
+        case BB_FIELD_SIZE:
+            cJSON_AddNumberToObject(object, field->name, (double)*(const size_t*)value);
+            break;
+        case BB_FIELD_FLOAT:
+            cJSON_AddNumberToObject(object, field->name, *(const float*)value);
+            break;
+        case BB_FIELD_DOUBLE:
+            cJSON_AddNumberToObject(object, field->name, *(const double*)value);
+            break;
+        case BB_FIELD_BOOL:
+            cJSON_AddBoolToObject(object, field->name, *(const int*)value);
+            break;
+        case BB_FIELD_STRING:
+            cJSON_AddStringToObject(object, field->name, (const char*)value);
+            break;
+    }
+}
+
+void Blackboard_Export_JSON(Blackboard* bb, cJSON* parent) {
+    if (!bb || !parent) return;
+
+    for (int i = 0; i < bb->slot_count; i++) {
+        const BlackboardSlot* slot = &bb->slots[i];
+        if (!slot->fields || !(bb->written & (1u << i))) continue;
+
+        cJSON* object = cJSON_CreateObject();
+        for (int f = 0; f < slot->field_count; f++) {
+            export_field(object, &slot->fields[f], (const uint8_t*)slot->data);
+        }
+        cJSON_AddItemToObject(parent, slot->name, object);
+    }
+}
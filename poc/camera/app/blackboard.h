@@ -0,0 +1,112 @@
+/**
+ * blackboard.h
+ *
+ * Typed per-frame module blackboard for Axis I.S. POC
+ * Modules register named slots at init and write fixed-layout structs into
+ * them every frame; later modules read them back by slot ID, without string
+ * lookups. Slots that carry a field table are serialized into the metadata
+ * "modules" object at publish time - the only place JSON is produced.
+ *
+ * Slot storage is preallocated at registration and persists across frames,
+ * so fields that never change (configuration echoes) can be written once
+ * in init. Only the per-frame "written" flag is reset by
+ * Blackboard_Begin_Frame(); unwritten slots are neither readable nor
+ * exported for that frame.
+ */
+
+#ifndef BLACKBOARD_H
+#define BLACKBOARD_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BLACKBOARD_MAX_SLOTS 32
+#define BLACKBOARD_NAME_LEN 32
+
+typedef struct Blackboard Blackboard;
+
+typedef enum {
+    BB_FIELD_INT = 0,           // int
+    BB_FIELD_UINT32,            // uint32_t
+    BB_FIELD_UINT64,            // uint64_t
+    BB_FIELD_SIZE,              // size_t
+    BB_FIELD_FLOAT,             // float
+    BB_FIELD_DOUBLE,            // double
+    BB_FIELD_BOOL,              // int, exported as true/false
+    BB_FIELD_STRING             // char[] inside the struct
+} BlackboardFieldType;
+
+/* Exported member of a slot struct */
+typedef struct {
+    const char* name;           // JSON key (static string)
+    BlackboardFieldType type;
+    size_t offset;              // offsetof(slot struct, member)
+} BlackboardField;
+
+/* Field table entry whose JSON key is the member name */
+#define BB_FIELD(slot_type, member, field_type) \
+    { #member, field_type, offsetof(slot_type, member) }
+
+#define BB_FIELD_COUNT(fields) ((int)(sizeof(fields) / sizeof((fields)[0])))
+
+/**
+ * Create an empty blackboard
+ * @return Blackboard pointer, NULL on failure
+ */
+Blackboard* Blackboard_Create(void);
+
+/**
+ * Free the blackboard and every slot
+ */
+void Blackboard_Destroy(Blackboard* bb);
+
+/**
+ * Register a slot (module init only)
+ * @param name Slot name, also the key under "modules" when exported
+ * @param size sizeof the slot struct
+ * @param fields Field table to export, NULL for a slot only read by modules
+ * @param field_count Entries in fields
+ * @return Slot ID, -1 on failure
+ */
+int Blackboard_Register(Blackboard* bb, const char* name, size_t size,
+                        const BlackboardField* fields, int field_count);
+
+/**
+ * Look up a slot registered by an earlier module (init only)
+ * @return Slot ID, -1 if not registered
+ */
+int Blackboard_Find(Blackboard* bb, const char* name);
+
+/**
+ * Start a frame - every slot becomes unwritten
+ */
+void Blackboard_Begin_Frame(Blackboard* bb);
+
+/**
+ * Get a slot for writing and mark it written for this frame
+ * Contents are what was last written (zeroed on registration)
+ * @return Slot struct, NULL for an invalid slot
+ */
+void* Blackboard_Write(Blackboard* bb, int slot);
+
+/**
+ * Get a slot written during this frame
+ * @return Slot struct, NULL when not written this frame
+ */
+const void* Blackboard_Read(Blackboard* bb, int slot);
+
+/**
+ * Add one object per written, exported slot to parent
+ */
+void Blackboard_Export_JSON(Blackboard* bb, cJSON* parent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLACKBOARD_H */
@@ -0,0 +1,662 @@
+/**
+ * capture_log.c
+ *
+ * Record-and-replay capture log implementation for Axis I.S. POC
+ *
+ * The pipeline thread copies straight into a MAP_SHARED segment that is
+ * sized up front with ftruncate (sparse until written), so recording costs
+ * one memcpy per record and no syscalls until the segment rolls over. A
+ * frame's records are kept in one segment where possible, so each segment
+ * replays on its own. Segment numbers continue across restarts and the
+ * oldest segments are deleted once max_segments is exceeded.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include "capture_log.h"
+#include "ACAP.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define CAPTURE_PREFIX "capture_"
+#define CAPTURE_SUFFIX ".axcap"
+#define CAPTURE_ALIGN 8
+#define CAPTURE_METADATA_RESERVE (64 * 1024)
+
+static struct {
+    int enabled;
+
+    // Configuration
+    char dir[256];
+    size_t segment_bytes;
+    uint32_t index_capacity;
+    int max_segments;
+    int every_n;
+    int downscale;
+    int record_frames;
+    int record_tensors;
+    int record_metadata;
+    int trigger_mode;
+    int trigger_frames;
+    int trigger_on_detection;
+
+    // Open segment (pipeline thread only)
+    int fd;
+    uint8_t* base;
+    CaptureSegmentHeader* header;
+    CaptureIndexEntry* index;
+    uint32_t segment;
+    uint32_t first_segment;         // Oldest segment still on disk
+
+    // Current frame
+    int recording;
+    uint32_t sequence;
+    int64_t timestamp_us;
+    size_t frame_bytes;             // Bytes recorded for the current frame
+    size_t group_reserve;           // Largest frame so far, kept free in a segment
+    uint64_t frames_seen;
+
+    // Trigger window and statistics (guarded by mutex)
+    int trigger_remaining;
+    unsigned long triggers;
+    unsigned long frames_recorded;
+    unsigned long records_dropped;
+    unsigned long segments_written;
+    uint64_t bytes_recorded;
+
+    pthread_mutex_t mutex;
+} g_capture = { .fd = -1 };
+
+static int config_int(cJSON* config, const char* key, int default_val) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsNumber(item) ? item->valueint : default_val;
+}
+
+static int config_bool(cJSON* config, const char* key, int default_val) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsBool(item) ? cJSON_IsTrue(item) : default_val;
+}
+
+static size_t align_up(size_t value) {
+    return (value + CAPTURE_ALIGN - 1) & ~(size_t)(CAPTURE_ALIGN - 1);
+}
+
+static int64_t wall_clock_us(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void segment_path(char* path, size_t size, uint32_t segment) {
+    snprintf(path, size, "%s/" CAPTURE_PREFIX "%06u" CAPTURE_SUFFIX, g_capture.dir, segment);
+}
+
+/**
+ * Find the segment number range already on disk
+ * @return 1 if any segment exists
+ */
+static int scan_segments(uint32_t* first, uint32_t* last) {
+    DIR* dir = opendir(g_capture.dir);
+    if (!dir) return 0;
+
+    int found = 0;
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        unsigned int number;
+        char suffix[16];
+        if (sscanf(entry->d_name, CAPTURE_PREFIX "%u%15s", &number, suffix) != 2 ||
+            strcmp(suffix, CAPTURE_SUFFIX) != 0) {
+            continue;
+        }
+        if (!found || number < *first) *first = number;
+        if (!found || number > *last) *last = number;
+        found = 1;
+    }
+    closedir(dir);
+    return found;
+}
+
+/**
+ * Truncate the open segment to its committed data and unmap it
+ */
+static void close_segment(void) {
+    if (!g_capture.base) return;
+
+    uint64_t data_end = g_capture.header->data_end;
+    uint32_t records = g_capture.header->index_count;
+    munmap(g_capture.base, g_capture.segment_bytes);
+    if (ftruncate(g_capture.fd, (off_t)data_end) != 0) {
+        LOG_ERR("Capture: Truncating segment %u failed: %s\n", g_capture.segment, strerror(errno));
+    }
+    close(g_capture.fd);
+
+    g_capture.base = NULL;
+    g_capture.header = NULL;
+    g_capture.index = NULL;
+    g_capture.fd = -1;
+
+    pthread_mutex_lock(&g_capture.mutex);
+    g_capture.segments_written++;
+    pthread_mutex_unlock(&g_capture.mutex);
+
+    LOG("Capture: Closed segment %u (%u records, %llu bytes)\n", g_capture.segment, records,
+        (unsigned long long)data_end);
+}
+
+/**
+ * Open the next segment, deleting the oldest beyond max_segments
+ * @return 1 on success
+ */
+static int open_segment(void) {
+    close_segment();
+    g_capture.segment++;
+
+    char path[320];
+    while (g_capture.segment - g_capture.first_segment >= (uint32_t)g_capture.max_segments) {
+        segment_path(path, sizeof(path), g_capture.first_segment++);
+        unlink(path);
+    }
+
+    segment_path(path, sizeof(path), g_capture.segment);
+    g_capture.fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (g_capture.fd < 0) {
+        LOG_ERR("Capture: Cannot create %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+    if (ftruncate(g_capture.fd, (off_t)g_capture.segment_bytes) != 0) {
+        LOG_ERR("Capture: Cannot size %s: %s\n", path, strerror(errno));
+        close(g_capture.fd);
+        g_capture.fd = -1;
+        return 0;
+    }
+
+    void* base = mmap(NULL, g_capture.segment_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, g_capture.fd, 0);
+    if (base == MAP_FAILED) {
+        LOG_ERR("Capture: mmap of %s failed: %s\n", path, strerror(errno));
+        close(g_capture.fd);
+        g_capture.fd = -1;
+        return 0;
+    }
+
+    g_capture.base = (uint8_t*)base;
+    g_capture.header = (CaptureSegmentHeader*)base;
+    g_capture.index = (CaptureIndexEntry*)(g_capture.base + sizeof(CaptureSegmentHeader));
+
+    CaptureSegmentHeader* h = g_capture.header;
+    memcpy(h->magic, CAPTURE_MAGIC, sizeof(h->magic));
+    h->version = CAPTURE_VERSION;
+    h->header_bytes = sizeof(CaptureSegmentHeader);
+    h->index_capacity = g_capture.index_capacity;
+    h->index_count = 0;
+    h->data_offset = align_up(sizeof(CaptureSegmentHeader) +
+                              (size_t)g_capture.index_capacity * sizeof(CaptureIndexEntry));
+    h->data_end = h->data_offset;
+    h->segment = g_capture.segment;
+    h->created_us = wall_clock_us();
+    return 1;
+}
+
+/**
+ * Payload bytes available in an empty segment
+ */
+static size_t segment_capacity(void) {
+    return g_capture.segment_bytes - align_up(sizeof(CaptureSegmentHeader) +
+                                              (size_t)g_capture.index_capacity * sizeof(CaptureIndexEntry));
+}
+
+static size_t segment_free(void) {
+    if (!g_capture.base) return 0;
+    return g_capture.segment_bytes - (size_t)g_capture.header->data_end;
+}
+
+static uint32_t index_free(void) {
+    if (!g_capture.base) return 0;
+    return g_capture.index_capacity - g_capture.header->index_count;
+}
+
+/**
+ * Reserve payload space for one record, rolling over to a new segment if needed
+ * @return Destination in the segment, NULL if the record can never fit
+ */
+static uint8_t* reserve(size_t size) {
+    if (size > segment_capacity()) return NULL;
+    if (segment_free() < size || index_free() == 0) {
+        if (!open_segment()) return NULL;
+    }
+    return g_capture.base + g_capture.header->data_end;
+}
+
+/**
+ * Index a payload written at the reserved position and publish it
+ */
+static void commit(int type, size_t size, unsigned int width, unsigned int height) {
+    CaptureSegmentHeader* h = g_capture.header;
+    CaptureIndexEntry* entry = &g_capture.index[h->index_count];
+    entry->timestamp_us = g_capture.timestamp_us;
+    entry->sequence = g_capture.sequence;
+    entry->type = (uint16_t)type;
+    entry->reserved = 0;
+    entry->offset = h->data_end;
+    entry->size = (uint32_t)size;
+    entry->width = (uint16_t)width;
+    entry->height = (uint16_t)height;
+
+    h->data_end = align_up((size_t)h->data_end + size);
+    // Readers of a crashed segment trust index_count - publish it last
+    __atomic_store_n(&h->index_count, h->index_count + 1, __ATOMIC_RELEASE);
+    g_capture.frame_bytes += size;
+}
+
+static void drop_record(void) {
+    pthread_mutex_lock(&g_capture.mutex);
+    g_capture.records_dropped++;
+    pthread_mutex_unlock(&g_capture.mutex);
+}
+
+/**
+ * Decimate an NV12 frame by an integer factor (nearest sample)
+ */
+static void downscale_nv12(const uint8_t* in, unsigned int width, unsigned int height,
+                           uint8_t* out, int factor) {
+    unsigned int out_width = width / factor;
+    unsigned int out_height = height / factor;
+
+    for (unsigned int y = 0; y < out_height; y++) {
+        const uint8_t* row = in + (size_t)y * factor * width;
+        uint8_t* dst = out + (size_t)y * out_width;
+        for (unsigned int x = 0; x < out_width; x++) {
+            dst[x] = row[x * factor];
+        }
+    }
+
+    const uint8_t* uv_in = in + (size_t)width * height;
+    uint8_t* uv_out = out + (size_t)out_width * out_height;
+    for (unsigned int y = 0; y < out_height / 2; y++) {
+        const uint8_t* row = uv_in + (size_t)y * factor * width;
+        uint8_t* dst = uv_out + (size_t)y * out_width;
+        for (unsigned int x = 0; x < out_width / 2; x++) {
+            dst[2 * x] = row[2 * x * factor];
+            dst[2 * x + 1] = row[2 * x * factor + 1];
+        }
+    }
+}
+
+int Capture_Init(cJSON* config) {
+    memset(&g_capture, 0, sizeof(g_capture));
+    g_capture.fd = -1;
+
+    g_capture.enabled = config_bool(config, "enabled", 0);
+    if (!g_capture.enabled) {
+        LOG("Capture: Disabled\n");
+        return 0;
+    }
+
+    cJSON* item = config ? cJSON_GetObjectItem(config, "dir") : NULL;
+    const char* dir = item && cJSON_IsString(item) && *item->valuestring ?
+                      item->valuestring : "localdata/capture";
+    if (dir[0] == '/') {
+        snprintf(g_capture.dir, sizeof(g_capture.dir), "%s", dir);
+    } else {
+        snprintf(g_capture.dir, sizeof(g_capture.dir), "%s%s", ACAP_FILE_AppPath(), dir);
+    }
+
+    int segment_mb = config_int(config, "segment_mb", 64);
+    g_capture.segment_bytes = (size_t)(segment_mb > 1 ? segment_mb : 1) * 1024 * 1024;
+    int index_entries = config_int(config, "index_entries", 4096);
+    g_capture.index_capacity = (uint32_t)(index_entries > 16 ? index_entries : 16);
+    // The index may take at most a quarter of a segment
+    size_t max_entries = g_capture.segment_bytes / 4 / sizeof(CaptureIndexEntry);
+    if (g_capture.index_capacity > max_entries) g_capture.index_capacity = (uint32_t)max_entries;
+    g_capture.max_segments = config_int(config, "max_segments", 4);
+    if (g_capture.max_segments < 1) g_capture.max_segments = 1;
+    g_capture.every_n = config_int(config, "every_n", 10);
+    if (g_capture.every_n < 1) g_capture.every_n = 1;
+    g_capture.downscale = config_int(config, "downscale", 2);
+    if (g_capture.downscale != 1 && g_capture.downscale != 2 && g_capture.downscale != 4) {
+        LOG_ERR("Capture: downscale must be 1, 2 or 4 - using 1\n");
+        g_capture.downscale = 1;
+    }
+    g_capture.record_frames = config_bool(config, "frames", 1);
+    g_capture.record_tensors = config_bool(config, "tensors", 1);
+    g_capture.record_metadata = config_bool(config, "metadata", 1);
+
+    item = config ? cJSON_GetObjectItem(config, "mode") : NULL;
+    const char* mode = item && cJSON_IsString(item) ? item->valuestring : "continuous";
+    g_capture.trigger_mode = strcmp(mode, "trigger") == 0;
+    g_capture.trigger_frames = config_int(config, "trigger_frames", 50);
+    g_capture.trigger_on_detection = config_bool(config, "trigger_on_detection", 0);
+
+    if (mkdir(g_capture.dir, 0755) != 0 && errno != EEXIST) {
+        LOG_ERR("Capture: Cannot create %s: %s\n", g_capture.dir, strerror(errno));
+        g_capture.enabled = 0;
+        return 0;
+    }
+
+    // Continue numbering after segments left by an earlier run
+    uint32_t first = 0, last = 0;
+    if (scan_segments(&first, &last)) {
+        g_capture.first_segment = first;
+        g_capture.segment = last;
+    } else {
+        g_capture.first_segment = 1;
+        g_capture.segment = 0;
+    }
+
+    pthread_mutex_init(&g_capture.mutex, NULL);
+
+    LOG("Capture: %s mode, every %d frames, 1/%d scale, %d x %dMB segments in %s\n",
+        g_capture.trigger_mode ? "trigger" : "continuous", g_capture.every_n,
+        g_capture.downscale, g_capture.max_segments, segment_mb, g_capture.dir);
+    return 1;
+}
+
+int Capture_Begin_Frame(uint32_t sequence, int64_t timestamp_us) {
+    g_capture.recording = 0;
+    if (!g_capture.enabled) return 0;
+
+    int sample = g_capture.frames_seen++ % (uint64_t)g_capture.every_n == 0;
+
+    pthread_mutex_lock(&g_capture.mutex);
+    int triggered = g_capture.trigger_remaining > 0;
+    if (triggered) g_capture.trigger_remaining--;
+    pthread_mutex_unlock(&g_capture.mutex);
+
+    // A trigger window records every frame; continuous mode samples
+    if (!triggered && (g_capture.trigger_mode || !sample)) return 0;
+
+    // Keep the whole frame in one segment when the last one fitted
+    if ((segment_free() < g_capture.group_reserve && g_capture.group_reserve <= segment_capacity()) ||
+        index_free() < 3) {
+        if (!open_segment()) return 0;
+    }
+
+    g_capture.recording = 1;
+    g_capture.sequence = sequence;
+    g_capture.timestamp_us = timestamp_us;
+    g_capture.frame_bytes = 0;
+    return 1;
+}
+
+void Capture_Frame(const void* nv12, unsigned int width, unsigned int height) {
+    if (!g_capture.recording || !g_capture.record_frames || !nv12) return;
+
+    int factor = g_capture.downscale;
+    if (((width / factor) & 1) || ((height / factor) & 1)) factor = 1;
+    unsigned int out_width = width / factor;
+    unsigned int out_height = height / factor;
+    size_t size = (size_t)out_width * out_height * 3 / 2;
+
+    uint8_t* dst = reserve(size);
+    if (!dst) {
+        drop_record();
+        return;
+    }
+    if (factor == 1) {
+        memcpy(dst, nv12, size);
+    } else {
+        downscale_nv12((const uint8_t*)nv12, width, height, dst, factor);
+    }
+    commit(CAPTURE_RECORD_FRAME, size, out_width, out_height);
+}
+
+void Capture_Tensor(const float* data, size_t size) {
+    if (!g_capture.recording || !g_capture.record_tensors || !data || size == 0) return;
+
+    uint8_t* dst = reserve(size);
+    if (!dst) {
+        drop_record();
+        return;
+    }
+    memcpy(dst, data, size);
+    commit(CAPTURE_RECORD_TENSOR, size, 0, 0);
+}
+
+void Capture_Metadata(cJSON* json) {
+    if (!g_capture.recording || !g_capture.record_metadata || !json) return;
+
+    // Print straight into the segment; retry once in a fresh segment
+    for (int attempt = 0; attempt < 2; attempt++) {
+        size_t space = segment_free();
+        if (space > CAPTURE_METADATA_RESERVE) space = CAPTURE_METADATA_RESERVE;
+        uint8_t* dst = index_free() > 0 && space > 0 ? g_capture.base + g_capture.header->data_end : NULL;
+        if (dst && cJSON_PrintPreallocated(json, (char*)dst, (int)space, 0)) {
+            commit(CAPTURE_RECORD_METADATA, strlen((const char*)dst), 0, 0);
+            return;
+        }
+        if (attempt == 0 && !open_segment()) break;
+    }
+    drop_record();
+}
+
+void Capture_End_Frame(int detection_count) {
+    if (!g_capture.enabled) return;
+
+    if (g_capture.trigger_on_detection && detection_count > 0) {
+        Capture_Trigger("detection");
+    }
+    if (!g_capture.recording) return;
+
+    g_capture.recording = 0;
+    if (g_capture.frame_bytes > g_capture.group_reserve) {
+        g_capture.group_reserve = g_capture.frame_bytes;
+    }
+
+    pthread_mutex_lock(&g_capture.mutex);
+    g_capture.frames_recorded++;
+    g_capture.bytes_recorded += g_capture.frame_bytes;
+    pthread_mutex_unlock(&g_capture.mutex);
+}
+
+void Capture_Trigger(const char* reason) {
+    if (!g_capture.enabled) return;
+
+    pthread_mutex_lock(&g_capture.mutex);
+    int armed = g_capture.trigger_remaining > 0;
+    g_capture.trigger_remaining = g_capture.trigger_frames;
+    if (!armed) g_capture.triggers++;
+    pthread_mutex_unlock(&g_capture.mutex);
+
+    if (!armed) {
+        LOG("Capture: Triggered (%s), recording %d frames\n", reason ? reason : "manual",
+            g_capture.trigger_frames);
+    }
+}
+
+cJSON* Capture_Stats_JSON(void) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", g_capture.enabled);
+    if (!g_capture.enabled) return json;
+
+    cJSON_AddStringToObject(json, "mode", g_capture.trigger_mode ? "trigger" : "continuous");
+    cJSON_AddStringToObject(json, "dir", g_capture.dir);
+
+    pthread_mutex_lock(&g_capture.mutex);
+    cJSON_AddNumberToObject(json, "segment", g_capture.segment);
+    cJSON_AddNumberToObject(json, "first_segment", g_capture.first_segment);
+    cJSON_AddNumberToObject(json, "segments_written", g_capture.segments_written);
+    cJSON_AddNumberToObject(json, "frames_recorded", g_capture.frames_recorded);
+    cJSON_AddNumberToObject(json, "bytes_recorded", (double)g_capture.bytes_recorded);
+    cJSON_AddNumberToObject(json, "records_dropped", g_capture.records_dropped);
+    cJSON_AddNumberToObject(json, "triggers", g_capture.triggers);
+    cJSON_AddNumberToObject(json, "trigger_remaining", g_capture.trigger_remaining);
+    pthread_mutex_unlock(&g_capture.mutex);
+
+    return json;
+}
+
+void Capture_Cleanup(void) {
+    if (!g_capture.enabled) return;
+
+    close_segment();
+
+    LOG("Capture cleanup: Frames=%lu Bytes=%llu Dropped=%lu Segments=%lu\n",
+        g_capture.frames_recorded, (unsigned long long)g_capture.bytes_recorded,
+        g_capture.records_dropped, g_capture.segments_written);
+
+    pthread_mutex_destroy(&g_capture.mutex);
+    g_capture.enabled = 0;
+}
+
+/*
+ * Reader
+ */
+
+struct CaptureReader {
+    uint8_t* base;
+    size_t map_size;
+    const CaptureIndexEntry* index;
+    size_t count;
+    size_t* positions[CAPTURE_RECORD_METADATA + 1];     // Index positions per type
+    size_t type_count[CAPTURE_RECORD_METADATA + 1];
+};
+
+int Capture_Is_Segment(const void* data, size_t size) {
+    return data && size >= sizeof(CaptureSegmentHeader) &&
+           memcmp(data, CAPTURE_MAGIC, strlen(CAPTURE_MAGIC)) == 0;
+}
+
+CaptureReader* Capture_Reader_Open(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERR("Capture: Cannot open %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(CaptureSegmentHeader)) {
+        LOG_ERR("Capture: %s is not a capture segment\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERR("Capture: mmap of %s failed: %s\n", path, strerror(errno));
+        return NULL;
+    }
+
+    CaptureReader* reader = (CaptureReader*)calloc(1, sizeof(CaptureReader));
+    if (!reader) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->base = (uint8_t*)base;
+    reader->map_size = (size_t)st.st_size;
+
+    const CaptureSegmentHeader* h = (const CaptureSegmentHeader*)base;
+    size_t index_end = sizeof(CaptureSegmentHeader) + (size_t)h->index_capacity * sizeof(CaptureIndexEntry);
+    if (!Capture_Is_Segment(base, reader->map_size) || h->version != CAPTURE_VERSION ||
+        h->header_bytes != sizeof(CaptureSegmentHeader) || h->index_count > h->index_capacity ||
+        index_end > reader->map_size) {
+        LOG_ERR("Capture: %s has an unsupported or damaged header\n", path);
+        Capture_Reader_Close(reader);
+        return NULL;
+    }
+    reader->index = (const CaptureIndexEntry*)(reader->base + sizeof(CaptureSegmentHeader));
+
+    // Drop records that point past the end (segment cut short)
+    size_t count = h->index_count;
+    for (size_t i = 0; i < count; i++) {
+        const CaptureIndexEntry* e = &reader->index[i];
+        if (e->offset + e->size > reader->map_size) {
+            LOG("Capture: %s truncated after %zu records\n", path, i);
+            count = i;
+            break;
+        }
+    }
+    reader->count = count;
+
+    for (int type = CAPTURE_RECORD_FRAME; type <= CAPTURE_RECORD_METADATA; type++) {
+        reader->positions[type] = (size_t*)malloc((count ? count : 1) * sizeof(size_t));
+        if (!reader->positions[type]) {
+            Capture_Reader_Close(reader);
+            return NULL;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        int type = reader->index[i].type;
+        if (type >= CAPTURE_RECORD_FRAME && type <= CAPTURE_RECORD_METADATA) {
+            reader->positions[type][reader->type_count[type]++] = i;
+        }
+    }
+
+    LOG("Capture: %s segment %u, %zu frames, %zu tensors, %zu metadata\n", path, h->segment,
+        reader->type_count[CAPTURE_RECORD_FRAME], reader->type_count[CAPTURE_RECORD_TENSOR],
+        reader->type_count[CAPTURE_RECORD_METADATA]);
+    return reader;
+}
+
+size_t Capture_Reader_Count(CaptureReader* reader, int type) {
+    if (!reader) return 0;
+    if (type == 0) return reader->count;
+    if (type < CAPTURE_RECORD_FRAME || type > CAPTURE_RECORD_METADATA) return 0;
+    return reader->type_count[type];
+}
+
+/**
+ * Index position of the n-th record of a type
+ */
+static const CaptureIndexEntry* reader_entry(CaptureReader* reader, int type, size_t n) {
+    if (n >= Capture_Reader_Count(reader, type)) return NULL;
+    return &reader->index[type == 0 ? n : reader->positions[type][n]];
+}
+
+const void* Capture_Reader_Get(CaptureReader* reader, int type, size_t n, CaptureIndexEntry* entry) {
+    const CaptureIndexEntry* e = reader_entry(reader, type, n);
+    if (!e) return NULL;
+    if (entry) *entry = *e;
+    return reader->base + e->offset;
+}
+
+size_t Capture_Reader_Find_Sequence(CaptureReader* reader, int type, uint32_t sequence) {
+    // Records are appended in frame order, so the index is sorted
+    size_t lo = 0, hi = Capture_Reader_Count(reader, type);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (reader_entry(reader, type, mid)->sequence < sequence) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t Capture_Reader_Find_Time(CaptureReader* reader, int type, int64_t timestamp_us) {
+    size_t lo = 0, hi = Capture_Reader_Count(reader, type);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (reader_entry(reader, type, mid)->timestamp_us < timestamp_us) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void Capture_Reader_Close(CaptureReader* reader) {
+    if (!reader) return;
+    for (int type = CAPTURE_RECORD_FRAME; type <= CAPTURE_RECORD_METADATA; type++) {
+        free(reader->positions[type]);
+    }
+    if (reader->base) munmap(reader->base, reader->map_size);
+    free(reader);
+}
@@ -0,0 +1,178 @@
+/**
+ * capture_log.h
+ *
+ * Record-and-replay capture log for Axis I.S. POC
+ * Appends raw NV12 frames (optionally downscaled), inference output tensors
+ * and published metadata JSON to segmented, memory-mapped log files so a
+ * field issue can be replayed on the host (file frame source and replay
+ * inference backend both read segments directly)
+ *
+ * Segment layout (capture_<n>.axcap, little-endian, 8-byte aligned):
+ *
+ *   CaptureSegmentHeader                    64 bytes
+ *   CaptureIndexEntry[index_capacity]       32 bytes each, sequence order
+ *   record payloads                         raw bytes, located by the index
+ *
+ * The writer fills a payload, then its index entry, then publishes the new
+ * index_count - a segment cut short by a crash is still readable up to the
+ * last committed record. Closed segments are truncated to data_end.
+ */
+
+#ifndef CAPTURE_LOG_H
+#define CAPTURE_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURE_MAGIC "AXISCAP1"
+#define CAPTURE_VERSION 1
+
+typedef enum {
+    CAPTURE_RECORD_FRAME = 1,       // NV12 pixels at width x height
+    CAPTURE_RECORD_TENSOR = 2,      // First output tensor, float32
+    CAPTURE_RECORD_METADATA = 3     // Published metadata, unformatted JSON
+} CaptureRecordType;
+
+typedef struct {
+    char magic[8];                  // CAPTURE_MAGIC
+    uint32_t version;
+    uint32_t header_bytes;          // sizeof(CaptureSegmentHeader)
+    uint32_t index_capacity;
+    uint32_t index_count;           // Committed records
+    uint64_t data_offset;           // First payload byte
+    uint64_t data_end;              // End of committed payloads
+    uint32_t segment;               // Segment number within the capture
+    uint32_t reserved;
+    int64_t created_us;             // Wall clock at segment open
+    char reserved2[8];
+} CaptureSegmentHeader;
+
+typedef struct {
+    int64_t timestamp_us;           // Frame timestamp (wall clock)
+    uint32_t sequence;              // Frame sequence number
+    uint16_t type;                  // CaptureRecordType
+    uint16_t reserved;
+    uint64_t offset;                // Payload offset from segment start
+    uint32_t size;                  // Payload bytes
+    uint16_t width;                 // Frame records only
+    uint16_t height;
+} CaptureIndexEntry;
+
+/*
+ * Writer (pipeline thread)
+ */
+
+/**
+ * Initialize capture from configuration
+ * @param config "capture" object from core config (may be NULL)
+ * @return 1 when capture is enabled, 0 when disabled or on failure
+ *
+ * Config keys:
+ *   enabled           Record anything at all (default false)
+ *   dir               Segment directory (default "localdata/capture")
+ *   segment_mb        Size of one segment (default 64)
+ *   max_segments      Oldest segment is deleted beyond this (default 4)
+ *   index_entries     Records per segment (default 4096)
+ *   every_n           Record every Nth frame (default 10)
+ *   downscale         Frame decimation factor 1, 2 or 4 (default 2)
+ *   frames, tensors, metadata   Record types to keep (default all true)
+ *   mode              "continuous" (default) or "trigger"
+ *   trigger_frames    Frames recorded after a trigger (default 50)
+ *   trigger_on_detection  Any detection triggers (default false)
+ */
+int Capture_Init(cJSON* config);
+
+/**
+ * Start a frame - decides whether this frame is recorded
+ * @return 1 if Capture_Frame/Tensor/Metadata will record until Capture_End_Frame
+ */
+int Capture_Begin_Frame(uint32_t sequence, int64_t timestamp_us);
+
+/**
+ * Record the frame pixels (NV12) of the current frame
+ */
+void Capture_Frame(const void* nv12, unsigned int width, unsigned int height);
+
+/**
+ * Record an output tensor of the current frame
+ */
+void Capture_Tensor(const float* data, size_t size);
+
+/**
+ * Record the published metadata of the current frame
+ * @param json Metadata object (serialized only when recording)
+ */
+void Capture_Metadata(cJSON* json);
+
+/**
+ * Finish the current frame
+ * @param detection_count Detections in the frame (for trigger_on_detection)
+ */
+void Capture_End_Frame(int detection_count);
+
+/**
+ * Record the next trigger_frames frames (any mode)
+ * Safe to call from any thread
+ * @param reason Short static string for the log
+ */
+void Capture_Trigger(const char* reason);
+
+/**
+ * Get capture statistics as JSON
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Capture_Stats_JSON(void);
+
+/**
+ * Close the open segment and free resources
+ */
+void Capture_Cleanup(void);
+
+/*
+ * Reader (host replay, file frame source, replay backend)
+ */
+
+typedef struct CaptureReader CaptureReader;
+
+/**
+ * Check whether a mapped file starts with a capture segment header
+ */
+int Capture_Is_Segment(const void* data, size_t size);
+
+/**
+ * Map a capture segment read-only
+ * @return Reader on success, NULL on failure
+ */
+CaptureReader* Capture_Reader_Open(const char* path);
+
+/**
+ * Number of records of a type (0 counts every record)
+ */
+size_t Capture_Reader_Count(CaptureReader* reader, int type);
+
+/**
+ * Get the n-th record of a type (0 means any type)
+ * @param entry Output: index entry
+ * @return Payload pointer, NULL when out of range
+ */
+const void* Capture_Reader_Get(CaptureReader* reader, int type, size_t n, CaptureIndexEntry* entry);
+
+/**
+ * Find the first record of a type at or after a sequence number / timestamp
+ * @return Position for Capture_Reader_Get(), or Capture_Reader_Count() if none
+ */
+size_t Capture_Reader_Find_Sequence(CaptureReader* reader, int type, uint32_t sequence);
+size_t Capture_Reader_Find_Time(CaptureReader* reader, int type, int64_t timestamp_us);
+
+void Capture_Reader_Close(CaptureReader* reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CAPTURE_LOG_H */
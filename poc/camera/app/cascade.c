@@ -0,0 +1,827 @@
+/**
+ * cascade.c
+ *
+ * Cascaded second-stage inference implementation for Axis I.S. POC
+ *
+ * Each stage owns an inference backend of its own. Crops are the parent
+ * box grown by the margin, clipped to the frame and, for crop jobs, aligned
+ * to even NV12 coordinates. A batch slot that cannot be filled by a crop
+ * job is filled on the CPU from the view cache, so one batch may mix both.
+ * With a result cache, crops whose object already has fresh results skip
+ * the model; only the rest are batched.
+ *
+ * A fresh result under fallback_below is sent to the cloud as a JPEG of
+ * its crop - the pixels the stage saw - when the stage has a
+ * fallback_prompt. Cached results are not sent again. The answer arrives
+ * on the main loop, after the frame, and is published on its own.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include "cascade.h"
+#include "larod_handler.h"
+#include "result_cache.h"
+#include "jpeg_encoder.h"
+#include "MQTT.h"
+#include "trace.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define CASCADE_MAX_CLASSES 16          // Parent classes a stage can select
+#define CASCADE_MAX_BATCH 16
+#define CASCADE_MAX_FALLBACKS 32        // Cloud fallbacks awaiting an answer
+
+typedef struct Stage Stage;
+
+struct Stage {
+    Cascade* owner;
+    char name[CASCADE_LABEL_SIZE];
+    int configured;                     // From core config, run every frame
+    int parent;                         // Stage id, -1 for detections
+    int classes[CASCADE_MAX_CLASSES];
+    int class_count;                    // 0 selects every class
+    float min_confidence;
+    float margin;
+    int max_crops;
+    unsigned int input_width;
+    unsigned int input_height;
+    unsigned int batch;
+    int hires;                          // Crop from the high-resolution match
+    float threshold;
+    float fallback_below;
+    char* fallback_prompt;              // NULL: flag fallbacks only
+    int fallback_quality;
+
+    CascadeDecodeFn decode;
+    void* user;
+    int num_classes;                    // Built-in yolo decoder
+    cJSON* labels;                      // Built-in classify decoder, may be NULL
+
+    InferenceBackend backend;
+    ResultCache* cache;                 // NULL without "cache"
+
+    // Results of the current frame
+    int ran;
+    int frame_id;
+    CascadeOutput outputs[CASCADE_MAX_RESULTS];
+    int count;
+
+    // Statistics
+    uint64_t runs;
+    uint64_t crops;
+    uint64_t jobs;
+    uint64_t zero_copy;                 // Slots filled by a crop job
+    uint64_t cpu_crops;
+    uint64_t results;
+    uint64_t cached;                    // Results served from the cache
+    uint64_t fallbacks;
+    uint64_t failures;
+    int64_t time_us;
+    uint64_t cloud_submitted;
+    uint64_t cloud_answers;
+    uint64_t cloud_failures;            // Not sent, or no answer
+};
+
+/* Fallback sent to the cloud, awaiting its answer */
+typedef struct Fallback {
+    struct Fallback* next;
+    Stage* stage;
+    int64_t sequence;                   // Frame the result came from
+    int detection;
+    CascadeResult result;
+} Fallback;
+
+struct Cascade {
+    Stage* stages[CASCADE_MAX_STAGES];
+    int count;
+
+    // Cloud fallback
+    CloudBatch* cloud;
+    char camera_id[64];
+    Fallback* fallbacks;
+    int fallback_count;
+    JpegBuffer jpeg;                    // Crop encode buffer, reused
+
+    // Track ids of this frame's detections (Cascade_Set_Tracks)
+    const int* tracks;
+    int track_count;
+};
+
+/* Crop to run, in frame-normalized centre coordinates */
+typedef struct {
+    float box[4];
+    int parent;
+    int detection;
+    int class_id;                       // Parent class
+    int pixels[4];                      // x, y, width, height in source pixels
+    int keyed;                          // key is valid
+    int entry;                          // Result cache entry, -1 for a new object
+    CacheKey key;
+} Crop;
+
+/* Pixels the crops are cut from */
+typedef struct {
+    unsigned int width;
+    unsigned int height;
+    int nv12;
+    int fd;
+    int64_t offset;
+    FrameViews* views;
+    HiResFrame hr;
+    int hires;
+} CropSource;
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Built-in decoder: argmax over the item's scores
+ */
+static int decode_classify(const float* output, size_t floats, CascadeResult* results,
+                           int capacity, void* user) {
+    Stage* stage = (Stage*)user;
+    if (floats == 0 || capacity < 1) return 0;
+
+    size_t best = 0;
+    for (size_t i = 1; i < floats; i++) {
+        if (output[i] > output[best]) best = i;
+    }
+    if (output[best] < stage->threshold) return 0;
+
+    memset(&results[0], 0, sizeof(CascadeResult));
+    results[0].class_id = (int)best;
+    results[0].confidence = output[best];
+    cJSON* label = stage->labels ? cJSON_GetArrayItem(stage->labels, (int)best) : NULL;
+    if (label && cJSON_IsString(label)) {
+        snprintf(results[0].label, sizeof(results[0].label), "%s", label->valuestring);
+    }
+    return 1;
+}
+
+/**
+ * Built-in decoder: best YOLOv5 box of the crop ([anchors, 5 + classes])
+ */
+static int decode_yolo(const float* output, size_t floats, CascadeResult* results,
+                       int capacity, void* user) {
+    Stage* stage = (Stage*)user;
+    size_t stride = 5 + (size_t)stage->num_classes;
+    if (capacity < 1 || floats < stride) return 0;
+
+    float best_confidence = 0.0f;
+    const float* best = NULL;
+    int best_class = 0;
+    for (size_t a = 0; a + stride <= floats; a += stride) {
+        const float* anchor = &output[a];
+        if (anchor[4] < stage->threshold) continue;
+        int class_id = 0;
+        for (int c = 1; c < stage->num_classes; c++) {
+            if (anchor[5 + c] > anchor[5 + class_id]) class_id = c;
+        }
+        float confidence = anchor[4] * anchor[5 + class_id];
+        if (confidence > best_confidence) {
+            best_confidence = confidence;
+            best = anchor;
+            best_class = class_id;
+        }
+    }
+    if (!best || best_confidence < stage->threshold) return 0;
+
+    memset(&results[0], 0, sizeof(CascadeResult));
+    results[0].class_id = best_class;
+    results[0].confidence = best_confidence;
+    results[0].x = best[0] / (float)stage->input_width;
+    results[0].y = best[1] / (float)stage->input_height;
+    results[0].width = best[2] / (float)stage->input_width;
+    results[0].height = best[3] / (float)stage->input_height;
+    return 1;
+}
+
+Cascade* Cascade_Create(cJSON* config, const char* camera_id, CloudBatch* cloud) {
+    Cascade* cascade = (Cascade*)calloc(1, sizeof(Cascade));
+    if (!cascade) {
+        LOG_ERR("Cascade: Failed to allocate context\n");
+        return NULL;
+    }
+    cascade->cloud = cloud;
+    snprintf(cascade->camera_id, sizeof(cascade->camera_id), "%s", camera_id ? camera_id : "");
+
+    cJSON* item;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(config, "stages")) {
+        int id = Cascade_Add_Stage(cascade, item, NULL, NULL);
+        if (id >= 0) cascade->stages[id]->configured = 1;
+    }
+    return cascade;
+}
+
+static float config_float(cJSON* config, const char* key, float def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsNumber(item) ? (float)item->valuedouble : def;
+}
+
+static int config_int(cJSON* config, const char* key, int def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsNumber(item) ? item->valueint : def;
+}
+
+static const char* config_string(cJSON* config, const char* key, const char* def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsString(item) ? item->valuestring : def;
+}
+
+int Cascade_Find_Stage(Cascade* cascade, const char* name) {
+    if (!cascade || !name) return -1;
+    for (int i = 0; i < cascade->count; i++) {
+        if (strcmp(cascade->stages[i]->name, name) == 0) return i;
+    }
+    return -1;
+}
+
+int Cascade_Add_Stage(Cascade* cascade, cJSON* config, CascadeDecodeFn decode, void* user) {
+    if (!cascade || !config) return -1;
+
+    const char* name = config_string(config, "name", NULL);
+    const char* model_path = config_string(config, "model_path", NULL);
+    if (!name || !*name || !model_path) {
+        LOG_ERR("Cascade: A stage needs a name and a model_path\n");
+        return -1;
+    }
+    if (cascade->count >= CASCADE_MAX_STAGES || Cascade_Find_Stage(cascade, name) >= 0) {
+        LOG_ERR("Cascade: Cannot add stage '%s' (duplicate, or %d stages already)\n",
+                name, CASCADE_MAX_STAGES);
+        return -1;
+    }
+
+    Stage* stage = (Stage*)calloc(1, sizeof(Stage));
+    if (!stage) {
+        LOG_ERR("Cascade: Failed to allocate stage\n");
+        return -1;
+    }
+
+    stage->owner = cascade;
+    snprintf(stage->name, sizeof(stage->name), "%s", name);
+    stage->min_confidence = config_float(config, "min_confidence", 0.5f);
+    stage->margin = config_float(config, "margin", 0.1f);
+    stage->max_crops = config_int(config, "max_crops", 8);
+    stage->input_width = (unsigned int)config_int(config, "input_width", 224);
+    stage->input_height = (unsigned int)config_int(config, "input_height", 224);
+    int batch = config_int(config, "batch", 1);
+    stage->batch = batch >= 1 && batch <= CASCADE_MAX_BATCH ? (unsigned int)batch : 1;
+    stage->hires = strcmp(config_string(config, "source", "frame"), "hires") == 0;
+    stage->threshold = config_float(config, "threshold", 0.25f);
+    stage->fallback_below = config_float(config, "fallback_below", 0.0f);
+    const char* fallback_prompt = config_string(config, "fallback_prompt", NULL);
+    stage->fallback_prompt = fallback_prompt && *fallback_prompt ? strdup(fallback_prompt) : NULL;
+    stage->fallback_quality = config_int(config, "fallback_quality", 85);
+    stage->num_classes = config_int(config, "num_classes", 1);
+    if (stage->max_crops < 1) stage->max_crops = 1;
+    if (stage->max_crops > CASCADE_MAX_RESULTS) stage->max_crops = CASCADE_MAX_RESULTS;
+    if (stage->margin < 0.0f) stage->margin = 0.0f;
+    if (stage->num_classes < 1) stage->num_classes = 1;
+
+    const char* parent = config_string(config, "parent", "detections");
+    stage->parent = strcmp(parent, "detections") == 0 ? -1 : Cascade_Find_Stage(cascade, parent);
+    cJSON* item;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(config, "classes")) {
+        if (cJSON_IsNumber(item) && stage->class_count < CASCADE_MAX_CLASSES) {
+            stage->classes[stage->class_count++] = item->valueint;
+        }
+    }
+
+    const char* decoder = config_string(config, "decoder", "classify");
+    stage->decode = decode;
+    stage->user = user;
+    if (!decode) {
+        stage->decode = strcmp(decoder, "yolo") == 0 ? decode_yolo : decode_classify;
+        stage->user = stage;
+        cJSON* labels = cJSON_GetObjectItem(config, "labels");
+        stage->labels = cJSON_IsArray(labels) ? cJSON_Duplicate(labels, 1) : NULL;
+    }
+
+    if (strcmp(parent, "detections") != 0 && stage->parent < 0) {
+        LOG_ERR("Cascade: Stage '%s' has unknown parent '%s'\n", name, parent);
+        cJSON_Delete(stage->labels);
+        free(stage->fallback_prompt);
+        free(stage);
+        return -1;
+    }
+    if (stage->input_width == 0 || stage->input_height == 0 ||
+        !Larod_Open_Backend(&stage->backend, model_path, config)) {
+        LOG_ERR("Cascade: Stage '%s' could not open %s\n", name, model_path);
+        cJSON_Delete(stage->labels);
+        free(stage->fallback_prompt);
+        free(stage);
+        return -1;
+    }
+    stage->cache = ResultCache_Create(cJSON_GetObjectItem(config, "cache"));
+
+    cascade->stages[cascade->count] = stage;
+    LOG("Cascade: Stage '%s' on %s <- %s (%d class(es), min %.2f), %ux%u x%u, %s\n",
+        stage->name, stage->backend.ops->name, parent, stage->class_count,
+        stage->min_confidence, stage->input_width, stage->input_height, stage->batch,
+        stage->hires ? "high-resolution crops" : "frame crops");
+    if (stage->cache) LOG("Cascade: Stage '%s' caches results per object\n", stage->name);
+    if (stage->fallback_prompt && stage->fallback_below > 0.0f) {
+        LOG("Cascade: Stage '%s' asks the cloud below %.2f%s\n", stage->name, stage->fallback_below,
+            cascade->cloud ? "" : " (no cloud_batch configured - flag only)");
+    }
+    return cascade->count++;
+}
+
+static int selects(const Stage* stage, int class_id, float confidence) {
+    if (confidence < stage->min_confidence) return 0;
+    if (stage->class_count == 0) return 1;
+    for (int i = 0; i < stage->class_count; i++) {
+        if (stage->classes[i] == class_id) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Where the stage's crops come from this frame
+ */
+static int crop_source(const Stage* stage, FrameData* frame, CropSource* src) {
+    memset(src, 0, sizeof(CropSource));
+    src->fd = -1;
+    if (stage->hires) {
+        if (!frame->hires || !HiRes_Get_Frame(frame->hires, frame->capture_us, &src->hr)) return 0;
+        src->hires = 1;
+        src->width = src->hr.width;
+        src->height = src->hr.height;
+        src->nv12 = 1;
+        src->fd = src->hr.fd;
+        src->offset = src->hr.offset;
+        src->views = src->hr.views;
+        return 1;
+    }
+
+    // After an early release only crops cached before it can be had
+    src->width = frame->width;
+    src->height = frame->height;
+    src->nv12 = frame->format == VDO_FORMAT_YUV && frame->frame_data != NULL;
+    if (frame->vdo_buffer) {
+        src->fd = vdo_buffer_get_fd(frame->vdo_buffer);
+        src->offset = vdo_buffer_get_offset(frame->vdo_buffer);
+    }
+    src->views = frame->views;
+    return 1;
+}
+
+/**
+ * Parent box grown by the margin, in source pixels
+ */
+static void crop_pixels(const Stage* stage, FrameData* frame, const CropSource* src, Crop* crop) {
+    float width = crop->box[2] * (1.0f + 2.0f * stage->margin);
+    float height = crop->box[3] * (1.0f + 2.0f * stage->margin);
+    int* px = crop->pixels;
+
+    if (src->hires) {
+        HiRes_Map_Box(frame->hires, &src->hr, crop->box[0], crop->box[1], width, height, px);
+    } else {
+        int x0 = (int)((crop->box[0] - width / 2.0f) * (float)src->width);
+        int y0 = (int)((crop->box[1] - height / 2.0f) * (float)src->height);
+        int x1 = (int)((crop->box[0] + width / 2.0f) * (float)src->width + 0.5f);
+        int y1 = (int)((crop->box[1] + height / 2.0f) * (float)src->height + 0.5f);
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > (int)src->width) x1 = (int)src->width;
+        if (y1 > (int)src->height) y1 = (int)src->height;
+        px[0] = x0;
+        px[1] = y0;
+        px[2] = x1 > x0 ? x1 - x0 : 0;
+        px[3] = y1 > y0 ? y1 - y0 : 0;
+    }
+
+    // Crop jobs want even NV12 coordinates
+    px[0] &= ~1;
+    px[1] &= ~1;
+    px[2] &= ~1;
+    px[3] &= ~1;
+}
+
+/**
+ * Crop-normalized decoder box to frame-normalized
+ */
+static void to_frame(FrameData* frame, const CropSource* src, const Crop* crop, CascadeResult* r) {
+    float box[4] = { (float)crop->pixels[0], (float)crop->pixels[1],
+                     (float)crop->pixels[2], (float)crop->pixels[3] };
+    if (r->width > 0.0f && r->height > 0.0f) {
+        box[0] += (r->x - r->width / 2.0f) * (float)crop->pixels[2];
+        box[1] += (r->y - r->height / 2.0f) * (float)crop->pixels[3];
+        box[2] = r->width * (float)crop->pixels[2];
+        box[3] = r->height * (float)crop->pixels[3];
+    }
+
+    if (src->hires) {
+        HiRes_Unmap_Box(frame->hires, &src->hr, box, &r->x, &r->y, &r->width, &r->height);
+    } else {
+        r->x = (box[0] + box[2] / 2.0f) / (float)src->width;
+        r->y = (box[1] + box[3] / 2.0f) / (float)src->height;
+        r->width = box[2] / (float)src->width;
+        r->height = box[3] / (float)src->height;
+    }
+}
+
+static void unlink_fallback(Cascade* cascade, Fallback* fb) {
+    for (Fallback** p = &cascade->fallbacks; *p; p = &(*p)->next) {
+        if (*p == fb) {
+            *p = fb->next;
+            cascade->fallback_count--;
+            return;
+        }
+    }
+}
+
+/**
+ * Cloud answer for a fallback - published with the local result it replaces
+ */
+static void on_fallback(const cJSON* result, int ok, void* user) {
+    Fallback* fb = (Fallback*)user;
+    Stage* stage = fb->stage;
+    Cascade* cascade = stage->owner;
+    unlink_fallback(cascade, fb);
+
+    if (!ok) {
+        stage->cloud_failures++;
+        free(fb);
+        return;
+    }
+    stage->cloud_answers++;
+
+    cJSON* msg = cJSON_CreateObject();
+    cJSON_AddStringToObject(msg, "camera_id", cascade->camera_id);
+    cJSON_AddStringToObject(msg, "stage", stage->name);
+    cJSON_AddNumberToObject(msg, "sequence", (double)fb->sequence);
+    cJSON_AddNumberToObject(msg, "detection", fb->detection);
+    cJSON* local = cJSON_AddObjectToObject(msg, "local");
+    cJSON_AddNumberToObject(local, "class_id", fb->result.class_id);
+    cJSON_AddNumberToObject(local, "confidence", fb->result.confidence);
+    if (fb->result.label[0]) cJSON_AddStringToObject(local, "label", fb->result.label);
+    cJSON_AddItemToObject(msg, "cloud", cJSON_Duplicate(result, 1));
+
+    char topic[128];
+    snprintf(topic, sizeof(topic), "axis-is/camera/%s/cascade", cascade->camera_id);
+    MQTT_Publish_JSON(topic, msg, 1, 0);
+    cJSON_Delete(msg);
+    free(fb);
+}
+
+/**
+ * Send a flagged result's crop to the cloud batcher
+ */
+static void submit_fallback(Stage* stage, FrameData* frame, const CropSource* src, const Crop* crop,
+                            const CascadeOutput* out) {
+    Cascade* cascade = stage->owner;
+    if (!stage->fallback_prompt || !cascade->cloud) return;
+    if (cascade->fallback_count >= CASCADE_MAX_FALLBACKS) {
+        stage->cloud_failures++;
+        return;
+    }
+
+    FrameView view;
+    if (!src->views ||
+        !Views_Crop(src->views, crop->pixels[0], crop->pixels[1], crop->pixels[2], crop->pixels[3],
+                    0, 0, 1, &view)) {
+        stage->cloud_failures++;
+        return;
+    }
+    JpegImage image = {
+        .width = view.width, .height = view.height, .quality = stage->fallback_quality,
+        .pixels = view.data, .stride = view.stride
+    };
+    size_t size = Jpeg_Encode(&image, &cascade->jpeg);
+    Fallback* fb = size ? (Fallback*)calloc(1, sizeof(Fallback)) : NULL;
+    if (!fb) {
+        stage->cloud_failures++;
+        return;
+    }
+    fb->stage = stage;
+    fb->sequence = frame->frame_id;
+    fb->detection = out->detection;
+    fb->result = out->result;
+
+    if (!CloudBatch_Submit(cascade->cloud, stage->name, stage->fallback_prompt,
+                           cascade->jpeg.data, size, on_fallback, fb)) {
+        stage->cloud_failures++;
+        free(fb);
+        return;
+    }
+    fb->next = cascade->fallbacks;
+    cascade->fallbacks = fb;
+    cascade->fallback_count++;
+    stage->cloud_submitted++;
+}
+
+/**
+ * Attach a crop's results (crop-normalized) to the stage's outputs
+ */
+static void emit(Stage* stage, FrameData* frame, const CropSource* src, const Crop* crop,
+                 const CascadeResult* results, int count, int cached, int32_t age_ms) {
+    for (int i = 0; i < count && stage->count < CASCADE_MAX_RESULTS; i++) {
+        CascadeOutput* out = &stage->outputs[stage->count++];
+        out->parent = crop->parent;
+        out->detection = crop->detection;
+        out->result = results[i];
+        to_frame(frame, src, crop, &out->result);
+        out->fallback = out->result.confidence < stage->fallback_below;
+        out->cached = cached;
+        out->age_ms = age_ms;
+        stage->fallbacks += (uint64_t)out->fallback;
+        stage->cached += (uint64_t)cached;
+        if (out->fallback && !cached) submit_fallback(stage, frame, src, crop, out);
+    }
+}
+
+/**
+ * Fill batch slot from crop - crop job, else CPU crop into the mapped tensor
+ */
+static int fill_slot(Stage* stage, const CropSource* src, const Crop* crop, unsigned int slot,
+                     uint8_t** input, size_t* input_size) {
+    const InferenceBackendOps* ops = stage->backend.ops;
+    if (src->nv12 && src->fd >= 0 && ops->set_input_crop &&
+        ops->set_input_crop(stage->backend.impl, src->fd, src->offset, src->width, src->height,
+                            crop->pixels, slot, stage->batch)) {
+        stage->zero_copy++;
+        return 1;
+    }
+
+    if (!*input) {
+        *input = (uint8_t*)ops->map_input(stage->backend.impl, input_size);
+        if (!*input) return 0;
+    }
+    size_t slot_size = *input_size / stage->batch;
+    size_t need = (size_t)stage->input_width * stage->input_height * 3;
+    FrameView view;
+    if (slot_size < need ||
+        !Views_Crop(src->views, crop->pixels[0], crop->pixels[1], crop->pixels[2], crop->pixels[3],
+                    stage->input_width, stage->input_height, 1, &view)) {
+        return 0;
+    }
+    memcpy(*input + slot * slot_size, view.data, need);
+    stage->cpu_crops++;
+    return 1;
+}
+
+/**
+ * Run one batch of crops and collect the decoded results
+ */
+static void run_batch(Stage* stage, FrameData* frame, const CropSource* src, const Crop* crops,
+                      int count, int64_t now) {
+    const InferenceBackendOps* ops = stage->backend.ops;
+    void* impl = stage->backend.impl;
+
+    int filled[CASCADE_MAX_BATCH];
+    int any = 0;
+    uint8_t* input = NULL;
+    size_t input_size = 0;
+    for (int k = 0; k < count; k++) {
+        filled[k] = fill_slot(stage, src, &crops[k], (unsigned int)k, &input, &input_size);
+        any |= filled[k];
+    }
+    if (input) ops->unmap_input(impl, input, input_size);
+    if (!any || !ops->invoke(impl)) {
+        stage->failures++;
+        return;
+    }
+    stage->jobs++;
+
+    size_t output_size = 0;
+    const float* output = ops->map_output(impl, &output_size);
+    if (!output) {
+        stage->failures++;
+        return;
+    }
+    size_t floats = output_size / sizeof(float) / stage->batch;
+
+    CascadeResult decoded[CASCADE_MAX_RESULTS];
+    for (int k = 0; k < count; k++) {
+        if (!filled[k]) continue;
+        int room = CASCADE_MAX_RESULTS - stage->count;
+        if (room <= 0) break;
+        int n = stage->decode(output + (size_t)k * floats, floats, decoded, room, stage->user);
+        if (crops[k].keyed) {
+            ResultCache_Store(stage->cache, crops[k].entry, &crops[k].key, now, decoded, n);
+        }
+        emit(stage, frame, src, &crops[k], decoded, n, 0, 0);
+    }
+    ops->unmap_output(impl, output, output_size);
+}
+
+int Cascade_Run(Cascade* cascade, FrameData* frame, int stage_id, const CascadeOutput** outputs) {
+    if (!cascade || !frame || stage_id < 0 || stage_id >= cascade->count) return -1;
+    Stage* stage = cascade->stages[stage_id];
+    if (outputs) *outputs = stage->outputs;
+    if (stage->ran && stage->frame_id == frame->frame_id) return stage->count;
+
+    stage->ran = 1;
+    stage->frame_id = frame->frame_id;
+    stage->count = 0;
+
+    // Parents: detections, or the parent stage's results (run first)
+    Crop crops[CASCADE_MAX_RESULTS];
+    int count = 0;
+    if (stage->parent < 0) {
+        MetadataFrame* meta = frame->metadata;
+        for (int i = 0; meta && i < meta->detection_count && count < stage->max_crops; i++) {
+            const Detection* det = &meta->detections[i];
+            if (!selects(stage, det->class_id, det->confidence)) continue;
+            crops[count++] = (Crop){ .box = { det->x, det->y, det->width, det->height },
+                                     .parent = i, .detection = i, .class_id = det->class_id };
+        }
+    } else {
+        const CascadeOutput* parents = NULL;
+        int parent_count = Cascade_Run(cascade, frame, stage->parent, &parents);
+        for (int i = 0; i < parent_count && count < stage->max_crops; i++) {
+            const CascadeResult* r = &parents[i].result;
+            if (!selects(stage, r->class_id, r->confidence)) continue;
+            crops[count++] = (Crop){ .box = { r->x, r->y, r->width, r->height },
+                                     .parent = i, .detection = parents[i].detection,
+                                     .class_id = r->class_id };
+        }
+    }
+    if (count == 0) return 0;
+
+    CropSource src;
+    if (!crop_source(stage, frame, &src)) {
+        stage->failures++;
+        return -1;
+    }
+
+    TraceSpan span = Trace_Begin("cascade");
+    int64_t start = now_us();
+    stage->runs++;
+
+    // Drop crops that vanished in clipping
+    int usable = 0;
+    for (int i = 0; i < count; i++) {
+        crop_pixels(stage, frame, &src, &crops[i]);
+        if (crops[i].pixels[2] >= 2 && crops[i].pixels[3] >= 2) crops[usable++] = crops[i];
+    }
+    stage->crops += (uint64_t)usable;
+
+    // Objects with fresh cached results skip the model
+    FrameView luma;
+    if (stage->cache && src.views && Views_Luma(src.views, &luma)) {
+        int pending = 0;
+        for (int i = 0; i < usable; i++) {
+            Crop* crop = &crops[i];
+            // The luma may be a pyramid level after an early release
+            int px[4];
+            for (int k = 0; k < 4; k++) {
+                unsigned int full = k % 2 ? src.height : src.width;
+                unsigned int scaled = k % 2 ? luma.height : luma.width;
+                px[k] = (int)((int64_t)crop->pixels[k] * scaled / full);
+            }
+            ResultCache_Key(&luma, px, &crop->key);
+            crop->key.class_id = crop->class_id;
+            if (cascade->tracks && crop->detection < cascade->track_count) {
+                crop->key.track = cascade->tracks[crop->detection];
+            }
+            crop->keyed = 1;
+
+            const CascadeResult* cached = NULL;
+            int cached_count = 0;
+            int32_t age_ms = 0;
+            if (ResultCache_Lookup(stage->cache, &crop->key, start, &crop->entry, &cached,
+                                   &cached_count, &age_ms) == RESULT_CACHE_HIT) {
+                emit(stage, frame, &src, crop, cached, cached_count, 1, age_ms);
+                continue;
+            }
+            crops[pending++] = *crop;
+        }
+        usable = pending;
+    }
+
+    for (int first = 0; first < usable; first += (int)stage->batch) {
+        int items = usable - first < (int)stage->batch ? usable - first : (int)stage->batch;
+        run_batch(stage, frame, &src, &crops[first], items, start);
+    }
+
+    stage->results += (uint64_t)stage->count;
+    stage->time_us += now_us() - start;
+    Trace_End(&span);
+    return stage->count;
+}
+
+int Cascade_Run_Configured(Cascade* cascade, FrameData* frame) {
+    if (!cascade || !frame) return 0;
+    int failed = 0;
+    for (int s = 0; s < cascade->count; s++) {
+        if (cascade->stages[s]->configured && Cascade_Run(cascade, frame, s, NULL) < 0) failed++;
+    }
+    return failed;
+}
+
+void Cascade_Attach_JSON(Cascade* cascade, int detection, cJSON* json) {
+    if (!cascade || !json) return;
+
+    cJSON* attached = NULL;
+    for (int s = 0; s < cascade->count; s++) {
+        Stage* stage = cascade->stages[s];
+        if (!stage->ran) continue;
+
+        cJSON* results = NULL;
+        for (int i = 0; i < stage->count; i++) {
+            const CascadeOutput* out = &stage->outputs[i];
+            if (out->detection != detection) continue;
+            if (!results) {
+                if (!attached) {
+                    attached = cJSON_CreateObject();
+                    cJSON_AddItemToObject(json, "cascade", attached);
+                }
+                results = cJSON_CreateArray();
+                cJSON_AddItemToObject(attached, stage->name, results);
+            }
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddNumberToObject(item, "class_id", out->result.class_id);
+            cJSON_AddNumberToObject(item, "confidence", out->result.confidence);
+            if (out->result.label[0]) cJSON_AddStringToObject(item, "label", out->result.label);
+            if (out->fallback) cJSON_AddBoolToObject(item, "fallback", 1);
+            if (out->cached) cJSON_AddNumberToObject(item, "cached_ms", out->age_ms);
+            cJSON_AddItemToArray(results, item);
+        }
+    }
+}
+
+void Cascade_Set_Tracks(Cascade* cascade, const int* track_ids, int count) {
+    if (!cascade) return;
+    cascade->tracks = count > 0 ? track_ids : NULL;
+    cascade->track_count = count > 0 ? count : 0;
+}
+
+void Cascade_End_Frame(Cascade* cascade) {
+    if (!cascade) return;
+    for (int s = 0; s < cascade->count; s++) {
+        cascade->stages[s]->ran = 0;
+        cascade->stages[s]->count = 0;
+        ResultCache_End_Frame(cascade->stages[s]->cache);
+    }
+    cascade->tracks = NULL;
+    cascade->track_count = 0;
+}
+
+cJSON* Cascade_Stats_JSON(Cascade* cascade) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON* stages = cJSON_CreateArray();
+    for (int s = 0; cascade && s < cascade->count; s++) {
+        Stage* stage = cascade->stages[s];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", stage->name);
+        cJSON_AddStringToObject(item, "backend", stage->backend.ops->name);
+        cJSON_AddNumberToObject(item, "batch", stage->batch);
+        cJSON_AddNumberToObject(item, "runs", (double)stage->runs);
+        cJSON_AddNumberToObject(item, "crops", (double)stage->crops);
+        cJSON_AddNumberToObject(item, "jobs", (double)stage->jobs);
+        cJSON_AddNumberToObject(item, "zero_copy", (double)stage->zero_copy);
+        cJSON_AddNumberToObject(item, "cpu_crops", (double)stage->cpu_crops);
+        cJSON_AddNumberToObject(item, "results", (double)stage->results);
+        cJSON_AddNumberToObject(item, "cached", (double)stage->cached);
+        cJSON_AddNumberToObject(item, "fallbacks", (double)stage->fallbacks);
+        cJSON_AddNumberToObject(item, "failures", (double)stage->failures);
+        cJSON_AddNumberToObject(item, "avg_run_us",
+                                stage->runs ? (double)stage->time_us / (double)stage->runs : 0);
+        if (stage->fallback_prompt) {
+            cJSON_AddNumberToObject(item, "cloud_submitted", (double)stage->cloud_submitted);
+            cJSON_AddNumberToObject(item, "cloud_answers", (double)stage->cloud_answers);
+            cJSON_AddNumberToObject(item, "cloud_failures", (double)stage->cloud_failures);
+        }
+        if (stage->cache) cJSON_AddItemToObject(item, "cache", ResultCache_Stats_JSON(stage->cache));
+        cJSON_AddItemToArray(stages, item);
+    }
+    cJSON_AddItemToObject(json, "stages", stages);
+    return json;
+}
+
+void Cascade_Destroy(Cascade* cascade) {
+    if (!cascade) return;
+    while (cascade->fallbacks) {
+        Fallback* fb = cascade->fallbacks;
+        cascade->fallbacks = fb->next;
+        CloudBatch_Cancel(cascade->cloud, fb);
+        free(fb);
+    }
+    Jpeg_Buffer_Free(&cascade->jpeg);
+    for (int s = 0; s < cascade->count; s++) {
+        Stage* stage = cascade->stages[s];
+        LOG("Cascade: '%s' cleanup: Runs=%llu Crops=%llu Jobs=%llu Results=%llu\n", stage->name,
+            (unsigned long long)stage->runs, (unsigned long long)stage->crops,
+            (unsigned long long)stage->jobs, (unsigned long long)stage->results);
+        if (stage->backend.ops) stage->backend.ops->cleanup(stage->backend.impl);
+        ResultCache_Destroy(stage->cache);
+        cJSON_Delete(stage->labels);
+        free(stage->fallback_prompt);
+        free(stage);
+    }
+    free(cascade);
+}
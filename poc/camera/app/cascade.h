@@ -0,0 +1,167 @@
+/**
+ * cascade.h
+ *
+ * Cascaded second-stage inference for Axis I.S. POC
+ * A module declares a stage - "run model X on crops of class Y above
+ * confidence Z" - at init. The first Cascade_Run() for a frame gathers
+ * the crops from that frame (or its high-resolution match), fills the
+ * model's batch slots with larod crop jobs where the backend has them (CPU
+ * crops otherwise), runs one job per batch and decodes each slot. Results
+ * hang off their parent: a detection, or a result of an earlier stage, so
+ * stages chain (vehicle -> plate detector -> plate OCR).
+ *
+ * Results are memoized per frame, and published with their root detection
+ * under "cascade". Stages listed in core config run on every frame after
+ * the modules. A result flagged as fallback is sent, cropped, to the cloud
+ * batcher when its stage has a fallback_prompt; the answer publishes on
+ * axis-is/camera/<id>/cascade. Pipeline thread only.
+ */
+
+#ifndef CASCADE_H
+#define CASCADE_H
+
+#include "cJSON.h"
+#include "module.h"
+#include "cloud_batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CASCADE_MAX_STAGES 8
+#define CASCADE_MAX_RESULTS 64          // Per stage and frame
+#define CASCADE_LABEL_SIZE 32
+
+/* One decoded result */
+typedef struct {
+    int class_id;
+    float confidence;
+    float x, y, width, height;          // Box: decoders write crop-normalized [0-1] centre
+                                        // and size, outputs hold frame-normalized; a
+                                        // zero width means the whole crop (classifiers)
+    char label[CASCADE_LABEL_SIZE];     // Text result (OCR), empty if none
+} CascadeResult;
+
+/* Result attached to its parent */
+typedef struct {
+    int parent;                         // Parent detection, or parent stage output index
+    int detection;                      // Root detection (metadata index)
+    int fallback;                       // Confidence under the stage's fallback_below
+    int cached;                         // From the stage's result cache, not this frame
+    int32_t age_ms;                     // Age of a cached result
+    CascadeResult result;
+} CascadeOutput;
+
+/**
+ * Decode one batch item of the stage's output tensor
+ * @param output The item's floats
+ * @param floats Floats per item
+ * @param results Output, at most capacity
+ * @param user Pointer given to Cascade_Add_Stage()
+ * @return Results written
+ */
+typedef int (*CascadeDecodeFn)(const float* output, size_t floats, CascadeResult* results,
+                               int capacity, void* user);
+
+/**
+ * Create the cascade (owned by core) with the stages of its config
+ * @param config "cascade" object from core config, NULL for none
+ * @param camera_id Camera the fallback answers publish for
+ * @param cloud Batcher for fallback crops, NULL for no cloud fallback
+ *
+ * Config keys:
+ *   stages  Stage objects (see Cascade_Add_Stage), run on every frame
+ *           after the modules
+ */
+Cascade* Cascade_Create(cJSON* config, const char* camera_id, CloudBatch* cloud);
+
+/**
+ * Declare a stage (module init)
+ * @param config Stage object from the module config
+ * @param decode Decoder, NULL to use the built-in one named in config
+ * @param user Passed to decode
+ * @return Stage id, -1 on failure
+ *
+ * Config keys:
+ *   name            Stage name, unique (results publish under it)
+ *   model_path      Model file
+ *   backend         Inference backend as in core "inference" (default "larod"),
+ *                   with its keys alongside
+ *   parent          "detections" (default) or the name of an earlier stage
+ *   classes         Parent class ids to crop (default all)
+ *   min_confidence  Parent confidence needed (default 0.5)
+ *   margin          Grow each crop by this fraction per side (default 0.1)
+ *   max_crops       Crops per frame (default 8)
+ *   input_width,    Model input size (default 224x224)
+ *   input_height
+ *   batch           Items per job - the model's batch dimension (default 1)
+ *   source          "frame" (default) or "hires" for the high-resolution match
+ *   decoder         Built-in decoder: "classify" (argmax, optional "labels"
+ *                   array) or "yolo" (best YOLOv5 box per crop, "num_classes")
+ *   threshold       Built-in decoders drop results below this (default 0.25)
+ *   fallback_below  Flag results under this confidence for a cloud fallback
+ *                   (default 0: never)
+ *   fallback_prompt Cloud instruction for flagged results; their crops go to
+ *                   the batcher under the stage name as prompt id (default
+ *                   none: flag only)
+ *   fallback_quality  JPEG quality of those crops (default 85)
+ *   cache           Per-object result cache (see result_cache.h), default none
+ */
+int Cascade_Add_Stage(Cascade* cascade, cJSON* config, CascadeDecodeFn decode, void* user);
+
+/**
+ * Look a stage up by name
+ * @return Stage id, -1 if unknown
+ */
+int Cascade_Find_Stage(Cascade* cascade, const char* name);
+
+/**
+ * Get a stage's results for the frame, running it (and its parents) first
+ * @param outputs Output: results, valid until the frame ends
+ * @return Result count, -1 on failure
+ */
+int Cascade_Run(Cascade* cascade, FrameData* frame, int stage, const CascadeOutput** outputs);
+
+/**
+ * Run the stages from core config that no module has run this frame
+ * @return Stages that failed
+ */
+int Cascade_Run_Configured(Cascade* cascade, FrameData* frame);
+
+/**
+ * Give the frame's detections track ids (tracker modules), so cached
+ * results follow objects by id instead of by appearance
+ * @param track_ids One per metadata detection, -1 for untracked; must stay
+ *                  valid until the frame ends
+ */
+void Cascade_Set_Tracks(Cascade* cascade, const int* track_ids, int count);
+
+/**
+ * Add the results for a detection to its published JSON (only stages that
+ * ran this frame)
+ */
+void Cascade_Attach_JSON(Cascade* cascade, int detection, cJSON* json);
+
+/**
+ * End of frame - results become stale
+ */
+void Cascade_End_Frame(Cascade* cascade);
+
+/**
+ * Get per-stage statistics as JSON (crops, jobs, zero-copy share, time,
+ * cloud fallbacks)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Cascade_Stats_JSON(Cascade* cascade);
+
+/**
+ * Drop pending cloud fallbacks and free every stage and its backend
+ * (before the cloud batcher)
+ */
+void Cascade_Destroy(Cascade* cascade);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CASCADE_H */
@@ -0,0 +1,602 @@
+/**
+ * cloud_batch.c
+ *
+ * Cloud AI request batcher implementation for Axis I.S. POC
+ *
+ * Gathering batches are kept per prompt id with a GLib timer for their
+ * window; sent batches stay listed until their response arrives, so a
+ * repeated image finds its item either way. Items are keyed by a 64-bit
+ * FNV-1a hash of prompt id and image bytes, which is also the "id" sent.
+ * Answers served from the response cache are queued and handed out from
+ * one idle source, so callbacks never run inside Submit.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <glib.h>
+#include "cloud_batch.h"
+#include "cloud_cache.h"
+#include "frame_arena.h"
+#include "module.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define BASE64_SIZE(n) (4 * (((n) + 2) / 3))
+
+typedef struct Waiter {
+    struct Waiter* next;
+    CloudResultFn done;
+    void* user;
+} Waiter;
+
+/* Response cache hit waiting for the main loop */
+typedef struct Answer {
+    struct Answer* next;
+    cJSON* response;
+    CloudResultFn done;
+    void* user;
+} Answer;
+
+typedef struct Item {
+    struct Item* next;
+    uint64_t hash;
+    uint64_t phash;                     // Perceptual hash for the response cache
+    int hashed;
+    char id[17];                        // Hash as hex, the item's "id"
+    uint8_t* jpeg;                      // Freed once encoded into the call
+    size_t jpeg_size;
+    int position;                       // Index in the call's "items", -1 if left out
+    Waiter* waiters;
+} Item;
+
+typedef struct Batch {
+    struct Batch* next;
+    CloudBatch* cb;
+    char* prompt_id;
+    char* prompt;
+    Item* items;
+    Item* tail;
+    int count;
+    int sent;                           // Items that made it into the call
+    size_t bytes;                       // Base64 image bytes
+    guint timer;                        // Window, or the idle failing a refused call
+    int64_t opened_us;
+    int64_t sent_us;
+} Batch;
+
+struct CloudBatch {
+    HttpClient* http;
+    char* url;
+    char* headers;
+    guint window_ms;
+    int max_items;
+    size_t max_bytes;
+    int max_pending;
+    long timeout_ms;
+
+    Batch* gathering;
+    Batch* in_flight;
+    int pending;                        // Items in either list
+
+    CloudCache* cache;
+    Answer* answers;
+    Answer* answers_tail;
+    guint answer_source;
+
+    // Statistics
+    uint64_t submitted;
+    uint64_t deduplicated;              // Joined an item already pending
+    uint64_t cached;                    // Answered from the response cache
+    uint64_t refused;                   // max_pending reached
+    uint64_t cancelled;
+    uint64_t calls;
+    uint64_t calls_answered;            // Response or transport failure came back
+    uint64_t calls_failed;
+    uint64_t items_sent;
+    uint64_t items_unanswered;          // Call succeeded without a result for them
+    uint64_t bytes_sent;
+    int64_t gather_us;                  // Window time, summed over calls
+    int64_t call_us;
+};
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static uint64_t content_hash(const char* prompt_id, const uint8_t* data, size_t size) {
+    uint64_t hash = 1469598103934665603ull;
+    for (const char* p = prompt_id; *p; p++) hash = (hash ^ (uint8_t)*p) * 1099511628211ull;
+    hash = (hash ^ 0xff) * 1099511628211ull;
+    for (size_t i = 0; i < size; i++) hash = (hash ^ data[i]) * 1099511628211ull;
+    return hash;
+}
+
+CloudBatch* CloudBatch_Create(cJSON* config, HttpClient* http) {
+    const char* url = module_config_get_string(config, "url", "");
+    if (!config || !http || !url[0]) return NULL;
+
+    CloudBatch* cb = (CloudBatch*)calloc(1, sizeof(CloudBatch));
+    if (!cb) {
+        LOG_ERR("CloudBatch: Failed to allocate context\n");
+        return NULL;
+    }
+
+    const char* api_key = module_config_get_string(config, "api_key", "");
+    int window_ms = module_config_get_int(config, "window_ms", 50);
+    cb->http = http;
+    cb->max_items = module_config_get_int(config, "max_items", 8);
+    cb->max_bytes = (size_t)module_config_get_int(config, "max_body_kb", 2048) * 1024;
+    cb->max_pending = module_config_get_int(config, "max_pending", 64);
+    cb->timeout_ms = module_config_get_int(config, "timeout_ms", 0);
+    cb->window_ms = window_ms > 0 ? (guint)window_ms : 0;
+    if (cb->max_items < 1) cb->max_items = 1;
+    if (cb->max_pending < 1) cb->max_pending = 1;
+    cb->cache = CloudCache_Create(cJSON_GetObjectItem(config, "cache"));
+
+    cb->url = strdup(url);
+    cb->headers = api_key[0] ? g_strdup_printf("Content-Type: application/json\n"
+                                               "Authorization: Bearer %s", api_key)
+                             : g_strdup("Content-Type: application/json");
+    if (!cb->url || !cb->headers) {
+        LOG_ERR("CloudBatch: Failed to allocate context\n");
+        CloudBatch_Destroy(cb);
+        return NULL;
+    }
+
+    LOG("CloudBatch: %s (window %ums, %d items, %zu KB per call, cache %s)\n",
+        cb->url, cb->window_ms, cb->max_items, cb->max_bytes / 1024, cb->cache ? "on" : "off");
+    return cb;
+}
+
+static void free_batch(Batch* batch) {
+    Item* item = batch->items;
+    while (item) {
+        Item* next = item->next;
+        Waiter* w = item->waiters;
+        while (w) {
+            Waiter* wn = w->next;
+            free(w);
+            w = wn;
+        }
+        free(item->jpeg);
+        free(item);
+        item = next;
+    }
+    free(batch->prompt_id);
+    free(batch->prompt);
+    free(batch);
+}
+
+static void unlink_batch(Batch** list, Batch* batch) {
+    for (Batch** p = list; *p; p = &(*p)->next) {
+        if (*p == batch) {
+            *p = batch->next;
+            return;
+        }
+    }
+}
+
+/**
+ * Answer every waiter of a finished call, then free it
+ */
+static void finish(CloudBatch* cb, Batch* batch, cJSON* results) {
+    unlink_batch(&cb->in_flight, batch);
+    cb->pending -= batch->count;
+
+    // Results without ids line up with the call only if none is missing
+    int positional = results && cJSON_GetArraySize(results) == batch->sent;
+    for (Item* item = batch->items; item; item = item->next) {
+        cJSON* result = NULL;
+        cJSON* entry;
+        if (item->position < 0) {
+            // Left out of the call, nothing can answer it
+            for (Waiter* w = item->waiters; w; w = w->next) w->done(NULL, 0, w->user);
+            continue;
+        }
+        cJSON_ArrayForEach(entry, results) {
+            cJSON* id = cJSON_GetObjectItem(entry, "id");
+            if (cJSON_IsString(id) && strcmp(id->valuestring, item->id) == 0) {
+                result = entry;
+                break;
+            }
+        }
+        if (!result && positional) {
+            entry = cJSON_GetArrayItem(results, item->position);
+            if (entry && !cJSON_GetObjectItem(entry, "id")) result = entry;
+        }
+        if (results && !result) cb->items_unanswered++;
+        if (result && cb->cache && item->hashed) {
+            CloudCache_Store(cb->cache, batch->prompt_id, item->phash, result);
+        }
+
+        for (Waiter* w = item->waiters; w; w = w->next) w->done(result, result != NULL, w->user);
+    }
+    free_batch(batch);
+}
+
+static void call_done(const HttpResponse* response, int ok, void* user) {
+    Batch* batch = (Batch*)user;
+    CloudBatch* cb = batch->cb;
+    cb->call_us += now_us() - batch->sent_us;
+    cb->calls_answered++;
+
+    cJSON* json = NULL;
+    if (ok && response->status >= 200 && response->status < 300) json = cJSON_Parse(response->body);
+    cJSON* results = json ? cJSON_GetObjectItem(json, "results") : NULL;
+    if (!cJSON_IsArray(results)) {
+        cb->calls_failed++;
+        LOG_ERR("CloudBatch: Call with %d items failed (HTTP %ld)\n", batch->count, response->status);
+        results = NULL;
+    }
+    finish(cb, batch, results);
+    cJSON_Delete(json);
+}
+
+static gboolean call_refused(gpointer user) {
+    Batch* batch = (Batch*)user;
+    batch->timer = 0;
+    batch->cb->calls_failed++;
+    finish(batch->cb, batch, NULL);
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * Post a gathering batch and move it to the in-flight list
+ */
+static void send_batch(CloudBatch* cb, Batch* batch) {
+    unlink_batch(&cb->gathering, batch);
+    if (batch->timer) {
+        g_source_remove(batch->timer);
+        batch->timer = 0;
+    }
+    batch->next = cb->in_flight;
+    cb->in_flight = batch;
+    batch->sent_us = now_us();
+    cb->gather_us += batch->sent_us - batch->opened_us;
+
+    cJSON* request = cJSON_CreateObject();
+    cJSON_AddStringToObject(request, "prompt_id", batch->prompt_id);
+    cJSON_AddStringToObject(request, "prompt", batch->prompt);
+    cJSON* items = cJSON_AddArrayToObject(request, "items");
+    batch->sent = 0;
+    for (Item* item = batch->items; item; item = item->next) {
+        char* image = NULL;
+        item->position = -1;
+        if (encode_base64((const char*)item->jpeg, item->jpeg_size, &image) == 0) {
+            item->position = batch->sent++;
+            cJSON* entry = cJSON_CreateObject();
+            cJSON_AddStringToObject(entry, "id", item->id);
+            cJSON_AddStringToObject(entry, "image", image);
+            cJSON_AddItemToArray(items, entry);
+            free(image);
+        } else {
+            LOG_ERR("CloudBatch: Failed to encode %zu byte image, left out of the call\n",
+                    item->jpeg_size);
+        }
+        free(item->jpeg);
+        item->jpeg = NULL;
+    }
+    char* body = cJSON_PrintUnformatted(request);
+    cJSON_Delete(request);
+
+    // Callers hear about a refused call from the main loop, never from inside Submit
+    if (!body || !Http_Post_Async(cb->http, cb->url, cb->headers, body, strlen(body),
+                                  cb->timeout_ms, call_done, batch)) {
+        LOG_ERR("CloudBatch: Call with %d items refused\n", batch->count);
+        batch->timer = g_idle_add(call_refused, batch);
+    } else {
+        cb->calls++;
+        cb->items_sent += (uint64_t)batch->sent;
+        cb->bytes_sent += strlen(body);
+    }
+    cJSON_free(body);
+}
+
+static gboolean window_closed(gpointer user) {
+    Batch* batch = (Batch*)user;
+    batch->timer = 0;
+    send_batch(batch->cb, batch);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean deliver_answers(gpointer user) {
+    CloudBatch* cb = (CloudBatch*)user;
+    Answer* answer = cb->answers;
+    cb->answers = cb->answers_tail = NULL;
+    cb->answer_source = 0;
+    while (answer) {
+        Answer* next = answer->next;
+        answer->done(answer->response, 1, answer->user);
+        cJSON_Delete(answer->response);
+        free(answer);
+        answer = next;
+    }
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * Serve a submission from the response cache
+ * @return 1 on a hit (done is called from the main loop)
+ */
+static int answer_cached(CloudBatch* cb, const char* prompt_id, uint64_t phash,
+                         CloudResultFn done, void* user) {
+    const cJSON* cached = CloudCache_Lookup(cb->cache, prompt_id, phash);
+    if (!cached) return 0;
+    Answer* answer = (Answer*)calloc(1, sizeof(Answer));
+    if (!answer) return 0;
+    // Delivered from the main loop after this frame's arena is reset
+    FrameArena* arena = Arena_Set_Current(NULL);
+    answer->response = cJSON_Duplicate(cached, 1);
+    Arena_Set_Current(arena);
+    if (!answer->response) {
+        free(answer);
+        return 0;
+    }
+    answer->done = done;
+    answer->user = user;
+    if (cb->answers_tail) {
+        cb->answers_tail->next = answer;
+    } else {
+        cb->answers = answer;
+    }
+    cb->answers_tail = answer;
+    if (!cb->answer_source) cb->answer_source = g_idle_add(deliver_answers, cb);
+    return 1;
+}
+
+static Item* find_item(Batch* list, uint64_t hash) {
+    for (Batch* batch = list; batch; batch = batch->next) {
+        for (Item* item = batch->items; item; item = item->next) {
+            if (item->hash == hash) return item;
+        }
+    }
+    return NULL;
+}
+
+int CloudBatch_Submit(CloudBatch* cb, const char* prompt_id, const char* prompt,
+                      const uint8_t* jpeg, size_t jpeg_size, CloudResultFn done, void* user) {
+    if (!cb || !prompt_id || !jpeg || !jpeg_size || !done) return 0;
+
+    // Answered before for this or a near-identical image - no call at all
+    uint64_t phash = 0;
+    int hashed = cb->cache && CloudCache_Hash(jpeg, jpeg_size, &phash);
+    if (hashed && answer_cached(cb, prompt_id, phash, done, user)) {
+        cb->submitted++;
+        cb->cached++;
+        return 1;
+    }
+
+    Waiter* waiter = (Waiter*)calloc(1, sizeof(Waiter));
+    if (!waiter) return 0;
+    waiter->done = done;
+    waiter->user = user;
+
+    // Same prompt and bytes already on their way - wait for that result
+    uint64_t hash = content_hash(prompt_id, jpeg, jpeg_size);
+    Item* item = find_item(cb->gathering, hash);
+    if (!item) item = find_item(cb->in_flight, hash);
+    if (item) {
+        waiter->next = item->waiters;
+        item->waiters = waiter;
+        cb->submitted++;
+        cb->deduplicated++;
+        return 1;
+    }
+
+    if (cb->pending >= cb->max_pending) {
+        cb->refused++;
+        free(waiter);
+        return 0;
+    }
+
+    item = (Item*)calloc(1, sizeof(Item));
+    if (item) item->jpeg = (uint8_t*)malloc(jpeg_size);
+    if (!item || !item->jpeg) {
+        free(item);
+        free(waiter);
+        return 0;
+    }
+    memcpy(item->jpeg, jpeg, jpeg_size);
+    item->jpeg_size = jpeg_size;
+    item->hash = hash;
+    item->phash = phash;
+    item->hashed = hashed;
+    snprintf(item->id, sizeof(item->id), "%016llx", (unsigned long long)hash);
+    item->waiters = waiter;
+
+    size_t bytes = BASE64_SIZE(jpeg_size);
+    Batch* batch = cb->gathering;
+    while (batch && strcmp(batch->prompt_id, prompt_id) != 0) batch = batch->next;
+    if (batch && batch->bytes + bytes > cb->max_bytes) {
+        send_batch(cb, batch);
+        batch = NULL;
+    }
+    if (!batch) {
+        batch = (Batch*)calloc(1, sizeof(Batch));
+        if (batch) {
+            batch->prompt_id = strdup(prompt_id);
+            batch->prompt = strdup(prompt ? prompt : "");
+        }
+        if (!batch || !batch->prompt_id || !batch->prompt) {
+            if (batch) free_batch(batch);
+            free(item->jpeg);
+            free(item);
+            free(waiter);
+            return 0;
+        }
+        batch->cb = cb;
+        batch->opened_us = now_us();
+        batch->next = cb->gathering;
+        cb->gathering = batch;
+        batch->timer = g_timeout_add(cb->window_ms, window_closed, batch);
+    }
+
+    if (batch->tail) {
+        batch->tail->next = item;
+    } else {
+        batch->items = item;
+    }
+    batch->tail = item;
+    batch->count++;
+    batch->bytes += bytes;
+    cb->pending++;
+    cb->submitted++;
+
+    if (batch->count >= cb->max_items) send_batch(cb, batch);
+    return 1;
+}
+
+void CloudBatch_Flush(CloudBatch* cb) {
+    if (!cb) return;
+    while (cb->gathering) send_batch(cb, cb->gathering);
+}
+
+/**
+ * Remove a caller's waiters from one item
+ */
+static int drop_waiters(Item* item, void* user) {
+    int dropped = 0;
+    Waiter** p = &item->waiters;
+    while (*p) {
+        Waiter* w = *p;
+        if (w->user == user) {
+            *p = w->next;
+            free(w);
+            dropped++;
+        } else {
+            p = &w->next;
+        }
+    }
+    return dropped;
+}
+
+int CloudBatch_Cancel(CloudBatch* cb, void* user) {
+    if (!cb) return 0;
+    int dropped = 0;
+
+    Answer** a = &cb->answers;
+    cb->answers_tail = NULL;
+    while (*a) {
+        Answer* answer = *a;
+        if (answer->user == user) {
+            *a = answer->next;
+            cJSON_Delete(answer->response);
+            free(answer);
+            dropped++;
+        } else {
+            cb->answers_tail = answer;
+            a = &answer->next;
+        }
+    }
+
+    // In flight: the call goes on, nobody is told
+    for (Batch* batch = cb->in_flight; batch; batch = batch->next) {
+        for (Item* item = batch->items; item; item = item->next) dropped += drop_waiters(item, user);
+    }
+
+    // Gathering: items nobody waits for are not sent at all
+    Batch* batch = cb->gathering;
+    while (batch) {
+        Batch* next_batch = batch->next;
+        Item** p = &batch->items;
+        batch->tail = NULL;
+        while (*p) {
+            Item* item = *p;
+            dropped += drop_waiters(item, user);
+            if (!item->waiters) {
+                *p = item->next;
+                batch->count--;
+                batch->bytes -= BASE64_SIZE(item->jpeg_size);
+                cb->pending--;
+                free(item->jpeg);
+                free(item);
+            } else {
+                batch->tail = item;
+                p = &item->next;
+            }
+        }
+        if (batch->count == 0) {
+            unlink_batch(&cb->gathering, batch);
+            if (batch->timer) g_source_remove(batch->timer);
+            free_batch(batch);
+        }
+        batch = next_batch;
+    }
+
+    cb->cancelled += (uint64_t)dropped;
+    return dropped;
+}
+
+cJSON* CloudBatch_Stats_JSON(CloudBatch* cb) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", cb != NULL);
+    if (!cb) return json;
+
+    cJSON_AddNumberToObject(json, "pending", cb->pending);
+    cJSON_AddNumberToObject(json, "submitted", (double)cb->submitted);
+    cJSON_AddNumberToObject(json, "deduplicated", (double)cb->deduplicated);
+    cJSON_AddNumberToObject(json, "cached", (double)cb->cached);
+    cJSON_AddNumberToObject(json, "refused", (double)cb->refused);
+    cJSON_AddNumberToObject(json, "cancelled", (double)cb->cancelled);
+    cJSON_AddNumberToObject(json, "calls", (double)cb->calls);
+    cJSON_AddNumberToObject(json, "calls_failed", (double)cb->calls_failed);
+    cJSON_AddNumberToObject(json, "items_sent", (double)cb->items_sent);
+    cJSON_AddNumberToObject(json, "items_unanswered", (double)cb->items_unanswered);
+    cJSON_AddNumberToObject(json, "items_per_call", cb->calls ? (double)cb->items_sent / (double)cb->calls : 0);
+    cJSON_AddNumberToObject(json, "bytes_sent", (double)cb->bytes_sent);
+    cJSON_AddNumberToObject(json, "avg_gather_ms",
+                            cb->calls ? (double)cb->gather_us / 1000.0 / (double)cb->calls : 0);
+    cJSON_AddNumberToObject(json, "avg_call_ms",
+                            cb->calls_answered ? (double)cb->call_us / 1000.0 / (double)cb->calls_answered : 0);
+    cJSON_AddItemToObject(json, "cache", CloudCache_Stats_JSON(cb->cache));
+    return json;
+}
+
+void CloudBatch_Destroy(CloudBatch* cb) {
+    if (!cb) return;
+
+    LOG("CloudBatch: cleanup: Submitted=%llu Deduplicated=%llu Cached=%llu Calls=%llu Items=%llu\n",
+        (unsigned long long)cb->submitted, (unsigned long long)cb->deduplicated,
+        (unsigned long long)cb->cached, (unsigned long long)cb->calls,
+        (unsigned long long)cb->items_sent);
+
+    if (cb->answer_source) g_source_remove(cb->answer_source);
+    while (cb->answers) {
+        Answer* answer = cb->answers;
+        cb->answers = answer->next;
+        cJSON_Delete(answer->response);
+        free(answer);
+    }
+
+    while (cb->in_flight) {
+        Batch* batch = cb->in_flight;
+        cb->in_flight = batch->next;
+        if (batch->timer) {
+            g_source_remove(batch->timer);
+        } else {
+            Http_Cancel(cb->http, batch);
+        }
+        free_batch(batch);
+    }
+    while (cb->gathering) {
+        Batch* batch = cb->gathering;
+        cb->gathering = batch->next;
+        if (batch->timer) g_source_remove(batch->timer);
+        free_batch(batch);
+    }
+    CloudCache_Destroy(cb->cache);
+    g_free(cb->headers);
+    free(cb->url);
+    free(cb);
+}
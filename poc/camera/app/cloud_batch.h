@@ -0,0 +1,106 @@
+/**
+ * cloud_batch.h
+ *
+ * Cloud AI request batcher for Axis I.S. POC
+ * Modules that send crops to a cloud model (plates, signs, text) submit
+ * them here instead of posting one call each. Items with the same prompt
+ * are gathered for window_ms, or until max_items, and go out as one
+ * multi-image call; the response is split back to the callers. An item
+ * whose prompt and image bytes match one already pending or in flight is
+ * not sent again - its caller simply waits for the same result. With a
+ * response cache (cloud_cache.h) an image answered before, or one that
+ * looks the same, is answered on the camera without any call.
+ *
+ * Batch call (POST url, JSON):
+ *   request   {"prompt_id": "...", "prompt": "...",
+ *              "items": [{"id": "<content hash>", "image": "<base64 JPEG>"}, ...]}
+ *   response  {"results": [{"id": "<content hash>", ...}, ...]}
+ * Results are matched by "id", or by position when they carry none and
+ * there is exactly one per item sent.
+ *
+ * Calls are asynchronous (Http_Post_Async). Pipeline thread only; results
+ * arrive on the same thread.
+ */
+
+#ifndef CLOUD_BATCH_H
+#define CLOUD_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+#include "http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct CloudBatch CloudBatch;
+
+/**
+ * Result of one submitted item
+ * @param result The item's object from "results" (valid during the call
+ *               only), NULL when ok is 0
+ * @param ok 1 on success, 0 when the call failed or had no result for it
+ */
+typedef void (*CloudResultFn)(const cJSON* result, int ok, void* user);
+
+/**
+ * Create the batcher
+ * @param config "cloud_batch" object from core config; NULL or no "url" for none
+ * @param http Shared client the calls go through
+ * @return Batcher pointer, NULL when not configured or on failure
+ *
+ * Config keys:
+ *   url           Batch endpoint
+ *   api_key       Sent as "Authorization: Bearer <key>" (default none)
+ *   window_ms     Gather time after a batch's first item (default 50)
+ *   max_items     Items per call (default 8)
+ *   max_body_kb   Image bytes per call, base64 included (default 2048)
+ *   max_pending   Items waiting or in flight before submissions are
+ *                 refused (default 64)
+ *   timeout_ms    Call limit (default: the http client's)
+ *   cache         Response cache config, see CloudCache_Create (default none)
+ */
+CloudBatch* CloudBatch_Create(cJSON* config, HttpClient* http);
+
+/**
+ * Submit an image for a prompt
+ * @param prompt_id Short name of the prompt - items batch and dedupe per id
+ * @param prompt Instruction text, sent once per call (the first item's)
+ * @param jpeg Encoded image, copied
+ * @param done Called exactly once unless cancelled
+ * @param user Passed to done; also the key for CloudBatch_Cancel
+ * @return 1 when accepted, 0 when refused (done is not called)
+ */
+int CloudBatch_Submit(CloudBatch* cb, const char* prompt_id, const char* prompt,
+                      const uint8_t* jpeg, size_t jpeg_size, CloudResultFn done, void* user);
+
+/**
+ * Send every gathered batch now instead of at the end of its window
+ */
+void CloudBatch_Flush(CloudBatch* cb);
+
+/**
+ * Forget a caller's pending submissions, without callbacks (module
+ * cleanup). Items nobody waits for any more are not sent.
+ * @return Submissions dropped
+ */
+int CloudBatch_Cancel(CloudBatch* cb, void* user);
+
+/**
+ * Get batching statistics as JSON (submitted, deduplicated, cached, calls,
+ * items per call, failures, latency, response cache hit rate)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* CloudBatch_Stats_JSON(CloudBatch* cb);
+
+/**
+ * Drop everything pending and free the batcher (before the http client)
+ */
+void CloudBatch_Destroy(CloudBatch* cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOUD_BATCH_H */
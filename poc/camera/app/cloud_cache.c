@@ -0,0 +1,389 @@
+/**
+ * cloud_cache.c
+ *
+ * Cloud AI response cache implementation for Axis I.S. POC
+ *
+ * The JPEG is decoded to grayscale at the coarsest DCT scale that still
+ * leaves 32 pixels on the short side, averaged into 9x8 cells, and each
+ * bit of the hash is "cell brighter than its right neighbour" (the same
+ * difference hash the result cache uses for crops). Entries carry a use
+ * tick for LRU eviction and a wall-clock time so age survives a restart.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <syslog.h>
+#include <time.h>
+#include <jpeglib.h>
+#include "cloud_cache.h"
+#include "ACAP.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define HASH_MIN_SIZE 32                // Short side of the decoded image, at least
+#define CLOUD_CACHE_PATH_SIZE 128
+
+typedef struct {
+    int valid;
+    char prompt_id[CLOUD_CACHE_PROMPT_SIZE];
+    uint64_t hash;
+    cJSON* response;
+    int64_t stored_s;                   // Wall clock
+    uint64_t used;                      // Use tick, lowest evicted first
+} CacheEntry;
+
+struct CloudCache {
+    CacheEntry* entries;
+    int capacity;
+    int hash_distance;
+    int64_t max_age_s;
+    uint64_t tick;
+
+    int persist;
+    char path[CLOUD_CACHE_PATH_SIZE];
+    int64_t save_interval_s;
+    int64_t saved_s;
+    int dirty;
+
+    // Statistics
+    uint64_t hits;
+    uint64_t near_hits;                 // Hits on a hash that was not identical
+    uint64_t misses;
+    uint64_t expired;
+    uint64_t evictions;
+    uint64_t loaded;                    // Entries read back at start
+    uint64_t saves;
+};
+
+typedef struct {
+    struct jpeg_error_mgr pub;
+    jmp_buf setjmp_buffer;
+} CloudCacheJpegError;
+
+static void cloud_cache_jpeg_error_exit(j_common_ptr cinfo) {
+    CloudCacheJpegError* err = (CloudCacheJpegError*)cinfo->err;
+    longjmp(err->setjmp_buffer, 1);
+}
+
+int CloudCache_Hash(const uint8_t* jpeg, size_t jpeg_size, uint64_t* hash) {
+    if (!jpeg || !jpeg_size || !hash) return 0;
+
+    struct jpeg_decompress_struct cinfo;
+    CloudCacheJpegError jerr;
+    // Cell sums, 9 columns by 8 rows
+    uint32_t sums[8][9];
+    uint32_t counts[8][9];
+    // volatile: must survive the longjmp back into this frame
+    JSAMPLE* volatile row = NULL;
+
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = cloud_cache_jpeg_error_exit;
+    if (setjmp(jerr.setjmp_buffer)) {
+        jpeg_destroy_decompress(&cinfo);
+        free(row);
+        return 0;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, (unsigned char*)jpeg, (unsigned long)jpeg_size);
+    jpeg_read_header(&cinfo, TRUE);
+
+    unsigned int short_side = cinfo.image_width < cinfo.image_height ? cinfo.image_width : cinfo.image_height;
+    unsigned int denom = 8;
+    while (denom > 1 && short_side / denom < HASH_MIN_SIZE) denom /= 2;
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = denom;
+    cinfo.out_color_space = JCS_GRAYSCALE;
+    cinfo.dct_method = JDCT_IFAST;
+    jpeg_start_decompress(&cinfo);
+
+    unsigned int width = cinfo.output_width, height = cinfo.output_height;
+    if (width < 9 || height < 8) {
+        jpeg_destroy_decompress(&cinfo);
+        return 0;
+    }
+    row = (JSAMPLE*)malloc(width);
+    if (!row) {
+        jpeg_destroy_decompress(&cinfo);
+        return 0;
+    }
+
+    memset(sums, 0, sizeof(sums));
+    memset(counts, 0, sizeof(counts));
+    while (cinfo.output_scanline < height) {
+        unsigned int r = cinfo.output_scanline * 8 / height;
+        JSAMPROW rows[1] = { row };
+        jpeg_read_scanlines(&cinfo, rows, 1);
+        for (unsigned int x = 0; x < width; x++) {
+            unsigned int c = x * 9 / width;
+            sums[r][c] += row[x];
+            counts[r][c]++;
+        }
+    }
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    free(row);
+
+    uint64_t bits = 0;
+    for (int r = 0; r < 8; r++) {
+        for (int c = 0; c < 8; c++) {
+            // Compare means without dividing: a/n > b/m  <=>  a*m > b*n
+            if ((uint64_t)sums[r][c] * counts[r][c + 1] > (uint64_t)sums[r][c + 1] * counts[r][c]) {
+                bits |= 1ull << (r * 8 + c);
+            }
+        }
+    }
+    *hash = bits;
+    return 1;
+}
+
+static int64_t now_s(void) {
+    return (int64_t)time(NULL);
+}
+
+static void free_entry(CacheEntry* e) {
+    cJSON_Delete(e->response);
+    memset(e, 0, sizeof(CacheEntry));
+}
+
+static int by_use(const void* a, const void* b) {
+    const CacheEntry* ea = *(const CacheEntry* const*)a;
+    const CacheEntry* eb = *(const CacheEntry* const*)b;
+    return ea->used < eb->used ? -1 : ea->used > eb->used;
+}
+
+/**
+ * Write the valid entries, least recently used first
+ */
+static void save(CloudCache* cache) {
+    CacheEntry** order = (CacheEntry**)malloc((size_t)cache->capacity * sizeof(CacheEntry*));
+    if (!order) return;
+    int count = 0;
+    for (int i = 0; i < cache->capacity; i++) {
+        if (cache->entries[i].valid) order[count++] = &cache->entries[i];
+    }
+    qsort(order, (size_t)count, sizeof(CacheEntry*), by_use);
+
+    cJSON* file = cJSON_CreateObject();
+    cJSON_AddNumberToObject(file, "version", 1);
+    cJSON* list = cJSON_AddArrayToObject(file, "entries");
+    for (int i = 0; i < count; i++) {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)order[i]->hash);
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "prompt_id", order[i]->prompt_id);
+        cJSON_AddStringToObject(item, "hash", hex);
+        cJSON_AddNumberToObject(item, "stored", (double)order[i]->stored_s);
+        cJSON_AddItemToObject(item, "response", cJSON_Duplicate(order[i]->response, 1));
+        cJSON_AddItemToArray(list, item);
+    }
+    free(order);
+
+    if (ACAP_FILE_Write(cache->path, file)) {
+        cache->saves++;
+        cache->dirty = 0;
+    } else {
+        LOG_ERR("CloudCache: Could not save %s\n", cache->path);
+    }
+    cache->saved_s = now_s();
+    cJSON_Delete(file);
+}
+
+/**
+ * Prompt ids that would not fit an entry are never cached: cut short they
+ * could match another prompt's entries
+ */
+static int prompt_fits(const char* prompt_id) {
+    return strlen(prompt_id) < CLOUD_CACHE_PROMPT_SIZE;
+}
+
+static void load(CloudCache* cache) {
+    cJSON* file = ACAP_FILE_Read(cache->path);
+    if (!file) return;
+
+    int64_t now = now_s();
+    cJSON* item;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(file, "entries")) {
+        cJSON* prompt_id = cJSON_GetObjectItem(item, "prompt_id");
+        cJSON* hash = cJSON_GetObjectItem(item, "hash");
+        cJSON* stored = cJSON_GetObjectItem(item, "stored");
+        cJSON* response = cJSON_GetObjectItem(item, "response");
+        if (!cJSON_IsString(prompt_id) || !cJSON_IsString(hash) || !cJSON_IsNumber(stored) || !response) continue;
+        if (!prompt_fits(prompt_id->valuestring)) continue;
+        if (cache->max_age_s > 0 && now - (int64_t)stored->valuedouble > cache->max_age_s) continue;
+
+        // File is oldest first - once full, later entries replace the oldest
+        CacheEntry* e = &cache->entries[cache->loaded % (uint64_t)cache->capacity];
+        free_entry(e);
+        e->valid = 1;
+        snprintf(e->prompt_id, sizeof(e->prompt_id), "%s", prompt_id->valuestring);
+        e->hash = strtoull(hash->valuestring, NULL, 16);
+        e->stored_s = (int64_t)stored->valuedouble;
+        e->response = cJSON_Duplicate(response, 1);
+        e->used = ++cache->tick;
+        cache->loaded++;
+    }
+    cJSON_Delete(file);
+    LOG("CloudCache: Loaded %llu responses from %s\n", (unsigned long long)cache->loaded, cache->path);
+}
+
+CloudCache* CloudCache_Create(cJSON* config) {
+    if (!config) return NULL;
+    cJSON* enabled = cJSON_GetObjectItem(config, "enabled");
+    if (enabled && !cJSON_IsTrue(enabled)) return NULL;
+
+    CloudCache* cache = (CloudCache*)calloc(1, sizeof(CloudCache));
+    if (!cache) {
+        LOG_ERR("CloudCache: Failed to allocate context\n");
+        return NULL;
+    }
+
+    cJSON* item = cJSON_GetObjectItem(config, "entries");
+    cache->capacity = cJSON_IsNumber(item) ? item->valueint : 256;
+    item = cJSON_GetObjectItem(config, "hash_distance");
+    cache->hash_distance = cJSON_IsNumber(item) ? item->valueint : 6;
+    item = cJSON_GetObjectItem(config, "max_age_s");
+    cache->max_age_s = cJSON_IsNumber(item) ? (int64_t)item->valuedouble : 3600;
+    item = cJSON_GetObjectItem(config, "persist");
+    cache->persist = cJSON_IsTrue(item);
+    item = cJSON_GetObjectItem(config, "path");
+    snprintf(cache->path, sizeof(cache->path), "%s",
+             cJSON_IsString(item) ? item->valuestring : "localdata/cloud_cache.json");
+    item = cJSON_GetObjectItem(config, "save_interval_s");
+    cache->save_interval_s = cJSON_IsNumber(item) ? (int64_t)item->valuedouble : 300;
+    if (cache->capacity < 1) cache->capacity = 1;
+    if (cache->hash_distance < 0) cache->hash_distance = 0;
+
+    cache->entries = (CacheEntry*)calloc((size_t)cache->capacity, sizeof(CacheEntry));
+    if (!cache->entries) {
+        LOG_ERR("CloudCache: Failed to allocate %d entries\n", cache->capacity);
+        free(cache);
+        return NULL;
+    }
+
+    if (cache->persist) load(cache);
+    cache->saved_s = now_s();
+    return cache;
+}
+
+/**
+ * Closest entry within hash_distance for the prompt, -1 for none
+ * (expired entries met on the way are dropped)
+ */
+static int nearest(CloudCache* cache, const char* prompt_id, uint64_t hash, int* distance) {
+    int64_t now = now_s();
+    int best = -1;
+    int best_distance = cache->hash_distance + 1;
+    for (int i = 0; i < cache->capacity; i++) {
+        CacheEntry* e = &cache->entries[i];
+        if (!e->valid || strcmp(e->prompt_id, prompt_id) != 0) continue;
+        if (cache->max_age_s > 0 && now - e->stored_s > cache->max_age_s) {
+            free_entry(e);
+            cache->expired++;
+            cache->dirty = 1;
+            continue;
+        }
+        int d = __builtin_popcountll(e->hash ^ hash);
+        if (d < best_distance) {
+            best = i;
+            best_distance = d;
+            if (d == 0) break;
+        }
+    }
+    if (distance) *distance = best_distance;
+    return best;
+}
+
+const cJSON* CloudCache_Lookup(CloudCache* cache, const char* prompt_id, uint64_t hash) {
+    if (!cache || !prompt_id) return NULL;
+    if (!prompt_fits(prompt_id)) {
+        cache->misses++;
+        return NULL;
+    }
+
+    int distance = 0;
+    int i = nearest(cache, prompt_id, hash, &distance);
+    if (i < 0) {
+        cache->misses++;
+        return NULL;
+    }
+    cache->hits++;
+    if (distance > 0) cache->near_hits++;
+    cache->entries[i].used = ++cache->tick;
+    return cache->entries[i].response;
+}
+
+void CloudCache_Store(CloudCache* cache, const char* prompt_id, uint64_t hash, const cJSON* response) {
+    if (!cache || !prompt_id || !response || !prompt_fits(prompt_id)) return;
+
+    // Same image again (answered twice while in flight) - refresh it
+    int i = nearest(cache, prompt_id, hash, NULL);
+    if (i < 0) {
+        // Free entry, else the least recently used
+        i = 0;
+        for (int j = 0; j < cache->capacity; j++) {
+            if (!cache->entries[j].valid) {
+                i = j;
+                break;
+            }
+            if (cache->entries[j].used < cache->entries[i].used) i = j;
+        }
+        if (cache->entries[i].valid) cache->evictions++;
+    }
+
+    cJSON* copy = cJSON_Duplicate(response, 1);
+    if (!copy) return;
+    CacheEntry* e = &cache->entries[i];
+    free_entry(e);
+    e->valid = 1;
+    snprintf(e->prompt_id, sizeof(e->prompt_id), "%s", prompt_id);
+    e->hash = hash;
+    e->response = copy;
+    e->stored_s = now_s();
+    e->used = ++cache->tick;
+    cache->dirty = 1;
+
+    if (cache->persist && now_s() - cache->saved_s >= cache->save_interval_s) save(cache);
+}
+
+cJSON* CloudCache_Stats_JSON(CloudCache* cache) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", cache != NULL);
+    if (!cache) return json;
+
+    int valid = 0;
+    for (int i = 0; i < cache->capacity; i++) valid += cache->entries[i].valid;
+    uint64_t lookups = cache->hits + cache->misses;
+    cJSON_AddNumberToObject(json, "entries", valid);
+    cJSON_AddNumberToObject(json, "capacity", cache->capacity);
+    cJSON_AddNumberToObject(json, "hits", (double)cache->hits);
+    cJSON_AddNumberToObject(json, "near_hits", (double)cache->near_hits);
+    cJSON_AddNumberToObject(json, "misses", (double)cache->misses);
+    cJSON_AddNumberToObject(json, "expired", (double)cache->expired);
+    cJSON_AddNumberToObject(json, "evictions", (double)cache->evictions);
+    cJSON_AddNumberToObject(json, "hit_rate", lookups ? (double)cache->hits / (double)lookups : 0);
+    if (cache->persist) {
+        cJSON_AddNumberToObject(json, "loaded", (double)cache->loaded);
+        cJSON_AddNumberToObject(json, "saves", (double)cache->saves);
+    }
+    return json;
+}
+
+void CloudCache_Destroy(CloudCache* cache) {
+    if (!cache) return;
+    if (cache->persist && cache->dirty) save(cache);
+
+    LOG("CloudCache: cleanup: Hits=%llu NearHits=%llu Misses=%llu\n", (unsigned long long)cache->hits,
+        (unsigned long long)cache->near_hits, (unsigned long long)cache->misses);
+    for (int i = 0; i < cache->capacity; i++) cJSON_Delete(cache->entries[i].response);
+    free(cache->entries);
+    free(cache);
+}
@@ -0,0 +1,85 @@
+/**
+ * cloud_cache.h
+ *
+ * Cloud AI response cache for Axis I.S. POC
+ * The same plate, sign or static scene is sent to the cloud over and over.
+ * Answers are remembered per prompt id under a perceptual hash of the
+ * submitted image, so a re-encoded or slightly shifted copy of an image
+ * already answered is served from memory without any network I/O.
+ *
+ * The hash is a 64-bit difference hash of the JPEG decoded at reduced
+ * scale (libjpeg DCT scaling, no full decode). Images match when their
+ * hashes differ in at most hash_distance bits. The cache holds a bounded
+ * number of entries, least recently used evicted, and can be kept across
+ * restarts in a JSON file under localdata/.
+ *
+ * Pipeline thread only.
+ */
+
+#ifndef CLOUD_CACHE_H
+#define CLOUD_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLOUD_CACHE_PROMPT_SIZE 48      // Longer prompt ids are not cached
+
+typedef struct CloudCache CloudCache;
+
+/**
+ * Create a cache
+ * @param config "cache" object of the cloud_batch config, NULL or
+ *               "enabled": false for none
+ * @return Cache pointer, NULL when disabled or on failure
+ *
+ * Config keys:
+ *   enabled          Cache responses (default true)
+ *   entries          Responses kept (default 256)
+ *   hash_distance    Differing hash bits still counted as the same image (default 6)
+ *   max_age_s        Responses expire after this long, 0 for never (default 3600)
+ *   persist          Keep the cache in a file (default false)
+ *   path             File under the package root (default "localdata/cloud_cache.json")
+ *   save_interval_s  Write changes at most this often (default 300)
+ */
+CloudCache* CloudCache_Create(cJSON* config);
+
+/**
+ * Perceptual hash of a JPEG
+ * @return 1 on success, 0 when the image cannot be decoded
+ */
+int CloudCache_Hash(const uint8_t* jpeg, size_t jpeg_size, uint64_t* hash);
+
+/**
+ * Find the response for an image
+ * @return Cached response (owned by the cache, valid until the next
+ *         CloudCache_Store), NULL on a miss
+ */
+const cJSON* CloudCache_Lookup(CloudCache* cache, const char* prompt_id, uint64_t hash);
+
+/**
+ * Remember the response for an image (copied); saves when persisting and
+ * save_interval_s has passed
+ */
+void CloudCache_Store(CloudCache* cache, const char* prompt_id, uint64_t hash, const cJSON* response);
+
+/**
+ * Get cache statistics as JSON (entries, hits, near hits, misses, hit rate)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* CloudCache_Stats_JSON(CloudCache* cache);
+
+/**
+ * Save if persisting, then free the cache
+ */
+void CloudCache_Destroy(CloudCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLOUD_CACHE_H */
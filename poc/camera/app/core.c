@@ -6,14 +6,17 @@
 
 #include "core.h"
 #include "ACAP.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "capture_log.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
 #include <stdarg.h>
 #include <sys/time.h>
-#include <curl/curl.h>
 #include <ctype.h>
+#include <glib.h>
 
 /* Undefine system LOG macros */
 #ifdef LOG_WARN
@@ -39,25 +42,37 @@ static int64_t get_timestamp_us(void) {
     return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
 }
 
+/**
+ * Once-a-second sampling of counters that allocate to read
+ */
+static gboolean sample_counters(gpointer user_data) {
+    CoreContext* ctx = (CoreContext*)user_data;
+    ctx->mqtt_pending = MQTT_Pending_Count();
+    return G_SOURCE_CONTINUE;
+}
+
 /**
  * Initialize core context
  */
 int core_init(CoreContext** ctx, const char* config_file) {
+    // Load configuration
+    cJSON* config = config_file ? ACAP_FILE_Read(config_file) : NULL;
+    return core_init_with_config(ctx, config);
+}
+
+/**
+ * Initialize core context from an already loaded configuration
+ */
+int core_init_with_config(CoreContext** ctx, cJSON* config) {
     *ctx = (CoreContext*)calloc(1, sizeof(CoreContext));
     if (!*ctx) {
         LOG(LOG_ERR, "Core: Failed to allocate context\n");
+        cJSON_Delete(config);
         return -1;
     }
 
     CoreContext* core = *ctx;
-
-    // Load configuration
-    if (config_file) {
-        cJSON* cfg_json = ACAP_FILE_Read(config_file);
-        if (cfg_json) {
-            core->config = cfg_json;
-        }
-    }
+    core->config = config;
 
     if (!core->config) {
         // Default configuration
@@ -77,23 +92,95 @@ int core_init(CoreContext** ctx, const char* config_file) {
     cJSON* threshold = cJSON_GetObjectItem(core->config, "confidence_threshold");
     float conf_threshold = threshold && cJSON_IsNumber(threshold) ? (float)threshold->valuedouble : 0.25;
 
+    // Pipeline tracing is cheap enough to leave on in production
+    cJSON* trace = cJSON_GetObjectItem(core->config, "trace_enabled");
+    Trace_Init(trace ? cJSON_IsTrue(trace) : 1);
+    Trace_Set_Thread_Name("pipeline");
+
+    // Hardware counters cost two read() syscalls per span - off by default
+    cJSON* perf = cJSON_GetObjectItem(core->config, "perf_counters_enabled");
+    Perf_Init(perf ? cJSON_IsTrue(perf) : 0);
+
+    // Per-frame arena: steady-state frames make no heap calls
+    cJSON* arena_kb = cJSON_GetObjectItem(core->config, "frame_arena_kb");
+    size_t arena_bytes = (size_t)(arena_kb && cJSON_IsNumber(arena_kb) && arena_kb->valueint > 0 ?
+                                  arena_kb->valueint : ARENA_DEFAULT_KB) * 1024;
+    core->arena = Arena_Create(arena_bytes);
+    if (!core->arena) {
+        LOG(LOG_WARNING, "Core: Per-frame arena unavailable - frames use the heap\n");
+    }
+
+    core->blackboard = Blackboard_Create();
+    if (!core->blackboard) {
+        LOG(LOG_ERR, "Core: Failed to create module blackboard\n");
+        goto error;
+    }
+
+    // Without a view cache modules simply get no derived images
+    core->views = Views_Create();
+
+    // Record-and-replay capture - off unless configured
+    Capture_Init(cJSON_GetObjectItem(core->config, "capture"));
+
     // Initialize DLPU coordinator
     core->dlpu = Dlpu_Init(camera_id, 0);
     if (!core->dlpu) {
         LOG(LOG_ERR, "Core: Failed to initialize DLPU\n");
         goto error;
     }
+    cJSON* slicing = cJSON_GetObjectItem(core->config, "dlpu_time_slicing");
+    core->dlpu->time_slicing = slicing ? cJSON_IsTrue(slicing) : 1;
 
-    // Initialize VDO stream at 640x640 to match YOLOv5n model from Axis Model Zoo
-    core->vdo = Vdo_Init(640, 640, target_fps);
-    if (!core->vdo) {
-        LOG(LOG_ERR, "Core: Failed to initialize VDO\n");
+    // Initialize frame source at 640x640 to match YOLOv5n model from Axis Model Zoo
+    // (a VDO source negotiates the stream format the model can take directly)
+    core->source = FrameSource_Init(cJSON_GetObjectItem(core->config, "frame_source"),
+                                    640, 640, target_fps);
+    if (!core->source) {
+        LOG(LOG_ERR, "Core: Failed to initialize frame source\n");
         goto error;
     }
+    if (core->source->format != VDO_FORMAT_YUV) {
+        LOG(LOG_INFO, "Core: %s frames - capture records tensors and metadata only\n",
+            Vdo_Format_Name(core->source->format));
+    }
+
+    core->frame_pool = FramePool_Init(cJSON_GetObjectItem(core->config, "frame_retention"),
+                                      core->source);
+    if (!core->frame_pool) {
+        LOG(LOG_WARNING, "Core: Frame retention unavailable\n");
+    }
+
+    // Second VDO stream at full resolution, NULL for file/synthetic sources
+    core->hires = HiRes_Init(cJSON_GetObjectItem(core->config, "hires_stream"), core->source);
+
+    // Shared HTTP client - connections and TLS sessions outlive requests
+    core->http = Http_Init(cJSON_GetObjectItem(core->config, "http"));
+    if (!core->http) {
+        LOG(LOG_WARNING, "Core: HTTP client unavailable - http_post will fail\n");
+    }
+    core->cloud = CloudBatch_Create(cJSON_GetObjectItem(core->config, "cloud_batch"), core->http);
+
+    // Stages from core config here, more from modules at init
+    core->cascade = Cascade_Create(cJSON_GetObjectItem(core->config, "cascade"), camera_id, core->cloud);
+
+    // Return source buffers before inference - off unless configured
+    cJSON* early = cJSON_GetObjectItem(core->config, "early_release");
+    cJSON* early_mode = early ? cJSON_GetObjectItem(early, "mode") : NULL;
+    if (early_mode && cJSON_IsString(early_mode)) {
+        if (strcmp(early_mode->valuestring, "copy") == 0) {
+            core->early_release = EARLY_RELEASE_COPY;
+        } else if (strcmp(early_mode->valuestring, "model_input") == 0) {
+            core->early_release = EARLY_RELEASE_MODEL_INPUT;
+        }
+    }
+    cJSON* luma_level = early ? cJSON_GetObjectItem(early, "luma_level") : NULL;
+    core->early_luma_level = luma_level && cJSON_IsNumber(luma_level) && luma_level->valueint >= 1 &&
+                             luma_level->valueint <= VIEWS_MAX_LEVEL ? luma_level->valueint : 1;
 
     // Initialize Larod inference (optional - POC can run without ML model)
     // Model: YOLOv5n for ARTPEC-8 from Axis Model Zoo (640x640 INT8)
-    core->larod = Larod_Init("/usr/local/packages/axis_is_poc/models/yolov5n_artpec8_coco_640.tflite", conf_threshold);
+    core->larod = Larod_Init("/usr/local/packages/axis_is_poc/models/yolov5n_artpec8_coco_640.tflite", conf_threshold,
+                             cJSON_GetObjectItem(core->config, "inference"));
     if (!core->larod) {
         LOG(LOG_WARNING, "Core: Larod init failed - running without ML inference (model not found)\n");
         LOG(LOG_INFO, "Core: To enable ML inference, add yolov5n_int8.tflite to models/ directory\n");
@@ -112,6 +199,14 @@ int core_init(CoreContext** ctx, const char* config_file) {
     core->api.publish_metadata = core_api_publish_metadata;
     core->api.log = core_api_log;
     core->api.http_post = core_api_http_post;
+    core->api.http_post_async = core_api_http_post_async;
+    core->api.http_cancel = core_api_http_cancel;
+    core->api.cloud_submit = core_api_cloud_submit;
+    core->api.cloud_cancel = core_api_cloud_cancel;
+
+    // Counters too costly to read per frame
+    core->mqtt_pending = MQTT_Pending_Count();
+    core->sample_source = g_timeout_add_seconds(1, sample_counters, core);
 
     // Initialize frame tracking
     core->current_frame_id = 0;
@@ -232,6 +327,14 @@ int core_start(CoreContext* ctx) {
 
     LOG(LOG_INFO, "Core: Starting module pipeline\n");
 
+    // Flight recorder columns follow pipeline order
+    const char* module_names[FLIGHT_MAX_MODULES];
+    int named = ctx->module_count < FLIGHT_MAX_MODULES ? ctx->module_count : FLIGHT_MAX_MODULES;
+    for (int i = 0; i < named; i++) {
+        module_names[i] = ctx->modules[i]->name;
+    }
+    Flight_Init(cJSON_GetObjectItem(ctx->config, "flight_recorder"), module_names, named);
+
     // Call on_start hooks for all modules
     for (int i = 0; i < ctx->module_count; i++) {
         ModuleInterface* mod = ctx->modules[i];
@@ -251,6 +354,8 @@ int core_stop(CoreContext* ctx) {
 
     LOG(LOG_INFO, "Core: Stopping module pipeline\n");
 
+    Flight_Cleanup();
+
     // Call on_stop hooks for all modules
     for (int i = 0; i < ctx->module_count; i++) {
         ModuleInterface* mod = ctx->modules[i];
@@ -262,89 +367,249 @@ int core_stop(CoreContext* ctx) {
     return 0;
 }
 
+/**
+ * View cache layout for a source format
+ */
+static ViewsFormat views_format(VdoFormat format) {
+    switch (format) {
+        case VDO_FORMAT_RGB: return VIEWS_FORMAT_RGB;
+        case VDO_FORMAT_PLANAR_RGB: return VIEWS_FORMAT_PLANAR_RGB;
+        default: return VIEWS_FORMAT_NV12;
+    }
+}
+
+/**
+ * Account the time the pipeline held a source buffer
+ */
+static int32_t note_hold(CoreContext* ctx, int64_t captured_us) {
+    int64_t hold_us = Trace_Now_Us() - captured_us;
+    ctx->hold_us_last = hold_us;
+    ctx->hold_us_total += hold_us;
+    if (hold_us > ctx->hold_us_max) ctx->hold_us_max = hold_us;
+    ctx->hold_frames++;
+    return (int32_t)hold_us;
+}
+
+/**
+ * Keep what the modules need and give the source buffer back
+ * @return 1 if the source frame was released
+ */
+static int early_release_frame(CoreContext* ctx, FrameData* fdata, SourceFrame* frame) {
+    if (ctx->early_release == EARLY_RELEASE_COPY) {
+        if (ctx->staging_size < frame->size) {
+            uint8_t* grown = (uint8_t*)realloc(ctx->staging, frame->size);
+            if (!grown) {
+                LOG(LOG_ERR, "Core: Failed to allocate %zu byte staging frame\n", frame->size);
+                return 0;
+            }
+            ctx->staging = grown;
+            ctx->staging_size = frame->size;
+        }
+        memcpy(ctx->staging, frame->data, frame->size);
+        fdata->frame_data = ctx->staging;
+        Views_Begin_Frame(ctx->views, ctx->staging, views_format(fdata->format),
+                          fdata->width, fdata->height);
+        fdata->ref = FramePool_Begin_Detached(ctx->frame_pool, ctx->staging, frame->size,
+                                              fdata->width, fdata->height,
+                                              fdata->timestamp_us, fdata->frame_id);
+    } else {
+        // Model input goes straight into the input tensor, motion and scene
+        // analysis run on a downscaled luma plane; the full frame is gone
+        LarodFrame input = {
+            .data = frame->data,
+            .size = frame->size,
+            .width = fdata->width,
+            .height = fdata->height,
+            .nv12 = fdata->format == VDO_FORMAT_YUV,
+            .fd = frame->vdo_buffer ? vdo_buffer_get_fd(frame->vdo_buffer) : -1,
+            .offset = frame->vdo_buffer ? vdo_buffer_get_offset(frame->vdo_buffer) : 0,
+            .views = ctx->views
+        };
+        if (ctx->larod && !Larod_Stage_Frame(ctx->larod, &input)) {
+            // Keep the frame: the detection module stages it itself
+            LOG(LOG_WARN, "Core: Failed to stage model input, holding the frame\n");
+            return 0;
+        }
+        FrameView luma;
+        Views_Gray(ctx->views, ctx->early_luma_level, &luma);
+        Views_Detach_Frame(ctx->views);
+        fdata->frame_data = NULL;
+        fdata->frame_size = 0;
+        fdata->ref = NULL;
+    }
+
+    fdata->vdo_buffer = NULL;
+    FrameSource_Release_Frame(ctx->source, frame);
+    return 1;
+}
+
 /**
  * Process single frame through module pipeline
  */
 int core_process_frame(CoreContext* ctx) {
     if (!ctx) return -1;
 
-    // Acquire DLPU time slot
-    if (!Dlpu_Wait_For_Slot(ctx->dlpu)) {
-        LOG(LOG_WARN, "Core: DLPU slot wait timeout\n");
-        return -1;
-    }
+    Trace_Set_Frame(ctx->current_frame_id);
+    TraceSpan frame_span = Trace_Begin("frame");
 
-    // Capture frame from VDO
-    VdoBuffer* buffer = Vdo_Get_Frame(ctx->vdo);
-    if (!buffer) {
-        LOG(LOG_WARN, "Core: Failed to capture frame\n");
-        Dlpu_Release_Slot(ctx->dlpu);
-        return -1;
-    }
+    FlightRecord rec = { .frame_id = ctx->current_frame_id };
+    rec.start_us = Trace_Now_Us();
+    int status = 0;
 
-    // Get frame data directly from VDO buffer
-    // Note: ACAP SDK uses VdoBuffer directly, VdoFrame functions don't exist
-    void* frame_data = vdo_buffer_get_data(buffer);
-    if (!frame_data) {
-        LOG(LOG_ERR, "Core: Failed to get frame data from buffer\n");
-        Vdo_Release_Frame(ctx->vdo, buffer);
+    // Acquire DLPU time slot
+    TraceSpan span = Trace_Begin("dlpu_wait");
+    int have_slot = Dlpu_Wait_For_Slot(ctx->dlpu);
+    Trace_End(&span);
+    int64_t stage_us = Trace_Now_Us();
+    rec.dlpu_wait_us = (int32_t)(stage_us - rec.start_us);
+    if (!have_slot) {
+        LOG(LOG_WARN, "Core: DLPU slot wait timeout\n");
+        rec.error = FLIGHT_ERROR_DLPU_TIMEOUT;
+        status = -1;
+        goto done;
+    }
+
+    // Capture frame from source
+    SourceFrame frame;
+    span = Trace_Begin("capture");
+    int captured = FrameSource_Get_Frame(ctx->source, &frame);
+    Trace_End(&span);
+    int64_t captured_us = Trace_Now_Us();
+    rec.capture_us = (int32_t)(captured_us - stage_us);
+    if (!captured) {
+        if (!ctx->source->eof) {
+            LOG(LOG_WARN, "Core: Failed to capture frame\n");
+        }
         Dlpu_Release_Slot(ctx->dlpu);
-        return -1;
+        rec.error = FLIGHT_ERROR_CAPTURE;
+        status = -1;
+        goto done;
     }
 
-    // Use dimensions from VdoContext (set at initialization)
-    unsigned int width = ctx->vdo->width;
-    unsigned int height = ctx->vdo->height;
-    VdoFormat format = VDO_FORMAT_YUV;  // Set during VDO init
+    // Everything allocated for this frame comes from the arena until it ends
+    Arena_Begin_Frame(ctx->arena);
 
     // Create frame data structure
+    // Frames come in the source's format (NV12 unless VDO negotiated RGB)
     FrameData fdata = {
-        .vdo_buffer = buffer,
+        .vdo_buffer = frame.vdo_buffer,
         .vdo_frame = NULL,  // VdoFrame type not used in ACAP SDK
-        .frame_data = frame_data,
-        .width = width,
-        .height = height,
-        .format = format,
+        .frame_data = frame.data,
+        .frame_size = frame.size,
+        .width = ctx->source->width,
+        .height = ctx->source->height,
+        .format = ctx->source->format,
         .timestamp_us = get_timestamp_us(),
+        .capture_us = frame.capture_us,
         .frame_id = ctx->current_frame_id++,
+        .views = ctx->views,
+        .hires = ctx->hires,
+        .cascade = ctx->cascade,
         .metadata = metadata_create()
     };
 
     if (!fdata.metadata) {
         LOG(LOG_ERR, "Core: Failed to create metadata\n");
-        Vdo_Release_Frame(ctx->vdo, buffer);
+        Arena_End_Frame(ctx->arena);
+        FrameSource_Release_Frame(ctx->source, &frame);
         Dlpu_Release_Slot(ctx->dlpu);
-        return -1;
+        rec.error = FLIGHT_ERROR_METADATA;
+        status = -1;
+        goto done;
     }
 
+    fdata.metadata->blackboard = ctx->blackboard;
+    Blackboard_Begin_Frame(ctx->blackboard);
+    Views_Begin_Frame(ctx->views, fdata.frame_data, views_format(fdata.format),
+                      fdata.width, fdata.height);
+
     fdata.metadata->timestamp_us = fdata.timestamp_us;
     fdata.metadata->sequence = ctx->current_frame_id - 1;
 
+    // Capture segments hold NV12 frames only
+    if (Capture_Begin_Frame((uint32_t)fdata.frame_id, fdata.timestamp_us) &&
+        fdata.format == VDO_FORMAT_YUV) {
+        Capture_Frame(fdata.frame_data, fdata.width, fdata.height);
+    }
+
+    // Give the source buffer back before inference when configured
+    int source_held = 1;
+    if (ctx->early_release != EARLY_RELEASE_OFF) {
+        span = Trace_Begin("early_release");
+        if (early_release_frame(ctx, &fdata, &frame)) {
+            source_held = 0;
+            rec.hold_us = note_hold(ctx, captured_us);
+        }
+        Trace_End(&span);
+    }
+    if (source_held) {
+        fdata.ref = FramePool_Begin(ctx->frame_pool, &frame, fdata.width, fdata.height,
+                                    fdata.timestamp_us, fdata.frame_id);
+    }
+
+    int inferences_before = ctx->larod ? ctx->larod->total_inferences : 0;
+
     // Process frame through module pipeline
     for (int i = 0; i < ctx->module_count; i++) {
         ModuleInterface* mod = ctx->modules[i];
         ModuleContext* mod_ctx = ctx->module_contexts[i];
 
         if (mod->process) {
-            int status = mod->process(mod_ctx, &fdata);
-            if (status == AXIS_IS_MODULE_ERROR) {
+            span = Trace_Begin(mod->name);
+            stage_us = Trace_Now_Us();
+            int mod_status = mod->process(mod_ctx, &fdata);
+            if (i < FLIGHT_MAX_MODULES) {
+                rec.module_us[i] = (int32_t)(Trace_Now_Us() - stage_us);
+            }
+            Trace_End(&span);
+            if (mod_status == AXIS_IS_MODULE_ERROR) {
                 LOG(LOG_WARN, "Core: Module '%s' returned error\n", mod->name);
             }
         }
     }
 
+    // Configured second stages no module asked for
+    Cascade_Run_Configured(ctx->cascade, &fdata);
+
     // Release DLPU slot after all processing
     Dlpu_Release_Slot(ctx->dlpu);
 
+    if (ctx->larod && ctx->larod->total_inferences != inferences_before) {
+        rec.inference_us = ctx->larod->last_time_ms * 1000;
+    }
+
     // Publish aggregated metadata
+    span = Trace_Begin("publish");
+    stage_us = Trace_Now_Us();
     core_api_publish_metadata(ctx, fdata.metadata);
+    rec.publish_us = (int32_t)(Trace_Now_Us() - stage_us);
+    Trace_End(&span);
+
+    rec.detection_count = (int16_t)fdata.metadata->detection_count;
+    Capture_End_Frame(fdata.metadata->detection_count);
 
     // Cleanup
+    Views_End_Frame(ctx->views);
+    HiRes_End_Frame(ctx->hires);
+    Cascade_End_Frame(ctx->cascade);
     metadata_free(fdata.metadata);
-    // Note: No vdo_frame_unref needed - VdoFrame not used in ACAP SDK
-    Vdo_Release_Frame(ctx->vdo, buffer);
+    Arena_End_Frame(ctx->arena);
+    FramePool_End(ctx->frame_pool, fdata.ref);
+    if (source_held) {
+        FrameSource_Release_Frame(ctx->source, &frame);     // No-op when the pool took it
+        rec.hold_us = note_hold(ctx, captured_us);
+    }
 
-    return 0;
+done:
+    // Every frame, failed or not, ends its span and is recorded
+    Trace_End(&frame_span);
+
+    rec.total_us = (int32_t)(Trace_Now_Us() - rec.start_us);
+    rec.mqtt_pending = (int16_t)ctx->mqtt_pending;
+    rec.vdo_dropped = ctx->source->frames_dropped;
+    Flight_Record(&rec);
+
+    return status;
 }
 
 /**
@@ -377,13 +642,24 @@ void core_cleanup(CoreContext* ctx) {
         free(ctx->modules);
     }
 
+    if (ctx->sample_source) {
+        g_source_remove(ctx->sample_source);
+        ctx->sample_source = 0;
+    }
+
     // Cleanup core resources
     if (ctx->larod) {
         Larod_Cleanup(ctx->larod);
     }
 
-    if (ctx->vdo) {
-        Vdo_Cleanup(ctx->vdo);
+    Cascade_Destroy(ctx->cascade);
+    CloudBatch_Destroy(ctx->cloud);
+    Http_Cleanup(ctx->http);
+    FramePool_Cleanup(ctx->frame_pool);
+    HiRes_Cleanup(ctx->hires);
+
+    if (ctx->source) {
+        FrameSource_Cleanup(ctx->source);
     }
 
     if (ctx->dlpu) {
@@ -394,11 +670,18 @@ void core_cleanup(CoreContext* ctx) {
         cJSON_Delete(ctx->config);
     }
 
-    if (ctx->last_metadata) {
-        cJSON_Delete(ctx->last_metadata);
-    }
+    free(ctx->last_metadata);
+    free(ctx->staging);
     pthread_mutex_destroy(&ctx->metadata_mutex);
 
+    Arena_Destroy(ctx->arena);
+    Blackboard_Destroy(ctx->blackboard);
+    Views_Destroy(ctx->views);
+
+    Capture_Cleanup();
+    Perf_Cleanup();
+    Trace_Cleanup();
+
     // Clear global context pointer
     g_core_context = NULL;
 
@@ -411,11 +694,14 @@ void core_cleanup(CoreContext* ctx) {
  */
 
 VdoBuffer* core_api_get_frame(CoreContext* ctx) {
-    return Vdo_Get_Frame(ctx->vdo);
+    // Raw VdoBuffer access only exists when running on the camera stream
+    VdoContext* vdo = FrameSource_Get_Vdo(ctx->source);
+    return vdo ? Vdo_Get_Frame(vdo) : NULL;
 }
 
 void core_api_release_frame(CoreContext* ctx, VdoBuffer* buffer) {
-    Vdo_Release_Frame(ctx->vdo, buffer);
+    VdoContext* vdo = FrameSource_Get_Vdo(ctx->source);
+    if (vdo) Vdo_Release_Frame(vdo, buffer);
 }
 
 larodTensor** core_api_run_inference(CoreContext* ctx, const char* model_name,
@@ -442,7 +728,8 @@ void core_api_publish_metadata(CoreContext* ctx, MetadataFrame* meta) {
     char topic[128];
     snprintf(topic, sizeof(topic), "axis-is/camera/%s/metadata", camera_id);
 
-    // Convert metadata to JSON
+    // Convert metadata to JSON - the tree and its printed text live in the frame arena
+    int json_scope = Arena_JSON_Begin();
     cJSON* json = cJSON_CreateObject();
     cJSON_AddStringToObject(json, "camera_id", camera_id);
     cJSON_AddNumberToObject(json, "timestamp_us", meta->timestamp_us);
@@ -461,27 +748,104 @@ void core_api_publish_metadata(CoreContext* ctx, MetadataFrame* meta) {
         cJSON_AddNumberToObject(det, "y", meta->detections[i].y);
         cJSON_AddNumberToObject(det, "width", meta->detections[i].width);
         cJSON_AddNumberToObject(det, "height", meta->detections[i].height);
+        Cascade_Attach_JSON(ctx->cascade, i, det);
         cJSON_AddItemToArray(dets, det);
     }
     cJSON_AddItemToObject(json, "detections", dets);
 
-    // Add custom module data
-    if (meta->custom_data) {
-        cJSON_AddItemToObject(json, "modules", cJSON_Duplicate(meta->custom_data, 1));
+    // Add exported module slots
+    if (meta->blackboard) {
+        cJSON* modules = cJSON_CreateObject();
+        Blackboard_Export_JSON(meta->blackboard, modules);
+        cJSON_AddItemToObject(json, "modules", modules);
     }
 
     // Publish
+    TraceSpan span = Trace_Begin("mqtt_publish");
     MQTT_Publish_JSON(topic, json, 0, 0);
+    Trace_End(&span);
+
+    Capture_Metadata(json);
 
-    // Update last metadata
+    // Update last metadata - printed into a buffer that only grows, so
+    // nothing allocated in the frame arena outlives the frame
     pthread_mutex_lock(&ctx->metadata_mutex);
-    if (ctx->last_metadata) {
-        cJSON_Delete(ctx->last_metadata);
+    int printed = ctx->last_metadata &&
+                  cJSON_PrintPreallocated(json, ctx->last_metadata, (int)ctx->last_metadata_capacity, 0);
+    if (!printed) {
+        FrameArena* arena = Arena_Set_Current(NULL);
+        char* text = cJSON_PrintUnformatted(json);
+        if (text) {
+            size_t length = strlen(text) + 1;
+            size_t capacity = length * 2 > 4096 ? length * 2 : 4096;
+            char* grown = (char*)realloc(ctx->last_metadata, capacity);
+            if (grown) {
+                memcpy(grown, text, length);
+                ctx->last_metadata = grown;
+                ctx->last_metadata_capacity = capacity;
+            }
+            cJSON_free(text);
+        }
+        Arena_Set_Current(arena);
     }
-    ctx->last_metadata = cJSON_Duplicate(json, 1);
     pthread_mutex_unlock(&ctx->metadata_mutex);
 
     cJSON_Delete(json);
+    Arena_JSON_End(json_scope);
+}
+
+cJSON* core_get_metrics(CoreContext* ctx) {
+    if (!ctx) return NULL;
+
+    cJSON* metrics = cJSON_CreateObject();
+    cJSON_AddNumberToObject(metrics, "frames", ctx->current_frame_id);
+
+    if (ctx->source) {
+        cJSON* source = cJSON_CreateObject();
+        cJSON_AddStringToObject(source, "type", FrameSource_Type_Name(ctx->source));
+        cJSON_AddNumberToObject(source, "width", ctx->source->width);
+        cJSON_AddNumberToObject(source, "height", ctx->source->height);
+        cJSON_AddStringToObject(source, "format", Vdo_Format_Name(ctx->source->format));
+        cJSON_AddNumberToObject(source, "frames_captured", ctx->source->frames_captured);
+        cJSON_AddNumberToObject(source, "frames_dropped", ctx->source->frames_dropped);
+        cJSON_AddBoolToObject(source, "eof", ctx->source->eof);
+        static const char* early_names[] = { "off", "copy", "model_input" };
+        cJSON_AddStringToObject(source, "early_release", early_names[ctx->early_release]);
+        cJSON_AddNumberToObject(source, "hold_us_last", (double)ctx->hold_us_last);
+        cJSON_AddNumberToObject(source, "hold_us_avg",
+                                ctx->hold_frames ? (double)ctx->hold_us_total / ctx->hold_frames : 0);
+        cJSON_AddNumberToObject(source, "hold_us_max", (double)ctx->hold_us_max);
+        cJSON_AddItemToObject(metrics, "source", source);
+    }
+
+    if (ctx->larod) {
+        cJSON* larod = cJSON_CreateObject();
+        cJSON_AddNumberToObject(larod, "inferences", ctx->larod->total_inferences);
+        cJSON_AddNumberToObject(larod, "avg_time_ms", Larod_Get_Avg_Time(ctx->larod));
+        cJSON_AddNumberToObject(larod, "last_time_ms", ctx->larod->last_time_ms);
+        cJSON_AddItemToObject(metrics, "larod", larod);
+    }
+
+    if (ctx->dlpu) {
+        cJSON* dlpu = cJSON_CreateObject();
+        cJSON_AddNumberToObject(dlpu, "waits", ctx->dlpu->total_waits);
+        cJSON_AddNumberToObject(dlpu, "avg_wait_ms", Dlpu_Get_Avg_Wait(ctx->dlpu));
+        cJSON_AddItemToObject(metrics, "dlpu", dlpu);
+    }
+
+    cJSON_AddNumberToObject(metrics, "mqtt_pending", ctx->mqtt_pending);
+    cJSON_AddItemToObject(metrics, "perf", Perf_Stats_JSON());
+    cJSON_AddItemToObject(metrics, "flight_recorder", Flight_Stats_JSON());
+    cJSON_AddItemToObject(metrics, "capture", Capture_Stats_JSON());
+    cJSON_AddItemToObject(metrics, "arena", Arena_Stats_JSON(ctx->arena));
+    cJSON_AddItemToObject(metrics, "views", Views_Stats_JSON(ctx->views));
+    cJSON_AddItemToObject(metrics, "retention", FramePool_Stats_JSON(ctx->frame_pool));
+    cJSON_AddItemToObject(metrics, "hires", HiRes_Stats_JSON(ctx->hires));
+    cJSON_AddItemToObject(metrics, "cascade", Cascade_Stats_JSON(ctx->cascade));
+    cJSON_AddItemToObject(metrics, "http", Http_Stats_JSON(ctx->http));
+    cJSON_AddItemToObject(metrics, "cloud_batch", CloudBatch_Stats_JSON(ctx->cloud));
+
+    return metrics;
 }
 
 cJSON* core_get_latest_metadata(CoreContext* ctx) {
@@ -489,7 +853,7 @@ cJSON* core_get_latest_metadata(CoreContext* ctx) {
     cJSON* meta = NULL;
     pthread_mutex_lock(&ctx->metadata_mutex);
     if (ctx->last_metadata) {
-        meta = cJSON_Duplicate(ctx->last_metadata, 1);
+        meta = cJSON_Parse(ctx->last_metadata);
     }
     pthread_mutex_unlock(&ctx->metadata_mutex);
     return meta;
@@ -505,31 +869,6 @@ void core_api_log(int level, const char* module, const char* format, ...) {
     syslog(level, "[%s] %s", module, buffer);
 }
 
-/**
- * HTTP POST helper with CURL
- */
-struct MemoryStruct {
-    char* memory;
-    size_t size;
-};
-
-static size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct* mem = (struct MemoryStruct*)userp;
-
-    char* ptr = realloc(mem->memory, mem->size + realsize + 1);
-    if (!ptr) {
-        return 0;
-    }
-
-    mem->memory = ptr;
-    memcpy(&(mem->memory[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
-
-    return realsize;
-}
-
 /**
  * Get the shared Larod context from core
  * Modules should use this instead of creating their own Larod connection
@@ -541,38 +880,48 @@ LarodContext* core_api_get_larod(void) {
 
 int core_api_http_post(const char* url, const char* headers,
                        const char* body, char** response) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return -1;
-
-    struct MemoryStruct chunk = {0};
-    chunk.memory = malloc(1);
-    chunk.size = 0;
+    if (!response) return -1;
+    *response = NULL;
+    if (!g_core_context || !g_core_context->http) return -1;
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)&chunk);
-
-    // Set headers if provided
-    struct curl_slist* header_list = NULL;
-    if (headers) {
-        header_list = curl_slist_append(NULL, headers);
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    HttpResponse res;
+    if (!Http_Post(g_core_context->http, url, headers, body, body ? strlen(body) : 0, 0, &res)) {
+        return -1;
     }
-
-    CURLcode res = curl_easy_perform(curl);
-
-    if (header_list) {
-        curl_slist_free_all(header_list);
+    if (res.status < 200 || res.status >= 400) {
+        LOG(LOG_WARNING, "Core: POST %s returned HTTP %ld\n", url, res.status);
+        free(res.body);
+        return -1;
     }
 
-    curl_easy_cleanup(curl);
+    *response = res.body;
+    return 0;
+}
 
-    if (res != CURLE_OK) {
-        free(chunk.memory);
+int core_api_http_post_async(const char* url, const char* headers, const char* body,
+                             HttpCallback done, void* user) {
+    if (!g_core_context || !g_core_context->http) return -1;
+    if (!Http_Post_Async(g_core_context->http, url, headers, body, body ? strlen(body) : 0, 0,
+                         done, user)) {
+        LOG(LOG_WARNING, "Core: Async POST %s rejected\n", url);
         return -1;
     }
-
-    *response = chunk.memory;
     return 0;
 }
+
+int core_api_http_cancel(void* user) {
+    if (!g_core_context || !g_core_context->http) return 0;
+    return Http_Cancel(g_core_context->http, user);
+}
+
+int core_api_cloud_submit(const char* prompt_id, const char* prompt, const uint8_t* jpeg,
+                          size_t jpeg_size, CloudResultFn done, void* user) {
+    if (!g_core_context || !g_core_context->cloud) return -1;
+    return CloudBatch_Submit(g_core_context->cloud, prompt_id, prompt, jpeg, jpeg_size,
+                             done, user) ? 0 : -1;
+}
+
+int core_api_cloud_cancel(void* user) {
+    if (!g_core_context) return 0;
+    return CloudBatch_Cancel(g_core_context->cloud, user);
+}
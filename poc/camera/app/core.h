@@ -8,18 +8,31 @@
 #define CORE_H
 
 #include "module.h"
-#include "vdo_handler.h"
+#include "frame_source.h"
 #include "larod_handler.h"
 #include "dlpu_basic.h"
 #include "MQTT.h"
+#include "frame_arena.h"
+#include "cascade.h"
+#include "http_client.h"
 #include <pthread.h>
 
+/**
+ * When the source buffer goes back to the frame source
+ */
+typedef enum {
+    EARLY_RELEASE_OFF = 0,          // After publishing (modules see the source buffer)
+    EARLY_RELEASE_COPY,             // Before modules, which get a private NV12 copy
+    EARLY_RELEASE_MODEL_INPUT       // Before modules, keeping only the staged model
+                                    // input and a downscaled luma plane
+} EarlyReleaseMode;
+
 /**
  * Core context structure
  */
 struct CoreContext {
-    // VDO streaming
-    VdoContext* vdo;
+    // Frame source (VDO, file or synthetic)
+    FrameSource* source;
 
     // Larod inference
     LarodContext* larod;
@@ -42,9 +55,50 @@ struct CoreContext {
     int current_frame_id;
     int64_t start_time_us;
 
-    // Last metadata (thread-safe)
+    // Per-frame allocations (metadata, results, cJSON)
+    FrameArena* arena;
+
+    // Typed module-to-module data, slots registered at module init
+    Blackboard* blackboard;
+
+    // Derived images shared by the modules of one frame
+    FrameViews* views;
+
+    // Frame handles that modules can retain beyond process()
+    FramePool* frame_pool;
+
+    // Full-resolution stream, opened when a module first asks
+    HiResStream* hires;
+
+    // Second-stage models on detection crops, stages declared by modules
+    Cascade* cascade;
+
+    // Pooled keep-alive HTTP client behind http_post
+    HttpClient* http;
+
+    // Batches cloud AI calls of all modules, NULL unless configured
+    CloudBatch* cloud;
+
+    // Early return of source buffers
+    EarlyReleaseMode early_release;
+    int early_luma_level;           // Pyramid level kept in model_input mode
+    uint8_t* staging;               // Private frame copy in copy mode
+    size_t staging_size;
+
+    // Source buffer hold time per frame
+    int64_t hold_us_total;
+    int64_t hold_us_max;
+    int64_t hold_us_last;
+    uint64_t hold_frames;
+
+    // MQTT backlog, sampled once a second - counting it allocates in paho
+    int mqtt_pending;
+    unsigned int sample_source;     // GLib timer id, 0 when not running
+
+    // Last metadata as JSON text, buffer reused across frames (thread-safe)
     pthread_mutex_t metadata_mutex;
-    cJSON* last_metadata;
+    char* last_metadata;
+    size_t last_metadata_capacity;
 
     // Configuration
     cJSON* config;
@@ -55,11 +109,22 @@ struct CoreContext {
  */
 cJSON* core_get_latest_metadata(CoreContext* ctx);
 
+/**
+ * Get pipeline metrics (caller must free)
+ */
+cJSON* core_get_metrics(CoreContext* ctx);
+
 /**
  * Initialize the core module
  */
 int core_init(CoreContext** ctx, const char* config_file);
 
+/**
+ * Initialize the core module from a configuration object
+ * Takes ownership of config (NULL selects the built-in defaults)
+ */
+int core_init_with_config(CoreContext** ctx, cJSON* config);
+
 /**
  * Start core module (after all modules initialized)
  */
@@ -101,8 +166,36 @@ void core_api_free_inference(larodTensor** outputs);
 void core_api_add_detection(MetadataFrame* meta, Detection det);
 void core_api_publish_metadata(CoreContext* ctx, MetadataFrame* meta);
 void core_api_log(int level, const char* module, const char* format, ...);
+/**
+ * POST over the shared, pooled HTTP client
+ * @param headers Header lines separated by "\n" or "\r\n", NULL for none
+ * @param response Output on success: response body, caller frees
+ * @return 0 for a 2xx/3xx response, -1 otherwise
+ */
 int core_api_http_post(const char* url, const char* headers,
                        const char* body, char** response);
+/**
+ * POST without blocking the pipeline; done runs on the main loop thread
+ * @return 0 when queued, -1 when rejected (done is not called)
+ */
+int core_api_http_post_async(const char* url, const char* headers, const char* body,
+                             HttpCallback done, void* user);
+/**
+ * Drop a module's pending asynchronous posts (call from its cleanup)
+ * @return Requests dropped
+ */
+int core_api_http_cancel(void* user);
+/**
+ * Queue an image for a batched cloud AI call; done runs on the main loop thread
+ * @return 0 when accepted, -1 when refused or batching is not configured
+ */
+int core_api_cloud_submit(const char* prompt_id, const char* prompt, const uint8_t* jpeg,
+                          size_t jpeg_size, CloudResultFn done, void* user);
+/**
+ * Drop a module's pending cloud submissions (call from its cleanup)
+ * @return Submissions dropped
+ */
+int core_api_cloud_cancel(void* user);
 
 /**
  * Get the shared Larod context from core
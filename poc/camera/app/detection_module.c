@@ -7,7 +7,11 @@
 
 #include "module.h"
 #include "larod_handler.h"
+#include "tiling.h"
+#include "roi_mask.h"
+#include "detection_slot.h"
 #include "core.h"
+#include "trace.h"
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
@@ -21,11 +25,18 @@
 #define MODULE_VERSION "1.0.0"
 #define MODULE_PRIORITY 10
 
+#define DETECTION_CAPACITY 256      // Full-frame plus tile detections before NMS
+
 /**
  * Module state
  */
 typedef struct {
     LarodContext* larod;
+    Tiling* tiling;                 // NULL unless tiling is enabled
+    RoiMask* roi;                   // NULL without ROI / exclusion polygons
+    Detection* detections;          // Merge buffer, DETECTION_CAPACITY
+    Blackboard* blackboard;
+    int slot;
 
     // Motion detection state
     unsigned char* last_frame_data;
@@ -96,6 +107,34 @@ static float compute_motion_score(DetectionState* state, const unsigned char* fr
     return sample_count > 0 ? (float)diff_count / (float)sample_count : 0.0;
 }
 
+/**
+ * Hand the "classes" filter to the decoder
+ *   enabled     Class ids to keep (default all)
+ *   thresholds  { "<class id>": confidence } overriding the core threshold
+ */
+static void configure_classes(LarodContext* larod, cJSON* config) {
+    if (!larod || !config) return;
+
+    int classes[LAROD_NUM_CLASSES];
+    int count = 0;
+    cJSON* enabled = cJSON_GetObjectItem(config, "enabled");
+    cJSON* item;
+    cJSON_ArrayForEach(item, enabled) {
+        if (cJSON_IsNumber(item) && count < LAROD_NUM_CLASSES) classes[count++] = item->valueint;
+    }
+
+    float thresholds[LAROD_NUM_CLASSES];
+    for (int c = 0; c < LAROD_NUM_CLASSES; c++) thresholds[c] = larod->confidence_threshold;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(config, "thresholds")) {
+        int class_id = atoi(item->string);
+        if (cJSON_IsNumber(item) && class_id >= 0 && class_id < LAROD_NUM_CLASSES) {
+            thresholds[class_id] = (float)item->valuedouble;
+        }
+    }
+
+    Larod_Set_Classes(larod, cJSON_IsArray(enabled) ? classes : NULL, count, thresholds);
+}
+
 /**
  * Module initialization
  *
@@ -125,6 +164,35 @@ static int detection_init(ModuleContext* ctx, cJSON* config) {
         syslog(LOG_WARNING, "[%s] Core Larod not available - motion/scene analysis only\n", MODULE_NAME);
     } else {
         syslog(LOG_INFO, "[%s] Using core's Larod context for inference\n", MODULE_NAME);
+        state->tiling = Tiling_Init(cJSON_GetObjectItem(config, "tiling"), state->larod);
+        configure_classes(state->larod, cJSON_GetObjectItem(config, "classes"));
+    }
+
+    // Infer the ROI bounding box only - the core stages early-released frames the same way
+    state->roi = Roi_Init(cJSON_GetObjectItem(config, "roi"));
+    float crop[4];
+    if (state->larod && Roi_Crop(state->roi, crop)) {
+        Larod_Set_Roi(state->larod, crop);
+        Tiling_Set_Region(state->tiling, crop);
+    }
+
+    state->detections = (Detection*)calloc(DETECTION_CAPACITY, sizeof(Detection));
+    if (!state->detections) {
+        syslog(LOG_ERR, "[%s] Failed to allocate detections\n", MODULE_NAME);
+        Tiling_Cleanup(state->tiling);
+        Roi_Cleanup(state->roi);
+        free(state);
+        return -1;
+    }
+
+    // Constant fields go into the slot once; process() only updates the rest
+    state->blackboard = ctx->core->blackboard;
+    state->slot = Blackboard_Register(state->blackboard, MODULE_NAME, sizeof(DetectionSlot),
+                                      detection_fields, BB_FIELD_COUNT(detection_fields));
+    DetectionSlot* slot = (DetectionSlot*)Blackboard_Write(state->blackboard, state->slot);
+    if (slot) {
+        slot->confidence_threshold = state->confidence_threshold;
+        slot->ml_enabled = state->larod != NULL;
     }
 
     ctx->module_state = state;
@@ -146,51 +214,90 @@ static int detection_process(ModuleContext* ctx, FrameData* frame) {
 
     int num_detections = 0;
     float inference_time_ms = 0.0f;
+    TilingResult tiles = {0};
+    int masked = 0;
 
     // Run YOLOv5n inference if Larod is available
+    // Without frame_data the core released the buffer early and staged the input
     if (state->larod) {
-        LarodResult* result = Larod_Run_Inference(state->larod, frame->vdo_buffer);
-        if (result) {
-            // Add detections to metadata
-            for (int i = 0; i < result->num_detections; i++) {
-                Detection det = {
-                    .class_id = result->detections[i].class_id,
-                    .confidence = result->detections[i].confidence,
-                    .x = result->detections[i].x,
-                    .y = result->detections[i].y,
-                    .width = result->detections[i].width,
-                    .height = result->detections[i].height
-                };
-                metadata_add_detection(frame->metadata, det);
+        LarodResult* result = NULL;
+        if (frame->frame_data) {
+            LarodFrame input = {
+                .data = frame->frame_data,
+                .size = frame->frame_size,
+                .width = frame->width,
+                .height = frame->height,
+                .nv12 = frame->format == VDO_FORMAT_YUV,
+                .fd = frame->vdo_buffer ? vdo_buffer_get_fd(frame->vdo_buffer) : -1,
+                .offset = frame->vdo_buffer ? vdo_buffer_get_offset(frame->vdo_buffer) : 0,
+                .views = frame->views
+            };
+            if (Larod_Stage_Frame(state->larod, &input)) {
+                result = Larod_Run_Staged(state->larod);
             }
-            num_detections = result->num_detections;
+        } else {
+            result = Larod_Run_Staged(state->larod);
+        }
+        if (result) {
+            num_detections = result->num_detections < DETECTION_CAPACITY ?
+                             result->num_detections : DETECTION_CAPACITY;
+            memcpy(state->detections, result->detections, num_detections * sizeof(Detection));
             inference_time_ms = result->inference_time_ms;
             Larod_Free_Result(result);
         } else {
             syslog(LOG_WARNING, "[%s] Inference failed\n", MODULE_NAME);
         }
+
+        // Small objects from high-resolution tiles, merged with the full-frame pass
+        if (state->tiling) {
+            num_detections = Tiling_Run(state->tiling, frame, state->detections, num_detections,
+                                        DETECTION_CAPACITY, &tiles);
+            inference_time_ms += tiles.time_ms;
+        }
+
+        // Add detections to metadata - minus those the mask rules out
+        for (int i = 0; i < num_detections; i++) {
+            if (!Roi_Allows(state->roi, &state->detections[i])) {
+                masked++;
+                continue;
+            }
+            metadata_add_detection(frame->metadata, state->detections[i]);
+        }
+        num_detections -= masked;
     }
 
-    // Compute scene hash (works without ML)
-    if (frame->frame_data) {
+    // Compute scene hash (works without ML) - on the whole NV12 frame, or on
+    // luma for RGB streams and for the downscaled plane kept after an early release
+    const unsigned char* pixels = frame->format == VDO_FORMAT_YUV ?
+                                  (const unsigned char*)frame->frame_data : NULL;
+    size_t frame_size = frame->frame_size;  // YUV420 size
+    FrameView luma;
+    if (!pixels && Views_Luma(frame->views, &luma)) {
+        pixels = luma.data;
+        frame_size = luma.size;
+    }
+    if (pixels) {
         uint32_t scene_hash = 0;
-        size_t frame_size = frame->width * frame->height * 3 / 2;  // YUV420 size
-        compute_scene_hash((unsigned char*)frame->frame_data, frame_size, &scene_hash);
+        TraceSpan span = Trace_Begin("scene_hash");
+        compute_scene_hash(pixels, frame_size, &scene_hash);
+        Trace_End(&span);
         frame->metadata->scene_hash = scene_hash;
 
         // Compute motion score (works without ML)
-        frame->metadata->motion_score = compute_motion_score(state,
-                                                              (unsigned char*)frame->frame_data,
-                                                              frame_size);
+        span = Trace_Begin("motion");
+        frame->metadata->motion_score = compute_motion_score(state, pixels, frame_size);
+        Trace_End(&span);
     }
 
-    // Add detection module data to custom metadata
-    cJSON* detection_data = cJSON_CreateObject();
-    cJSON_AddNumberToObject(detection_data, "inference_time_ms", inference_time_ms);
-    cJSON_AddNumberToObject(detection_data, "num_detections", num_detections);
-    cJSON_AddNumberToObject(detection_data, "confidence_threshold", state->confidence_threshold);
-    cJSON_AddBoolToObject(detection_data, "ml_enabled", state->larod != NULL);
-    cJSON_AddItemToObject(frame->metadata->custom_data, "detection", detection_data);
+    // Publish per-frame results to the blackboard
+    DetectionSlot* slot = (DetectionSlot*)Blackboard_Write(frame->metadata->blackboard, state->slot);
+    if (slot) {
+        slot->inference_time_ms = inference_time_ms;
+        slot->num_detections = num_detections;
+        slot->tiles_run = tiles.tiles_run;
+        slot->tiles_skipped = tiles.tiles_skipped;
+        slot->masked = masked;
+    }
 
     return AXIS_IS_MODULE_SUCCESS;
 }
@@ -210,6 +317,9 @@ static void detection_cleanup(ModuleContext* ctx) {
     // Note: Don't cleanup state->larod - it's borrowed from core
     // Core owns the Larod context and will clean it up
 
+    Tiling_Cleanup(state->tiling);
+    Roi_Cleanup(state->roi);
+    free(state->detections);
     if (state->last_frame_data) {
         free(state->last_frame_data);
     }
@@ -0,0 +1,43 @@
+/**
+ * detection_slot.h
+ *
+ * Blackboard slot "detection" for Axis I.S. POC
+ * Written by the detection module every frame and exported under
+ * modules.detection. The micro-benchmarks register the same slot to
+ * measure the payload the camera publishes, so the layout lives here.
+ */
+
+#ifndef DETECTION_SLOT_H
+#define DETECTION_SLOT_H
+
+#include "blackboard.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    float inference_time_ms;
+    int num_detections;
+    float confidence_threshold;     // Written once at init
+    int ml_enabled;                 // Written once at init
+    int tiles_run;
+    int tiles_skipped;
+    int masked;                     // Detections outside the ROI or in an exclusion zone
+} DetectionSlot;
+
+static const BlackboardField detection_fields[] = {
+    BB_FIELD(DetectionSlot, inference_time_ms, BB_FIELD_FLOAT),
+    BB_FIELD(DetectionSlot, num_detections, BB_FIELD_INT),
+    BB_FIELD(DetectionSlot, confidence_threshold, BB_FIELD_FLOAT),
+    BB_FIELD(DetectionSlot, ml_enabled, BB_FIELD_BOOL),
+    BB_FIELD(DetectionSlot, tiles_run, BB_FIELD_INT),
+    BB_FIELD(DetectionSlot, tiles_skipped, BB_FIELD_INT),
+    BB_FIELD(DetectionSlot, masked, BB_FIELD_INT)
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DETECTION_SLOT_H */
@@ -41,6 +41,7 @@ DlpuContext* Dlpu_Init(const char* camera_id, int camera_index) {
     strncpy(ctx->camera_id, camera_id, sizeof(ctx->camera_id) - 1);
     ctx->camera_index = camera_index;
     ctx->slot_offset_ms = camera_index * SLOT_DURATION_MS;
+    ctx->time_slicing = 1;
 
     LOG("DLPU initialized: Camera=%s Index=%d SlotOffset=%dms\n",
         camera_id, camera_index, ctx->slot_offset_ms);
@@ -54,6 +55,11 @@ int Dlpu_Wait_For_Slot(DlpuContext* ctx) {
         return 0;
     }
 
+    if (!ctx->time_slicing) {
+        ctx->total_waits++;
+        return 1;
+    }
+
     struct timeval start, now;
     gettimeofday(&start, NULL);
 
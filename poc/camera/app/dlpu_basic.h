@@ -16,6 +16,7 @@ extern "C" {
 typedef struct {
     int camera_index;
     int slot_offset_ms;
+    int time_slicing;           // 0 = never wait (single camera, host benchmarks)
     char camera_id[64];
     int total_waits;
     int total_wait_ms;
@@ -0,0 +1,359 @@
+/**
+ * flight_recorder.c
+ *
+ * Frame flight recorder implementation for Axis I.S. POC
+ *
+ * The pipeline thread appends one fixed-size record per frame under a short
+ * mutex. Dumps are frozen into a separate snapshot buffer and written by a
+ * watchdog thread, which also detects stalls - a stalled pipeline usually
+ * means the GLib main loop is blocked, so the check cannot live there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include "flight_recorder.h"
+#include "trace.h"
+#include "ACAP.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_WARN(fmt, args...) { syslog(LOG_WARNING, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define WATCHDOG_PERIOD_MS 100
+
+static struct {
+    int enabled;
+
+    // History ring (guarded by mutex)
+    FlightRecord ring[FLIGHT_RECORDER_FRAMES];
+    uint64_t head;
+    uint64_t frames;                        // Records appended, repeats included
+    int64_t last_frame_end_us;              // Last frame without error
+    int stall_latched;
+
+    // Frozen copy awaiting write (owned by watchdog while pending)
+    FlightRecord snapshot[FLIGHT_RECORDER_FRAMES];
+    int snapshot_count;
+    const char* pending_reason;
+    int64_t last_dump_us;
+
+    // Configuration
+    int deadline_us;
+    int stall_ms;
+    int deadline_includes_dlpu_wait;
+    int min_dump_interval_s;
+    int max_dumps;
+    const char* module_names[FLIGHT_MAX_MODULES];
+    int module_count;
+
+    // Statistics
+    unsigned long deadline_misses;
+    unsigned long failed_frames;            // Records with an error
+    unsigned long stalls;
+    unsigned long dumps_written;
+    unsigned long dumps_suppressed;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int running;
+} g_flight;
+
+static int config_int(cJSON* config, const char* key, int default_val) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsNumber(item) ? item->valueint : default_val;
+}
+
+static int config_bool(cJSON* config, const char* key, int default_val) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsBool(item) ? cJSON_IsTrue(item) : default_val;
+}
+
+/**
+ * Freeze history into the snapshot buffer
+ * Must be called with mutex held
+ */
+static int trigger_locked(const char* reason) {
+    int64_t now = Trace_Now_Us();
+
+    if (g_flight.pending_reason ||
+        (g_flight.last_dump_us > 0 &&
+         now - g_flight.last_dump_us < (int64_t)g_flight.min_dump_interval_s * 1000000)) {
+        g_flight.dumps_suppressed++;
+        return 0;
+    }
+
+    uint64_t head = g_flight.head;
+    uint64_t first = head > FLIGHT_RECORDER_FRAMES ? head - FLIGHT_RECORDER_FRAMES : 0;
+    int count = 0;
+    for (uint64_t i = first; i < head; i++) {
+        g_flight.snapshot[count++] = g_flight.ring[i % FLIGHT_RECORDER_FRAMES];
+    }
+
+    g_flight.snapshot_count = count;
+    g_flight.pending_reason = reason;
+    g_flight.last_dump_us = now;
+    pthread_cond_signal(&g_flight.cond);
+    return 1;
+}
+
+/**
+ * Serialize the snapshot in a compact column/row layout
+ */
+static cJSON* snapshot_to_json(const char* reason) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddStringToObject(json, "reason", reason);
+    cJSON_AddNumberToObject(json, "timestamp", (double)time(NULL));
+    cJSON_AddNumberToObject(json, "deadline_ms", g_flight.deadline_us / 1000);
+    cJSON_AddNumberToObject(json, "stall_ms", g_flight.stall_ms);
+
+    cJSON* columns = cJSON_CreateArray();
+    const char* fixed_columns[] = { "frame_id", "start_us", "total_us", "dlpu_wait_us",
+                                    "capture_us", "hold_us", "inference_us", "publish_us" };
+    for (size_t i = 0; i < sizeof(fixed_columns) / sizeof(fixed_columns[0]); i++) {
+        cJSON_AddItemToArray(columns, cJSON_CreateString(fixed_columns[i]));
+    }
+    for (int m = 0; m < g_flight.module_count; m++) {
+        char name[64];
+        snprintf(name, sizeof(name), "%s_us", g_flight.module_names[m]);
+        cJSON_AddItemToArray(columns, cJSON_CreateString(name));
+    }
+    cJSON_AddItemToArray(columns, cJSON_CreateString("detections"));
+    cJSON_AddItemToArray(columns, cJSON_CreateString("mqtt_pending"));
+    cJSON_AddItemToArray(columns, cJSON_CreateString("vdo_dropped"));
+    cJSON_AddItemToArray(columns, cJSON_CreateString("error"));
+    cJSON_AddItemToArray(columns, cJSON_CreateString("repeats"));
+    cJSON_AddItemToObject(json, "columns", columns);
+
+    cJSON* frames = cJSON_CreateArray();
+    for (int i = 0; i < g_flight.snapshot_count; i++) {
+        const FlightRecord* r = &g_flight.snapshot[i];
+        cJSON* row = cJSON_CreateArray();
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->frame_id));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber((double)r->start_us));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->total_us));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->dlpu_wait_us));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->capture_us));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->hold_us));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->inference_us));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->publish_us));
+        for (int m = 0; m < g_flight.module_count; m++) {
+            cJSON_AddItemToArray(row, cJSON_CreateNumber(r->module_us[m]));
+        }
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->detection_count));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->mqtt_pending));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->vdo_dropped));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->error));
+        cJSON_AddItemToArray(row, cJSON_CreateNumber(r->repeats));
+        cJSON_AddItemToArray(frames, row);
+    }
+    cJSON_AddItemToObject(json, "frames", frames);
+
+    return json;
+}
+
+/**
+ * Write the pending snapshot to localdata/ and fire the ACAP event
+ */
+static void write_snapshot(const char* reason) {
+    char path[128];
+    snprintf(path, sizeof(path), "localdata/flight_recorder_%lu.json",
+             g_flight.dumps_written % (unsigned long)g_flight.max_dumps);
+
+    cJSON* json = snapshot_to_json(reason);
+    char* text = cJSON_PrintUnformatted(json);
+    cJSON_Delete(json);
+    if (!text) {
+        LOG_ERR("Flight: Failed to serialize snapshot\n");
+        return;
+    }
+
+    FILE* file = ACAP_FILE_Open(path, "w");
+    if (!file) {
+        LOG_ERR("Flight: Cannot open %s for writing\n", path);
+        free(text);
+        return;
+    }
+    fputs(text, file);
+    fclose(file);
+    free(text);
+
+    g_flight.dumps_written++;
+    LOG_WARN("Flight: Dumped %d frames to %s (reason=%s)\n",
+             g_flight.snapshot_count, path, reason);
+
+    ACAP_EVENTS_Fire(FLIGHT_EVENT_ID);
+}
+
+static void* watchdog_thread(void* arg) {
+    (void)arg;
+    Trace_Set_Thread_Name("flight_recorder");
+
+    pthread_mutex_lock(&g_flight.mutex);
+    while (g_flight.running) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_nsec += WATCHDOG_PERIOD_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&g_flight.cond, &g_flight.mutex, &deadline);
+        if (!g_flight.running) break;
+
+        // Stall: no frame has completed for stall_ms
+        int64_t now = Trace_Now_Us();
+        if (g_flight.last_frame_end_us > 0 && !g_flight.stall_latched &&
+            now - g_flight.last_frame_end_us > (int64_t)g_flight.stall_ms * 1000) {
+            g_flight.stall_latched = 1;
+            g_flight.stalls++;
+            LOG_WARN("Flight: Pipeline stalled for %lldms\n",
+                     (long long)((now - g_flight.last_frame_end_us) / 1000));
+            trigger_locked("stall");
+        }
+
+        if (g_flight.pending_reason) {
+            const char* reason = g_flight.pending_reason;
+            pthread_mutex_unlock(&g_flight.mutex);
+            write_snapshot(reason);
+            pthread_mutex_lock(&g_flight.mutex);
+            g_flight.pending_reason = NULL;
+        }
+    }
+    pthread_mutex_unlock(&g_flight.mutex);
+    return NULL;
+}
+
+int Flight_Init(cJSON* config, const char** module_names, int module_count) {
+    memset(&g_flight, 0, sizeof(g_flight));
+
+    g_flight.enabled = config_bool(config, "enabled", 1);
+    if (!g_flight.enabled) {
+        LOG("Flight: Recorder disabled\n");
+        return 0;
+    }
+
+    g_flight.deadline_us = config_int(config, "deadline_ms", 500) * 1000;
+    g_flight.stall_ms = config_int(config, "stall_ms", 5000);
+    g_flight.deadline_includes_dlpu_wait = config_bool(config, "deadline_includes_dlpu_wait", 0);
+    g_flight.min_dump_interval_s = config_int(config, "min_dump_interval_s", 300);
+    g_flight.max_dumps = config_int(config, "max_dumps", 5);
+    if (g_flight.max_dumps < 1) g_flight.max_dumps = 1;
+
+    g_flight.module_count = module_count < FLIGHT_MAX_MODULES ? module_count : FLIGHT_MAX_MODULES;
+    for (int i = 0; i < g_flight.module_count; i++) {
+        g_flight.module_names[i] = module_names[i];
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&g_flight.cond, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&g_flight.mutex, NULL);
+
+    ACAP_EVENTS_Add_Event(FLIGHT_EVENT_ID, "Flight recorder dump", 0);
+
+    g_flight.running = 1;
+    if (pthread_create(&g_flight.thread, NULL, watchdog_thread, NULL) != 0) {
+        LOG_ERR("Flight: Failed to start watchdog thread\n");
+        g_flight.running = 0;
+        g_flight.enabled = 0;
+        pthread_cond_destroy(&g_flight.cond);
+        pthread_mutex_destroy(&g_flight.mutex);
+        return 0;
+    }
+
+    LOG("Flight: Recording %d frames, deadline=%dms stall=%dms\n",
+        FLIGHT_RECORDER_FRAMES, g_flight.deadline_us / 1000, g_flight.stall_ms);
+    return 1;
+}
+
+void Flight_Record(const FlightRecord* record) {
+    if (!g_flight.enabled || !record) return;
+
+    int32_t work_us = record->total_us;
+    if (!g_flight.deadline_includes_dlpu_wait) {
+        work_us -= record->dlpu_wait_us;
+    }
+
+    pthread_mutex_lock(&g_flight.mutex);
+    g_flight.frames++;
+    FlightRecord* last = g_flight.head > 0
+        ? &g_flight.ring[(g_flight.head - 1) % FLIGHT_RECORDER_FRAMES] : NULL;
+    if (record->error && last && last->error == record->error) {
+        // Retry of the same failure: keep the first record, count the rest
+        if (last->repeats < UINT16_MAX) last->repeats++;
+    } else {
+        g_flight.ring[g_flight.head % FLIGHT_RECORDER_FRAMES] = *record;
+        g_flight.ring[g_flight.head % FLIGHT_RECORDER_FRAMES].repeats = 0;
+        g_flight.head++;
+    }
+    if (record->error) {
+        g_flight.failed_frames++;
+    } else {
+        // Failed frames are not progress: a source that keeps timing out is a stall
+        g_flight.last_frame_end_us = record->start_us + record->total_us;
+        g_flight.stall_latched = 0;
+    }
+
+    if (g_flight.deadline_us > 0 && work_us > g_flight.deadline_us) {
+        g_flight.deadline_misses++;
+        trigger_locked("deadline");
+    }
+    pthread_mutex_unlock(&g_flight.mutex);
+}
+
+int Flight_Trigger(const char* reason) {
+    if (!g_flight.enabled) return 0;
+
+    pthread_mutex_lock(&g_flight.mutex);
+    int scheduled = trigger_locked(reason ? reason : "manual");
+    pthread_mutex_unlock(&g_flight.mutex);
+    return scheduled;
+}
+
+cJSON* Flight_Stats_JSON(void) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", g_flight.enabled);
+    if (!g_flight.enabled) return json;
+
+    pthread_mutex_lock(&g_flight.mutex);
+    cJSON_AddNumberToObject(json, "frames_recorded", (double)g_flight.frames);
+    cJSON_AddNumberToObject(json, "deadline_misses", g_flight.deadline_misses);
+    cJSON_AddNumberToObject(json, "failed_frames", g_flight.failed_frames);
+    cJSON_AddNumberToObject(json, "stalls", g_flight.stalls);
+    cJSON_AddNumberToObject(json, "dumps_written", g_flight.dumps_written);
+    cJSON_AddNumberToObject(json, "dumps_suppressed", g_flight.dumps_suppressed);
+    pthread_mutex_unlock(&g_flight.mutex);
+
+    return json;
+}
+
+void Flight_Cleanup(void) {
+    if (!g_flight.enabled) return;
+
+    pthread_mutex_lock(&g_flight.mutex);
+    g_flight.running = 0;
+    pthread_cond_signal(&g_flight.cond);
+    pthread_mutex_unlock(&g_flight.mutex);
+    pthread_join(g_flight.thread, NULL);
+
+    LOG("Flight cleanup: Frames=%llu DeadlineMisses=%lu Stalls=%lu Dumps=%lu\n",
+        (unsigned long long)g_flight.frames, g_flight.deadline_misses,
+        g_flight.stalls, g_flight.dumps_written);
+
+    pthread_cond_destroy(&g_flight.cond);
+    pthread_mutex_destroy(&g_flight.mutex);
+    g_flight.enabled = 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * flight_recorder.h
+ *
+ * Always-on frame flight recorder for Axis I.S. POC
+ * Keeps the last FLIGHT_RECORDER_FRAMES frames of pipeline timings and
+ * freezes a copy to localdata/ when a frame misses its deadline or the
+ * pipeline stalls
+ */
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_RECORDER_FRAMES 1024
+#define FLIGHT_MAX_MODULES 8
+#define FLIGHT_EVENT_ID "flightRecorderDump"
+
+/* Why a frame ended early (FlightRecord.error) */
+#define FLIGHT_ERROR_NONE 0
+#define FLIGHT_ERROR_DLPU_TIMEOUT 1             // No DLPU slot
+#define FLIGHT_ERROR_CAPTURE 2                  // No frame from the source
+#define FLIGHT_ERROR_METADATA 3                 // Metadata allocation failed
+
+/* Per-frame record */
+typedef struct {
+    int frame_id;
+    int64_t start_us;                       // Monotonic frame start
+    int32_t total_us;                       // Whole core_process_frame
+    int32_t dlpu_wait_us;                   // DLPU slot wait
+    int32_t capture_us;                     // VDO buffer fetch
+    int32_t hold_us;                        // Fetch to return of the source buffer
+    int32_t inference_us;                   // Larod job (0 if none ran)
+    int32_t publish_us;                     // Metadata JSON + MQTT
+    int32_t module_us[FLIGHT_MAX_MODULES];  // Each module's process()
+    int16_t detection_count;
+    int16_t mqtt_pending;                   // MQTT messages awaiting delivery
+    int16_t error;                          // FLIGHT_ERROR_*, stages after it are 0
+    uint16_t repeats;                       // Identical failures right after this one
+    uint32_t vdo_dropped;                   // Cumulative VDO drops
+} FlightRecord;
+
+/**
+ * Initialize the flight recorder and start its watchdog thread
+ * @param config "flight_recorder" object from core config (may be NULL)
+ * @param module_names Module names in pipeline order (static strings)
+ * @param module_count Number of modules
+ * @return 1 on success, 0 on failure or when disabled
+ */
+int Flight_Init(cJSON* config, const char** module_names, int module_count);
+
+/**
+ * Append a completed frame and check it against the deadline
+ * A failure with the same error as the previous record only counts in its
+ * repeats, so a failing source cannot push older history out of the ring.
+ * Only frames without error count as progress for the stall check.
+ * @param record Frame record (copied)
+ */
+void Flight_Record(const FlightRecord* record);
+
+/**
+ * Freeze the current history and schedule it to be written to localdata/
+ * @param reason Short static string ("deadline", "stall", "manual")
+ * @return 1 if a dump was scheduled, 0 if rate-limited or busy
+ */
+int Flight_Trigger(const char* reason);
+
+/**
+ * Get recorder statistics as JSON
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Flight_Stats_JSON(void);
+
+/**
+ * Stop the watchdog thread and free resources
+ */
+void Flight_Cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHT_RECORDER_H */
@@ -0,0 +1,254 @@
+/**
+ * frame_arena.c
+ *
+ * Per-frame arena allocator implementation for Axis I.S. POC
+ *
+ * Each block carries a 16-byte header holding its size so Arena_Realloc can
+ * copy, and so the most recent block can be grown or released in place -
+ * the common cJSON print pattern. Frees of older blocks are no-ops; the
+ * whole arena is reclaimed by Arena_End_Frame. Ownership of a pointer is
+ * decided by address range, so arena and heap memory can be mixed freely
+ * (cJSON trees built before the hooks were installed still free correctly).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <pthread.h>
+#include "frame_arena.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define ARENA_ALIGN 16
+#define ARENA_HEADER ARENA_ALIGN
+#define ARENA_MAX 4
+
+struct FrameArena {
+    uint8_t* base;
+    size_t capacity;
+    size_t used;
+    size_t last;                    // Offset of the most recent block's header
+
+    // Statistics (written by the owning thread, read anywhere)
+    uint64_t frames;
+    uint64_t overflow_allocs;       // Heap fallbacks while the arena was active
+    uint64_t overflow_bytes;
+    size_t high_water;
+};
+
+static __thread FrameArena* t_current = NULL;
+static __thread int t_json = 0;         // cJSON allocates from t_current
+
+/* Every live arena, for ownership checks on free */
+static FrameArena* g_arenas[ARENA_MAX];
+static pthread_mutex_t g_arenas_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t align_up(size_t value) {
+    return (value + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static int owns(const FrameArena* arena, const void* ptr) {
+    return arena && (const uint8_t*)ptr >= arena->base &&
+           (const uint8_t*)ptr < arena->base + arena->capacity;
+}
+
+static FrameArena* find_owner(const void* ptr) {
+    if (owns(t_current, ptr)) return t_current;
+    for (int i = 0; i < ARENA_MAX; i++) {
+        FrameArena* arena = __atomic_load_n(&g_arenas[i], __ATOMIC_ACQUIRE);
+        if (owns(arena, ptr)) return arena;
+    }
+    return NULL;
+}
+
+static size_t block_size(const void* ptr) {
+    return *(const size_t*)((const uint8_t*)ptr - ARENA_HEADER);
+}
+
+static void* arena_alloc(FrameArena* arena, size_t size) {
+    size_t need = ARENA_HEADER + align_up(size ? size : 1);
+    if (need > arena->capacity - arena->used) return NULL;
+
+    uint8_t* block = arena->base + arena->used;
+    *(size_t*)block = size;
+    arena->last = arena->used;
+    arena->used += need;
+    if (arena->used > arena->high_water) arena->high_water = arena->used;
+    return block + ARENA_HEADER;
+}
+
+static int is_last(const FrameArena* arena, const void* ptr) {
+    return arena->used > 0 && (const uint8_t*)ptr == arena->base + arena->last + ARENA_HEADER;
+}
+
+static void* heap_fallback(size_t size) {
+    FrameArena* arena = t_current;
+    if (arena) {
+        arena->overflow_allocs++;
+        arena->overflow_bytes += size;
+    }
+    return malloc(size);
+}
+
+void* Arena_Malloc(size_t size) {
+    FrameArena* arena = t_current;
+    if (arena) {
+        void* ptr = arena_alloc(arena, size);
+        if (ptr) return ptr;
+    }
+    return heap_fallback(size);
+}
+
+void* Arena_Calloc(size_t count, size_t size) {
+    if (size && count > SIZE_MAX / size) return NULL;
+    void* ptr = Arena_Malloc(count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* Arena_Realloc(void* ptr, size_t size) {
+    if (!ptr) return Arena_Malloc(size);
+
+    FrameArena* arena = find_owner(ptr);
+    if (!arena) return realloc(ptr, size);
+
+    // Grow or shrink the most recent block in place
+    if (arena == t_current && is_last(arena, ptr)) {
+        size_t end = arena->last + ARENA_HEADER + align_up(size ? size : 1);
+        if (end <= arena->capacity) {
+            *(size_t*)(arena->base + arena->last) = size;
+            arena->used = end;
+            if (arena->used > arena->high_water) arena->high_water = arena->used;
+            return ptr;
+        }
+    }
+
+    size_t old_size = block_size(ptr);
+    void* moved = Arena_Malloc(size);
+    if (moved) memcpy(moved, ptr, old_size < size ? old_size : size);
+    return moved;
+}
+
+/* cJSON hook - the arena only inside an Arena_JSON scope */
+static void* json_malloc(size_t size) {
+    return t_json ? Arena_Malloc(size) : malloc(size);
+}
+
+int Arena_JSON_Begin(void) {
+    int previous = t_json;
+    t_json = 1;
+    return previous;
+}
+
+void Arena_JSON_End(int previous) {
+    t_json = previous;
+}
+
+void Arena_Free(void* ptr) {
+    if (!ptr) return;
+
+    FrameArena* arena = find_owner(ptr);
+    if (!arena) {
+        free(ptr);
+        return;
+    }
+    // Only the most recent block can be handed back before frame end
+    if (arena == t_current && is_last(arena, ptr)) {
+        arena->used = arena->last;
+    }
+}
+
+FrameArena* Arena_Create(size_t capacity) {
+    FrameArena* arena = (FrameArena*)calloc(1, sizeof(FrameArena));
+    if (!arena) {
+        LOG_ERR("Arena: Failed to allocate context\n");
+        return NULL;
+    }
+    arena->capacity = align_up(capacity);
+    arena->base = (uint8_t*)malloc(arena->capacity);
+    if (!arena->base) {
+        LOG_ERR("Arena: Failed to allocate %zu bytes\n", arena->capacity);
+        free(arena);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_arenas_mutex);
+    int slot = -1;
+    for (int i = 0; i < ARENA_MAX && slot < 0; i++) {
+        if (!g_arenas[i]) slot = i;
+    }
+    if (slot >= 0) __atomic_store_n(&g_arenas[slot], arena, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&g_arenas_mutex);
+
+    if (slot < 0) {
+        LOG_ERR("Arena: Too many arenas (max %d)\n", ARENA_MAX);
+        free(arena->base);
+        free(arena);
+        return NULL;
+    }
+
+    // Safe to install repeatedly; outside a JSON scope the hooks are malloc/free
+    cJSON_Hooks hooks = { .malloc_fn = json_malloc, .free_fn = Arena_Free };
+    cJSON_InitHooks(&hooks);
+
+    LOG("Arena: %zu KB per-frame arena\n", arena->capacity / 1024);
+    return arena;
+}
+
+void Arena_Destroy(FrameArena* arena) {
+    if (!arena) return;
+
+    if (t_current == arena) t_current = NULL;
+
+    pthread_mutex_lock(&g_arenas_mutex);
+    for (int i = 0; i < ARENA_MAX; i++) {
+        if (g_arenas[i] == arena) __atomic_store_n(&g_arenas[i], NULL, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&g_arenas_mutex);
+
+    LOG("Arena cleanup: Frames=%llu HighWater=%zu Overflows=%llu\n",
+        (unsigned long long)arena->frames, arena->high_water,
+        (unsigned long long)arena->overflow_allocs);
+
+    free(arena->base);
+    free(arena);
+}
+
+void Arena_Begin_Frame(FrameArena* arena) {
+    if (!arena) return;
+    arena->used = 0;
+    t_current = arena;
+}
+
+void Arena_End_Frame(FrameArena* arena) {
+    if (!arena) return;
+    if (t_current == arena) t_current = NULL;
+    arena->used = 0;
+    arena->frames++;
+}
+
+FrameArena* Arena_Set_Current(FrameArena* arena) {
+    FrameArena* previous = t_current;
+    t_current = arena;
+    return previous;
+}
+
+cJSON* Arena_Stats_JSON(FrameArena* arena) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", arena != NULL);
+    if (!arena) return json;
+
+    cJSON_AddNumberToObject(json, "capacity_bytes", (double)arena->capacity);
+    cJSON_AddNumberToObject(json, "high_water_bytes", (double)arena->high_water);
+    cJSON_AddNumberToObject(json, "frames", (double)arena->frames);
+    cJSON_AddNumberToObject(json, "overflow_allocs", (double)arena->overflow_allocs);
+    cJSON_AddNumberToObject(json, "overflow_bytes", (double)arena->overflow_bytes);
+    return json;
+}
@@ -0,0 +1,104 @@
+/**
+ * frame_arena.h
+ *
+ * Per-frame arena allocator for Axis I.S. POC
+ * Everything the pipeline allocates for one frame - the MetadataFrame and
+ * its detection array, LarodResult, and the cJSON tree and printed string
+ * of the published metadata - is bump-allocated from one preallocated
+ * block and dropped in a single reset at frame end. The steady state
+ * therefore makes no heap calls and cannot fragment the heap.
+ *
+ * The arena is only active on the pipeline thread between
+ * Arena_Begin_Frame() and Arena_End_Frame(); everywhere else the Arena_*
+ * allocation functions fall through to malloc/free. Memory that must
+ * outlive the frame has to be copied out with plain malloc (or created
+ * with Arena_Set_Current(NULL) in effect).
+ *
+ * cJSON is routed through the hooks too, but only allocates from the
+ * arena inside an Arena_JSON_Begin()/Arena_JSON_End() scope - the core
+ * opens one around building and publishing the metadata. cJSON objects a
+ * module creates in process() (a parsed cloud response, say) are plain
+ * heap memory and may be kept past the frame.
+ */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARENA_DEFAULT_KB 256
+
+typedef struct FrameArena FrameArena;
+
+/**
+ * Create an arena and route cJSON allocations through the Arena_* functions
+ * @param capacity Block size in bytes
+ * @return Arena pointer, NULL on failure
+ */
+FrameArena* Arena_Create(size_t capacity);
+
+/**
+ * Free the arena block
+ */
+void Arena_Destroy(FrameArena* arena);
+
+/**
+ * Make the arena current on this thread for one frame
+ */
+void Arena_Begin_Frame(FrameArena* arena);
+
+/**
+ * Drop every allocation of the frame and deactivate the arena
+ */
+void Arena_End_Frame(FrameArena* arena);
+
+/**
+ * Replace this thread's current arena
+ * @param arena New arena, NULL to allocate from the heap
+ * @return Previous arena, to be restored by the caller
+ */
+FrameArena* Arena_Set_Current(FrameArena* arena);
+
+/**
+ * Let cJSON allocate from the current arena on this thread, for a tree
+ * that is deleted before the frame ends
+ * @return Previous scope state, to be passed to Arena_JSON_End
+ */
+int Arena_JSON_Begin(void);
+
+/**
+ * Close the scope - cJSON allocates from the heap again
+ */
+void Arena_JSON_End(int previous);
+
+/**
+ * Allocate from the current arena, or the heap when none is active or
+ * the arena is exhausted (counted as an overflow)
+ */
+void* Arena_Malloc(size_t size);
+void* Arena_Calloc(size_t count, size_t size);
+void* Arena_Realloc(void* ptr, size_t size);
+
+/**
+ * Free memory from Arena_Malloc/Calloc/Realloc or the cJSON hooks
+ * Arena memory is reclaimed at frame end (the most recent block at once)
+ */
+void Arena_Free(void* ptr);
+
+/**
+ * Get arena statistics as JSON
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Arena_Stats_JSON(FrameArena* arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_ARENA_H */
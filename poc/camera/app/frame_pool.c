@@ -0,0 +1,350 @@
+/**
+ * frame_pool.c
+ *
+ * Reference-counted frame retention implementation for Axis I.S. POC
+ *
+ * Handles and copy buffers are preallocated (copy buffers lazily, at the
+ * frame size) so retaining a frame never allocates in the steady state.
+ * The first retain of a frame happens on the pipeline thread while
+ * core_process_frame still holds its reference, so the pixels can be
+ * copied without holding the pool lock.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <pthread.h>
+#include "frame_pool.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_WARN(fmt, args...) { syslog(LOG_WARNING, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define POOL_DEFAULT_COPIES 4
+#define POOL_MAX_COPIES 32
+
+struct FramePool {
+    FrameSource* source;
+    pthread_mutex_t mutex;
+
+    FrameRef* handles;
+    int handle_count;
+    FrameRef* free_handles;
+    FrameRef* pending;              // Source frames to release on the pipeline thread
+
+    uint8_t* copies[POOL_MAX_COPIES];
+    size_t copy_size[POOL_MAX_COPIES];
+    int copy_busy[POOL_MAX_COPIES];
+    int copy_count;
+
+    int vdo_retain_max;
+
+    // Statistics
+    int handles_in_use;
+    int vdo_held;
+    int vdo_held_max;
+    int copies_in_use;
+    int copies_max;
+    uint64_t retains;
+    uint64_t retains_zero_copy;
+    uint64_t retains_copied;
+    uint64_t retain_failures;
+    uint64_t deferred_releases;
+};
+
+static int config_int(cJSON* config, const char* key, int default_val) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsNumber(item) ? item->valueint : default_val;
+}
+
+/* Caller holds the lock */
+static void put_handle(FramePool* pool, FrameRef* ref) {
+    ref->next = pool->free_handles;
+    pool->free_handles = ref;
+    pool->handles_in_use--;
+}
+
+/* Caller holds the lock; returns the source frame to the source later */
+static void finish(FramePool* pool, FrameRef* ref) {
+    if (ref->copy_slot >= 0) {
+        pool->copy_busy[ref->copy_slot] = 0;
+        pool->copies_in_use--;
+        ref->copy_slot = -1;
+    }
+    if (ref->owns_source) {
+        // Only a zero-copy retain keeps the source frame past FramePool_End
+        if (ref->retained) pool->vdo_held--;
+        ref->next = pool->pending;
+        pool->pending = ref;
+    } else {
+        put_handle(pool, ref);
+    }
+}
+
+/* Pipeline thread: hand queued source frames back to the source */
+static void drain(FramePool* pool) {
+    pthread_mutex_lock(&pool->mutex);
+    FrameRef* list = pool->pending;
+    pool->pending = NULL;
+    pthread_mutex_unlock(&pool->mutex);
+
+    while (list) {
+        FrameRef* ref = list;
+        list = list->next;
+        FrameSource_Release_Frame(pool->source, &ref->source);
+
+        pthread_mutex_lock(&pool->mutex);
+        ref->owns_source = 0;
+        put_handle(pool, ref);
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+FramePool* FramePool_Init(cJSON* config, FrameSource* source) {
+    FramePool* pool = (FramePool*)calloc(1, sizeof(FramePool));
+    if (!pool) {
+        LOG_ERR("FramePool: Failed to allocate context\n");
+        return NULL;
+    }
+    pool->source = source;
+    pthread_mutex_init(&pool->mutex, NULL);
+
+    pool->copy_count = config_int(config, "copy_buffers", POOL_DEFAULT_COPIES);
+    if (pool->copy_count < 0) pool->copy_count = 0;
+    if (pool->copy_count > POOL_MAX_COPIES) pool->copy_count = POOL_MAX_COPIES;
+
+    // One buffer is always capturing and one must stay free for the next frame
+    int buffer_count = source ? (int)source->buffer_count : 1;
+    int vdo_default = source && source->type == FRAME_SOURCE_VDO ? buffer_count - 2 : 0;
+    pool->vdo_retain_max = config_int(config, "vdo_retain_max", vdo_default);
+    if (pool->vdo_retain_max > buffer_count - 2) pool->vdo_retain_max = buffer_count - 2;
+    if (pool->vdo_retain_max < 0) pool->vdo_retain_max = 0;
+
+    // Every frame that can be held at once plus the one in flight
+    pool->handle_count = pool->copy_count + pool->vdo_retain_max + 2;
+    pool->handles = (FrameRef*)calloc(pool->handle_count, sizeof(FrameRef));
+    if (!pool->handles) {
+        LOG_ERR("FramePool: Failed to allocate %d handles\n", pool->handle_count);
+        pthread_mutex_destroy(&pool->mutex);
+        free(pool);
+        return NULL;
+    }
+    for (int i = pool->handle_count - 1; i >= 0; i--) {
+        pool->handles[i].pool = pool;
+        pool->handles[i].next = pool->free_handles;
+        pool->free_handles = &pool->handles[i];
+    }
+
+    LOG("FramePool: %u source buffers, %d zero-copy retains, %d copy buffers\n",
+        (unsigned int)buffer_count, pool->vdo_retain_max, pool->copy_count);
+    return pool;
+}
+
+static FrameRef* take_handle(FramePool* pool, const void* data, size_t size, unsigned int width,
+                             unsigned int height, int64_t timestamp_us, int frame_id) {
+    drain(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    FrameRef* ref = pool->free_handles;
+    if (ref) {
+        pool->free_handles = ref->next;
+        pool->handles_in_use++;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    if (!ref) return NULL;
+
+    ref->data = data;
+    ref->size = size;
+    ref->width = width;
+    ref->height = height;
+    ref->timestamp_us = timestamp_us;
+    ref->frame_id = frame_id;
+    ref->refs = 1;
+    ref->retained = 0;
+    ref->owns_source = 0;
+    ref->copy_slot = -1;
+    memset(&ref->source, 0, sizeof(ref->source));
+    ref->next = NULL;
+    return ref;
+}
+
+FrameRef* FramePool_Begin(FramePool* pool, SourceFrame* frame, unsigned int width,
+                          unsigned int height, int64_t timestamp_us, int frame_id) {
+    if (!pool || !frame) return NULL;
+
+    FrameRef* ref = take_handle(pool, frame->data, frame->size, width, height,
+                                timestamp_us, frame_id);
+    if (!ref) return NULL;
+
+    // The handle owns the source frame from here on
+    ref->owns_source = 1;
+    ref->source = *frame;
+    frame->data = NULL;
+    frame->vdo_buffer = NULL;
+    return ref;
+}
+
+FrameRef* FramePool_Begin_Detached(FramePool* pool, const void* data, size_t size,
+                                   unsigned int width, unsigned int height,
+                                   int64_t timestamp_us, int frame_id) {
+    if (!pool || !data) return NULL;
+    return take_handle(pool, data, size, width, height, timestamp_us, frame_id);
+}
+
+void FramePool_End(FramePool* pool, FrameRef* ref) {
+    if (!pool || !ref) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    int release_now = 0;
+    // Copied (or never retained): the source frame goes back right away
+    if (ref->owns_source && (ref->copy_slot >= 0 || !ref->retained)) {
+        ref->owns_source = 0;
+        release_now = 1;
+    }
+    SourceFrame source = ref->source;
+    if (--ref->refs == 0) {
+        finish(pool, ref);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+
+    if (release_now) {
+        FrameSource_Release_Frame(pool->source, &source);
+    }
+    drain(pool);
+}
+
+FrameRef* FrameRef_Retain(FrameRef* ref) {
+    if (!ref || !ref->pool) return NULL;
+    FramePool* pool = ref->pool;
+
+    pthread_mutex_lock(&pool->mutex);
+    if (ref->refs <= 0) {
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+    if (ref->retained) {
+        ref->refs++;
+        pool->retains++;
+        pthread_mutex_unlock(&pool->mutex);
+        return ref;
+    }
+
+    // Zero-copy while the VDO pool can spare the buffer
+    if (ref->source.vdo_buffer && pool->vdo_held < pool->vdo_retain_max) {
+        pool->vdo_held++;
+        if (pool->vdo_held > pool->vdo_held_max) pool->vdo_held_max = pool->vdo_held;
+        ref->retained = 1;
+        ref->refs++;
+        pool->retains++;
+        pool->retains_zero_copy++;
+        pthread_mutex_unlock(&pool->mutex);
+        return ref;
+    }
+
+    // Copy-on-retain into a pooled buffer
+    int slot = -1;
+    for (int i = 0; i < pool->copy_count && slot < 0; i++) {
+        if (!pool->copy_busy[i]) slot = i;
+    }
+    if (slot < 0) {
+        pool->retain_failures++;
+        pthread_mutex_unlock(&pool->mutex);
+        return NULL;
+    }
+    pool->copy_busy[slot] = 1;
+    pool->copies_in_use++;
+    if (pool->copies_in_use > pool->copies_max) pool->copies_max = pool->copies_in_use;
+    pthread_mutex_unlock(&pool->mutex);
+
+    // The pipeline still holds its reference, so the pixels cannot go away
+    if (pool->copy_size[slot] < ref->size) {
+        uint8_t* grown = (uint8_t*)realloc(pool->copies[slot], ref->size);
+        if (!grown) {
+            LOG_ERR("FramePool: Failed to allocate %zu byte copy\n", ref->size);
+            pthread_mutex_lock(&pool->mutex);
+            pool->copy_busy[slot] = 0;
+            pool->copies_in_use--;
+            pool->retain_failures++;
+            pthread_mutex_unlock(&pool->mutex);
+            return NULL;
+        }
+        pool->copies[slot] = grown;
+        pool->copy_size[slot] = ref->size;
+    }
+    memcpy(pool->copies[slot], ref->data, ref->size);
+
+    pthread_mutex_lock(&pool->mutex);
+    ref->data = pool->copies[slot];
+    ref->copy_slot = slot;
+    ref->retained = 1;
+    ref->refs++;
+    pool->retains++;
+    pool->retains_copied++;
+    pthread_mutex_unlock(&pool->mutex);
+    return ref;
+}
+
+void FrameRef_Release(FrameRef* ref) {
+    if (!ref || !ref->pool) return;
+    FramePool* pool = ref->pool;
+
+    pthread_mutex_lock(&pool->mutex);
+    if (ref->refs <= 0) {
+        pthread_mutex_unlock(&pool->mutex);
+        LOG_WARN("FramePool: Release of unreferenced frame %d\n", ref->frame_id);
+        return;
+    }
+    if (--ref->refs == 0) {
+        if (ref->owns_source) pool->deferred_releases++;
+        finish(pool, ref);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+cJSON* FramePool_Stats_JSON(FramePool* pool) {
+    cJSON* json = cJSON_CreateObject();
+    if (!pool) return json;
+
+    pthread_mutex_lock(&pool->mutex);
+    cJSON_AddNumberToObject(json, "source_buffers", pool->source ? pool->source->buffer_count : 0);
+    cJSON_AddNumberToObject(json, "vdo_retain_max", pool->vdo_retain_max);
+    cJSON_AddNumberToObject(json, "vdo_held", pool->vdo_held);
+    cJSON_AddNumberToObject(json, "vdo_held_max", pool->vdo_held_max);
+    cJSON_AddNumberToObject(json, "copy_buffers", pool->copy_count);
+    cJSON_AddNumberToObject(json, "copies_in_use", pool->copies_in_use);
+    cJSON_AddNumberToObject(json, "copies_max", pool->copies_max);
+    cJSON_AddNumberToObject(json, "handles_in_use", pool->handles_in_use);
+    cJSON_AddNumberToObject(json, "retains", (double)pool->retains);
+    cJSON_AddNumberToObject(json, "retains_zero_copy", (double)pool->retains_zero_copy);
+    cJSON_AddNumberToObject(json, "retains_copied", (double)pool->retains_copied);
+    cJSON_AddNumberToObject(json, "retain_failures", (double)pool->retain_failures);
+    cJSON_AddNumberToObject(json, "deferred_releases", (double)pool->deferred_releases);
+    pthread_mutex_unlock(&pool->mutex);
+    return json;
+}
+
+void FramePool_Cleanup(FramePool* pool) {
+    if (!pool) return;
+
+    drain(pool);
+    if (pool->handles_in_use > 0) {
+        LOG_WARN("FramePool: %d frames still retained at cleanup\n", pool->handles_in_use);
+    }
+
+    LOG("FramePool cleanup: Retains=%llu ZeroCopy=%llu Copied=%llu Failures=%llu\n",
+        (unsigned long long)pool->retains, (unsigned long long)pool->retains_zero_copy,
+        (unsigned long long)pool->retains_copied, (unsigned long long)pool->retain_failures);
+
+    for (int i = 0; i < pool->copy_count; i++) {
+        free(pool->copies[i]);
+    }
+    free(pool->handles);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool);
+}
@@ -0,0 +1,115 @@
+/**
+ * frame_pool.h
+ *
+ * Reference-counted frame retention for Axis I.S. POC
+ * Every pipeline frame is wrapped in a FrameRef holding one reference for
+ * core_process_frame. A module that wants the pixels after process()
+ * returns (async encode, upload, second-stage inference) takes its own
+ * reference with FrameRef_Retain() and drops it from any thread with
+ * FrameRef_Release().
+ *
+ * Retaining keeps the VDO buffer itself (zero-copy) while the stream's
+ * buffer pool can spare it - at least one buffer must stay free for
+ * capture. Otherwise, and for file/synthetic sources that reuse their
+ * buffer, the frame is copied once into a pooled buffer on first retain.
+ *
+ * Source buffers are only ever released on the pipeline thread: a last
+ * release from another thread queues the buffer, and the queue is drained
+ * at the next FramePool_Begin()/FramePool_End().
+ */
+
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+#include "frame_source.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FramePool FramePool;
+
+/* Frame handle - fields are read-only for modules */
+typedef struct FrameRef {
+    const void* data;               // NV12 pixels, valid while a reference is held
+    size_t size;
+    unsigned int width;
+    unsigned int height;
+    int64_t timestamp_us;
+    int frame_id;
+
+    // Pool bookkeeping
+    FramePool* pool;
+    int refs;
+    int retained;                   // A module took a reference this frame
+    int owns_source;                // Source frame still held (returned at last release)
+    int copy_slot;                  // Copy buffer index, -1 when zero-copy
+    SourceFrame source;
+    struct FrameRef* next;          // Free list / pending-release queue
+} FrameRef;
+
+/**
+ * Create the retention pool for a frame source
+ * @param config "frame_retention" object from core config (may be NULL)
+ * @return Pool pointer, NULL on failure
+ *
+ * Config keys:
+ *   copy_buffers      Pooled frame copies for copy-on-retain (default 4)
+ *   vdo_retain_max    VDO buffers modules may hold at once
+ *                     (default buffer_count - 2: one capturing, one spare)
+ */
+FramePool* FramePool_Init(cJSON* config, FrameSource* source);
+
+/**
+ * Wrap the frame just taken from the source (pipeline thread)
+ * @return Handle with one reference, NULL if every handle is in use
+ *         (the frame is then processed without retention support)
+ */
+FrameRef* FramePool_Begin(FramePool* pool, SourceFrame* frame, unsigned int width,
+                          unsigned int height, int64_t timestamp_us, int frame_id);
+
+/**
+ * Wrap pixels the pipeline owns itself (no source frame behind them,
+ * e.g. a private copy after early release); retaining always copies
+ */
+FrameRef* FramePool_Begin_Detached(FramePool* pool, const void* data, size_t size,
+                                   unsigned int width, unsigned int height,
+                                   int64_t timestamp_us, int frame_id);
+
+/**
+ * Drop the pipeline's reference (pipeline thread)
+ * The source frame is released now unless a module kept it zero-copy
+ */
+void FramePool_End(FramePool* pool, FrameRef* ref);
+
+/**
+ * Take a reference on a frame (normally from a module's process())
+ * @return ref on success, NULL when neither a VDO buffer nor a copy
+ *         buffer is available
+ */
+FrameRef* FrameRef_Retain(FrameRef* ref);
+
+/**
+ * Drop a reference taken with FrameRef_Retain() (any thread)
+ */
+void FrameRef_Release(FrameRef* ref);
+
+/**
+ * Get retention statistics as JSON (buffer pool size and pressure)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* FramePool_Stats_JSON(FramePool* pool);
+
+/**
+ * Free the pool - every retained frame must have been released
+ */
+void FramePool_Cleanup(FramePool* pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_POOL_H */
@@ -5,19 +5,24 @@
  * JPEG-encoded frames via MQTT.
  *
  * Features:
- * - JPEG encoding with configurable quality
+ * - Colour JPEG with configurable quality (shared frame view cache)
+ * - Full-resolution frames on request ("resolution": "high") from the
+ *   on-demand high-resolution stream
  * - Base64 encoding for MQTT transmission
  * - Rate limiting (max 1 frame/minute per camera)
  * - Frame metadata correlation
+ * - Best shot per object ("best_shot"): the sharpest, largest, most
+ *   confident image of each object, published when it leaves
  */
 
 #include "module.h"
+#include "core.h"
 #include "MQTT.h"
+#include "best_shot.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
-#include <jpeglib.h>
 #include <time.h>
 
 /* Undefine system LOG macros */
@@ -29,6 +34,27 @@
 #define LOG_WARN(fmt, args...)    { syslog(LOG_WARNING, "[frame_publisher] " fmt, ## args); printf("[frame_publisher] " fmt, ## args);}
 #define LOG_ERR(fmt, args...)    { syslog(3, "[frame_publisher] " fmt, ## args); fprintf(stderr, "[frame_publisher] " fmt, ## args);}
 
+#define HIRES_MAX_ATTEMPTS 10       // Frames to wait for a high-resolution match
+
+/* Blackboard slot "frame_publisher" - exported on frames that were sent */
+typedef struct {
+    uint64_t frames_sent;
+    uint64_t requests_received;
+    uint64_t requests_throttled;
+    size_t jpeg_size_bytes;
+    size_t base64_size_bytes;
+    uint64_t best_shots_sent;
+} FramePublisherSlot;
+
+static const BlackboardField frame_publisher_fields[] = {
+    BB_FIELD(FramePublisherSlot, frames_sent, BB_FIELD_UINT64),
+    BB_FIELD(FramePublisherSlot, requests_received, BB_FIELD_UINT64),
+    BB_FIELD(FramePublisherSlot, requests_throttled, BB_FIELD_UINT64),
+    BB_FIELD(FramePublisherSlot, jpeg_size_bytes, BB_FIELD_SIZE),
+    BB_FIELD(FramePublisherSlot, base64_size_bytes, BB_FIELD_SIZE),
+    BB_FIELD(FramePublisherSlot, best_shots_sent, BB_FIELD_UINT64)
+};
+
 /* Module state */
 typedef struct {
     bool enabled;
@@ -44,8 +70,16 @@ typedef struct {
 
     /* Current frame request */
     bool frame_requested;
+    bool high_resolution;       // Wants the high-resolution stream
+    int hires_attempts;         // Frames tried so far for a high-resolution match
     char request_id[128];
     char request_reason[256];
+
+    /* Best shot per object */
+    BestShot* best_shot;        // NULL unless "best_shot" is configured
+    unsigned long best_shots_sent;
+
+    int slot;                   // Blackboard slot ID
 } FramePublisherState;
 
 /* Global state pointer for MQTT callback access */
@@ -85,73 +119,6 @@ static char* base64_encode(const unsigned char* data, size_t input_length, size_
     return encoded;
 }
 
-/**
- * Encode YUV frame to JPEG
- */
-static unsigned char* encode_yuv_to_jpeg(const unsigned char* yuv_data, int width, int height,
-                                         int quality, size_t* jpeg_size) {
-    struct jpeg_compress_struct cinfo;
-    struct jpeg_error_mgr jerr;
-    unsigned char* jpeg_buffer = NULL;
-    unsigned long jpeg_buffer_size = 0;
-
-    // Initialize JPEG compression
-    cinfo.err = jpeg_std_error(&jerr);
-    jpeg_create_compress(&cinfo);
-
-    // Output to memory buffer
-    jpeg_mem_dest(&cinfo, &jpeg_buffer, &jpeg_buffer_size);
-
-    // Set compression parameters
-    cinfo.image_width = width;
-    cinfo.image_height = height;
-    cinfo.input_components = 3;  // RGB
-    cinfo.in_color_space = JCS_RGB;
-
-    jpeg_set_defaults(&cinfo);
-    jpeg_set_quality(&cinfo, quality, TRUE);
-
-    // Start compression
-    jpeg_start_compress(&cinfo, TRUE);
-
-    // Convert YUV to RGB and compress line by line
-    unsigned char* rgb_row = malloc(width * 3);
-    if (!rgb_row) {
-        jpeg_destroy_compress(&cinfo);
-        return NULL;
-    }
-
-    for (int y = 0; y < height; y++) {
-        // Simple YUV to RGB conversion (Y component only for grayscale)
-        // For full color, you'd need proper YUV->RGB conversion
-        for (int x = 0; x < width; x++) {
-            unsigned char Y = yuv_data[y * width + x];
-            rgb_row[x * 3 + 0] = Y;  // R
-            rgb_row[x * 3 + 1] = Y;  // G
-            rgb_row[x * 3 + 2] = Y;  // B
-        }
-
-        JSAMPROW row_pointer[1] = { rgb_row };
-        jpeg_write_scanlines(&cinfo, row_pointer, 1);
-    }
-
-    free(rgb_row);
-    jpeg_finish_compress(&cinfo);
-
-    *jpeg_size = jpeg_buffer_size;
-
-    // Copy buffer (jpeg_mem_dest allocates its own buffer)
-    unsigned char* result = malloc(jpeg_buffer_size);
-    if (result) {
-        memcpy(result, jpeg_buffer, jpeg_buffer_size);
-    }
-
-    free(jpeg_buffer);
-    jpeg_destroy_compress(&cinfo);
-
-    return result;
-}
-
 /**
  * MQTT callback for frame requests
  * Called by MQTT library when message arrives on subscribed topic
@@ -180,6 +147,7 @@ void frame_request_callback(const char* topic, const char* payload) {
 
     cJSON* req_id = cJSON_GetObjectItem(req, "request_id");
     cJSON* reason = cJSON_GetObjectItem(req, "reason");
+    cJSON* resolution = cJSON_GetObjectItem(req, "resolution");
 
     if (req_id && req_id->valuestring) {
         strncpy(state->request_id, req_id->valuestring, sizeof(state->request_id) - 1);
@@ -200,6 +168,9 @@ void frame_request_callback(const char* topic, const char* payload) {
     }
 
     // Mark frame as requested (will be processed in next process() call)
+    state->high_resolution = resolution && cJSON_IsString(resolution) &&
+                             strcmp(resolution->valuestring, "high") == 0;
+    state->hires_attempts = 0;
     state->frame_requested = true;
 
     LOG("Frame requested: id=%s reason=%s\n", state->request_id, state->request_reason);
@@ -207,6 +178,57 @@ void frame_request_callback(const char* topic, const char* payload) {
     cJSON_Delete(req);
 }
 
+/**
+ * Publish an object's best shot (called from BestShot_End_Frame)
+ */
+static void publish_best_shot(const BestShotImage* image, void* user) {
+    FramePublisherState* state = (FramePublisherState*)user;
+
+    size_t base64_size = 0;
+    char* base64_data = base64_encode(image->jpeg, image->jpeg_size, &base64_size);
+    if (!base64_data) {
+        LOG_ERR("Failed to Base64 encode best shot\n");
+        return;
+    }
+
+    cJSON* msg = cJSON_CreateObject();
+    cJSON_AddNumberToObject(msg, "timestamp_us", image->timestamp_us);
+    cJSON_AddNumberToObject(msg, "frame_id", image->frame_id);
+    cJSON_AddNumberToObject(msg, "first_seen_us", image->first_seen_us);
+    cJSON_AddNumberToObject(msg, "last_seen_us", image->last_seen_us);
+    if (image->track >= 0) cJSON_AddNumberToObject(msg, "track_id", image->track);
+    cJSON_AddNumberToObject(msg, "class_id", image->class_id);
+    cJSON_AddNumberToObject(msg, "confidence", image->confidence);
+    cJSON* box = cJSON_CreateObject();
+    cJSON_AddNumberToObject(box, "x", image->x);
+    cJSON_AddNumberToObject(box, "y", image->y);
+    cJSON_AddNumberToObject(box, "width", image->box_width);
+    cJSON_AddNumberToObject(box, "height", image->box_height);
+    cJSON_AddItemToObject(msg, "box", box);
+    cJSON_AddNumberToObject(msg, "sharpness", image->sharpness);
+    cJSON_AddNumberToObject(msg, "score", image->score);
+    cJSON_AddNumberToObject(msg, "candidates", image->candidates);
+    cJSON_AddStringToObject(msg, "image", image->crop ? "crop" : "frame");
+    cJSON_AddNumberToObject(msg, "width", image->width);
+    cJSON_AddNumberToObject(msg, "height", image->height);
+    cJSON_AddStringToObject(msg, "format", "jpeg");
+    cJSON_AddNumberToObject(msg, "jpeg_size", image->jpeg_size);
+    cJSON_AddStringToObject(msg, "image_base64", base64_data);
+
+    char topic[256];
+    snprintf(topic, sizeof(topic), "axis-is/camera/%s/best_shot", state->camera_id);
+    if (MQTT_Publish_JSON(topic, msg, 1, 0) == 0) {
+        state->best_shots_sent++;
+        LOG("Best shot published: class=%d %ux%u %zu bytes (best of %d)\n", image->class_id,
+            image->width, image->height, image->jpeg_size, image->candidates);
+    } else {
+        LOG_ERR("Failed to publish best shot\n");
+    }
+
+    free(base64_data);
+    cJSON_Delete(msg);
+}
+
 /**
  * Initialize frame publisher module
  */
@@ -245,6 +267,9 @@ static int frame_publisher_init(ModuleContext* ctx, cJSON* config) {
     state->requests_throttled = 0;
     state->frame_requested = false;
 
+    state->best_shot = BestShot_Create(cJSON_GetObjectItem(config, "best_shot"),
+                                       publish_best_shot, state);
+
     // Set global state pointer for MQTT callback access
     g_frame_publisher_state = state;
 
@@ -257,6 +282,10 @@ static int frame_publisher_init(ModuleContext* ctx, cJSON* config) {
     LOG("Configuration: quality=%d rate_limit=%ds\n",
         state->jpeg_quality, state->rate_limit_seconds);
 
+    state->slot = Blackboard_Register(ctx->core->blackboard, "frame_publisher",
+                                      sizeof(FramePublisherSlot), frame_publisher_fields,
+                                      BB_FIELD_COUNT(frame_publisher_fields));
+
     ctx->module_state = state;
     return AXIS_IS_MODULE_SUCCESS;
 }
@@ -271,37 +300,67 @@ static int frame_publisher_process(ModuleContext* ctx, FrameData* frame) {
         return AXIS_IS_MODULE_SKIP;
     }
 
+    // Best shots: offer every detection, publish objects that left
+    if (state->best_shot && frame->metadata) {
+        unsigned long sent = state->best_shots_sent;
+        for (int i = 0; i < frame->metadata->detection_count; i++) {
+            BestShot_Offer(state->best_shot, frame, -1, &frame->metadata->detections[i]);
+        }
+        BestShot_End_Frame(state->best_shot, frame->timestamp_us);
+
+        FramePublisherSlot* slot = state->best_shots_sent != sent ?
+            (FramePublisherSlot*)Blackboard_Write(frame->metadata->blackboard, state->slot) : NULL;
+        if (slot) slot->best_shots_sent = state->best_shots_sent;
+    }
+
     // Check if frame was requested
     if (!state->frame_requested) {
         return AXIS_IS_MODULE_SKIP;
     }
 
+    // Full resolution: the stream opens on the first request, so its first
+    // frames only match later analytics frames - keep trying for a few
+    FrameViews* views = frame->views;
+    unsigned int width = frame->width;
+    unsigned int height = frame->height;
+    HiResFrame hires;
+    if (state->high_resolution && frame->hires) {
+        if (HiRes_Get_Frame(frame->hires, frame->capture_us, &hires)) {
+            views = hires.views;
+            width = hires.width;
+            height = hires.height;
+        } else if (++state->hires_attempts < HIRES_MAX_ATTEMPTS) {
+            return AXIS_IS_MODULE_SKIP;
+        } else {
+            LOG_WARN("No high-resolution frame for %s, sending the analytics frame\n",
+                     state->request_id);
+        }
+    }
+
     // Reset request flag
     state->frame_requested = false;
 
-    LOG("Processing frame request: %s\n", state->request_id);
+    if (views == frame->views && !frame->frame_data) {
+        LOG_WARN("Frame %s not available - early_release mode model_input drops the full frame\n",
+                 state->request_id);
+        return AXIS_IS_MODULE_SKIP;
+    }
 
-    // Encode frame to JPEG
-    size_t jpeg_size = 0;
-    unsigned char* jpeg_data = encode_yuv_to_jpeg(
-        frame->frame_data,
-        frame->width,
-        frame->height,
-        state->jpeg_quality,
-        &jpeg_size
-    );
+    LOG("Processing frame request: %s (%ux%u)\n", state->request_id, width, height);
 
-    if (!jpeg_data) {
+    // Encode frame to JPEG - any other module asking for the same quality gets it free
+    FrameView jpeg;
+    if (!Views_JPEG(views, state->jpeg_quality, &jpeg)) {
         LOG_ERR("Failed to encode JPEG\n");
         return AXIS_IS_MODULE_ERROR;
     }
+    size_t jpeg_size = jpeg.size;
 
     LOG("JPEG encoded: %zu bytes (quality=%d)\n", jpeg_size, state->jpeg_quality);
 
     // Base64 encode JPEG
     size_t base64_size = 0;
-    char* base64_data = base64_encode(jpeg_data, jpeg_size, &base64_size);
-    free(jpeg_data);
+    char* base64_data = base64_encode(jpeg.data, jpeg_size, &base64_size);
 
     if (!base64_data) {
         LOG_ERR("Failed to Base64 encode\n");
@@ -315,8 +374,8 @@ static int frame_publisher_process(ModuleContext* ctx, FrameData* frame) {
     cJSON_AddStringToObject(msg, "request_id", state->request_id);
     cJSON_AddNumberToObject(msg, "timestamp_us", frame->timestamp_us);
     cJSON_AddNumberToObject(msg, "frame_id", frame->frame_id);
-    cJSON_AddNumberToObject(msg, "width", frame->width);
-    cJSON_AddNumberToObject(msg, "height", frame->height);
+    cJSON_AddNumberToObject(msg, "width", width);
+    cJSON_AddNumberToObject(msg, "height", height);
     cJSON_AddStringToObject(msg, "format", "jpeg");
     cJSON_AddNumberToObject(msg, "quality", state->jpeg_quality);
     cJSON_AddNumberToObject(msg, "jpeg_size", jpeg_size);
@@ -342,13 +401,16 @@ static int frame_publisher_process(ModuleContext* ctx, FrameData* frame) {
     cJSON_Delete(msg);
 
     // Add module metadata
-    cJSON* module_data = cJSON_CreateObject();
-    cJSON_AddNumberToObject(module_data, "frames_sent", state->frames_sent);
-    cJSON_AddNumberToObject(module_data, "requests_received", state->requests_received);
-    cJSON_AddNumberToObject(module_data, "requests_throttled", state->requests_throttled);
-    cJSON_AddNumberToObject(module_data, "jpeg_size_bytes", jpeg_size);
-    cJSON_AddNumberToObject(module_data, "base64_size_bytes", base64_size);
-    cJSON_AddItemToObject(frame->metadata->custom_data, "frame_publisher", module_data);
+    FramePublisherSlot* slot = (FramePublisherSlot*)Blackboard_Write(frame->metadata->blackboard,
+                                                                     state->slot);
+    if (slot) {
+        slot->frames_sent = state->frames_sent;
+        slot->requests_received = state->requests_received;
+        slot->requests_throttled = state->requests_throttled;
+        slot->jpeg_size_bytes = jpeg_size;
+        slot->base64_size_bytes = base64_size;
+        slot->best_shots_sent = state->best_shots_sent;
+    }
 
     return result == 0 ? AXIS_IS_MODULE_SUCCESS : AXIS_IS_MODULE_ERROR;
 }
@@ -360,8 +422,9 @@ static void frame_publisher_cleanup(ModuleContext* ctx) {
     FramePublisherState* state = (FramePublisherState*)ctx->module_state;
 
     if (state) {
-        LOG("Cleanup: sent %lu frames, throttled %lu requests\n",
-            state->frames_sent, state->requests_throttled);
+        LOG("Cleanup: sent %lu frames, %lu best shots, throttled %lu requests\n",
+            state->frames_sent, state->best_shots_sent, state->requests_throttled);
+        BestShot_Destroy(state->best_shot);
 
         // Unsubscribe from MQTT topic
         char topic[256];
@@ -0,0 +1,124 @@
+/**
+ * frame_source.h
+ *
+ * Pluggable frame sources for Axis I.S. POC
+ * The pipeline pulls frames through this interface so it can run on a
+ * camera (VDO), from a recorded Y4M/raw NV12 file or capture log segment, or
+ * from a synthetic moving-pattern generator on a plain Linux host. File and
+ * synthetic frames are NV12; the VDO stream format is negotiated for the model
+ */
+
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+#include "vdo_handler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FRAME_SOURCE_VDO_BUFFERS 4    // Default VDO buffer.count
+
+typedef enum {
+    FRAME_SOURCE_VDO = 0,
+    FRAME_SOURCE_FILE,
+    FRAME_SOURCE_SYNTHETIC
+} FrameSourceType;
+
+/* Frame handed out by a source - valid until released */
+typedef struct {
+    void* data;                 // Pixels in the source's format (NV12: Y plane, interleaved UV)
+    size_t size;                // Bytes at data
+    VdoBuffer* vdo_buffer;      // Underlying VDO buffer, NULL for non-VDO sources
+    uint64_t index;             // Source frame counter
+    int64_t capture_us;         // Capture time: VDO timestamp, else monotonic clock at get
+} SourceFrame;
+
+typedef struct FrameSource FrameSource;
+
+/* Source implementation */
+typedef struct {
+    int (*get_frame)(FrameSource* src, SourceFrame* frame);
+    void (*release_frame)(FrameSource* src, SourceFrame* frame);
+    void (*cleanup)(FrameSource* src);
+} FrameSourceOps;
+
+struct FrameSource {
+    const FrameSourceOps* ops;
+    FrameSourceType type;
+    unsigned int width;
+    unsigned int height;
+    unsigned int fps;
+    VdoFormat format;           // VDO_FORMAT_YUV (NV12), or RGB / planar RGB from VDO
+    int free_running;           // Source paces itself (or not at all) - caller must not throttle
+    unsigned int buffer_count;  // Frames that may be held at once (VDO buffer.count, else 1)
+    unsigned int frames_captured;
+    unsigned int frames_dropped;
+    int eof;                    // Non-looping file source reached its end
+    void* impl;
+};
+
+/**
+ * Create the frame source selected by configuration
+ * @param config "frame_source" object from core.json (NULL selects VDO)
+ * @param width Pipeline frame width (used by VDO, synthetic and raw NV12)
+ * @param height Pipeline frame height
+ * @param fps Target frames per second
+ * @return FrameSource pointer on success, NULL on failure
+ *
+ * Config keys:
+ *   type    "vdo" (default), "file" or "synthetic"
+ *   path    File to read (file source)
+ *   format  "auto" (default, detects Y4M and capture headers), "y4m", "nv12" or "capture"
+ *   width, height  Raw NV12 dimensions (default: pipeline size)
+ *   fps     Pacing rate (default: Y4M header rate or target fps)
+ *   loop    Restart at end of file (default true)
+ *   paced   Deliver frames in real time, false runs as fast as possible (default true)
+ *   buffer_count  VDO stream buffers, >= 2 (default FRAME_SOURCE_VDO_BUFFERS)
+ *   vdo_formats   VDO formats in order of preference ("yuv", "rgb", "planar_rgb"),
+ *                 "auto" (default) tries model_format, then yuv
+ *   model_format  Input layout of the model, "rgb" (default) or "planar_rgb"
+ */
+FrameSource* FrameSource_Init(cJSON* config, unsigned int width, unsigned int height,
+                              unsigned int fps);
+
+/**
+ * Get next frame
+ * @param src Frame source
+ * @param frame Output frame
+ * @return 1 on success, 0 on failure (or end of a non-looping file)
+ *
+ * IMPORTANT: Only a VDO source hands out more than one frame at a time (up to
+ * buffer_count); for the others call FrameSource_Release_Frame() before the next get
+ */
+int FrameSource_Get_Frame(FrameSource* src, SourceFrame* frame);
+
+/**
+ * Release a frame obtained with FrameSource_Get_Frame()
+ */
+void FrameSource_Release_Frame(FrameSource* src, SourceFrame* frame);
+
+/**
+ * Get the VDO context behind a VDO source
+ * @return VdoContext pointer, or NULL for other source types
+ */
+VdoContext* FrameSource_Get_Vdo(FrameSource* src);
+
+/**
+ * Source type name for logs and metrics
+ */
+const char* FrameSource_Type_Name(FrameSource* src);
+
+/**
+ * Cleanup frame source resources
+ */
+void FrameSource_Cleanup(FrameSource* src);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_SOURCE_H */
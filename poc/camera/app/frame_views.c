@@ -0,0 +1,476 @@
+/**
+ * frame_views.c
+ *
+ * Per-frame derived-image cache implementation for Axis I.S. POC
+ *
+ * A view is identified by its kind and up to six integer parameters. Each
+ * cache entry keeps its buffer between frames; a miss reuses the stale
+ * entry with the same key first (same size, no realloc), then any stale
+ * entry, so the steady state makes no allocations.
+ *
+ * After Views_Detach_Frame() only views already computed for the frame
+ * can be served; anything else is refused.
+ *
+ * Colour conversion is full-range BT.601 (JFIF), scaling is nearest
+ * neighbour. Frames are assumed packed (stride == width, planes back to
+ * back).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "frame_views.h"
+#include "jpeg_encoder.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define VIEW_KEY_LEN 6
+
+typedef struct {
+    ViewKind kind;
+    int key[VIEW_KEY_LEN];
+    uint64_t frame;                 // Frame the view was computed for, 0 = never
+    uint8_t* buffer;
+    size_t capacity;
+    FrameView view;
+} ViewEntry;
+
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t bytes;                 // Bytes produced by misses
+} ViewKindStats;
+
+struct FrameViews {
+    const uint8_t* pixels;
+    ViewsFormat format;
+    unsigned int width;
+    unsigned int height;
+    uint64_t frame;                 // Current frame stamp, 0 outside a frame
+    uint64_t frames;                // Frames bound so far
+
+    ViewEntry entries[VIEWS_MAX_ENTRIES];
+    uint8_t* row;                   // JPEG scanline scratch
+    size_t row_capacity;
+
+    ViewKindStats stats[VIEW_KIND_COUNT];
+    uint64_t cache_full;            // Requests refused, every entry in use this frame
+};
+
+static const char* kind_names[VIEW_KIND_COUNT] = {
+    "gray", "rgb", "jpeg", "crop_gray", "crop_rgb"
+};
+
+static uint8_t clamp_u8(int value) {
+    return (uint8_t)(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+/* Full-range BT.601 luma, 8.8 fixed point: 0.299, 0.587, 0.114 */
+static uint8_t rgb_luma(int r, int g, int b) {
+    return (uint8_t)((77 * r + 150 * g + 29 * b + 128) >> 8);
+}
+
+static ViewEntry* lookup(FrameViews* views, ViewKind kind, const int* key) {
+    for (int i = 0; i < VIEWS_MAX_ENTRIES; i++) {
+        ViewEntry* e = &views->entries[i];
+        if (e->frame == views->frame && e->kind == kind &&
+            memcmp(e->key, key, sizeof(e->key)) == 0) {
+            views->stats[kind].hits++;
+            return e;
+        }
+    }
+    return NULL;
+}
+
+/* Claim an entry for a new view of need bytes (0 lets the producer size it) */
+static ViewEntry* acquire(FrameViews* views, ViewKind kind, const int* key, size_t need) {
+    ViewEntry* chosen = NULL;
+    for (int i = 0; i < VIEWS_MAX_ENTRIES && !chosen; i++) {
+        ViewEntry* e = &views->entries[i];
+        if (e->frame != views->frame && e->kind == kind &&
+            memcmp(e->key, key, sizeof(e->key)) == 0) {
+            chosen = e;
+        }
+    }
+    for (int i = 0; i < VIEWS_MAX_ENTRIES && !chosen; i++) {
+        ViewEntry* e = &views->entries[i];
+        if (e->frame != views->frame && e->capacity >= need) chosen = e;
+    }
+    for (int i = 0; i < VIEWS_MAX_ENTRIES && !chosen; i++) {
+        ViewEntry* e = &views->entries[i];
+        if (e->frame != views->frame) chosen = e;
+    }
+    if (!chosen) {
+        views->cache_full++;
+        return NULL;
+    }
+
+    if (need > chosen->capacity) {
+        uint8_t* grown = (uint8_t*)realloc(chosen->buffer, need);
+        if (!grown) {
+            LOG_ERR("Views: Failed to allocate %zu bytes\n", need);
+            return NULL;
+        }
+        chosen->buffer = grown;
+        chosen->capacity = need;
+    }
+
+    chosen->kind = kind;
+    memcpy(chosen->key, key, sizeof(chosen->key));
+    chosen->frame = 0;              // Not valid until the producer commits
+    views->stats[kind].misses++;
+    return chosen;
+}
+
+static void commit(FrameViews* views, ViewEntry* e, size_t size,
+                   unsigned int width, unsigned int height, unsigned int stride, FrameView* out) {
+    e->view.data = e->buffer;
+    e->view.size = size;
+    e->view.width = width;
+    e->view.height = height;
+    e->view.stride = stride;
+    e->frame = views->frame;
+    views->stats[e->kind].bytes += size;
+    *out = e->view;
+}
+
+/* Nearest-neighbour resample of a frame region to gray or RGB */
+static void resample(const FrameViews* views, int x0, int y0, int width, int height,
+                     unsigned int out_width, unsigned int out_height, int rgb, uint8_t* dst) {
+    size_t plane = (size_t)views->width * views->height;
+    uint32_t step_x = (uint32_t)(((uint64_t)width << 16) / out_width);
+    uint32_t step_y = (uint32_t)(((uint64_t)height << 16) / out_height);
+
+    uint32_t fy = 0;
+    for (unsigned int y = 0; y < out_height; y++, fy += step_y) {
+        int sy = y0 + (int)(fy >> 16);
+        uint32_t fx = 0;
+
+        if (views->format == VIEWS_FORMAT_RGB) {
+            const uint8_t* row = views->pixels + (size_t)sy * views->width * 3;
+            for (unsigned int x = 0; x < out_width; x++, fx += step_x) {
+                const uint8_t* px = row + (size_t)(x0 + (int)(fx >> 16)) * 3;
+                if (rgb) {
+                    *dst++ = px[0];
+                    *dst++ = px[1];
+                    *dst++ = px[2];
+                } else {
+                    *dst++ = rgb_luma(px[0], px[1], px[2]);
+                }
+            }
+            continue;
+        }
+
+        if (views->format == VIEWS_FORMAT_PLANAR_RGB) {
+            const uint8_t* rrow = views->pixels + (size_t)sy * views->width;
+            const uint8_t* grow = rrow + plane;
+            const uint8_t* brow = grow + plane;
+            for (unsigned int x = 0; x < out_width; x++, fx += step_x) {
+                int sx = x0 + (int)(fx >> 16);
+                if (rgb) {
+                    *dst++ = rrow[sx];
+                    *dst++ = grow[sx];
+                    *dst++ = brow[sx];
+                } else {
+                    *dst++ = rgb_luma(rrow[sx], grow[sx], brow[sx]);
+                }
+            }
+            continue;
+        }
+
+        const uint8_t* yrow = views->pixels + (size_t)sy * views->width;
+        const uint8_t* uvrow = views->pixels + plane + (size_t)(sy >> 1) * views->width;
+        for (unsigned int x = 0; x < out_width; x++, fx += step_x) {
+            int sx = x0 + (int)(fx >> 16);
+            int Y = yrow[sx];
+            if (!rgb) {
+                *dst++ = (uint8_t)Y;
+                continue;
+            }
+            const uint8_t* uv = uvrow + (sx & ~1);
+            int cb = uv[0] - 128;
+            int cr = uv[1] - 128;
+            // 16.16 fixed point: 1.402, 0.344136, 0.714136, 1.772
+            *dst++ = clamp_u8(Y + ((91881 * cr) >> 16));
+            *dst++ = clamp_u8(Y - ((22554 * cb + 46802 * cr) >> 16));
+            *dst++ = clamp_u8(Y + ((116130 * cb) >> 16));
+        }
+    }
+}
+
+FrameViews* Views_Create(void) {
+    FrameViews* views = (FrameViews*)calloc(1, sizeof(FrameViews));
+    if (!views) {
+        LOG_ERR("Views: Failed to allocate context\n");
+    }
+    return views;
+}
+
+void Views_Destroy(FrameViews* views) {
+    if (!views) return;
+    for (int i = 0; i < VIEWS_MAX_ENTRIES; i++) {
+        free(views->entries[i].buffer);
+    }
+    free(views->row);
+    free(views);
+}
+
+void Views_Begin_Frame(FrameViews* views, const void* pixels, ViewsFormat format,
+                       unsigned int width, unsigned int height) {
+    if (!views) return;
+    views->pixels = (const uint8_t*)pixels;
+    views->format = format;
+    views->width = width;
+    views->height = height;
+    views->frame = ++views->frames;
+}
+
+void Views_Detach_Frame(FrameViews* views) {
+    if (views) views->pixels = NULL;
+}
+
+int Views_Luma(FrameViews* views, FrameView* out) {
+    if (!views || !views->frame || !out) return 0;
+    if (views->pixels) return Views_Gray(views, 0, out);
+
+    // Detached: the finest level computed before the pixels went away
+    for (int level = 0; level <= VIEWS_MAX_LEVEL; level++) {
+        int key[VIEW_KEY_LEN] = { level };
+        ViewEntry* e = lookup(views, VIEW_GRAY, key);
+        if (e) {
+            *out = e->view;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void Views_End_Frame(FrameViews* views) {
+    if (!views) return;
+    views->pixels = NULL;
+    views->frame = 0;
+}
+
+int Views_Gray(FrameViews* views, int level, FrameView* out) {
+    if (!views || !views->frame || !out || level < 0 || level > VIEWS_MAX_LEVEL) return 0;
+
+    // Level 0 of an NV12 frame is the luma plane as delivered
+    if (level == 0 && views->format == VIEWS_FORMAT_NV12) {
+        if (!views->pixels) return 0;
+        views->stats[VIEW_GRAY].hits++;
+        out->data = views->pixels;
+        out->width = views->width;
+        out->height = views->height;
+        out->stride = views->width;
+        out->size = (size_t)views->width * views->height;
+        return 1;
+    }
+
+    int key[VIEW_KEY_LEN] = { level };
+    ViewEntry* e = lookup(views, VIEW_GRAY, key);
+    if (e) {
+        *out = e->view;
+        return 1;
+    }
+
+    if (!views->pixels) return 0;
+
+    // RGB frames: level 0 is converted once, the pyramid builds on it
+    if (level == 0) {
+        size_t size = (size_t)views->width * views->height;
+        e = acquire(views, VIEW_GRAY, key, size);
+        if (!e) return 0;
+        resample(views, 0, 0, (int)views->width, (int)views->height,
+                 views->width, views->height, 0, e->buffer);
+        commit(views, e, size, views->width, views->height, views->width, out);
+        return 1;
+    }
+
+    FrameView parent;
+    if (!Views_Gray(views, level - 1, &parent)) return 0;
+    unsigned int width = parent.width / 2;
+    unsigned int height = parent.height / 2;
+    if (width == 0 || height == 0) return 0;
+
+    e = acquire(views, VIEW_GRAY, key, (size_t)width * height);
+    if (!e) return 0;
+
+    uint8_t* dst = e->buffer;
+    for (unsigned int y = 0; y < height; y++) {
+        const uint8_t* r0 = parent.data + (size_t)(2 * y) * parent.stride;
+        const uint8_t* r1 = r0 + parent.stride;
+        for (unsigned int x = 0; x < width; x++) {
+            *dst++ = (uint8_t)((r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1] + 2) >> 2);
+        }
+    }
+    commit(views, e, (size_t)width * height, width, height, width, out);
+    return 1;
+}
+
+int Views_RGB(FrameViews* views, unsigned int width, unsigned int height, FrameView* out) {
+    if (!views || !views->frame || !out) return 0;
+    if (width == 0) width = views->width;
+    if (height == 0) height = views->height;
+
+    // An RGB frame at the requested size is the view
+    if (views->format == VIEWS_FORMAT_RGB && views->pixels &&
+        width == views->width && height == views->height) {
+        views->stats[VIEW_RGB].hits++;
+        out->data = views->pixels;
+        out->width = width;
+        out->height = height;
+        out->stride = width * 3;
+        out->size = (size_t)width * height * 3;
+        return 1;
+    }
+
+    int key[VIEW_KEY_LEN] = { (int)width, (int)height };
+    ViewEntry* e = lookup(views, VIEW_RGB, key);
+    if (e) {
+        *out = e->view;
+        return 1;
+    }
+
+    if (!views->pixels) return 0;
+    size_t size = (size_t)width * height * 3;
+    e = acquire(views, VIEW_RGB, key, size);
+    if (!e) return 0;
+
+    resample(views, 0, 0, (int)views->width, (int)views->height, width, height, 1, e->buffer);
+    commit(views, e, size, width, height, width * 3, out);
+    return 1;
+}
+
+int Views_Crop(FrameViews* views, int x, int y, int width, int height,
+               unsigned int out_width, unsigned int out_height, int rgb, FrameView* out) {
+    if (!views || !views->frame || !out) return 0;
+
+    // Clip to the frame
+    if (x < 0) { width += x; x = 0; }
+    if (y < 0) { height += y; y = 0; }
+    if (x + width > (int)views->width) width = (int)views->width - x;
+    if (y + height > (int)views->height) height = (int)views->height - y;
+    if (width <= 0 || height <= 0) return 0;
+    if (out_width == 0) out_width = (unsigned int)width;
+    if (out_height == 0) out_height = (unsigned int)height;
+
+    ViewKind kind = rgb ? VIEW_CROP_RGB : VIEW_CROP_GRAY;
+    int key[VIEW_KEY_LEN] = { x, y, width, height, (int)out_width, (int)out_height };
+    ViewEntry* e = lookup(views, kind, key);
+    if (e) {
+        *out = e->view;
+        return 1;
+    }
+
+    if (!views->pixels) return 0;
+    unsigned int channels = rgb ? 3 : 1;
+    size_t size = (size_t)out_width * out_height * channels;
+    e = acquire(views, kind, key, size);
+    if (!e) return 0;
+
+    resample(views, x, y, width, height, out_width, out_height, rgb, e->buffer);
+    commit(views, e, size, out_width, out_height, out_width * channels, out);
+    return 1;
+}
+
+/* Rows of the bound frame as 3-byte pixels for the encoder */
+static const uint8_t* jpeg_row(unsigned int y, void* user) {
+    FrameViews* views = (FrameViews*)user;
+    unsigned int width = views->width;
+    size_t plane = (size_t)width * views->height;
+    uint8_t* dst = views->row;
+    if (views->format == VIEWS_FORMAT_PLANAR_RGB) {
+        const uint8_t* rrow = views->pixels + (size_t)y * width;
+        for (unsigned int x = 0; x < width; x++) {
+            *dst++ = rrow[x];
+            *dst++ = rrow[plane + x];
+            *dst++ = rrow[2 * plane + x];
+        }
+    } else {
+        // NV12 maps onto YCbCr without conversion
+        const uint8_t* yrow = views->pixels + (size_t)y * width;
+        const uint8_t* uvrow = views->pixels + plane + (size_t)(y >> 1) * width;
+        for (unsigned int x = 0; x < width; x++) {
+            const uint8_t* uv = uvrow + (x & ~1u);
+            *dst++ = yrow[x];
+            *dst++ = uv[0];
+            *dst++ = uv[1];
+        }
+    }
+    return views->row;
+}
+
+int Views_JPEG(FrameViews* views, int quality, FrameView* out) {
+    if (!views || !views->frame || !out) return 0;
+    if (quality < 1) quality = 1;
+    if (quality > 100) quality = 100;
+
+    int key[VIEW_KEY_LEN] = { quality };
+    ViewEntry* e = lookup(views, VIEW_JPEG, key);
+    if (e) {
+        *out = e->view;
+        return 1;
+    }
+
+    if (!views->pixels) return 0;
+    unsigned int width = views->width;
+    unsigned int height = views->height;
+    size_t row_bytes = (size_t)width * 3;
+    if (row_bytes > views->row_capacity) {
+        uint8_t* grown = (uint8_t*)realloc(views->row, row_bytes);
+        if (!grown) return 0;
+        views->row = grown;
+        views->row_capacity = row_bytes;
+    }
+
+    // Size 0: keep whatever buffer the entry already has, the encoder grows it
+    e = acquire(views, VIEW_JPEG, key, 0);
+    if (!e) return 0;
+
+    // Interleaved RGB rows go to libjpeg as they are
+    JpegImage image = {
+        .width = width, .height = height, .quality = quality,
+        .ycbcr = views->format == VIEWS_FORMAT_NV12,
+        .pixels = views->format == VIEWS_FORMAT_RGB ? views->pixels : NULL,
+        .row = jpeg_row, .user = views
+    };
+    JpegBuffer jpeg = { .data = e->buffer, .capacity = e->capacity };
+    size_t size = Jpeg_Encode(&image, &jpeg);
+    e->buffer = jpeg.data;
+    e->capacity = jpeg.capacity;
+    if (size == 0) {
+        LOG_ERR("Views: JPEG encoding failed\n");
+        return 0;
+    }
+    commit(views, e, size, width, height, 0, out);
+    return 1;
+}
+
+cJSON* Views_Stats_JSON(FrameViews* views) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", views != NULL);
+    if (!views) return json;
+
+    size_t pool_bytes = 0;
+    for (int i = 0; i < VIEWS_MAX_ENTRIES; i++) {
+        pool_bytes += views->entries[i].capacity;
+    }
+    cJSON_AddNumberToObject(json, "frames", (double)views->frames);
+    cJSON_AddNumberToObject(json, "pool_bytes", (double)pool_bytes);
+    cJSON_AddNumberToObject(json, "cache_full", (double)views->cache_full);
+
+    for (int k = 0; k < VIEW_KIND_COUNT; k++) {
+        cJSON* kind = cJSON_CreateObject();
+        cJSON_AddNumberToObject(kind, "hits", (double)views->stats[k].hits);
+        cJSON_AddNumberToObject(kind, "misses", (double)views->stats[k].misses);
+        cJSON_AddNumberToObject(kind, "bytes", (double)views->stats[k].bytes);
+        cJSON_AddItemToObject(json, kind_names[k], kind);
+    }
+    return json;
+}
@@ -0,0 +1,135 @@
+/**
+ * frame_views.h
+ *
+ * Per-frame derived-image cache for Axis I.S. POC
+ * Modules ask the frame for the view they need - a grayscale pyramid
+ * level, RGB at a given size, a JPEG, a crop - instead of deriving their
+ * own. Each distinct view is computed at most once per frame, on first
+ * request, into a buffer that is pooled across frames; later requests for
+ * the same view in the same frame are hits.
+ *
+ * Frames are NV12, interleaved RGB or planar RGB (whatever the stream was
+ * negotiated to); views come out the same for all three. Views that match
+ * the frame as delivered - gray level 0 of NV12, full-size RGB of an RGB
+ * frame - are the frame itself, no copy.
+ *
+ * Views are valid until Views_End_Frame() and must not be written to.
+ * Pipeline thread only.
+ */
+
+#ifndef FRAME_VIEWS_H
+#define FRAME_VIEWS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VIEWS_MAX_ENTRIES 16        // Distinct views per frame (pooled buffers)
+#define VIEWS_MAX_LEVEL 6           // Deepest grayscale pyramid level
+
+typedef struct FrameViews FrameViews;
+
+/* Pixel layout of the bound frame */
+typedef enum {
+    VIEWS_FORMAT_NV12 = 0,          // Y plane followed by interleaved CbCr
+    VIEWS_FORMAT_RGB,               // Interleaved RGB888
+    VIEWS_FORMAT_PLANAR_RGB         // R, G and B planes
+} ViewsFormat;
+
+typedef enum {
+    VIEW_GRAY = 0,                  // 8-bit luma, 1 byte per pixel
+    VIEW_RGB,                       // RGB888, 3 bytes per pixel
+    VIEW_JPEG,                      // Encoded JPEG, width/height of the image
+    VIEW_CROP_GRAY,
+    VIEW_CROP_RGB,
+    VIEW_KIND_COUNT
+} ViewKind;
+
+/* Derived image - owned by the cache */
+typedef struct {
+    const uint8_t* data;
+    size_t size;                    // Bytes at data
+    unsigned int width;
+    unsigned int height;
+    unsigned int stride;            // Bytes per row (0 for JPEG)
+} FrameView;
+
+/**
+ * Create an empty view cache
+ * @return Cache pointer, NULL on failure
+ */
+FrameViews* Views_Create(void);
+
+/**
+ * Free the cache and its pooled buffers
+ */
+void Views_Destroy(FrameViews* views);
+
+/**
+ * Bind the cache to a new frame - every view becomes stale
+ */
+void Views_Begin_Frame(FrameViews* views, const void* pixels, ViewsFormat format,
+                       unsigned int width, unsigned int height);
+
+/**
+ * Drop the pixels but keep the views computed so far for this frame
+ * (the frame buffer is returned early; later requests can only hit)
+ */
+void Views_Detach_Frame(FrameViews* views);
+
+/**
+ * Unbind the frame (pixels may be released after this)
+ */
+void Views_End_Frame(FrameViews* views);
+
+/**
+ * Grayscale pyramid level
+ * @param level 0 is full resolution (the luma plane itself for NV12), each
+ *              level halves both dimensions with a 2x2 box filter
+ * @return 1 on success, 0 on failure
+ */
+int Views_Gray(FrameViews* views, int level, FrameView* out);
+
+/**
+ * Finest grayscale image available - level 0, or after
+ * Views_Detach_Frame() the lowest pyramid level computed before it
+ */
+int Views_Luma(FrameViews* views, FrameView* out);
+
+/**
+ * Full-frame interleaved RGB888 scaled to width x height (e.g. model input size)
+ * @param width Output width, 0 for frame width
+ * @param height Output height, 0 for frame height
+ */
+int Views_RGB(FrameViews* views, unsigned int width, unsigned int height, FrameView* out);
+
+/**
+ * Full-frame colour JPEG
+ * @param quality JPEG quality 1-100
+ */
+int Views_JPEG(FrameViews* views, int quality, FrameView* out);
+
+/**
+ * Crop a frame region, optionally scaled
+ * @param x, y, width, height Region in frame pixels (clipped to the frame)
+ * @param out_width, out_height Output size, 0 for the region size
+ * @param rgb 1 for RGB888, 0 for grayscale
+ */
+int Views_Crop(FrameViews* views, int x, int y, int width, int height,
+               unsigned int out_width, unsigned int out_height, int rgb, FrameView* out);
+
+/**
+ * Get cache statistics as JSON (hits/misses per view kind)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Views_Stats_JSON(FrameViews* views);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAME_VIEWS_H */
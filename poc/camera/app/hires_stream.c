@@ -0,0 +1,320 @@
+/**
+ * hires_stream.c
+ *
+ * On-demand high-resolution stream implementation for Axis I.S. POC
+ *
+ * Matching: buffers are pulled oldest first until one is captured at or
+ * after the analytics frame, keeping whichever is closest. Frames that
+ * queued up while nobody asked are pulled through and released, so the
+ * loop is bounded by buffer_count plus one fresh frame.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include "hires_stream.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define HIRES_DEFAULT_WIDTH 1920
+#define HIRES_DEFAULT_HEIGHT 1080
+#define HIRES_DEFAULT_BUFFERS 3
+
+struct HiResStream {
+    FrameSource* analytics;
+    VdoContext* vdo;                // NULL while closed
+    unsigned int width;
+    unsigned int height;
+    unsigned int fps;
+    unsigned int buffer_count;
+    int64_t max_skew_us;
+    int64_t idle_stop_us;
+    int center_crop;                // Analytics stream is a centred crop of the field of view
+
+    // Match for the current analytics frame
+    int requested;                  // A module asked during this frame
+    int matched;                    // ... and got a frame
+    int64_t requested_for;          // Analytics capture_us asked for
+    VdoBuffer* held;
+    HiResFrame frame;
+    FrameViews* views;
+
+    int64_t last_request_us;        // Monotonic
+
+    // Statistics
+    uint64_t requests;
+    uint64_t matches;
+    uint64_t misses;
+    uint64_t pulls;                 // Buffers taken from the stream
+    uint64_t opens;
+    uint64_t closes;
+    int64_t skew_abs_total;
+    int64_t skew_abs_max;
+};
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int64_t abs_us(int64_t value) {
+    return value < 0 ? -value : value;
+}
+
+static int config_int(cJSON* config, const char* key, int def) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsNumber(item) ? item->valueint : def;
+}
+
+HiResStream* HiRes_Init(cJSON* config, FrameSource* analytics) {
+    cJSON* enabled = config ? cJSON_GetObjectItem(config, "enabled") : NULL;
+    if (enabled && !cJSON_IsTrue(enabled)) return NULL;
+    if (!FrameSource_Get_Vdo(analytics)) {
+        LOG("HiRes: %s source has no high-resolution stream\n", FrameSource_Type_Name(analytics));
+        return NULL;
+    }
+
+    HiResStream* hires = (HiResStream*)calloc(1, sizeof(HiResStream));
+    if (!hires) {
+        LOG_ERR("HiRes: Failed to allocate context\n");
+        return NULL;
+    }
+
+    hires->analytics = analytics;
+    hires->width = (unsigned int)config_int(config, "width", HIRES_DEFAULT_WIDTH);
+    hires->height = (unsigned int)config_int(config, "height", HIRES_DEFAULT_HEIGHT);
+    int fps = config_int(config, "fps", 0);
+    hires->fps = fps > 0 ? (unsigned int)fps : analytics->fps;
+    int buffers = config_int(config, "buffer_count", HIRES_DEFAULT_BUFFERS);
+    hires->buffer_count = buffers >= 2 ? (unsigned int)buffers : HIRES_DEFAULT_BUFFERS;
+    hires->max_skew_us = (int64_t)config_int(config, "max_skew_ms", 150) * 1000;
+    hires->idle_stop_us = (int64_t)config_int(config, "idle_stop_s", 10) * 1000000;
+
+    cJSON* crop = config ? cJSON_GetObjectItem(config, "analytics_crop") : NULL;
+    hires->center_crop = !(crop && cJSON_IsString(crop) && strcmp(crop->valuestring, "none") == 0);
+
+    hires->views = Views_Create();
+    if (!hires->views || hires->width == 0 || hires->height == 0) {
+        LOG_ERR("HiRes: Invalid configuration\n");
+        HiRes_Cleanup(hires);
+        return NULL;
+    }
+
+    LOG("HiRes: %ux%u @ %u FPS on demand (max skew %lldms, idle stop %llds)\n",
+        hires->width, hires->height, hires->fps,
+        (long long)(hires->max_skew_us / 1000), (long long)(hires->idle_stop_us / 1000000));
+    return hires;
+}
+
+static int open_stream(HiResStream* hires) {
+    hires->vdo = Vdo_Init(hires->width, hires->height, VDO_FORMAT_YUV, hires->fps,
+                          hires->buffer_count);
+    if (!hires->vdo) {
+        LOG_ERR("HiRes: Failed to open %ux%u stream\n", hires->width, hires->height);
+        return 0;
+    }
+    hires->opens++;
+    return 1;
+}
+
+static void close_stream(HiResStream* hires) {
+    if (!hires->vdo) return;
+    Vdo_Cleanup(hires->vdo);
+    hires->vdo = NULL;
+    hires->closes++;
+}
+
+static void release_held(HiResStream* hires) {
+    if (hires->held) {
+        Views_End_Frame(hires->views);
+        Vdo_Release_Frame(hires->vdo, hires->held);
+        hires->held = NULL;
+    }
+    hires->requested = 0;
+    hires->matched = 0;
+}
+
+int HiRes_Get_Frame(HiResStream* hires, int64_t capture_us, HiResFrame* frame) {
+    if (!hires || !frame) return 0;
+
+    // Every module asking about this analytics frame shares one match
+    if (hires->requested && hires->requested_for == capture_us) {
+        if (hires->matched) *frame = hires->frame;
+        return hires->matched;
+    }
+    release_held(hires);
+
+    hires->requested = 1;
+    hires->requested_for = capture_us;
+    hires->requests++;
+    hires->last_request_us = now_us();
+
+    if (!hires->vdo && !open_stream(hires)) {
+        hires->misses++;
+        return 0;
+    }
+
+    VdoBuffer* best = NULL;
+    int64_t best_us = 0;
+    for (unsigned int i = 0; i < hires->buffer_count + 1; i++) {
+        VdoBuffer* buffer = Vdo_Get_Frame(hires->vdo);
+        if (!buffer) break;
+        hires->pulls++;
+
+        int64_t ts = Vdo_Buffer_Timestamp_Us(buffer);
+        if (best && abs_us(ts - capture_us) >= abs_us(best_us - capture_us)) {
+            // Moving away from the analytics frame
+            Vdo_Release_Frame(hires->vdo, buffer);
+            break;
+        }
+        if (best) Vdo_Release_Frame(hires->vdo, best);
+        best = buffer;
+        best_us = ts;
+        if (ts >= capture_us) break;
+    }
+
+    void* data = best ? vdo_buffer_get_data(best) : NULL;
+    int64_t skew = best_us - capture_us;
+    if (!data || abs_us(skew) > hires->max_skew_us) {
+        if (best) Vdo_Release_Frame(hires->vdo, best);
+        hires->misses++;
+        return 0;
+    }
+
+    hires->held = best;
+    hires->matched = 1;
+    hires->frame = (HiResFrame){
+        .data = data,
+        .size = Vdo_Frame_Size(VDO_FORMAT_YUV, hires->width, hires->height),
+        .width = hires->width,
+        .height = hires->height,
+        .capture_us = best_us,
+        .skew_us = skew,
+        .fd = vdo_buffer_get_fd(best),
+        .offset = vdo_buffer_get_offset(best),
+        .views = hires->views
+    };
+    Views_Begin_Frame(hires->views, data, VIEWS_FORMAT_NV12, hires->width, hires->height);
+
+    hires->matches++;
+    hires->skew_abs_total += abs_us(skew);
+    if (abs_us(skew) > hires->skew_abs_max) hires->skew_abs_max = abs_us(skew);
+
+    *frame = hires->frame;
+    return 1;
+}
+
+/**
+ * Part of the high-resolution frame the analytics frame covers, in pixels
+ */
+static void analytics_region(HiResStream* hires, const HiResFrame* frame,
+                             float* fx, float* fy, float* fw, float* fh) {
+    *fx = 0.0f;
+    *fy = 0.0f;
+    *fw = (float)frame->width;
+    *fh = (float)frame->height;
+    if (hires->center_crop && hires->analytics->height > 0) {
+        float analytics_aspect = (float)hires->analytics->width / (float)hires->analytics->height;
+        if (*fw / *fh > analytics_aspect) {
+            float visible = *fh * analytics_aspect;
+            *fx = (*fw - visible) / 2.0f;
+            *fw = visible;
+        } else if (*fw / *fh < analytics_aspect) {
+            float visible = *fw / analytics_aspect;
+            *fy = (*fh - visible) / 2.0f;
+            *fh = visible;
+        }
+    }
+}
+
+void HiRes_Map_Box(HiResStream* hires, const HiResFrame* frame, float cx, float cy,
+                   float width, float height, int out[4]) {
+    if (!hires || !frame || !out) return;
+
+    float fx, fy, fw, fh;
+    analytics_region(hires, frame, &fx, &fy, &fw, &fh);
+
+    int x0 = (int)(fx + (cx - width / 2.0f) * fw);
+    int y0 = (int)(fy + (cy - height / 2.0f) * fh);
+    int x1 = (int)(fx + (cx + width / 2.0f) * fw + 0.5f);
+    int y1 = (int)(fy + (cy + height / 2.0f) * fh + 0.5f);
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > (int)frame->width) x1 = (int)frame->width;
+    if (y1 > (int)frame->height) y1 = (int)frame->height;
+
+    out[0] = x0;
+    out[1] = y0;
+    out[2] = x1 > x0 ? x1 - x0 : 0;
+    out[3] = y1 > y0 ? y1 - y0 : 0;
+}
+
+void HiRes_Unmap_Box(HiResStream* hires, const HiResFrame* frame, const float box[4],
+                     float* cx, float* cy, float* width, float* height) {
+    if (!hires || !frame || !box) return;
+
+    float fx, fy, fw, fh;
+    analytics_region(hires, frame, &fx, &fy, &fw, &fh);
+    if (fw <= 0.0f || fh <= 0.0f) return;
+
+    *cx = (box[0] + box[2] / 2.0f - fx) / fw;
+    *cy = (box[1] + box[3] / 2.0f - fy) / fh;
+    *width = box[2] / fw;
+    *height = box[3] / fh;
+}
+
+void HiRes_End_Frame(HiResStream* hires) {
+    if (!hires) return;
+    release_held(hires);
+
+    // Give the ISP its bandwidth back when nobody has asked for a while
+    if (hires->vdo && now_us() - hires->last_request_us > hires->idle_stop_us) {
+        LOG("HiRes: Idle, closing stream\n");
+        close_stream(hires);
+    }
+}
+
+cJSON* HiRes_Stats_JSON(HiResStream* hires) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", hires != NULL);
+    if (!hires) return json;
+
+    cJSON_AddNumberToObject(json, "width", hires->width);
+    cJSON_AddNumberToObject(json, "height", hires->height);
+    cJSON_AddBoolToObject(json, "open", hires->vdo != NULL);
+    cJSON_AddNumberToObject(json, "opens", (double)hires->opens);
+    cJSON_AddNumberToObject(json, "closes", (double)hires->closes);
+    cJSON_AddNumberToObject(json, "requests", (double)hires->requests);
+    cJSON_AddNumberToObject(json, "matches", (double)hires->matches);
+    cJSON_AddNumberToObject(json, "misses", (double)hires->misses);
+    cJSON_AddNumberToObject(json, "pulls", (double)hires->pulls);
+    cJSON_AddNumberToObject(json, "skew_us_avg",
+                            hires->matches ? (double)hires->skew_abs_total / hires->matches : 0);
+    cJSON_AddNumberToObject(json, "skew_us_max", (double)hires->skew_abs_max);
+    cJSON_AddItemToObject(json, "views", Views_Stats_JSON(hires->views));
+    return json;
+}
+
+void HiRes_Cleanup(HiResStream* hires) {
+    if (!hires) return;
+
+    if (hires->vdo) {
+        release_held(hires);
+        close_stream(hires);
+    }
+    LOG("HiRes: cleanup: Requests=%llu Matches=%llu Opens=%llu\n",
+        (unsigned long long)hires->requests, (unsigned long long)hires->matches,
+        (unsigned long long)hires->opens);
+
+    Views_Destroy(hires->views);
+    free(hires);
+}
@@ -0,0 +1,118 @@
+/**
+ * hires_stream.h
+ *
+ * On-demand high-resolution stream for Axis I.S. POC
+ * Motion and detection run on the small analytics stream at full rate;
+ * snapshots, crops and plate reads want full resolution now and then. The
+ * high-resolution VDO stream is opened on the first request and closed
+ * again after it has gone unused for a while.
+ *
+ * A request names the analytics frame it is for; the high-resolution frame
+ * with the closest capture timestamp (same VDO clock, same channel) is
+ * pulled, so a detection box on the analytics frame maps onto it with
+ * HiRes_Map_Box(). The frame comes with its own view cache for JPEGs and
+ * crops, and stays valid until the analytics frame ends.
+ *
+ * Pipeline thread only.
+ */
+
+#ifndef HIRES_STREAM_H
+#define HIRES_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+#include "frame_source.h"
+#include "frame_views.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct HiResStream HiResStream;
+
+/* High-resolution frame matched to an analytics frame */
+typedef struct {
+    const void* data;               // NV12 pixels, valid until HiRes_End_Frame()
+    size_t size;
+    unsigned int width;
+    unsigned int height;
+    int64_t capture_us;             // VDO capture timestamp
+    int64_t skew_us;                // capture_us minus the analytics frame's
+    int fd;                         // dma-buf of the pixels for larod crop jobs
+    int64_t offset;                 // ... and their offset in it
+    FrameViews* views;              // JPEG / crop / gray views of this frame
+} HiResFrame;
+
+/**
+ * Set up the high-resolution stream for an analytics source (nothing is
+ * opened until the first request)
+ * @param config "hires_stream" object from core config
+ * @param analytics Analytics frame source - must be a VDO source
+ * @return Stream pointer, NULL when disabled or the source is not VDO
+ *
+ * Config keys:
+ *   enabled        Allow high-resolution requests (default true)
+ *   width, height  Stream size (default 1920x1080)
+ *   fps            Stream rate (default: analytics rate)
+ *   buffer_count   VDO buffers (default 3)
+ *   max_skew_ms    Largest timestamp difference accepted as a match (default 150)
+ *   idle_stop_s    Close the stream after this long without a request (default 10)
+ *   analytics_crop "center" (default) when the analytics stream is a centred
+ *                  crop of the field of view, "none" when it is squeezed
+ */
+HiResStream* HiRes_Init(cJSON* config, FrameSource* analytics);
+
+/**
+ * Get the high-resolution frame matching an analytics frame
+ * Opens the stream if needed. Repeated calls for the same analytics frame
+ * return the same frame.
+ * @param capture_us Analytics frame capture timestamp (FrameData.capture_us)
+ * @param frame Output frame
+ * @return 1 on success, 0 if no frame within max_skew_ms could be had
+ *
+ * The first request after the stream opens waits for its first frame and
+ * usually only matches a later analytics frame.
+ */
+int HiRes_Get_Frame(HiResStream* hires, int64_t capture_us, HiResFrame* frame);
+
+/**
+ * Map a normalized analytics-frame box onto high-resolution pixels
+ * @param cx, cy, width, height Box centre and size in [0-1] analytics frame
+ *              coordinates (as in Detection)
+ * @param out Output box as x, y, width, height in frame pixels (clipped)
+ */
+void HiRes_Map_Box(HiResStream* hires, const HiResFrame* frame, float cx, float cy,
+                   float width, float height, int out[4]);
+
+/**
+ * Map a high-resolution pixel box back to normalized analytics-frame
+ * coordinates (inverse of HiRes_Map_Box(); not clipped)
+ * @param box x, y, width, height in frame pixels (fractional allowed)
+ * @param cx, cy, width, height Output box centre and size
+ */
+void HiRes_Unmap_Box(HiResStream* hires, const HiResFrame* frame, const float box[4],
+                     float* cx, float* cy, float* width, float* height);
+
+/**
+ * End of the analytics frame - releases the matched frame and closes the
+ * stream once it has been idle long enough
+ */
+void HiRes_End_Frame(HiResStream* hires);
+
+/**
+ * Get stream statistics as JSON (requests, matches, skew, open/close counts)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* HiRes_Stats_JSON(HiResStream* hires);
+
+/**
+ * Close the stream and free everything
+ */
+void HiRes_Cleanup(HiResStream* hires);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HIRES_STREAM_H */
@@ -0,0 +1,759 @@
+/**
+ * http_client.c
+ *
+ * Shared HTTP client implementation for Axis I.S. POC
+ *
+ * A curl share handle holds the connection, TLS session and DNS caches;
+ * every easy handle is attached to it, so any handle can pick up any idle
+ * connection. Easy handles are reset and reused rather than recreated.
+ *
+ * Asynchronous requests run on a curl multi handle driven by the GLib main
+ * loop: libcurl's sockets become unix fd sources and its timer a timeout
+ * source, so transfers progress between frames and callbacks arrive on the
+ * main loop thread - the pipeline thread. Requests wait in a bounded queue
+ * until one of max_active transfer slots frees up.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <pthread.h>
+#include <time.h>
+#include <curl/curl.h>
+#include <glib.h>
+#include <glib-unix.h>
+#include "http_client.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define HTTP_MAX_HANDLES 16
+#define HTTP_HOST_SIZE 128
+
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+} Buffer;
+
+/* Asynchronous request, queued then active */
+typedef struct AsyncRequest {
+    struct AsyncRequest* next;
+    char* url;
+    struct curl_slist* headers;
+    char* body;
+    size_t body_size;
+    long timeout_ms;
+    HttpCallback done;
+    void* user;
+    CURL* curl;
+    Buffer response;
+    int64_t queued_us;
+} AsyncRequest;
+
+/* GLib source watching one of libcurl's sockets */
+typedef struct SocketWatch {
+    struct SocketWatch* next;
+    curl_socket_t fd;
+    guint source;
+} SocketWatch;
+
+typedef struct {
+    char host[HTTP_HOST_SIZE];          // scheme://host[:port]
+    uint64_t requests;
+    uint64_t connects;                  // New connections
+    uint64_t reused;
+    uint64_t failures;                  // No response
+    uint64_t http_errors;               // Status 400 and up
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    double time_ms;
+    double connect_ms;                  // Spent in TCP connect
+    double tls_ms;                      // Spent in the TLS handshake
+} HostStats;
+
+struct HttpClient {
+    CURLSH* share;
+    pthread_mutex_t locks[CURL_LOCK_DATA_LAST];
+
+    long connect_timeout_ms;
+    long timeout_ms;
+    long max_connections;
+    long keepalive_idle_s;
+    int verify_peer;
+    char user_agent[64];
+
+    // Idle easy handles
+    pthread_mutex_t pool_mutex;
+    CURL* idle[HTTP_MAX_HANDLES];
+    int idle_count;
+    int max_handles;
+    uint64_t handles_created;
+
+    // Statistics
+    pthread_mutex_t stats_mutex;
+    HostStats hosts[HTTP_MAX_HOSTS];
+    int host_count;
+    uint64_t other_requests;            // Hosts past HTTP_MAX_HOSTS
+
+    // Asynchronous requests (multi state on the main loop thread only)
+    CURLM* multi;
+    int max_active;
+    int max_queued;
+    pthread_mutex_t queue_mutex;
+    AsyncRequest* queue_head;           // Waiting for a transfer slot
+    AsyncRequest* queue_tail;
+    int queued;
+    guint kick_source;                  // Idle source starting queued requests
+    AsyncRequest* active;               // Running on the multi handle
+    int active_count;
+    guint timer_source;
+    SocketWatch* watches;
+    uint64_t async_submitted;
+    uint64_t async_rejected;            // Queue full
+    uint64_t async_completed;           // Callback got a response
+    uint64_t async_failed;              // Callback got a transport failure
+    uint64_t async_started;
+    uint64_t async_cancelled;
+    int64_t queue_wait_us;
+};
+
+static void share_lock(CURL* handle, curl_lock_data data, curl_lock_access access, void* user) {
+    HttpClient* client = (HttpClient*)user;
+    pthread_mutex_lock(&client->locks[data]);
+}
+
+static void share_unlock(CURL* handle, curl_lock_data data, void* user) {
+    HttpClient* client = (HttpClient*)user;
+    pthread_mutex_unlock(&client->locks[data]);
+}
+
+static int socket_changed(CURL* easy, curl_socket_t fd, int what, void* user, void* socket_user);
+static int timer_changed(CURLM* multi, long timeout_ms, void* user);
+
+static long config_long(cJSON* config, const char* key, long def) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, key) : NULL;
+    return item && cJSON_IsNumber(item) ? (long)item->valuedouble : def;
+}
+
+HttpClient* Http_Init(cJSON* config) {
+    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+        LOG_ERR("Http: curl_global_init failed\n");
+        return NULL;
+    }
+
+    HttpClient* client = (HttpClient*)calloc(1, sizeof(HttpClient));
+    if (!client) {
+        LOG_ERR("Http: Failed to allocate client\n");
+        curl_global_cleanup();
+        return NULL;
+    }
+
+    client->connect_timeout_ms = config_long(config, "connect_timeout_ms", 5000);
+    client->timeout_ms = config_long(config, "timeout_ms", 30000);
+    client->max_connections = config_long(config, "max_connections", 8);
+    client->keepalive_idle_s = config_long(config, "keepalive_idle_s", 30);
+    client->max_handles = (int)config_long(config, "handles", 4);
+    client->max_active = (int)config_long(config, "max_active", 4);
+    client->max_queued = (int)config_long(config, "max_queued", 32);
+    cJSON* verify = config ? cJSON_GetObjectItem(config, "verify_peer") : NULL;
+    client->verify_peer = verify ? cJSON_IsTrue(verify) : 1;
+    cJSON* agent = config ? cJSON_GetObjectItem(config, "user_agent") : NULL;
+    snprintf(client->user_agent, sizeof(client->user_agent), "%s",
+             agent && cJSON_IsString(agent) ? agent->valuestring : "axis-is-poc");
+    if (client->max_handles < 1) client->max_handles = 1;
+    if (client->max_handles > HTTP_MAX_HANDLES) client->max_handles = HTTP_MAX_HANDLES;
+    if (client->max_connections < 1) client->max_connections = 1;
+    if (client->max_active < 1) client->max_active = 1;
+    if (client->max_queued < 0) client->max_queued = 0;
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) pthread_mutex_init(&client->locks[i], NULL);
+    pthread_mutex_init(&client->pool_mutex, NULL);
+    pthread_mutex_init(&client->stats_mutex, NULL);
+    pthread_mutex_init(&client->queue_mutex, NULL);
+
+    client->share = curl_share_init();
+    if (!client->share) {
+        LOG_ERR("Http: curl_share_init failed\n");
+        Http_Cleanup(client);
+        return NULL;
+    }
+    curl_share_setopt(client->share, CURLSHOPT_LOCKFUNC, share_lock);
+    curl_share_setopt(client->share, CURLSHOPT_UNLOCKFUNC, share_unlock);
+    curl_share_setopt(client->share, CURLSHOPT_USERDATA, client);
+    curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    if (curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT) != CURLSHE_OK) {
+        LOG_ERR("Http: libcurl cannot share connections - only TLS sessions are reused\n");
+    }
+
+    client->multi = curl_multi_init();
+    if (!client->multi) {
+        LOG_ERR("Http: curl_multi_init failed - asynchronous requests disabled\n");
+    } else {
+        curl_multi_setopt(client->multi, CURLMOPT_SOCKETFUNCTION, socket_changed);
+        curl_multi_setopt(client->multi, CURLMOPT_SOCKETDATA, client);
+        curl_multi_setopt(client->multi, CURLMOPT_TIMERFUNCTION, timer_changed);
+        curl_multi_setopt(client->multi, CURLMOPT_TIMERDATA, client);
+        curl_multi_setopt(client->multi, CURLMOPT_MAXCONNECTS, client->max_connections);
+    }
+
+    LOG("Http: Client ready (connect %ldms, timeout %ldms, %ld idle connections, %d handles, "
+        "%d active / %d queued async)\n", client->connect_timeout_ms, client->timeout_ms,
+        client->max_connections, client->max_handles, client->max_active, client->max_queued);
+    return client;
+}
+
+/**
+ * Idle easy handle, or a new one attached to the share
+ */
+static CURL* acquire(HttpClient* client) {
+    CURL* curl = NULL;
+    pthread_mutex_lock(&client->pool_mutex);
+    if (client->idle_count > 0) curl = client->idle[--client->idle_count];
+    pthread_mutex_unlock(&client->pool_mutex);
+
+    if (curl) {
+        curl_easy_reset(curl);
+    } else {
+        curl = curl_easy_init();
+        if (!curl) return NULL;
+        pthread_mutex_lock(&client->pool_mutex);
+        client->handles_created++;
+        pthread_mutex_unlock(&client->pool_mutex);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_SHARE, client->share);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, client->connect_timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_MAXCONNECTS, client->max_connections);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPIDLE, client->keepalive_idle_s);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPINTVL, client->keepalive_idle_s);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, client->verify_peer ? 1L : 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, client->verify_peer ? 2L : 0L);
+    curl_easy_setopt(curl, CURLOPT_USERAGENT, client->user_agent);
+    return curl;
+}
+
+static void release(HttpClient* client, CURL* curl) {
+    pthread_mutex_lock(&client->pool_mutex);
+    if (client->idle_count < client->max_handles) {
+        client->idle[client->idle_count++] = curl;
+        curl = NULL;
+    }
+    pthread_mutex_unlock(&client->pool_mutex);
+    if (curl) curl_easy_cleanup(curl);
+}
+
+/**
+ * Header block to a curl list, one entry per non-empty line
+ */
+static struct curl_slist* header_list(const char* headers) {
+    struct curl_slist* list = NULL;
+    const char* p = headers;
+    while (p && *p) {
+        size_t len = strcspn(p, "\r\n");
+        if (len > 0) {
+            char* line = strndup(p, len);
+            struct curl_slist* grown = line ? curl_slist_append(list, line) : NULL;
+            free(line);
+            if (!grown) {
+                curl_slist_free_all(list);
+                return NULL;
+            }
+            list = grown;
+        }
+        p += len;
+        while (*p == '\r' || *p == '\n') p++;
+    }
+    return list;
+}
+
+/**
+ * Statistics entry for the URL's scheme://host[:port] (stats_mutex held)
+ */
+static HostStats* host_stats(HttpClient* client, const char* url) {
+    const char* start = strstr(url, "://");
+    size_t len = start ? (size_t)(start - url) + 3 + strcspn(start + 3, "/?#") : strcspn(url, "/?#");
+    if (len >= HTTP_HOST_SIZE) len = HTTP_HOST_SIZE - 1;
+
+    for (int i = 0; i < client->host_count; i++) {
+        if (strncmp(client->hosts[i].host, url, len) == 0 && client->hosts[i].host[len] == '\0') {
+            return &client->hosts[i];
+        }
+    }
+    if (client->host_count >= HTTP_MAX_HOSTS) return NULL;
+    HostStats* stats = &client->hosts[client->host_count++];
+    memcpy(stats->host, url, len);
+    stats->host[len] = '\0';
+    return stats;
+}
+
+static size_t write_body(void* contents, size_t size, size_t nmemb, void* user) {
+    Buffer* buf = (Buffer*)user;
+    size_t bytes = size * nmemb;
+    if (buf->size + bytes + 1 > buf->capacity) {
+        size_t capacity = buf->capacity ? buf->capacity : 4096;
+        while (capacity < buf->size + bytes + 1) capacity *= 2;
+        char* grown = (char*)realloc(buf->data, capacity);
+        if (!grown) return 0;
+        buf->data = grown;
+        buf->capacity = capacity;
+    }
+    memcpy(buf->data + buf->size, contents, bytes);
+    buf->size += bytes;
+    buf->data[buf->size] = '\0';
+    return bytes;
+}
+
+/**
+ * Fill the response timing and count the transfer for its host
+ */
+static void record(HttpClient* client, const char* url, CURL* curl, CURLcode res, size_t sent,
+                   size_t received, HttpResponse* response) {
+    long connects = 0;
+    double total = 0, connect = 0, tls = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response->status);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME, &total);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME, &tls);
+    response->time_ms = total * 1000.0;
+    response->reused = res == CURLE_OK && connects == 0;
+
+    pthread_mutex_lock(&client->stats_mutex);
+    HostStats* stats = host_stats(client, url);
+    if (stats) {
+        stats->requests++;
+        stats->connects += (uint64_t)connects;
+        stats->reused += (uint64_t)response->reused;
+        stats->failures += res != CURLE_OK;
+        stats->http_errors += res == CURLE_OK && response->status >= 400;
+        stats->bytes_sent += res == CURLE_OK ? sent : 0;
+        stats->bytes_received += received;
+        stats->time_ms += response->time_ms;
+        if (connects > 0) {
+            stats->connect_ms += connect * 1000.0;
+            if (tls > connect) stats->tls_ms += (tls - connect) * 1000.0;
+        }
+    } else {
+        client->other_requests++;
+    }
+    pthread_mutex_unlock(&client->stats_mutex);
+}
+
+int Http_Post(HttpClient* client, const char* url, const char* headers, const void* body,
+              size_t body_size, long timeout_ms, HttpResponse* response) {
+    if (!response) return 0;
+    memset(response, 0, sizeof(HttpResponse));
+    if (!client || !url) return 0;
+
+    CURL* curl = acquire(client);
+    if (!curl) {
+        LOG_ERR("Http: curl_easy_init failed\n");
+        return 0;
+    }
+
+    Buffer buf = { 0 };
+    struct curl_slist* list = header_list(headers);
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body ? body : "");
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)(body ? body_size : 0));
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms > 0 ? timeout_ms : client->timeout_ms);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_body);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void*)&buf);
+    if (list) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    record(client, url, curl, res, body ? body_size : 0, buf.size, response);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, NULL);
+    curl_slist_free_all(list);
+    release(client, curl);
+
+    if (res != CURLE_OK) {
+        LOG_ERR("Http: POST %s failed: %s\n", url, curl_easy_strerror(res));
+        free(buf.data);
+        return 0;
+    }
+
+    // Always hand back a string, even for an empty body
+    response->body = buf.data ? buf.data : (char*)calloc(1, 1);
+    response->size = buf.size;
+    return 1;
+}
+
+static int64_t now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void free_request(AsyncRequest* req) {
+    curl_slist_free_all(req->headers);
+    free(req->response.data);
+    free(req->body);
+    free(req->url);
+    free(req);
+}
+
+/**
+ * Take a request off the multi handle and give its easy handle back
+ */
+static void detach(HttpClient* client, AsyncRequest* req) {
+    for (AsyncRequest** p = &client->active; *p; p = &(*p)->next) {
+        if (*p == req) {
+            *p = req->next;
+            break;
+        }
+    }
+    client->active_count--;
+    curl_multi_remove_handle(client->multi, req->curl);
+    curl_easy_setopt(req->curl, CURLOPT_HTTPHEADER, NULL);
+    release(client, req->curl);
+    req->curl = NULL;
+}
+
+/**
+ * Completed transfers: statistics, then the caller's callback
+ */
+static void collect_done(HttpClient* client) {
+    CURLMsg* msg;
+    int left;
+    while ((msg = curl_multi_info_read(client->multi, &left))) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        AsyncRequest* req = NULL;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char**)&req);
+        if (!req) continue;
+        CURLcode res = msg->data.result;
+
+        HttpResponse response;
+        memset(&response, 0, sizeof(response));
+        record(client, req->url, req->curl, res, req->body_size, req->response.size, &response);
+        detach(client, req);
+
+        int ok = res == CURLE_OK;
+        if (ok) {
+            client->async_completed++;
+            response.body = req->response.data ? req->response.data : (char*)"";
+            response.size = req->response.size;
+        } else {
+            client->async_failed++;
+            LOG_ERR("Http: Async POST %s failed: %s\n", req->url, curl_easy_strerror(res));
+        }
+        req->done(&response, ok, req->user);
+        free_request(req);
+    }
+}
+
+/**
+ * Move queued requests onto the multi handle while slots are free
+ */
+static void start_queued(HttpClient* client) {
+    while (client->active_count < client->max_active) {
+        pthread_mutex_lock(&client->queue_mutex);
+        AsyncRequest* req = client->queue_head;
+        if (req) {
+            client->queue_head = req->next;
+            if (!client->queue_head) client->queue_tail = NULL;
+            client->queued--;
+            client->async_started++;
+            client->queue_wait_us += now_us() - req->queued_us;
+        }
+        pthread_mutex_unlock(&client->queue_mutex);
+        if (!req) return;
+
+        req->curl = acquire(client);
+        if (!req->curl) {
+            HttpResponse response;
+            memset(&response, 0, sizeof(response));
+            client->async_failed++;
+            req->done(&response, 0, req->user);
+            free_request(req);
+            continue;
+        }
+        curl_easy_setopt(req->curl, CURLOPT_URL, req->url);
+        curl_easy_setopt(req->curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(req->curl, CURLOPT_POSTFIELDS, req->body ? req->body : "");
+        curl_easy_setopt(req->curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)req->body_size);
+        curl_easy_setopt(req->curl, CURLOPT_TIMEOUT_MS,
+                         req->timeout_ms > 0 ? req->timeout_ms : client->timeout_ms);
+        curl_easy_setopt(req->curl, CURLOPT_WRITEFUNCTION, write_body);
+        curl_easy_setopt(req->curl, CURLOPT_WRITEDATA, (void*)&req->response);
+        curl_easy_setopt(req->curl, CURLOPT_PRIVATE, (char*)req);
+        if (req->headers) curl_easy_setopt(req->curl, CURLOPT_HTTPHEADER, req->headers);
+
+        req->next = client->active;
+        client->active = req;
+        client->active_count++;
+        curl_multi_add_handle(client->multi, req->curl);
+    }
+}
+
+static gboolean kick(gpointer user) {
+    HttpClient* client = (HttpClient*)user;
+    pthread_mutex_lock(&client->queue_mutex);
+    client->kick_source = 0;
+    pthread_mutex_unlock(&client->queue_mutex);
+    start_queued(client);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean socket_ready(gint fd, GIOCondition condition, gpointer user) {
+    HttpClient* client = (HttpClient*)user;
+    int flags = 0;
+    if (condition & G_IO_IN) flags |= CURL_CSELECT_IN;
+    if (condition & G_IO_OUT) flags |= CURL_CSELECT_OUT;
+    if (condition & (G_IO_ERR | G_IO_HUP)) flags |= CURL_CSELECT_ERR;
+
+    int running = 0;
+    curl_multi_socket_action(client->multi, fd, flags, &running);
+    collect_done(client);
+    start_queued(client);
+    // The watch may have been replaced or removed by socket_changed()
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean timer_fired(gpointer user) {
+    HttpClient* client = (HttpClient*)user;
+    client->timer_source = 0;
+
+    int running = 0;
+    curl_multi_socket_action(client->multi, CURL_SOCKET_TIMEOUT, 0, &running);
+    collect_done(client);
+    start_queued(client);
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * libcurl wants a socket watched for other events, or no longer
+ */
+static int socket_changed(CURL* easy, curl_socket_t fd, int what, void* user, void* socket_user) {
+    HttpClient* client = (HttpClient*)user;
+    SocketWatch* watch = (SocketWatch*)socket_user;
+
+    if (what == CURL_POLL_REMOVE) {
+        if (!watch) return 0;
+        for (SocketWatch** p = &client->watches; *p; p = &(*p)->next) {
+            if (*p == watch) {
+                *p = watch->next;
+                break;
+            }
+        }
+        g_source_remove(watch->source);
+        curl_multi_assign(client->multi, fd, NULL);
+        free(watch);
+        return 0;
+    }
+
+    if (watch) {
+        g_source_remove(watch->source);
+    } else {
+        watch = (SocketWatch*)calloc(1, sizeof(SocketWatch));
+        if (!watch) return -1;
+        watch->fd = fd;
+        watch->next = client->watches;
+        client->watches = watch;
+        curl_multi_assign(client->multi, fd, watch);
+    }
+    GIOCondition condition = G_IO_ERR | G_IO_HUP;
+    if (what & CURL_POLL_IN) condition |= G_IO_IN;
+    if (what & CURL_POLL_OUT) condition |= G_IO_OUT;
+    watch->source = g_unix_fd_add(fd, condition, socket_ready, client);
+    return 0;
+}
+
+/**
+ * libcurl wants socket_action(CURL_SOCKET_TIMEOUT) after timeout_ms (-1: never)
+ */
+static int timer_changed(CURLM* multi, long timeout_ms, void* user) {
+    HttpClient* client = (HttpClient*)user;
+    if (client->timer_source) {
+        g_source_remove(client->timer_source);
+        client->timer_source = 0;
+    }
+    if (timeout_ms >= 0) {
+        client->timer_source = g_timeout_add((guint)timeout_ms, timer_fired, client);
+    }
+    return 0;
+}
+
+int Http_Post_Async(HttpClient* client, const char* url, const char* headers, const void* body,
+                    size_t body_size, long timeout_ms, HttpCallback done, void* user) {
+    if (!client || !client->multi || !url || !done) return 0;
+
+    AsyncRequest* req = (AsyncRequest*)calloc(1, sizeof(AsyncRequest));
+    if (!req) return 0;
+    req->url = strdup(url);
+    req->headers = header_list(headers);
+    req->body_size = body ? body_size : 0;
+    req->body = (char*)malloc(req->body_size + 1);
+    if (!req->url || !req->body || (headers && *headers && !req->headers)) {
+        free_request(req);
+        return 0;
+    }
+    if (req->body_size) memcpy(req->body, body, req->body_size);
+    req->body[req->body_size] = '\0';
+    req->timeout_ms = timeout_ms;
+    req->done = done;
+    req->user = user;
+    req->queued_us = now_us();
+
+    pthread_mutex_lock(&client->queue_mutex);
+    if (client->queued >= client->max_queued) {
+        client->async_rejected++;
+        pthread_mutex_unlock(&client->queue_mutex);
+        free_request(req);
+        return 0;
+    }
+    if (client->queue_tail) {
+        client->queue_tail->next = req;
+    } else {
+        client->queue_head = req;
+    }
+    client->queue_tail = req;
+    client->queued++;
+    client->async_submitted++;
+    // Started from the main loop, whichever thread submitted
+    if (!client->kick_source) client->kick_source = g_idle_add(kick, client);
+    pthread_mutex_unlock(&client->queue_mutex);
+    return 1;
+}
+
+int Http_Cancel(HttpClient* client, void* user) {
+    if (!client) return 0;
+    int cancelled = 0;
+
+    pthread_mutex_lock(&client->queue_mutex);
+    AsyncRequest** p = &client->queue_head;
+    client->queue_tail = NULL;
+    while (*p) {
+        AsyncRequest* req = *p;
+        if (req->user == user) {
+            *p = req->next;
+            client->queued--;
+            free_request(req);
+            cancelled++;
+        } else {
+            client->queue_tail = req;
+            p = &req->next;
+        }
+    }
+    pthread_mutex_unlock(&client->queue_mutex);
+
+    AsyncRequest* req = client->active;
+    while (req) {
+        AsyncRequest* next = req->next;
+        if (req->user == user) {
+            detach(client, req);
+            free_request(req);
+            cancelled++;
+        }
+        req = next;
+    }
+
+    client->async_cancelled += (uint64_t)cancelled;
+    return cancelled;
+}
+
+cJSON* Http_Stats_JSON(HttpClient* client) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", client != NULL);
+    if (!client) return json;
+
+    pthread_mutex_lock(&client->pool_mutex);
+    cJSON_AddNumberToObject(json, "handles_created", (double)client->handles_created);
+    cJSON_AddNumberToObject(json, "handles_idle", client->idle_count);
+    pthread_mutex_unlock(&client->pool_mutex);
+
+    pthread_mutex_lock(&client->stats_mutex);
+    cJSON* hosts = cJSON_CreateArray();
+    for (int i = 0; i < client->host_count; i++) {
+        const HostStats* s = &client->hosts[i];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "host", s->host);
+        cJSON_AddNumberToObject(item, "requests", (double)s->requests);
+        cJSON_AddNumberToObject(item, "connects", (double)s->connects);
+        cJSON_AddNumberToObject(item, "reused", (double)s->reused);
+        cJSON_AddNumberToObject(item, "reuse_rate", s->requests ? (double)s->reused / (double)s->requests : 0);
+        cJSON_AddNumberToObject(item, "failures", (double)s->failures);
+        cJSON_AddNumberToObject(item, "http_errors", (double)s->http_errors);
+        cJSON_AddNumberToObject(item, "bytes_sent", (double)s->bytes_sent);
+        cJSON_AddNumberToObject(item, "bytes_received", (double)s->bytes_received);
+        cJSON_AddNumberToObject(item, "avg_ms", s->requests ? s->time_ms / (double)s->requests : 0);
+        cJSON_AddNumberToObject(item, "avg_connect_ms", s->connects ? s->connect_ms / (double)s->connects : 0);
+        cJSON_AddNumberToObject(item, "avg_tls_ms", s->connects ? s->tls_ms / (double)s->connects : 0);
+        cJSON_AddItemToArray(hosts, item);
+    }
+    cJSON_AddItemToObject(json, "hosts", hosts);
+    cJSON_AddNumberToObject(json, "other_requests", (double)client->other_requests);
+    pthread_mutex_unlock(&client->stats_mutex);
+
+    pthread_mutex_lock(&client->queue_mutex);
+    cJSON* async = cJSON_CreateObject();
+    cJSON_AddNumberToObject(async, "active", client->active_count);
+    cJSON_AddNumberToObject(async, "queued", client->queued);
+    cJSON_AddNumberToObject(async, "submitted", (double)client->async_submitted);
+    cJSON_AddNumberToObject(async, "rejected", (double)client->async_rejected);
+    cJSON_AddNumberToObject(async, "completed", (double)client->async_completed);
+    cJSON_AddNumberToObject(async, "failed", (double)client->async_failed);
+    cJSON_AddNumberToObject(async, "cancelled", (double)client->async_cancelled);
+    cJSON_AddNumberToObject(async, "avg_queue_ms", client->async_started ?
+                            (double)client->queue_wait_us / 1000.0 / (double)client->async_started : 0);
+    pthread_mutex_unlock(&client->queue_mutex);
+    cJSON_AddItemToObject(json, "async", async);
+    return json;
+}
+
+void Http_Cleanup(HttpClient* client) {
+    if (!client) return;
+
+    uint64_t requests = 0, reused = 0;
+    for (int i = 0; i < client->host_count; i++) {
+        requests += client->hosts[i].requests;
+        reused += client->hosts[i].reused;
+    }
+    LOG("Http: cleanup: Requests=%llu Reused=%llu Handles=%llu\n", (unsigned long long)requests,
+        (unsigned long long)reused, (unsigned long long)client->handles_created);
+
+    // Pending requests are dropped without callbacks (modules are gone)
+    if (client->kick_source) g_source_remove(client->kick_source);
+    while (client->queue_head) {
+        AsyncRequest* req = client->queue_head;
+        client->queue_head = req->next;
+        free_request(req);
+    }
+    while (client->active) {
+        AsyncRequest* req = client->active;
+        detach(client, req);
+        free_request(req);
+    }
+    if (client->multi) curl_multi_cleanup(client->multi);
+    if (client->timer_source) g_source_remove(client->timer_source);
+    while (client->watches) {
+        SocketWatch* watch = client->watches;
+        client->watches = watch->next;
+        g_source_remove(watch->source);
+        free(watch);
+    }
+
+    // Handles first - the share cannot go while they are attached
+    for (int i = 0; i < client->idle_count; i++) curl_easy_cleanup(client->idle[i]);
+    if (client->share) curl_share_cleanup(client->share);
+
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; i++) pthread_mutex_destroy(&client->locks[i]);
+    pthread_mutex_destroy(&client->pool_mutex);
+    pthread_mutex_destroy(&client->stats_mutex);
+    pthread_mutex_destroy(&client->queue_mutex);
+    free(client);
+    curl_global_cleanup();
+}
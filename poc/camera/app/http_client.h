@@ -0,0 +1,109 @@
+/**
+ * http_client.h
+ *
+ * Shared HTTP client for Axis I.S. POC
+ * Cloud AI calls go to the same few hosts over and over. All requests
+ * share one libcurl connection cache, TLS session cache and DNS cache, and
+ * reuse a small pool of easy handles, so after the first call to a host
+ * the TCP and TLS handshakes are skipped while the connection stays alive.
+ * Per-host statistics show how often a connection was reused.
+ *
+ * Http_Post blocks its caller. Http_Post_Async returns at once; the
+ * transfer runs on the GLib main loop alongside the frame pipeline and the
+ * callback is made there, so a slow cloud call never stalls a frame.
+ *
+ * Thread-safe: modules may post from any thread. Http_Cancel and all
+ * callbacks are on the main loop thread.
+ */
+
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <stddef.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_MAX_HOSTS 16               // Hosts with their own statistics
+
+typedef struct HttpClient HttpClient;
+
+typedef struct {
+    long status;                        // HTTP status, 0 without a response
+    char* body;                         // NUL-terminated; Http_Post: free() when done
+    size_t size;
+    int reused;                         // Went over an existing connection
+    double time_ms;
+} HttpResponse;
+
+/**
+ * Asynchronous completion, on the main loop thread
+ * @param response Status and body (valid during the callback only)
+ * @param ok 1 when a response arrived (any status), 0 on transport failure
+ */
+typedef void (*HttpCallback)(const HttpResponse* response, int ok, void* user);
+
+/**
+ * Create the client (core init, before any module thread)
+ * @param config "http" object from core config, may be NULL
+ * @return Client pointer, NULL on failure
+ *
+ * Config keys:
+ *   connect_timeout_ms  TCP + TLS connect limit (default 5000)
+ *   timeout_ms          Whole-request limit unless the caller gives one (default 30000)
+ *   max_connections     Idle connections kept open (default 8)
+ *   keepalive_idle_s    TCP keepalive probe interval (default 30)
+ *   handles             Easy handles kept for reuse (default 4)
+ *   verify_peer         Check server certificates (default true)
+ *   user_agent          User-Agent header (default "axis-is-poc")
+ *   max_active          Asynchronous transfers running at once (default 4)
+ *   max_queued          Asynchronous requests waiting for a slot (default 32)
+ */
+HttpClient* Http_Init(cJSON* config);
+
+/**
+ * POST a body and collect the response
+ * @param headers Header lines separated by "\n" or "\r\n", NULL for none
+ * @param timeout_ms Request limit, 0 for the configured one
+ * @param response Output; response->body is set whenever 1 is returned
+ * @return 1 when a response arrived (any status), 0 on transport failure
+ */
+int Http_Post(HttpClient* client, const char* url, const char* headers, const void* body,
+              size_t body_size, long timeout_ms, HttpResponse* response);
+
+/**
+ * POST without blocking - url, headers and body are copied
+ * @param done Called exactly once unless the request is cancelled
+ * @param user Passed to done; also the key for Http_Cancel
+ * @return 1 when queued, 0 when rejected (queue full) - done is not called
+ */
+int Http_Post_Async(HttpClient* client, const char* url, const char* headers, const void* body,
+                    size_t body_size, long timeout_ms, HttpCallback done, void* user);
+
+/**
+ * Drop queued and running asynchronous requests of a caller, without
+ * callbacks (call from module cleanup before freeing user)
+ * @return Requests dropped
+ */
+int Http_Cancel(HttpClient* client, void* user);
+
+/**
+ * Get per-host statistics as JSON (requests, new vs reused connections,
+ * connect and TLS time, failures) and asynchronous queue counters
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Http_Stats_JSON(HttpClient* client);
+
+/**
+ * Close every connection and free the client (pending asynchronous
+ * requests are dropped without callbacks)
+ */
+void Http_Cleanup(HttpClient* client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HTTP_CLIENT_H */
@@ -0,0 +1,106 @@
+/**
+ * inference_backend.h
+ *
+ * Inference backend interface for Axis I.S. POC
+ * LarodContext drives one backend through this table: the backend owns the
+ * model and its input/output tensors, LarodContext owns preprocessing,
+ * output parsing and statistics
+ *
+ * Backends:
+ *   larod   Larod service (DLPU on ARTPEC-8/9, CPU fallback)
+ *   tflite  TensorFlow Lite C API with XNNPACK (built with ENABLE_TFLITE=1)
+ *   replay  Recorded output tensors with configurable latency
+ */
+
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// YOLOv5n 640x640 tensor sizes (RGB uint8 in, [1, 25200, 85] float out)
+#define INFERENCE_DEFAULT_INPUT_BYTES (640 * 640 * 3)
+#define INFERENCE_DEFAULT_OUTPUT_BYTES (25200 * 85 * sizeof(float))
+
+typedef struct {
+    const char* name;
+
+    /**
+     * Map the input tensor for writing
+     * @param size Output: tensor size in bytes
+     * @return Writable pointer, NULL on failure
+     */
+    void* (*map_input)(void* impl, size_t* size);
+    void (*unmap_input)(void* impl, void* data, size_t size);
+
+    /**
+     * Optional: fill the input tensor from a region of an NV12 frame buffer,
+     * cropped, scaled and colour converted off the CPU (NULL if unsupported)
+     * @param fd, offset dma-buf holding the frame (e.g. a VDO buffer)
+     * @param width, height Frame size
+     * @param crop Region as x, y, width, height in frame pixels
+     * @param slot, slots Batch item to fill of a tensor holding slots items
+     *                    (0, 1 for an unbatched model)
+     * @return 1 on success, 0 on failure
+     */
+    int (*set_input_crop)(void* impl, int fd, int64_t offset, unsigned int width,
+                          unsigned int height, const int crop[4], unsigned int slot,
+                          unsigned int slots);
+
+    /**
+     * Run the model on the current input tensor
+     * @return 1 on success, 0 on failure
+     */
+    int (*invoke)(void* impl);
+
+    /**
+     * Map the first output tensor as float32
+     * @param size Output: size in bytes
+     * @return Read-only pointer, NULL on failure
+     */
+    const float* (*map_output)(void* impl, size_t* size);
+    void (*unmap_output)(void* impl, const float* data, size_t size);
+
+    void (*cleanup)(void* impl);
+} InferenceBackendOps;
+
+typedef struct {
+    const InferenceBackendOps* ops;
+    void* impl;
+} InferenceBackend;
+
+/**
+ * Open the larod backend
+ * @param backend Output backend
+ * @param model_path Model file (artpec8/artpec9 variants are derived from it)
+ * @return 1 on success, 0 on failure
+ */
+int Inference_Larod_Open(InferenceBackend* backend, const char* model_path);
+
+#ifdef ENABLE_TFLITE
+/**
+ * Open the TensorFlow Lite backend
+ * @param config "inference" object: threads (0 = all online CPUs), xnnpack (default true)
+ * @return 1 on success, 0 on failure
+ */
+int Inference_Tflite_Open(InferenceBackend* backend, const char* model_path, cJSON* config);
+#endif
+
+/**
+ * Open the replay backend
+ * @param config "inference" object: replay_path, replay_output_bytes, replay_input_bytes,
+ *               latency_ms
+ * @return 1 on success, 0 on failure
+ */
+int Inference_Replay_Open(InferenceBackend* backend, cJSON* config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INFERENCE_BACKEND_H */
@@ -0,0 +1,503 @@
+/**
+ * inference_larod.c
+ *
+ * Larod inference backend for Axis I.S. POC
+ * Executes the model on DLPU hardware through the larod service
+ *
+ * Uses Larod API v3 with larodListDevices() for proper device detection
+ * Supports ARTPEC-8, ARTPEC-9, and CPU fallback
+ *
+ * Region inputs (tiles, crops) go through a larod preprocessing model that
+ * reads the frame's dma-buf directly and writes the model input tensor, with
+ * the region passed per job as an "image.input.crop" map - no CPU copy
+ *
+ * Reference: https://developer.axis.com/acap/api/
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "larod.h"
+#include "inference_backend.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+// Device name patterns for DLPU detection
+// ARTPEC-8 uses "axis-a8-dlpu-tflite", ARTPEC-9 uses "a9-dlpu-tflite"
+// Use partial match pattern to support both
+#define DLPU_A9_DEVICE_NAME "a9-dlpu-tflite"
+#define DLPU_A8_DEVICE_NAME "a8-dlpu-tflite"
+#define CPU_DEVICE_NAME "cpu-tflite"
+#define PREPROC_DEVICE_NAME "cpu-proc"
+
+/* Larod backend state */
+typedef struct {
+    larodConnection* conn;
+    larodModel* model;
+    larodTensor** input_tensors;
+    larodTensor** output_tensors;
+    size_t num_inputs;
+    size_t num_outputs;
+
+    // Crop/scale/convert job feeding input_tensors, loaded for one frame size
+    larodModel* pp_model;
+    larodTensor** pp_inputs;
+    size_t pp_num_inputs;
+    larodMap* pp_crop;
+    larodTensor** pp_slot;          // Output aliasing one batch item of input_tensors[0]
+    size_t pp_num_slot;
+    unsigned int pp_width;
+    unsigned int pp_height;
+    int pp_failed;                  // Preprocessing unavailable, stop trying
+
+    larodDevice** devices;          // Listed on conn, valid while it is
+    size_t num_devices;
+} LarodBackend;
+
+/**
+ * List the connection's devices
+ * larodListDevices returns references owned by the connection, so the
+ * list belongs to its backend and is freed with it - a second backend
+ * (cascade stage) lists its own
+ */
+static int init_device_list(LarodBackend* lb) {
+    if (lb->devices) return 1;  // Already listed
+
+    larodError* error = NULL;
+    lb->devices = larodListDevices(lb->conn, &lb->num_devices, &error);
+    if (error || !lb->devices) {
+        if (error) {
+            LOG("Larod: Failed to list devices: %s\n", error->msg);
+            larodClearError(&error);
+        }
+        return 0;
+    }
+
+    LOG("Larod: Found %zu devices\n", lb->num_devices);
+    for (size_t i = 0; i < lb->num_devices; i++) {
+        const char* device_name = larodGetDeviceName(lb->devices[i], &error);
+        if (error) {
+            larodClearError(&error);
+            continue;
+        }
+        LOG("Larod: Device[%zu]: %s\n", i, device_name);
+    }
+
+    return 1;
+}
+
+/**
+ * Find device by name pattern in the backend's device list
+ * Returns device on success, NULL if not found
+ */
+static larodDevice* find_device_by_name(LarodBackend* lb, const char* name_pattern) {
+    if (!init_device_list(lb)) return NULL;
+
+    larodError* error = NULL;
+    larodDevice* found_device = NULL;
+
+    // Search for matching device
+    for (size_t i = 0; i < lb->num_devices; i++) {
+        const char* device_name = larodGetDeviceName(lb->devices[i], &error);
+        if (error) {
+            larodClearError(&error);
+            continue;
+        }
+
+        if (strstr(device_name, name_pattern)) {
+            found_device = lb->devices[i];
+            LOG("Larod: Selected device: %s\n", device_name);
+            break;  // Found it, no need to continue
+        }
+    }
+
+    return found_device;
+}
+
+/**
+ * Try to load model on a specific device
+ * Returns model on success, NULL on failure
+ */
+static larodModel* try_load_model_v3(larodConnection* conn, const char* model_path,
+                                      larodDevice* device, const char* device_desc) {
+    larodError* error = NULL;
+
+    int model_fd = open(model_path, O_RDONLY);
+    if (model_fd < 0) {
+        LOG("Larod: Cannot open model file: %s\n", model_path);
+        return NULL;
+    }
+
+    LOG("Larod: Loading model %s on %s...\n", model_path, device_desc);
+
+    // Use Larod API v3 model loading with device
+    larodModel* model = larodLoadModel(conn, model_fd, device, LAROD_ACCESS_PRIVATE,
+                                        "axis_is_yolov5n", NULL, &error);
+    close(model_fd);
+
+    if (model && !error) {
+        LOG("Larod: Successfully loaded model on %s\n", device_desc);
+        return model;
+    }
+
+    if (error) {
+        LOG("Larod: Failed to load on %s: %s\n", device_desc, error->msg);
+        larodClearError(&error);
+    }
+    return NULL;
+}
+
+/**
+ * Map a tensor's fd
+ */
+static void* map_tensor(larodTensor* tensor, int prot, size_t* size) {
+    larodError* error = NULL;
+
+    int fd = larodGetTensorFd(tensor, &error);
+    if (fd < 0 || error) {
+        LOG_ERR("Failed to get tensor fd: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        return NULL;
+    }
+
+    if (!larodGetTensorFdSize(tensor, size, &error) || error) {
+        LOG_ERR("Failed to get tensor size: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        return NULL;
+    }
+
+    void* data = mmap(NULL, *size, prot, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        LOG_ERR("Failed to mmap tensor\n");
+        return NULL;
+    }
+    return data;
+}
+
+static void* larod_map_input(void* impl, size_t* size) {
+    LarodBackend* lb = (LarodBackend*)impl;
+    if (!lb->input_tensors || lb->num_inputs == 0 || !lb->input_tensors[0]) {
+        LOG_ERR("Larod input tensor[0] is not allocated\n");
+        return NULL;
+    }
+    return map_tensor(lb->input_tensors[0], PROT_READ | PROT_WRITE, size);
+}
+
+static void larod_unmap_input(void* impl, void* data, size_t size) {
+    munmap(data, size);
+}
+
+static int larod_invoke(void* impl) {
+    LarodBackend* lb = (LarodBackend*)impl;
+    larodError* error = NULL;
+
+    larodJobRequest* req = larodCreateJobRequest(
+        lb->model,
+        lb->input_tensors,
+        lb->num_inputs,
+        lb->output_tensors,
+        lb->num_outputs,
+        NULL,  // No crop map
+        &error
+    );
+
+    if (!req || error) {
+        LOG_ERR("Failed to create job request: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        return 0;
+    }
+
+    // Run inference synchronously
+    int job_ok = larodRunJob(lb->conn, req, &error);
+    if (!job_ok) {
+        LOG_ERR("Inference failed: %s\n", error ? error->msg : "Unknown error");
+        if (error) larodClearError(&error);
+    }
+
+    larodDestroyJobRequest(&req);
+    return job_ok ? 1 : 0;
+}
+
+static void release_preprocess(LarodBackend* lb) {
+    if (lb->pp_inputs) {
+        larodDestroyTensors(lb->conn, &lb->pp_inputs, lb->pp_num_inputs, NULL);
+    }
+    if (lb->pp_model) {
+        larodDestroyModel(&lb->pp_model);
+    }
+    if (lb->pp_crop) {
+        larodDestroyMap(&lb->pp_crop);
+    }
+    if (lb->pp_slot) {
+        larodDestroyTensors(lb->conn, &lb->pp_slot, lb->pp_num_slot, NULL);
+    }
+    lb->pp_width = 0;
+    lb->pp_height = 0;
+}
+
+/**
+ * Load the preprocessing model for NV12 frames of width x height
+ * Output size and layout are those of the detection model's input tensor
+ */
+static int load_preprocess(LarodBackend* lb, unsigned int width, unsigned int height) {
+    if (lb->pp_model && lb->pp_width == width && lb->pp_height == height) return 1;
+    release_preprocess(lb);
+
+    larodError* error = NULL;
+    const larodTensorDims* dims = larodGetTensorDims(lb->input_tensors[0], &error);
+    if (!dims || dims->len < 3) {
+        LOG_ERR("Larod: Unknown model input dimensions: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        return 0;
+    }
+    // NHWC
+    size_t out_height = dims->dims[dims->len - 3];
+    size_t out_width = dims->dims[dims->len - 2];
+
+    const larodDevice* device = larodGetDevice(lb->conn, PREPROC_DEVICE_NAME, 0, &error);
+    larodMap* params = device ? larodCreateMap(&error) : NULL;
+    int ok = params &&
+             larodMapSetStr(params, "image.input.format", "nv12", &error) &&
+             larodMapSetIntArr2(params, "image.input.size", width, height, &error) &&
+             larodMapSetStr(params, "image.output.format", "rgb-interleaved", &error) &&
+             larodMapSetIntArr2(params, "image.output.size", (int64_t)out_width, (int64_t)out_height, &error);
+    if (ok) {
+        lb->pp_model = larodLoadModel(lb->conn, -1, device, LAROD_ACCESS_PRIVATE, "axis_is_crop",
+                                      params, &error);
+    }
+    if (params) larodDestroyMap(&params);
+    if (lb->pp_model) {
+        lb->pp_inputs = larodCreateModelInputs(lb->pp_model, &lb->pp_num_inputs, &error);
+    }
+    if (lb->pp_inputs) {
+        lb->pp_crop = larodCreateMap(&error);
+    }
+
+    if (!lb->pp_crop) {
+        LOG("Larod: Crop preprocessing unavailable (%s) - regions are cropped on the CPU\n",
+            error ? error->msg : "no " PREPROC_DEVICE_NAME " device");
+        if (error) larodClearError(&error);
+        release_preprocess(lb);
+        return 0;
+    }
+
+    lb->pp_width = width;
+    lb->pp_height = height;
+    LOG("Larod: Crop preprocessing %ux%u NV12 -> %zux%zu RGB on %s\n",
+        width, height, out_width, out_height, PREPROC_DEVICE_NAME);
+    return 1;
+}
+
+/**
+ * Point the slot output at batch item slot of the model input tensor
+ */
+static int bind_slot(LarodBackend* lb, unsigned int slot, unsigned int slots, larodError** error) {
+    if (!lb->pp_slot) {
+        lb->pp_slot = larodCreateModelOutputs(lb->pp_model, &lb->pp_num_slot, error);
+        if (!lb->pp_slot) return 0;
+    }
+    size_t size = 0;
+    int fd = larodGetTensorFd(lb->input_tensors[0], error);
+    if (fd < 0 || !larodGetTensorFdSize(lb->input_tensors[0], &size, error)) return 0;
+    return larodSetTensorFd(lb->pp_slot[0], fd, error) &&
+           larodSetTensorFdOffset(lb->pp_slot[0], (int64_t)(size / slots * slot), error);
+}
+
+static int larod_set_input_crop(void* impl, int fd, int64_t offset, unsigned int width,
+                                unsigned int height, const int crop[4], unsigned int slot,
+                                unsigned int slots) {
+    LarodBackend* lb = (LarodBackend*)impl;
+    if (lb->pp_failed || fd < 0 || slots == 0 || slot >= slots) return 0;
+    if (!load_preprocess(lb, width, height)) {
+        lb->pp_failed = 1;
+        return 0;
+    }
+
+    larodError* error = NULL;
+    larodJobRequest* req = NULL;
+    int batched = slots > 1;
+    if (batched && !bind_slot(lb, slot, slots, &error)) {
+        LOG_ERR("Larod: Cannot address batch item %u: %s\n", slot, error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        return 0;
+    }
+    int ok = larodSetTensorFd(lb->pp_inputs[0], fd, &error) &&
+             larodSetTensorFdOffset(lb->pp_inputs[0], offset, &error) &&
+             larodMapSetIntArr4(lb->pp_crop, "image.input.crop", crop[0], crop[1], crop[2], crop[3],
+                                &error);
+    if (ok) {
+        req = larodCreateJobRequest(lb->pp_model, lb->pp_inputs, lb->pp_num_inputs,
+                                    batched ? lb->pp_slot : lb->input_tensors,
+                                    batched ? lb->pp_num_slot : lb->num_inputs, lb->pp_crop, &error);
+    }
+    ok = req && larodRunJob(lb->conn, req, &error);
+    if (!ok) {
+        LOG_ERR("Larod: Crop job failed: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+    }
+    if (req) larodDestroyJobRequest(&req);
+    return ok ? 1 : 0;
+}
+
+static const float* larod_map_output(void* impl, size_t* size) {
+    LarodBackend* lb = (LarodBackend*)impl;
+    if (!lb->output_tensors || lb->num_outputs == 0 || !lb->output_tensors[0]) {
+        LOG_ERR("Larod output tensor[0] is not allocated\n");
+        return NULL;
+    }
+    return (const float*)map_tensor(lb->output_tensors[0], PROT_READ, size);
+}
+
+static void larod_unmap_output(void* impl, const float* data, size_t size) {
+    munmap((void*)data, size);
+}
+
+static void larod_cleanup(void* impl) {
+    LarodBackend* lb = (LarodBackend*)impl;
+    if (!lb) return;
+
+    release_preprocess(lb);
+    if (lb->input_tensors) {
+        larodDestroyTensors(lb->conn, &lb->input_tensors, lb->num_inputs, NULL);
+    }
+    if (lb->output_tensors) {
+        larodDestroyTensors(lb->conn, &lb->output_tensors, lb->num_outputs, NULL);
+    }
+    if (lb->model) {
+        larodDestroyModel(&lb->model);
+    }
+    // Device list before its connection
+    free(lb->devices);
+    if (lb->conn) {
+        larodDisconnect(&lb->conn, NULL);
+    }
+
+    free(lb);
+}
+
+static const InferenceBackendOps larod_ops = {
+    .name = "larod",
+    .map_input = larod_map_input,
+    .unmap_input = larod_unmap_input,
+    .set_input_crop = larod_set_input_crop,
+    .invoke = larod_invoke,
+    .map_output = larod_map_output,
+    .unmap_output = larod_unmap_output,
+    .cleanup = larod_cleanup
+};
+
+int Inference_Larod_Open(InferenceBackend* backend, const char* model_path) {
+    LarodBackend* lb = (LarodBackend*)calloc(1, sizeof(LarodBackend));
+    if (!lb) {
+        LOG_ERR("Failed to allocate Larod backend\n");
+        return 0;
+    }
+
+    larodError* error = NULL;
+
+    // Connect to Larod service
+    if (!larodConnect(&lb->conn, &error)) {
+        LOG_ERR("Failed to connect to Larod: %s\n", error ? error->msg : "unknown");
+        if (error) larodClearError(&error);
+        free(lb);
+        return 0;
+    }
+
+    LOG("Larod: Connected to larod service\n");
+    LOG("Larod: Auto-detecting available inference devices...\n");
+
+    // Determine model paths for ARTPEC-8 and ARTPEC-9
+    // Both use the same DLPU device name but need different model files
+    char artpec9_path[512] = {0};
+    char artpec8_path[512] = {0};
+
+    if (strstr(model_path, "artpec8")) {
+        // Config specifies artpec8 - derive artpec9 path
+        strncpy(artpec8_path, model_path, sizeof(artpec8_path) - 1);
+        strncpy(artpec9_path, model_path, sizeof(artpec9_path) - 1);
+        char* p = strstr(artpec9_path, "artpec8");
+        if (p) memcpy(p, "artpec9", 7);
+    } else if (strstr(model_path, "artpec9")) {
+        // Config specifies artpec9 - derive artpec8 path
+        strncpy(artpec9_path, model_path, sizeof(artpec9_path) - 1);
+        strncpy(artpec8_path, model_path, sizeof(artpec8_path) - 1);
+        char* p = strstr(artpec8_path, "artpec9");
+        if (p) memcpy(p, "artpec8", 7);
+    } else {
+        // Generic path - use as-is for both
+        strncpy(artpec9_path, model_path, sizeof(artpec9_path) - 1);
+        strncpy(artpec8_path, model_path, sizeof(artpec8_path) - 1);
+    }
+
+    // Find available DLPU devices - ARTPEC-9 uses "a9-dlpu-tflite", ARTPEC-8 uses patterns with "a8-dlpu"
+    larodDevice* dlpu_a9_device = find_device_by_name(lb, DLPU_A9_DEVICE_NAME);
+    larodDevice* dlpu_a8_device = find_device_by_name(lb, DLPU_A8_DEVICE_NAME);
+    larodDevice* cpu_device = find_device_by_name(lb, CPU_DEVICE_NAME);
+
+    // Try ARTPEC-9 DLPU first (for P3285-LVE and other ARTPEC-9 cameras)
+    if (dlpu_a9_device && access(artpec9_path, R_OK) == 0) {
+        LOG("Larod: Trying ARTPEC-9 DLPU with model: %s\n", artpec9_path);
+        lb->model = try_load_model_v3(lb->conn, artpec9_path, dlpu_a9_device, "DLPU (ARTPEC-9)");
+    }
+
+    // Try ARTPEC-8 DLPU
+    if (!lb->model && dlpu_a8_device && access(artpec8_path, R_OK) == 0) {
+        LOG("Larod: Trying ARTPEC-8 DLPU with model: %s\n", artpec8_path);
+        lb->model = try_load_model_v3(lb->conn, artpec8_path, dlpu_a8_device, "DLPU (ARTPEC-8)");
+    }
+
+    // Fallback to CPU with any available model
+    if (!lb->model && cpu_device) {
+        if (access(artpec9_path, R_OK) == 0) {
+            lb->model = try_load_model_v3(lb->conn, artpec9_path, cpu_device, "CPU (ARTPEC-9 model)");
+        }
+        if (!lb->model && access(artpec8_path, R_OK) == 0) {
+            lb->model = try_load_model_v3(lb->conn, artpec8_path, cpu_device, "CPU (ARTPEC-8 model)");
+        }
+        if (!lb->model && access(model_path, R_OK) == 0) {
+            lb->model = try_load_model_v3(lb->conn, model_path, cpu_device, "CPU (original model)");
+        }
+    }
+
+    if (!lb->model) {
+        LOG_ERR("Failed to load model on any available device\n");
+        LOG_ERR("Tried paths: %s, %s\n", artpec9_path, artpec8_path);
+        larod_cleanup(lb);
+        return 0;
+    }
+
+    // Allocate input and output tensors using Larod API v3 signatures
+    // larodAllocModelInputs(conn, model, fdPropFlags, numTensors, params, error)
+    lb->input_tensors = larodAllocModelInputs(lb->conn, lb->model, 0, &lb->num_inputs, NULL, &error);
+    if (!lb->input_tensors || error) {
+        LOG_ERR("Failed to allocate input tensors: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        larod_cleanup(lb);
+        return 0;
+    }
+
+    // larodAllocModelOutputs(conn, model, fdPropFlags, numTensors, params, error)
+    lb->output_tensors = larodAllocModelOutputs(lb->conn, lb->model, 0, &lb->num_outputs, NULL, &error);
+    if (!lb->output_tensors || error) {
+        LOG_ERR("Failed to allocate output tensors: %s\n", error ? error->msg : "Unknown");
+        if (error) larodClearError(&error);
+        larod_cleanup(lb);
+        return 0;
+    }
+
+    LOG("Larod: Inputs=%zu Outputs=%zu\n", lb->num_inputs, lb->num_outputs);
+
+    backend->ops = &larod_ops;
+    backend->impl = lb;
+    return 1;
+}
@@ -0,0 +1,217 @@
+/**
+ * inference_replay.c
+ *
+ * Replay inference backend for Axis I.S. POC
+ * Returns recorded output tensors instead of running a model, after an
+ * optional simulated latency. The recording is a flat file of back-to-back
+ * float32 output tensors (replay_output_bytes each), or a capture log
+ * segment whose tensor records are used, and is replayed in a loop.
+ * Without a recording every inference returns an all-zero tensor, which
+ * decodes to no detections.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "inference_backend.h"
+#include "capture_log.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+/* Replay backend state */
+typedef struct {
+    uint8_t* input;             // Scratch input tensor (contents ignored)
+    size_t input_bytes;
+    uint8_t* records;           // Mapped recording, or a single zeroed tensor
+    size_t map_size;            // Non-zero when records is a file mapping
+    size_t* offsets;            // Record offsets in a capture segment, NULL for flat files
+    size_t output_bytes;
+    size_t record_count;
+    size_t next;
+    size_t current;
+    int latency_ms;
+} ReplayBackend;
+
+static void* replay_map_input(void* impl, size_t* size) {
+    ReplayBackend* rb = (ReplayBackend*)impl;
+    *size = rb->input_bytes;
+    return rb->input;
+}
+
+static void replay_unmap_input(void* impl, void* data, size_t size) {
+}
+
+static int replay_invoke(void* impl) {
+    ReplayBackend* rb = (ReplayBackend*)impl;
+
+    if (rb->latency_ms > 0) {
+        struct timespec ts = {
+            .tv_sec = rb->latency_ms / 1000,
+            .tv_nsec = (long)(rb->latency_ms % 1000) * 1000000L
+        };
+        while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {}
+    }
+
+    rb->current = rb->next;
+    rb->next = (rb->next + 1) % rb->record_count;
+    return 1;
+}
+
+static const float* replay_map_output(void* impl, size_t* size) {
+    ReplayBackend* rb = (ReplayBackend*)impl;
+    *size = rb->output_bytes;
+    size_t offset = rb->offsets ? rb->offsets[rb->current] : rb->current * rb->output_bytes;
+    return (const float*)(rb->records + offset);
+}
+
+static void replay_unmap_output(void* impl, const float* data, size_t size) {
+}
+
+static void replay_cleanup(void* impl) {
+    ReplayBackend* rb = (ReplayBackend*)impl;
+    if (!rb) return;
+    if (rb->map_size) {
+        munmap(rb->records, rb->map_size);
+    } else {
+        free(rb->records);
+    }
+    free(rb->offsets);
+    free(rb->input);
+    free(rb);
+}
+
+static const InferenceBackendOps replay_ops = {
+    .name = "replay",
+    .map_input = replay_map_input,
+    .unmap_input = replay_unmap_input,
+    .invoke = replay_invoke,
+    .map_output = replay_map_output,
+    .unmap_output = replay_unmap_output,
+    .cleanup = replay_cleanup
+};
+
+/**
+ * Index the tensor records of a mapped capture log segment
+ * @return 1 if at least one tensor of the expected size was found
+ */
+static int replay_index_capture(ReplayBackend* rb, const char* path) {
+    CaptureReader* reader = Capture_Reader_Open(path);
+    if (!reader) return 0;
+
+    size_t count = Capture_Reader_Count(reader, CAPTURE_RECORD_TENSOR);
+    rb->offsets = (size_t*)malloc((count ? count : 1) * sizeof(size_t));
+    rb->record_count = 0;
+    for (size_t i = 0; rb->offsets && i < count; i++) {
+        CaptureIndexEntry entry;
+        Capture_Reader_Get(reader, CAPTURE_RECORD_TENSOR, i, &entry);
+        if (entry.size == rb->output_bytes) {
+            rb->offsets[rb->record_count++] = (size_t)entry.offset;
+        }
+    }
+    Capture_Reader_Close(reader);
+
+    if (rb->record_count == 0) {
+        LOG_ERR("Replay: %s holds no %zu-byte tensor records\n", path, rb->output_bytes);
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Map a recording file
+ * @return 1 on success
+ */
+static int replay_load(ReplayBackend* rb, const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERR("Replay: Cannot open %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < rb->output_bytes) {
+        LOG_ERR("Replay: %s holds no complete %zu-byte output tensor\n", path, rb->output_bytes);
+        close(fd);
+        return 0;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        LOG_ERR("Replay: mmap of %s failed: %s\n", path, strerror(errno));
+        return 0;
+    }
+
+    rb->records = (uint8_t*)base;
+    rb->map_size = (size_t)st.st_size;
+    if (Capture_Is_Segment(base, rb->map_size)) {
+        return replay_index_capture(rb, path);
+    }
+    rb->record_count = rb->map_size / rb->output_bytes;
+    if (rb->map_size % rb->output_bytes) {
+        LOG("Replay: Ignoring %zu trailing bytes in %s\n", rb->map_size % rb->output_bytes, path);
+    }
+    return 1;
+}
+
+int Inference_Replay_Open(InferenceBackend* backend, cJSON* config) {
+    ReplayBackend* rb = (ReplayBackend*)calloc(1, sizeof(ReplayBackend));
+    if (!rb) {
+        LOG_ERR("Replay: Failed to allocate backend\n");
+        return 0;
+    }
+
+    cJSON* item = cJSON_GetObjectItem(config, "replay_output_bytes");
+    rb->output_bytes = item && cJSON_IsNumber(item) && item->valuedouble > 0 ?
+                       (size_t)item->valuedouble : INFERENCE_DEFAULT_OUTPUT_BYTES;
+    item = cJSON_GetObjectItem(config, "replay_input_bytes");
+    rb->input_bytes = item && cJSON_IsNumber(item) && item->valuedouble > 0 ?
+                      (size_t)item->valuedouble : INFERENCE_DEFAULT_INPUT_BYTES;
+    item = cJSON_GetObjectItem(config, "latency_ms");
+    rb->latency_ms = item && cJSON_IsNumber(item) && item->valueint > 0 ? item->valueint : 0;
+
+    rb->input = (uint8_t*)malloc(rb->input_bytes);
+    if (!rb->input) {
+        LOG_ERR("Replay: Failed to allocate input tensor\n");
+        replay_cleanup(rb);
+        return 0;
+    }
+
+    item = cJSON_GetObjectItem(config, "replay_path");
+    const char* path = item && cJSON_IsString(item) ? item->valuestring : NULL;
+    if (path && *path) {
+        if (!replay_load(rb, path)) {
+            replay_cleanup(rb);
+            return 0;
+        }
+    } else {
+        rb->records = (uint8_t*)calloc(1, rb->output_bytes);
+        rb->record_count = 1;
+        if (!rb->records) {
+            LOG_ERR("Replay: Failed to allocate output tensor\n");
+            replay_cleanup(rb);
+            return 0;
+        }
+    }
+
+    LOG("Replay: %zu recorded outputs (%s), latency %dms\n", rb->record_count,
+        path && *path ? path : "empty", rb->latency_ms);
+
+    backend->ops = &replay_ops;
+    backend->impl = rb;
+    return 1;
+}
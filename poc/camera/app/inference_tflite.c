@@ -0,0 +1,196 @@
+/**
+ * inference_tflite.c
+ *
+ * TensorFlow Lite inference backend for Axis I.S. POC
+ * Runs the model in-process through the TFLite C API, with the XNNPACK
+ * delegate for multi-threaded CPU inference. Intended for cameras without
+ * a DLPU and for running the pipeline on x86/aarch64 Linux hosts.
+ *
+ * Only compiled with ENABLE_TFLITE=1 (links libtensorflowlite_c).
+ */
+
+#ifdef ENABLE_TFLITE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+#include "tensorflow/lite/c/c_api.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "inference_backend.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+/* TFLite backend state */
+typedef struct {
+    TfLiteModel* model;
+    TfLiteInterpreterOptions* options;
+    TfLiteDelegate* xnnpack;
+    TfLiteInterpreter* interpreter;
+    float* dequantized;         // Float copy of a quantized output tensor
+    size_t dequantized_count;
+} TfliteBackend;
+
+static void* tflite_map_input(void* impl, size_t* size) {
+    TfliteBackend* tb = (TfliteBackend*)impl;
+    TfLiteTensor* tensor = TfLiteInterpreterGetInputTensor(tb->interpreter, 0);
+    if (!tensor) return NULL;
+    *size = TfLiteTensorByteSize(tensor);
+    return TfLiteTensorData(tensor);
+}
+
+static void tflite_unmap_input(void* impl, void* data, size_t size) {
+}
+
+static int tflite_invoke(void* impl) {
+    TfliteBackend* tb = (TfliteBackend*)impl;
+    if (TfLiteInterpreterInvoke(tb->interpreter) != kTfLiteOk) {
+        LOG_ERR("TFLite: Invoke failed\n");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Output tensor as float32
+ * INT8/UINT8 outputs (Axis Model Zoo exports) are dequantized into a
+ * buffer owned by the backend; float outputs are returned in place
+ */
+static const float* tflite_map_output(void* impl, size_t* size) {
+    TfliteBackend* tb = (TfliteBackend*)impl;
+    const TfLiteTensor* tensor = TfLiteInterpreterGetOutputTensor(tb->interpreter, 0);
+    if (!tensor) return NULL;
+
+    size_t bytes = TfLiteTensorByteSize(tensor);
+    TfLiteType type = TfLiteTensorType(tensor);
+    if (type == kTfLiteFloat32) {
+        *size = bytes;
+        return (const float*)TfLiteTensorData(tensor);
+    }
+    if (type != kTfLiteInt8 && type != kTfLiteUInt8) {
+        LOG_ERR("TFLite: Unsupported output tensor type %d\n", (int)type);
+        return NULL;
+    }
+
+    if (tb->dequantized_count < bytes) {
+        float* grown = (float*)realloc(tb->dequantized, bytes * sizeof(float));
+        if (!grown) {
+            LOG_ERR("TFLite: Failed to allocate dequantization buffer\n");
+            return NULL;
+        }
+        tb->dequantized = grown;
+        tb->dequantized_count = bytes;
+    }
+
+    TfLiteQuantizationParams q = TfLiteTensorQuantizationParams(tensor);
+    const void* data = TfLiteTensorData(tensor);
+    if (type == kTfLiteInt8) {
+        const int8_t* in = (const int8_t*)data;
+        for (size_t i = 0; i < bytes; i++) {
+            tb->dequantized[i] = q.scale * (float)(in[i] - q.zero_point);
+        }
+    } else {
+        const uint8_t* in = (const uint8_t*)data;
+        for (size_t i = 0; i < bytes; i++) {
+            tb->dequantized[i] = q.scale * (float)((int)in[i] - q.zero_point);
+        }
+    }
+
+    *size = bytes * sizeof(float);
+    return tb->dequantized;
+}
+
+static void tflite_unmap_output(void* impl, const float* data, size_t size) {
+}
+
+static void tflite_cleanup(void* impl) {
+    TfliteBackend* tb = (TfliteBackend*)impl;
+    if (!tb) return;
+
+    // Interpreter must go before the delegate it was built with
+    if (tb->interpreter) TfLiteInterpreterDelete(tb->interpreter);
+    if (tb->xnnpack) TfLiteXNNPackDelegateDelete(tb->xnnpack);
+    if (tb->options) TfLiteInterpreterOptionsDelete(tb->options);
+    if (tb->model) TfLiteModelDelete(tb->model);
+    free(tb->dequantized);
+    free(tb);
+}
+
+static const InferenceBackendOps tflite_ops = {
+    .name = "tflite",
+    .map_input = tflite_map_input,
+    .unmap_input = tflite_unmap_input,
+    .invoke = tflite_invoke,
+    .map_output = tflite_map_output,
+    .unmap_output = tflite_unmap_output,
+    .cleanup = tflite_cleanup
+};
+
+int Inference_Tflite_Open(InferenceBackend* backend, const char* model_path, cJSON* config) {
+    TfliteBackend* tb = (TfliteBackend*)calloc(1, sizeof(TfliteBackend));
+    if (!tb) {
+        LOG_ERR("TFLite: Failed to allocate backend\n");
+        return 0;
+    }
+
+    cJSON* item = cJSON_GetObjectItem(config, "threads");
+    int threads = item && cJSON_IsNumber(item) ? item->valueint : 0;
+    if (threads <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (int)cpus : 1;
+    }
+    item = cJSON_GetObjectItem(config, "xnnpack");
+    int use_xnnpack = item ? cJSON_IsTrue(item) : 1;
+
+    tb->model = TfLiteModelCreateFromFile(model_path);
+    if (!tb->model) {
+        LOG_ERR("TFLite: Cannot load model %s\n", model_path);
+        tflite_cleanup(tb);
+        return 0;
+    }
+
+    tb->options = TfLiteInterpreterOptionsCreate();
+    TfLiteInterpreterOptionsSetNumThreads(tb->options, threads);
+
+    if (use_xnnpack) {
+        TfLiteXNNPackDelegateOptions xnn_opts = TfLiteXNNPackDelegateOptionsDefault();
+        xnn_opts.num_threads = threads;
+        tb->xnnpack = TfLiteXNNPackDelegateCreate(&xnn_opts);
+        if (tb->xnnpack) {
+            TfLiteInterpreterOptionsAddDelegate(tb->options, tb->xnnpack);
+        } else {
+            LOG("TFLite: XNNPACK delegate unavailable, using builtin kernels\n");
+        }
+    }
+
+    tb->interpreter = TfLiteInterpreterCreate(tb->model, tb->options);
+    if (!tb->interpreter) {
+        LOG_ERR("TFLite: Failed to create interpreter\n");
+        tflite_cleanup(tb);
+        return 0;
+    }
+
+    if (TfLiteInterpreterAllocateTensors(tb->interpreter) != kTfLiteOk) {
+        LOG_ERR("TFLite: Failed to allocate tensors\n");
+        tflite_cleanup(tb);
+        return 0;
+    }
+
+    LOG("TFLite: Loaded %s (threads=%d, xnnpack=%s) Inputs=%d Outputs=%d\n", model_path, threads,
+        tb->xnnpack ? "on" : "off",
+        TfLiteInterpreterGetInputTensorCount(tb->interpreter),
+        TfLiteInterpreterGetOutputTensorCount(tb->interpreter));
+
+    backend->ops = &tflite_ops;
+    backend->impl = tb;
+    return 1;
+}
+
+#endif /* ENABLE_TFLITE */
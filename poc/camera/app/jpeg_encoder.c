@@ -0,0 +1,135 @@
+/**
+ * jpeg_encoder.c
+ *
+ * Shared JPEG encoder implementation for Axis I.S. POC
+ *
+ * jpeg_mem_dest() grows into a buffer libjpeg allocates itself and only
+ * hands it back from jpeg_finish_compress(); on an error longjmp that
+ * buffer is lost. This destination manager writes straight into the
+ * caller's JpegBuffer instead and keeps its pointer current after every
+ * realloc, so the error path has nothing to free.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <setjmp.h>
+#include <syslog.h>
+#include <jpeglib.h>
+#include <jerror.h>
+#include "jpeg_encoder.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define JPEG_MIN_CAPACITY (16 * 1024)
+
+/**
+ * JPEG encoding error handler
+ */
+typedef struct {
+    struct jpeg_error_mgr pub;
+    jmp_buf setjmp_buffer;
+} JpegError;
+
+static void jpeg_error_exit(j_common_ptr cinfo) {
+    JpegError* err = (JpegError*)cinfo->err;
+    longjmp(err->setjmp_buffer, 1);
+}
+
+/* Destination writing into a JpegBuffer */
+typedef struct {
+    struct jpeg_destination_mgr pub;
+    JpegBuffer* out;
+} BufferDest;
+
+static void init_destination(j_compress_ptr cinfo) {
+    BufferDest* dest = (BufferDest*)cinfo->dest;
+    JpegBuffer* out = dest->out;
+    if (out->capacity < JPEG_MIN_CAPACITY) {
+        uint8_t* grown = (uint8_t*)realloc(out->data, JPEG_MIN_CAPACITY);
+        if (!grown) ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+        out->data = grown;
+        out->capacity = JPEG_MIN_CAPACITY;
+    }
+    dest->pub.next_output_byte = out->data;
+    dest->pub.free_in_buffer = out->capacity;
+}
+
+static boolean empty_output_buffer(j_compress_ptr cinfo) {
+    BufferDest* dest = (BufferDest*)cinfo->dest;
+    JpegBuffer* out = dest->out;
+    // libjpeg calls this with the whole buffer used
+    size_t used = out->capacity;
+    uint8_t* grown = (uint8_t*)realloc(out->data, used * 2);
+    if (!grown) ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 1);
+    out->data = grown;
+    out->capacity = used * 2;
+    dest->pub.next_output_byte = out->data + used;
+    dest->pub.free_in_buffer = out->capacity - used;
+    return TRUE;
+}
+
+static void term_destination(j_compress_ptr cinfo) {
+    BufferDest* dest = (BufferDest*)cinfo->dest;
+    dest->out->size = dest->out->capacity - dest->pub.free_in_buffer;
+}
+
+size_t Jpeg_Encode(const JpegImage* image, JpegBuffer* out) {
+    if (!image || !out || image->width == 0 || image->height == 0) return 0;
+    if (!image->pixels && !image->row) return 0;
+    out->size = 0;
+
+    struct jpeg_compress_struct cinfo;
+    JpegError jerr;
+    BufferDest dest = {
+        .pub = { .init_destination = init_destination,
+                 .empty_output_buffer = empty_output_buffer,
+                 .term_destination = term_destination },
+        .out = out
+    };
+
+    cinfo.err = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = jpeg_error_exit;
+    if (setjmp(jerr.setjmp_buffer)) {
+        jpeg_destroy_compress(&cinfo);
+        out->size = 0;
+        LOG_ERR("Jpeg: Encoding %ux%u failed\n", image->width, image->height);
+        return 0;
+    }
+
+    jpeg_create_compress(&cinfo);
+    cinfo.dest = &dest.pub;
+    cinfo.image_width = image->width;
+    cinfo.image_height = image->height;
+    cinfo.input_components = 3;
+    cinfo.in_color_space = image->ycbcr ? JCS_YCbCr : JCS_RGB;
+    jpeg_set_defaults(&cinfo);
+    jpeg_set_quality(&cinfo, image->quality < 1 ? 1 : image->quality > 100 ? 100 : image->quality,
+                     TRUE);
+    jpeg_start_compress(&cinfo, TRUE);
+
+    size_t stride = image->stride ? image->stride : (size_t)image->width * 3;
+    while (cinfo.next_scanline < cinfo.image_height) {
+        unsigned int y = cinfo.next_scanline;
+        JSAMPROW row = (JSAMPROW)(image->pixels ? image->pixels + (size_t)y * stride
+                                                : image->row(y, image->user));
+        jpeg_write_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(&cinfo);
+    jpeg_destroy_compress(&cinfo);
+    return out->size;
+}
+
+void Jpeg_Buffer_Free(JpegBuffer* buffer) {
+    if (!buffer) return;
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->size = 0;
+    buffer->capacity = 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * jpeg_encoder.h
+ *
+ * Shared JPEG encoder for Axis I.S. POC
+ * The view cache, the best-shot uploader and encode_jpeg() all compress
+ * through here. Output goes to a caller-owned buffer that is grown with
+ * realloc and kept between calls, so a steady stream of same-sized images
+ * stops allocating. libjpeg never holds a buffer of its own: when encoding
+ * fails the caller's buffer is still the only one, and nothing leaks.
+ */
+
+#ifndef JPEG_ENCODER_H
+#define JPEG_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Encode destination, reused across calls; zero-initialize before first use */
+typedef struct {
+    uint8_t* data;
+    size_t size;                        // Bytes of the last image
+    size_t capacity;
+} JpegBuffer;
+
+/**
+ * Produce one row of 3-byte pixels
+ * @param y Row index
+ * @return The row, valid until the next call
+ */
+typedef const uint8_t* (*JpegRowFn)(unsigned int y, void* user);
+
+/* Image to encode - interleaved rows in memory, or rows from a callback */
+typedef struct {
+    unsigned int width;
+    unsigned int height;
+    int ycbcr;                          // Rows are YCbCr (NV12 expanded), else RGB
+    int quality;                        // 1-100
+    const uint8_t* pixels;              // First row, NULL to use row()
+    size_t stride;                      // Bytes between rows, 0 for width * 3
+    JpegRowFn row;
+    void* user;
+} JpegImage;
+
+/**
+ * Encode an image into out
+ * @return Encoded size (also in out->size), 0 on failure - out->data then
+ *         stays owned by the caller, holding no image
+ */
+size_t Jpeg_Encode(const JpegImage* image, JpegBuffer* out);
+
+/**
+ * Free the buffer and reset it to empty
+ */
+void Jpeg_Buffer_Free(JpegBuffer* buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JPEG_ENCODER_H */
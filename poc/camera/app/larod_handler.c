@@ -2,12 +2,8 @@
  * larod_handler.c
  *
  * Larod (ML inference) handler implementation for Axis I.S. POC
- * Executes YOLOv5n INT8 model on DLPU hardware
- *
- * Uses Larod API v3 with larodListDevices() for proper device detection
- * Supports ARTPEC-8, ARTPEC-9, and CPU fallback
- *
- * Reference: https://developer.axis.com/acap/api/
+ * Executes YOLOv5n INT8 model through the configured inference backend
+ * (larod DLPU/CPU, TFLite/XNNPACK, or recorded-output replay)
  */
 
 #include <stdio.h>
@@ -15,11 +11,10 @@
 #include <string.h>
 #include <syslog.h>
 #include <sys/time.h>
-#include <sys/mman.h>
-#include <fcntl.h>
-#include <unistd.h>
 #include "larod_handler.h"
-#include "vdo-buffer.h"
+#include "trace.h"
+#include "capture_log.h"
+#include "frame_arena.h"
 
 /* Undefine system LOG macros */
 #ifdef LOG_ERR
@@ -33,15 +28,9 @@
 // See: https://github.com/AxisCommunications/axis-model-zoo
 #define YOLO_INPUT_WIDTH 640
 #define YOLO_INPUT_HEIGHT 640
-#define YOLO_NUM_CLASSES 80
+#define YOLO_NUM_CLASSES LAROD_NUM_CLASSES
 #define YOLO_MAX_DETECTIONS 100
-
-// Device name patterns for DLPU detection
-// ARTPEC-8 uses "axis-a8-dlpu-tflite", ARTPEC-9 uses "a9-dlpu-tflite"
-// Use partial match pattern to support both
-#define DLPU_A9_DEVICE_NAME "a9-dlpu-tflite"
-#define DLPU_A8_DEVICE_NAME "a8-dlpu-tflite"
-#define CPU_DEVICE_NAME "cpu-tflite"
+#define YOLO_OUTPUT_FLOATS (25200 * 85)
 
 /**
  * Parse YOLO output tensor
@@ -51,17 +40,27 @@
  *
  * Note: For INT8 quantized models from Axis Model Zoo, output may need
  * dequantization depending on model export settings.
+ *
+ * With a class filter a box is kept only when its best class is enabled,
+ * and it is held to that class's threshold.
  */
-static void parse_yolo_output(LarodContext* ctx, float* output_data,
+static void parse_yolo_output(LarodContext* ctx, const float* output_data,
                               Detection* detections, int* num_detections) {
     *num_detections = 0;
+    float min_threshold = ctx->class_filter ? ctx->min_threshold : ctx->confidence_threshold;
+
+    if (ctx->class_filter) {
+        int any = 0;
+        for (int w = 0; w < (YOLO_NUM_CLASSES + 31) / 32; w++) any |= ctx->class_mask[w] != 0;
+        if (!any) return;
+    }
 
     // 25200 anchors for 640x640: (80x80 + 40x40 + 20x20) x 3
     for (int i = 0; i < 25200 && *num_detections < YOLO_MAX_DETECTIONS; i++) {
-        float* detection = &output_data[i * 85];
+        const float* detection = &output_data[i * 85];
         float objectness = detection[4];
 
-        if (objectness < ctx->confidence_threshold) continue;
+        if (objectness < min_threshold) continue;
 
         // Find class with highest score
         int best_class = 0;
@@ -72,10 +71,16 @@ static void parse_yolo_output(LarodContext* ctx, float* output_data,
                 best_class = c;
             }
         }
+        if (ctx->class_filter &&
+            !(ctx->class_mask[best_class >> 5] & (1u << (best_class & 31)))) {
+            continue;
+        }
 
         // Combined confidence
         float final_confidence = objectness * best_score;
-        if (final_confidence < ctx->confidence_threshold) continue;
+        float threshold = ctx->class_filter ? ctx->class_threshold[best_class] :
+                          ctx->confidence_threshold;
+        if (final_confidence < threshold) continue;
 
         Detection* det = &detections[*num_detections];
         det->class_id = best_class;
@@ -90,391 +95,314 @@ static void parse_yolo_output(LarodContext* ctx, float* output_data,
     }
 }
 
-/**
- * Static storage for device list to avoid use-after-free
- * larodListDevices returns borrowed references that become invalid when freed
- */
-static larodDevice** g_device_list = NULL;
-static size_t g_num_devices = 0;
-
-/**
- * Initialize device list once at startup using Larod API v3
- * Must be called before find_device_by_name()
- */
-static int init_device_list(larodConnection* conn) {
-    if (g_device_list) return 1;  // Already initialized
-
-    larodError* error = NULL;
-    g_device_list = larodListDevices(conn, &g_num_devices, &error);
-    if (error || !g_device_list) {
-        if (error) {
-            LOG("Larod: Failed to list devices: %s\n", error->msg);
-            larodClearError(&error);
-        }
+int Larod_Open_Backend(InferenceBackend* backend, const char* model_path, cJSON* config) {
+    cJSON* item = config ? cJSON_GetObjectItem(config, "backend") : NULL;
+    const char* name = item && cJSON_IsString(item) ? item->valuestring : "larod";
+
+    if (strcmp(name, "larod") == 0) {
+        return Inference_Larod_Open(backend, model_path);
+    }
+    if (strcmp(name, "tflite") == 0) {
+#ifdef ENABLE_TFLITE
+        item = cJSON_GetObjectItem(config, "model_path");
+        const char* tflite_path = item && cJSON_IsString(item) && *item->valuestring ?
+                                  item->valuestring : model_path;
+        return Inference_Tflite_Open(backend, tflite_path, config);
+#else
+        LOG_ERR("Inference backend 'tflite' not built (rebuild with ENABLE_TFLITE=1)\n");
         return 0;
+#endif
     }
-
-    LOG("Larod: Found %zu devices\n", g_num_devices);
-    for (size_t i = 0; i < g_num_devices; i++) {
-        const char* device_name = larodGetDeviceName(g_device_list[i], &error);
-        if (error) {
-            larodClearError(&error);
-            continue;
-        }
-        LOG("Larod: Device[%zu]: %s\n", i, device_name);
+    if (strcmp(name, "replay") == 0) {
+        return Inference_Replay_Open(backend, config);
     }
 
-    return 1;
+    LOG_ERR("Unknown inference backend '%s'\n", name);
+    return 0;
 }
 
-/**
- * Find device by name pattern using cached device list
- * Returns device on success, NULL if not found
- */
-static larodDevice* find_device_by_name(larodConnection* conn, const char* name_pattern) {
-    if (!g_device_list) {
-        if (!init_device_list(conn)) return NULL;
+LarodContext* Larod_Init(const char* model_path, float confidence_threshold, cJSON* config) {
+    LarodContext* ctx = (LarodContext*)calloc(1, sizeof(LarodContext));
+    if (!ctx) {
+        LOG_ERR("Failed to allocate Larod context\n");
+        return NULL;
     }
 
-    larodError* error = NULL;
-    larodDevice* found_device = NULL;
-
-    // Search for matching device
-    for (size_t i = 0; i < g_num_devices; i++) {
-        const char* device_name = larodGetDeviceName(g_device_list[i], &error);
-        if (error) {
-            larodClearError(&error);
-            continue;
-        }
+    ctx->confidence_threshold = confidence_threshold;
+    ctx->input_width = YOLO_INPUT_WIDTH;
+    ctx->input_height = YOLO_INPUT_HEIGHT;
 
-        if (strstr(device_name, name_pattern)) {
-            found_device = g_device_list[i];
-            LOG("Larod: Selected device: %s\n", device_name);
-            break;  // Found it, no need to continue
-        }
+    if (!Larod_Open_Backend(&ctx->backend, model_path, config)) {
+        free(ctx);
+        return NULL;
     }
 
-    return found_device;
+    LOG("Larod initialized: Backend=%s Threshold=%.2f\n",
+        ctx->backend.ops->name, confidence_threshold);
+    return ctx;
 }
 
-/**
- * Cleanup device list (call during shutdown)
- */
-static void cleanup_device_list(void) {
-    if (g_device_list) {
-        free(g_device_list);
-        g_device_list = NULL;
-        g_num_devices = 0;
-    }
+static int elapsed_ms(const struct timeval* start, const struct timeval* end) {
+    return (int)(((end->tv_sec - start->tv_sec) * 1000) +
+                 ((end->tv_usec - start->tv_usec) / 1000));
 }
 
-/**
- * Try to load model on a specific device
- * Returns model on success, NULL on failure
- */
-static larodModel* try_load_model_v3(larodConnection* conn, const char* model_path,
-                                      larodDevice* device, const char* device_desc) {
-    larodError* error = NULL;
-
-    int model_fd = open(model_path, O_RDONLY);
-    if (model_fd < 0) {
-        LOG("Larod: Cannot open model file: %s\n", model_path);
-        return NULL;
+int Larod_Stage_Input(LarodContext* ctx, const void* frame_data, size_t frame_size) {
+    if (!ctx || !ctx->backend.ops || !frame_data || frame_size == 0) {
+        LOG_ERR("Invalid parameters to Larod_Stage_Input\n");
+        return 0;
     }
 
-    LOG("Larod: Loading model %s on %s...\n", model_path, device_desc);
+    const InferenceBackendOps* ops = ctx->backend.ops;
+    void* impl = ctx->backend.impl;
 
-    // Use Larod API v3 model loading with device
-    larodModel* model = larodLoadModel(conn, model_fd, device, LAROD_ACCESS_PRIVATE,
-                                        "axis_is_yolov5n", NULL, &error);
-    close(model_fd);
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+
+    TraceSpan span = Trace_Begin("larod_input");
 
-    if (model && !error) {
-        LOG("Larod: Successfully loaded model on %s\n", device_desc);
-        return model;
+    size_t tensor_size = 0;
+    void* input_data = ops->map_input(impl, &tensor_size);
+    if (!input_data) {
+        LOG_ERR("Failed to map input tensor\n");
+        Trace_End(&span);
+        return 0;
     }
 
-    if (error) {
-        LOG("Larod: Failed to load on %s: %s\n", device_desc, error->msg);
-        larodClearError(&error);
+    // Copy frame data to input tensor
+    // An RGB stream negotiated at model size fills the tensor exactly; NV12
+    // frames are converted by Larod_Stage_Frame() before they get here
+    // Frames smaller than the tensor (other source resolutions) leave the tail zeroed
+    size_t copy_size = frame_size < tensor_size ? frame_size : tensor_size;
+    memcpy(input_data, frame_data, copy_size);
+    if (copy_size < tensor_size) {
+        memset((uint8_t*)input_data + copy_size, 0, tensor_size - copy_size);
     }
-    return NULL;
+
+    ops->unmap_input(impl, input_data, tensor_size);
+    Trace_End(&span);
+
+    gettimeofday(&end, NULL);
+    ctx->stage_ms = elapsed_ms(&start, &end);
+    ctx->staged = 1;
+    ctx->staged_roi = 0;
+    return 1;
 }
 
-LarodContext* Larod_Init(const char* model_path, float confidence_threshold) {
-    LarodContext* ctx = (LarodContext*)calloc(1, sizeof(LarodContext));
-    if (!ctx) {
-        LOG_ERR("Failed to allocate Larod context\n");
-        return NULL;
-    }
+int Larod_Stage_Crop(LarodContext* ctx, int fd, int64_t offset, unsigned int width,
+                     unsigned int height, const int crop[4]) {
+    if (!ctx || !ctx->backend.ops || !crop) return 0;
 
-    ctx->confidence_threshold = confidence_threshold;
-    larodError* error = NULL;
+    const InferenceBackendOps* ops = ctx->backend.ops;
+    if (!ops->set_input_crop || fd < 0) return 0;
 
-    // Connect to Larod service
-    if (!larodConnect(&ctx->conn, &error)) {
-        LOG_ERR("Failed to connect to Larod: %s\n", error ? error->msg : "unknown");
-        if (error) larodClearError(&error);
-        free(ctx);
-        return NULL;
-    }
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
 
-    LOG("Larod: Connected to larod service\n");
-    LOG("Larod: Auto-detecting available inference devices...\n");
-
-    // Determine model paths for ARTPEC-8 and ARTPEC-9
-    // Both use the same DLPU device name but need different model files
-    char artpec9_path[512] = {0};
-    char artpec8_path[512] = {0};
-
-    if (strstr(model_path, "artpec8")) {
-        // Config specifies artpec8 - derive artpec9 path
-        strncpy(artpec8_path, model_path, sizeof(artpec8_path) - 1);
-        strncpy(artpec9_path, model_path, sizeof(artpec9_path) - 1);
-        char* p = strstr(artpec9_path, "artpec8");
-        if (p) memcpy(p, "artpec9", 7);
-    } else if (strstr(model_path, "artpec9")) {
-        // Config specifies artpec9 - derive artpec8 path
-        strncpy(artpec9_path, model_path, sizeof(artpec9_path) - 1);
-        strncpy(artpec8_path, model_path, sizeof(artpec8_path) - 1);
-        char* p = strstr(artpec8_path, "artpec9");
-        if (p) memcpy(p, "artpec8", 7);
-    } else {
-        // Generic path - use as-is for both
-        strncpy(artpec9_path, model_path, sizeof(artpec9_path) - 1);
-        strncpy(artpec8_path, model_path, sizeof(artpec8_path) - 1);
-    }
+    TraceSpan span = Trace_Begin("larod_crop");
+    int ok = ops->set_input_crop(ctx->backend.impl, fd, offset, width, height, crop, 0, 1);
+    Trace_End(&span);
+    if (!ok) return 0;
 
-    // Find available DLPU devices - ARTPEC-9 uses "a9-dlpu-tflite", ARTPEC-8 uses patterns with "a8-dlpu"
-    larodDevice* dlpu_a9_device = find_device_by_name(ctx->conn, DLPU_A9_DEVICE_NAME);
-    larodDevice* dlpu_a8_device = find_device_by_name(ctx->conn, DLPU_A8_DEVICE_NAME);
-    larodDevice* cpu_device = find_device_by_name(ctx->conn, CPU_DEVICE_NAME);
+    gettimeofday(&end, NULL);
+    ctx->stage_ms = elapsed_ms(&start, &end);
+    ctx->staged = 1;
+    ctx->staged_roi = 0;
+    return 1;
+}
 
-    // Try ARTPEC-9 DLPU first (for P3285-LVE and other ARTPEC-9 cameras)
-    if (dlpu_a9_device && access(artpec9_path, R_OK) == 0) {
-        LOG("Larod: Trying ARTPEC-9 DLPU with model: %s\n", artpec9_path);
-        ctx->model = try_load_model_v3(ctx->conn, artpec9_path, dlpu_a9_device, "DLPU (ARTPEC-9)");
-    }
+void Larod_Set_Classes(LarodContext* ctx, const int* classes, int count, const float* thresholds) {
+    if (!ctx) return;
 
-    // Try ARTPEC-8 DLPU
-    if (!ctx->model && dlpu_a8_device && access(artpec8_path, R_OK) == 0) {
-        LOG("Larod: Trying ARTPEC-8 DLPU with model: %s\n", artpec8_path);
-        ctx->model = try_load_model_v3(ctx->conn, artpec8_path, dlpu_a8_device, "DLPU (ARTPEC-8)");
+    memset(ctx->class_mask, 0, sizeof(ctx->class_mask));
+    ctx->class_filter = classes != NULL || thresholds != NULL;
+    ctx->min_threshold = 1.0f;
+    for (int c = 0; c < YOLO_NUM_CLASSES; c++) {
+        ctx->class_threshold[c] = thresholds ? thresholds[c] : ctx->confidence_threshold;
     }
-
-    // Fallback to CPU with any available model
-    if (!ctx->model && cpu_device) {
-        if (access(artpec9_path, R_OK) == 0) {
-            ctx->model = try_load_model_v3(ctx->conn, artpec9_path, cpu_device, "CPU (ARTPEC-9 model)");
-        }
-        if (!ctx->model && access(artpec8_path, R_OK) == 0) {
-            ctx->model = try_load_model_v3(ctx->conn, artpec8_path, cpu_device, "CPU (ARTPEC-8 model)");
+    if (!classes) {
+        for (int c = 0; c < YOLO_NUM_CLASSES; c++) {
+            ctx->class_mask[c >> 5] |= 1u << (c & 31);
         }
-        if (!ctx->model && access(model_path, R_OK) == 0) {
-            ctx->model = try_load_model_v3(ctx->conn, model_path, cpu_device, "CPU (original model)");
+    }
+    for (int i = 0; classes && i < count; i++) {
+        if (classes[i] < 0 || classes[i] >= YOLO_NUM_CLASSES) {
+            LOG_ERR("Larod: Ignoring class id %d\n", classes[i]);
+            continue;
         }
+        ctx->class_mask[classes[i] >> 5] |= 1u << (classes[i] & 31);
     }
 
-    if (!ctx->model) {
-        LOG_ERR("Failed to load model on any available device\n");
-        LOG_ERR("Tried paths: %s, %s\n", artpec9_path, artpec8_path);
-        larodDisconnect(&ctx->conn, NULL);
-        free(ctx);
-        return NULL;
+    int enabled = 0;
+    for (int c = 0; c < YOLO_NUM_CLASSES; c++) {
+        if (!(ctx->class_mask[c >> 5] & (1u << (c & 31)))) continue;
+        if (ctx->class_threshold[c] < ctx->min_threshold) ctx->min_threshold = ctx->class_threshold[c];
+        enabled++;
     }
+    LOG("Larod: Decoding %d of %d classes (lowest threshold %.2f)\n",
+        enabled, YOLO_NUM_CLASSES, enabled ? ctx->min_threshold : 0.0f);
+}
 
-    // Allocate input and output tensors using Larod API v3 signatures
-    // larodAllocModelInputs(conn, model, fdPropFlags, numTensors, params, error)
-    ctx->input_tensors = larodAllocModelInputs(ctx->conn, ctx->model, 0, &ctx->num_inputs, NULL, &error);
-    if (!ctx->input_tensors || error) {
-        LOG_ERR("Failed to allocate input tensors: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        larodDestroyModel(&ctx->model);
-        larodDisconnect(&ctx->conn, NULL);
-        free(ctx);
-        return NULL;
-    }
+void Larod_Set_Roi(LarodContext* ctx, const float roi[4]) {
+    if (!ctx) return;
+    ctx->roi_set = roi != NULL;
+    if (roi) memcpy(ctx->roi, roi, sizeof(ctx->roi));
+}
 
-    // larodAllocModelOutputs(conn, model, fdPropFlags, numTensors, params, error)
-    ctx->output_tensors = larodAllocModelOutputs(ctx->conn, ctx->model, 0, &ctx->num_outputs, NULL, &error);
-    if (!ctx->output_tensors || error) {
-        LOG_ERR("Failed to allocate output tensors: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        larodDestroyTensors(ctx->conn, &ctx->input_tensors, ctx->num_inputs, NULL);
-        larodDestroyModel(&ctx->model);
-        larodDisconnect(&ctx->conn, NULL);
-        free(ctx);
-        return NULL;
+int Larod_Stage_Frame(LarodContext* ctx, const LarodFrame* frame) {
+    if (!ctx || !frame) return 0;
+    int roi = ctx->roi_set && frame->width > 0 && frame->height > 0;
+
+    // The source already delivers the model's layout (RGB stream at model size)
+    if (!roi && (!frame->nv12 || frame->width == 0 || frame->height == 0)) {
+        return Larod_Stage_Input(ctx, frame->data, frame->size);
+    }
+
+    // NV12, or a region of interest: RGB at model size from a crop job, or
+    // from a CPU crop - the same tensor layout on every path
+    int crop[4] = { 0, 0, (int)frame->width, (int)frame->height };
+    if (roi) {
+        crop[0] = (int)(ctx->roi[0] * (float)frame->width);
+        crop[1] = (int)(ctx->roi[1] * (float)frame->height);
+        crop[2] = (int)(ctx->roi[2] * (float)frame->width + 0.5f);
+        crop[3] = (int)(ctx->roi[3] * (float)frame->height + 0.5f);
+        // Crop jobs want even NV12 coordinates
+        crop[0] &= ~1;
+        crop[1] &= ~1;
+        crop[2] = (crop[2] + 1) & ~1;
+        crop[3] = (crop[3] + 1) & ~1;
+        if (crop[0] + crop[2] > (int)frame->width) crop[2] = (int)frame->width - crop[0];
+        if (crop[1] + crop[3] > (int)frame->height) crop[3] = (int)frame->height - crop[1];
+    }
+
+    int staged = 0;
+    if (frame->nv12 && Larod_Stage_Crop(ctx, frame->fd, frame->offset, frame->width, frame->height, crop)) {
+        if (roi) ctx->roi_zero_copy++;
+        staged = 1;
+    } else {
+        FrameView view;
+        if (frame->views && Views_Crop(frame->views, crop[0], crop[1], crop[2], crop[3],
+                                       ctx->input_width, ctx->input_height, 1, &view) &&
+            Larod_Stage_Input(ctx, view.data, view.size)) {
+            if (roi) ctx->roi_cpu_crops++;
+            staged = 1;
+        }
     }
+    if (!staged) {
+        // No way to convert - infer the frame bytes as they are
+        return Larod_Stage_Input(ctx, frame->data, frame->size);
+    }
+    if (!roi) return 1;
 
-    LOG("Larod initialized: Inputs=%zu Outputs=%zu Threshold=%.2f\n",
-        ctx->num_inputs, ctx->num_outputs, confidence_threshold);
-    return ctx;
+    // Region actually staged, normalized
+    ctx->staged_region[0] = (float)crop[0] / (float)frame->width;
+    ctx->staged_region[1] = (float)crop[1] / (float)frame->height;
+    ctx->staged_region[2] = (float)crop[2] / (float)frame->width;
+    ctx->staged_region[3] = (float)crop[3] / (float)frame->height;
+    ctx->staged_roi = 1;
+    return 1;
 }
 
-LarodResult* Larod_Run_Inference(LarodContext* ctx, VdoBuffer* vdo_buffer) {
-    if (!ctx || !vdo_buffer) {
-        LOG_ERR("Invalid parameters to Larod_Run_Inference\n");
+LarodResult* Larod_Run_Staged(LarodContext* ctx) {
+    if (!ctx || !ctx->backend.ops || !ctx->staged) {
+        LOG_ERR("Larod_Run_Staged without a staged input\n");
         return NULL;
     }
+    ctx->staged = 0;
 
-    // Validate Larod context has tensors allocated
-    if (!ctx->input_tensors || ctx->num_inputs == 0) {
-        LOG_ERR("Larod context has no input tensors allocated\n");
-        return NULL;
-    }
-    if (!ctx->output_tensors || ctx->num_outputs == 0) {
-        LOG_ERR("Larod context has no output tensors allocated\n");
-        return NULL;
-    }
-    if (!ctx->input_tensors[0]) {
-        LOG_ERR("Larod input tensor[0] is NULL\n");
-        return NULL;
-    }
+    const InferenceBackendOps* ops = ctx->backend.ops;
+    void* impl = ctx->backend.impl;
 
     struct timeval start, end;
     gettimeofday(&start, NULL);
 
-    // Get frame data directly from VDO buffer
-    void* frame_data = vdo_buffer_get_data(vdo_buffer);
-    if (!frame_data) {
-        LOG_ERR("Failed to get frame data from VDO buffer\n");
-        return NULL;
-    }
-
-    larodError* error = NULL;
-
-    // Get input tensor file descriptor for mmap access
-    int input_fd = larodGetTensorFd(ctx->input_tensors[0], &error);
-    if (input_fd < 0 || error) {
-        LOG_ERR("Failed to get input tensor fd: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        return NULL;
-    }
-
-    // Get tensor size for memory mapping
-    size_t tensor_size = 0;
-    if (!larodGetTensorFdSize(ctx->input_tensors[0], &tensor_size, &error) || error) {
-        LOG_ERR("Failed to get tensor size: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        return NULL;
-    }
-
-    // Map input tensor memory
-    void* input_data = mmap(NULL, tensor_size, PROT_READ | PROT_WRITE, MAP_SHARED, input_fd, 0);
-    if (input_data == MAP_FAILED) {
-        LOG_ERR("Failed to mmap input tensor\n");
-        return NULL;
-    }
-
-    // Copy frame data to input tensor
-    // NOTE: In production, this would include YUV→RGB conversion and normalization
-    memcpy(input_data, frame_data, tensor_size);
-
-    // Unmap input tensor
-    munmap(input_data, tensor_size);
-
-    // Create and run job request
-    larodJobRequest* req = larodCreateJobRequest(
-        ctx->model,
-        ctx->input_tensors,
-        ctx->num_inputs,
-        ctx->output_tensors,
-        ctx->num_outputs,
-        NULL,  // No crop map
-        &error
-    );
-
-    if (!req || error) {
-        LOG_ERR("Failed to create job request: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        return NULL;
-    }
-
     // Run inference synchronously
-    if (!larodRunJob(ctx->conn, req, &error)) {
-        LOG_ERR("Inference failed: %s\n", error ? error->msg : "Unknown error");
-        if (error) larodClearError(&error);
-        larodDestroyJobRequest(&req);
+    TraceSpan span = Trace_Begin("larod_run");
+    int job_ok = ops->invoke(impl);
+    Trace_End(&span);
+    if (!job_ok) {
         return NULL;
     }
 
-    larodDestroyJobRequest(&req);
-
     gettimeofday(&end, NULL);
-    int inference_ms = (int)(((end.tv_sec - start.tv_sec) * 1000) +
-                             ((end.tv_usec - start.tv_usec) / 1000));
+    // Input staging counts towards inference time, wherever it happened
+    int inference_ms = ctx->stage_ms + elapsed_ms(&start, &end);
 
     // Parse output tensor
-    LarodResult* result = (LarodResult*)calloc(1, sizeof(LarodResult));
+    // Per-frame arena when called from the pipeline, heap otherwise
+    LarodResult* result = (LarodResult*)Arena_Calloc(1, sizeof(LarodResult));
     if (!result) {
         LOG_ERR("Failed to allocate result\n");
         return NULL;
     }
 
-    result->detections = (Detection*)calloc(YOLO_MAX_DETECTIONS, sizeof(Detection));
+    result->detections = (Detection*)Arena_Calloc(YOLO_MAX_DETECTIONS, sizeof(Detection));
     if (!result->detections) {
         LOG_ERR("Failed to allocate detections\n");
-        free(result);
+        Arena_Free(result);
         return NULL;
     }
 
     result->inference_time_ms = inference_ms;
 
-    // Validate output tensor before access
-    if (!ctx->output_tensors[0]) {
-        LOG_ERR("Larod output tensor[0] is NULL\n");
-        free(result->detections);
-        free(result);
-        return NULL;
-    }
-
-    // Get output tensor file descriptor and map memory to read results
-    int output_fd = larodGetTensorFd(ctx->output_tensors[0], &error);
-    if (output_fd < 0 || error) {
-        LOG_ERR("Failed to get output tensor fd: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        free(result->detections);
-        free(result);
-        return NULL;
-    }
-
     size_t output_size = 0;
-    if (!larodGetTensorFdSize(ctx->output_tensors[0], &output_size, &error) || error) {
-        LOG_ERR("Failed to get output tensor size: %s\n", error ? error->msg : "Unknown");
-        if (error) larodClearError(&error);
-        free(result->detections);
-        free(result);
+    const float* output_data = ops->map_output(impl, &output_size);
+    if (!output_data) {
+        LOG_ERR("Failed to map output tensor\n");
+        Arena_Free(result->detections);
+        Arena_Free(result);
         return NULL;
     }
 
-    float* output_data = mmap(NULL, output_size, PROT_READ, MAP_SHARED, output_fd, 0);
-    if (output_data == MAP_FAILED) {
-        LOG_ERR("Failed to mmap output tensor\n");
-        free(result->detections);
-        free(result);
+    // The decoder walks the full YOLOv5n output - refuse anything smaller
+    if (output_size < YOLO_OUTPUT_FLOATS * sizeof(float)) {
+        LOG_ERR("Output tensor too small for YOLOv5n: %zu bytes\n", output_size);
+        ops->unmap_output(impl, output_data, output_size);
+        Arena_Free(result->detections);
+        Arena_Free(result);
         return NULL;
     }
 
     // Parse YOLO output format
+    span = Trace_Begin("larod_parse");
     parse_yolo_output(ctx, output_data, result->detections, &result->num_detections);
+    Trace_End(&span);
+
+    // Region of interest input: back to whole-frame coordinates
+    if (ctx->staged_roi) {
+        for (int i = 0; i < result->num_detections; i++) {
+            Detection* det = &result->detections[i];
+            det->x = ctx->staged_region[0] + det->x * ctx->staged_region[2];
+            det->y = ctx->staged_region[1] + det->y * ctx->staged_region[3];
+            det->width *= ctx->staged_region[2];
+            det->height *= ctx->staged_region[3];
+        }
+        ctx->staged_roi = 0;
+    }
 
-    // Unmap output tensor
-    munmap(output_data, output_size);
+    Capture_Tensor(output_data, output_size);
+
+    ops->unmap_output(impl, output_data, output_size);
 
     // Update statistics
     ctx->total_inferences++;
     ctx->total_time_ms += inference_ms;
+    ctx->last_time_ms = inference_ms;
 
     return result;
 }
 
+LarodResult* Larod_Run_Inference(LarodContext* ctx, const void* frame_data, size_t frame_size) {
+    if (!Larod_Stage_Input(ctx, frame_data, frame_size)) {
+        return NULL;
+    }
+    return Larod_Run_Staged(ctx);
+}
+
 void Larod_Free_Result(LarodResult* result) {
     if (!result) return;
-    if (result->detections) {
-        free(result->detections);
-    }
-    free(result);
+    Arena_Free(result->detections);
+    Arena_Free(result);
 }
 
 int Larod_Get_Avg_Time(LarodContext* ctx) {
@@ -488,21 +416,9 @@ void Larod_Cleanup(LarodContext* ctx) {
     LOG("Larod cleanup: Inferences=%d AvgTime=%dms\n",
         ctx->total_inferences, Larod_Get_Avg_Time(ctx));
 
-    if (ctx->input_tensors) {
-        larodDestroyTensors(ctx->conn, &ctx->input_tensors, ctx->num_inputs, NULL);
+    if (ctx->backend.ops && ctx->backend.ops->cleanup) {
+        ctx->backend.ops->cleanup(ctx->backend.impl);
     }
-    if (ctx->output_tensors) {
-        larodDestroyTensors(ctx->conn, &ctx->output_tensors, ctx->num_outputs, NULL);
-    }
-    if (ctx->model) {
-        larodDestroyModel(&ctx->model);
-    }
-    if (ctx->conn) {
-        larodDisconnect(&ctx->conn, NULL);
-    }
-
-    // Cleanup static device list
-    cleanup_device_list();
 
     free(ctx);
 }
@@ -2,20 +2,24 @@
  * larod_handler.h
  *
  * Larod (ML inference) handler for Axis I.S. POC
- * Executes YOLOv5n INT8 model on DLPU hardware
+ * Executes YOLOv5n INT8 model on DLPU hardware, or on the CPU / a replay
+ * stub through the inference backend interface
  */
 
 #ifndef LAROD_HANDLER_H
 #define LAROD_HANDLER_H
 
-#include "vdo-types.h"
-#include "vdo-buffer.h"
-#include "larod.h"
+#include <stddef.h>
+#include "cJSON.h"
+#include "inference_backend.h"
+#include "frame_views.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define LAROD_NUM_CLASSES 80            // COCO
+
 /* Forward declaration - must match module.h */
 #ifndef MODULE_H
 typedef struct {
@@ -34,34 +38,123 @@ typedef struct {
 
 /* Larod context */
 typedef struct {
-    larodConnection* conn;
-    larodModel* model;
-    larodTensor** input_tensors;
-    larodTensor** output_tensors;
-    size_t num_inputs;
-    size_t num_outputs;
+    InferenceBackend backend;
     float confidence_threshold;
+    unsigned int input_width;   // Model input size in pixels
+    unsigned int input_height;
     int total_inferences;
     int total_time_ms;
+    int last_time_ms;
+    int staged;                 // Input tensor holds a frame not yet run
+    int stage_ms;               // Time spent staging it
+    int roi_set;                // Larod_Stage_Frame() infers roi only
+    float roi[4];               // x, y, width, height normalized to the frame
+    int staged_roi;             // Staged input is staged_region - results are mapped back
+    float staged_region[4];     // roi snapped to frame pixels
+    int roi_zero_copy;          // ROI crops staged by a crop job
+    int roi_cpu_crops;          // ... and by a CPU crop
+
+    // Class filter applied by the decoder (Larod_Set_Classes)
+    int class_filter;           // 0 decodes every class at confidence_threshold
+    uint32_t class_mask[(LAROD_NUM_CLASSES + 31) / 32];
+    float class_threshold[LAROD_NUM_CLASSES];
+    float min_threshold;        // Lowest enabled class threshold
 } LarodContext;
 
+/* Frame handed to Larod_Stage_Frame() */
+typedef struct {
+    const void* data;
+    size_t size;
+    unsigned int width;
+    unsigned int height;
+    int nv12;                   // Crop jobs read NV12 only
+    int fd;                     // dma-buf of the pixels, -1 if none
+    int64_t offset;
+    FrameViews* views;          // For CPU crops, may be NULL
+} LarodFrame;
+
 /**
  * Initialize Larod inference engine
  * @param model_path Path to TFLite model file
  * @param confidence_threshold Minimum confidence for detections (0-1)
+ * @param config "inference" object from core.json (NULL selects the larod backend)
+ *               backend: "larod" (default), "tflite" or "replay"
  * @return LarodContext pointer on success, NULL on failure
  */
-LarodContext* Larod_Init(const char* model_path, float confidence_threshold);
+LarodContext* Larod_Init(const char* model_path, float confidence_threshold, cJSON* config);
+
+/**
+ * Open an inference backend for a model (second-stage models get their own)
+ * @param config Object with backend: "larod" (default), "tflite" or "replay"
+ *               plus that backend's keys
+ * @return 1 on success, 0 on failure
+ */
+int Larod_Open_Backend(InferenceBackend* backend, const char* model_path, cJSON* config);
 
 /**
  * Run inference on frame
  * @param ctx Larod context
- * @param vdo_buffer VDO frame buffer
+ * @param frame_data Frame pixels
+ * @param frame_size Bytes at frame_data
  * @return LarodResult pointer on success, NULL on failure
  *
  * IMPORTANT: Caller must call Larod_Free_Result() when done
  */
-LarodResult* Larod_Run_Inference(LarodContext* ctx, VdoBuffer* vdo_buffer);
+LarodResult* Larod_Run_Inference(LarodContext* ctx, const void* frame_data, size_t frame_size);
+
+/**
+ * Copy a frame into the input tensor without running the model
+ * Lets the caller return the frame buffer before inference starts
+ * @return 1 on success, 0 on failure
+ */
+int Larod_Stage_Input(LarodContext* ctx, const void* frame_data, size_t frame_size);
+
+/**
+ * Fill the input tensor with a region of a frame's dma-buf, scaled to the
+ * model input size by the backend (no CPU copy)
+ * @param fd, offset Frame buffer file descriptor and offset of the pixels
+ * @param width, height NV12 frame size
+ * @param crop Region as x, y, width, height in frame pixels
+ * @return 1 on success, 0 if the backend cannot crop (the caller crops on
+ *         the CPU and uses Larod_Stage_Input()) or the job failed
+ */
+int Larod_Stage_Crop(LarodContext* ctx, int fd, int64_t offset, unsigned int width,
+                     unsigned int height, const int crop[4]);
+
+/**
+ * Restrict decoding to some classes, each with its own threshold
+ * Classes not enabled are never scored or stored.
+ * @param classes Class ids to decode, NULL for all
+ * @param count Entries at classes
+ * @param thresholds Minimum confidence per class id (LAROD_NUM_CLASSES
+ *                   entries), NULL for confidence_threshold everywhere
+ */
+void Larod_Set_Classes(LarodContext* ctx, const int* classes, int count, const float* thresholds);
+
+/**
+ * Restrict the full-frame pass to a region of interest
+ * @param roi x, y, width, height normalized to the frame, NULL for the whole frame
+ */
+void Larod_Set_Roi(LarodContext* ctx, const float roi[4]);
+
+/**
+ * Stage a frame for the full-frame pass as RGB at model size - the region
+ * of interest, or a whole NV12 frame, through a crop job (or a CPU crop
+ * without one); a frame already in the model's layout as
+ * Larod_Stage_Input(). Results of Larod_Run_Staged() come back in
+ * whole-frame coordinates either way.
+ * @return 1 on success, 0 on failure
+ */
+int Larod_Stage_Frame(LarodContext* ctx, const LarodFrame* frame);
+
+/**
+ * Run inference on the input staged by Larod_Stage_Input(), Larod_Stage_Crop()
+ * or Larod_Stage_Frame()
+ * @return LarodResult pointer on success, NULL on failure (or nothing staged)
+ *
+ * IMPORTANT: Caller must call Larod_Free_Result() when done
+ */
+LarodResult* Larod_Run_Staged(LarodContext* ctx);
 
 /**
  * Free inference result
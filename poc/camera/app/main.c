@@ -33,6 +33,9 @@
 #include "ACAP.h"
 #include "MQTT.h"
 #include "core.h"
+#include "trace.h"
+#include "flight_recorder.h"
+#include "capture_log.h"
 
 /* External: Frame publisher callback for MQTT messages */
 extern void frame_request_callback(const char* topic, const char* payload);
@@ -117,6 +120,11 @@ static gboolean process_frame(gpointer user_data) {
             LOG("Frame %lu: FPS=%.1f Modules=%d\n",
                 frame_count, actual_fps, ctx->module_count);
         }
+    } else if (ctx->source->eof) {
+        // Non-looping file source is exhausted - nothing more will arrive
+        LOG("Frame source finished after %lu frames, stopping\n", frame_count);
+        if (main_loop) g_main_loop_quit(main_loop);
+        return G_SOURCE_REMOVE;
     }
 
     return G_SOURCE_CONTINUE;
@@ -176,6 +184,8 @@ void HTTP_ENDPOINT_Status(ACAP_HTTP_Response response, const ACAP_HTTP_Request r
         cJSON_AddItemToObject(status, "modules", modules);
     }
 
+    cJSON_AddItemToObject(status, "flight_recorder", Flight_Stats_JSON());
+
     ACAP_HTTP_Respond_JSON(response, status);
     cJSON_Delete(status);
 }
@@ -334,6 +344,57 @@ void HTTP_ENDPOINT_Logs(ACAP_HTTP_Response response, const ACAP_HTTP_Request req
     free(logs);
 }
 
+/**
+ * HTTP metrics endpoint - pipeline counters and per-stage perf aggregates
+ */
+void HTTP_ENDPOINT_Metrics(ACAP_HTTP_Response response, const ACAP_HTTP_Request request) {
+    if (!core_ctx) {
+        ACAP_HTTP_Respond_Error(response, 503, "Core not initialized");
+        return;
+    }
+    cJSON* metrics = core_get_metrics(core_ctx);
+    ACAP_HTTP_Respond_JSON(response, metrics);
+    cJSON_Delete(metrics);
+}
+
+/**
+ * HTTP trace endpoint - pipeline spans in Chrome trace_event format
+ * Query: seconds=N (default 10) limits the export to the last N seconds
+ */
+void HTTP_ENDPOINT_Trace(ACAP_HTTP_Response response, const ACAP_HTTP_Request request) {
+    int seconds = 10;
+    const char* param = ACAP_HTTP_Request_Param(request, "seconds");
+    if (param) {
+        seconds = atoi(param);
+        free((void*)param);
+    }
+    if (seconds <= 0 || seconds > 300) seconds = 10;
+
+    cJSON* trace = Trace_Export_JSON(seconds);
+    if (!trace) {
+        ACAP_HTTP_Respond_Error(response, 500, "Trace export failed");
+        return;
+    }
+    ACAP_HTTP_Respond_JSON(response, trace);
+    cJSON_Delete(trace);
+}
+
+/**
+ * HTTP capture endpoint - record-and-replay capture status
+ * Query: trigger=1 records the next trigger_frames frames
+ */
+void HTTP_ENDPOINT_Capture(ACAP_HTTP_Response response, const ACAP_HTTP_Request request) {
+    const char* param = ACAP_HTTP_Request_Param(request, "trigger");
+    if (param) {
+        if (atoi(param) > 0) Capture_Trigger("http");
+        free((void*)param);
+    }
+
+    cJSON* stats = Capture_Stats_JSON();
+    ACAP_HTTP_Respond_JSON(response, stats);
+    cJSON_Delete(stats);
+}
+
 /**
  * Signal handler for clean shutdown
  */
@@ -394,6 +455,9 @@ int main(int argc, char* argv[]) {
     ACAP_HTTP_Node("frame/preview", HTTP_ENDPOINT_Frame);
     ACAP_HTTP_Node("config", HTTP_ENDPOINT_Config);
     ACAP_HTTP_Node("logs", HTTP_ENDPOINT_Logs);
+    ACAP_HTTP_Node("trace", HTTP_ENDPOINT_Trace);
+    ACAP_HTTP_Node("metrics", HTTP_ENDPOINT_Metrics);
+    ACAP_HTTP_Node("capture", HTTP_ENDPOINT_Capture);
 
     // Initialize MQTT with frame request callback
     if (!MQTT_Init(Main_MQTT_Status, frame_request_callback)) {
@@ -448,8 +512,13 @@ int main(int argc, char* argv[]) {
     }
 
     // Schedule frame processing (100ms = 10 FPS)
-    int interval_ms = 1000 / config.target_fps;
-    g_timeout_add(interval_ms, process_frame, core_ctx);
+    // File and synthetic sources pace themselves, so poll them from idle
+    if (core_ctx->source->free_running) {
+        g_idle_add(process_frame, core_ctx);
+    } else {
+        int interval_ms = 1000 / config.target_fps;
+        g_timeout_add(interval_ms, process_frame, core_ctx);
+    }
 
     LOG("Starting main loop (target %d FPS)\n", config.target_fps);
 
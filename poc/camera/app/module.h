@@ -11,6 +11,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "cJSON.h"
+#include "blackboard.h"
+#include "frame_views.h"
+#include "frame_pool.h"
+#include "hires_stream.h"
+#include "http_client.h"
+#include "cloud_batch.h"
 #include <vdo-stream.h>
 #include <larod.h>
 
@@ -20,6 +26,7 @@ typedef struct ModuleContext ModuleContext;
 typedef struct FrameData FrameData;
 typedef struct MetadataFrame MetadataFrame;
 typedef struct CoreContext CoreContext;
+typedef struct Cascade Cascade;
 
 /**
  * Module return codes
@@ -55,8 +62,8 @@ struct MetadataFrame {
     int detection_count;
     int detection_capacity;
 
-    // Module-specific data (JSON)
-    cJSON* custom_data;  // Each module adds its own fields
+    // Module-specific data - typed slots, serialized at publish (owned by core)
+    Blackboard* blackboard;
 };
 
 /**
@@ -64,15 +71,22 @@ struct MetadataFrame {
  * Note: ACAP SDK uses VdoBuffer directly, no VdoFrame abstraction
  */
 struct FrameData {
-    VdoBuffer* vdo_buffer;       // VDO buffer (zero-copy)
+    VdoBuffer* vdo_buffer;       // VDO buffer (zero-copy), NULL for file/synthetic sources
     void* vdo_frame;             // Reserved/unused (ACAP SDK doesn't have VdoFrame)
-    void* frame_data;            // Raw pixel data
+    void* frame_data;            // Raw pixel data in format (NV12, or RGB / planar RGB from VDO)
+    size_t frame_size;           // Bytes at frame_data
     unsigned int width;
     unsigned int height;
     VdoFormat format;
 
+    FrameViews* views;           // Memoized derived images (gray pyramid, RGB, JPEG, crops)
+    FrameRef* ref;               // FrameRef_Retain() to keep the pixels past process(), may be NULL
+    HiResStream* hires;          // HiRes_Get_Frame() for full resolution, NULL without a VDO source
+    Cascade* cascade;            // Cascade_Run() for second-stage results on detection crops
+
     MetadataFrame* metadata;     // Aggregated metadata
     int64_t timestamp_us;        // Frame timestamp
+    int64_t capture_us;          // Source capture time (VDO clock) - matches HiResFrame.capture_us
     int frame_id;                // Sequential frame ID
 };
 
@@ -109,6 +123,14 @@ typedef struct {
     // HTTP client for AI APIs
     int (*http_post)(const char* url, const char* headers,
                      const char* body, char** response);
+    int (*http_post_async)(const char* url, const char* headers, const char* body,
+                           HttpCallback done, void* user);
+    int (*http_cancel)(void* user);
+
+    // Batched, deduplicated cloud AI calls (see cloud_batch.h)
+    int (*cloud_submit)(const char* prompt_id, const char* prompt, const uint8_t* jpeg,
+                        size_t jpeg_size, CloudResultFn done, void* user);
+    int (*cloud_cancel)(void* user);
 } CoreAPI;
 
 /**
@@ -5,24 +5,25 @@
  */
 
 #include "module.h"
+#include "core.h"
+#include "frame_arena.h"
+#include "jpeg_encoder.h"
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include <jpeglib.h>
-#include <setjmp.h>
 
 /**
  * Create metadata frame
+ * Inside core_process_frame this comes from the per-frame arena
  */
 MetadataFrame* metadata_create(void) {
-    MetadataFrame* meta = (MetadataFrame*)calloc(1, sizeof(MetadataFrame));
+    MetadataFrame* meta = (MetadataFrame*)Arena_Calloc(1, sizeof(MetadataFrame));
     if (!meta) return NULL;
 
-    meta->custom_data = cJSON_CreateObject();
     meta->detection_capacity = 32;  // Initial capacity
-    meta->detections = (Detection*)calloc(meta->detection_capacity, sizeof(Detection));
+    meta->detections = (Detection*)Arena_Calloc(meta->detection_capacity, sizeof(Detection));
 
-    if (!meta->detections || !meta->custom_data) {
+    if (!meta->detections) {
         metadata_free(meta);
         return NULL;
     }
@@ -37,14 +38,10 @@ void metadata_free(MetadataFrame* meta) {
     if (!meta) return;
 
     if (meta->detections) {
-        free(meta->detections);
+        Arena_Free(meta->detections);
     }
 
-    if (meta->custom_data) {
-        cJSON_Delete(meta->custom_data);
-    }
-
-    free(meta);
+    Arena_Free(meta);
 }
 
 /**
@@ -56,8 +53,8 @@ void metadata_add_detection(MetadataFrame* meta, Detection det) {
     // Expand array if needed
     if (meta->detection_count >= meta->detection_capacity) {
         int new_capacity = meta->detection_capacity * 2;
-        Detection* new_dets = (Detection*)realloc(meta->detections,
-                                                   new_capacity * sizeof(Detection));
+        Detection* new_dets = (Detection*)Arena_Realloc(meta->detections,
+                                                         new_capacity * sizeof(Detection));
         if (!new_dets) return;
 
         meta->detections = new_dets;
@@ -124,74 +121,30 @@ bool module_config_get_bool(cJSON* config, const char* key, bool default_val) {
     return default_val;
 }
 
-/**
- * JPEG encoding error handler
- */
-struct jpeg_error_mgr_wrapper {
-    struct jpeg_error_mgr pub;
-    jmp_buf setjmp_buffer;
-};
-
-static void jpeg_error_exit(j_common_ptr cinfo) {
-    struct jpeg_error_mgr_wrapper* err = (struct jpeg_error_mgr_wrapper*)cinfo->err;
-    longjmp(err->setjmp_buffer, 1);
-}
-
 /**
  * Encode pixels to JPEG
  */
 int encode_jpeg(void* pixels, int width, int height, VdoFormat format,
                 char** jpeg_data, size_t* jpeg_size) {
-    struct jpeg_compress_struct cinfo;
-    struct jpeg_error_mgr_wrapper jerr;
-    unsigned char* jpeg_buffer = NULL;
-    unsigned long jpeg_buffer_size = 0;
-
     // Only support YUV420 format for now
-    if (format != VDO_FORMAT_YUV) {
+    if (format != VDO_FORMAT_YUV || width <= 0 || height <= 0) {
         return -1;
     }
 
-    // Initialize JPEG compression
-    cinfo.err = jpeg_std_error(&jerr.pub);
-    jerr.pub.error_exit = jpeg_error_exit;
-
-    if (setjmp(jerr.setjmp_buffer)) {
-        jpeg_destroy_compress(&cinfo);
-        if (jpeg_buffer) free(jpeg_buffer);
+    // Simplified: assumes pixels are already interleaved 3-byte YCbCr
+    // In production, you'd expand YUV420 first
+    JpegImage image = {
+        .width = (unsigned int)width, .height = (unsigned int)height,
+        .ycbcr = 1, .quality = 85, .pixels = (const uint8_t*)pixels
+    };
+    JpegBuffer jpeg = { 0 };
+    if (Jpeg_Encode(&image, &jpeg) == 0) {
+        Jpeg_Buffer_Free(&jpeg);
         return -1;
     }
 
-    jpeg_create_compress(&cinfo);
-    jpeg_mem_dest(&cinfo, &jpeg_buffer, &jpeg_buffer_size);
-
-    cinfo.image_width = width;
-    cinfo.image_height = height;
-    cinfo.input_components = 3;
-    cinfo.in_color_space = JCS_YCbCr;
-
-    jpeg_set_defaults(&cinfo);
-    jpeg_set_quality(&cinfo, 85, TRUE);
-
-    jpeg_start_compress(&cinfo, TRUE);
-
-    // Write scanlines
-    JSAMPROW row_pointer[1];
-    unsigned char* yuv_data = (unsigned char*)pixels;
-    int row_stride = width * 3;
-
-    // Simplified: assumes pixels are already in RGB/YUV format
-    // In production, you'd convert YUV420 to RGB first
-    while (cinfo.next_scanline < cinfo.image_height) {
-        row_pointer[0] = &yuv_data[cinfo.next_scanline * row_stride];
-        jpeg_write_scanlines(&cinfo, row_pointer, 1);
-    }
-
-    jpeg_finish_compress(&cinfo);
-    jpeg_destroy_compress(&cinfo);
-
-    *jpeg_data = (char*)jpeg_buffer;
-    *jpeg_size = jpeg_buffer_size;
+    *jpeg_data = (char*)jpeg.data;
+    *jpeg_size = jpeg.size;
 
     return 0;
 }
@@ -214,14 +167,15 @@ int encode_base64(const char* input, size_t input_len, char** output) {
     unsigned char a, b, c;
 
     while (i < input_len) {
-        a = i < input_len ? (unsigned char)input[i++] : 0;
-        b = i < input_len ? (unsigned char)input[i++] : 0;
-        c = i < input_len ? (unsigned char)input[i++] : 0;
+        size_t remaining = input_len - i;
+        a = (unsigned char)input[i++];
+        b = remaining > 1 ? (unsigned char)input[i++] : 0;
+        c = remaining > 2 ? (unsigned char)input[i++] : 0;
 
         (*output)[j++] = base64_table[a >> 2];
         (*output)[j++] = base64_table[((a & 0x3) << 4) | (b >> 4)];
-        (*output)[j++] = (i > input_len + 1) ? '=' : base64_table[((b & 0xF) << 2) | (c >> 6)];
-        (*output)[j++] = (i > input_len) ? '=' : base64_table[c & 0x3F];
+        (*output)[j++] = remaining > 1 ? base64_table[((b & 0xF) << 2) | (c >> 6)] : '=';
+        (*output)[j++] = remaining > 2 ? base64_table[c & 0x3F] : '=';
     }
 
     (*output)[j] = '\0';
@@ -229,26 +183,28 @@ int encode_base64(const char* input, size_t input_len, char** output) {
 }
 
 /**
- * HTTP POST JSON helper
+ * HTTP POST JSON helper (shared pooled client, see core_api_http_post)
  */
 int http_post_json(const char* url, const char* api_key, cJSON* request, cJSON** response) {
-    // Build request body
+    if (!response) return -1;
+    *response = NULL;
+
     char* request_str = cJSON_PrintUnformatted(request);
     if (!request_str) return -1;
 
-    // Build headers
-    char headers[512];
-    snprintf(headers, sizeof(headers),
-             "Content-Type: application/json\r\n"
-             "Authorization: Bearer %s", api_key);
+    char headers[1024];
+    if (api_key && *api_key) {
+        snprintf(headers, sizeof(headers),
+                 "Content-Type: application/json\r\n"
+                 "Authorization: Bearer %s", api_key);
+    } else {
+        snprintf(headers, sizeof(headers), "Content-Type: application/json");
+    }
 
-    // Make HTTP POST
     char* response_str = NULL;
-    // Note: This requires core_api_http_post which uses CURL
-    // For now, return error - modules will implement their own HTTP logic
-    free(request_str);
-
-    if (!response_str) {
+    int result = core_api_http_post(url, headers, request_str, &response_str);
+    cJSON_free(request_str);
+    if (result != 0 || !response_str) {
         return -1;
     }
 
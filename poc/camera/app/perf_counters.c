@@ -0,0 +1,264 @@
+/**
+ * perf_counters.c
+ *
+ * perf_event_open based stage counters for Axis I.S. POC
+ *
+ * Counters are opened per thread (pid=0, cpu=-1) as one group so all four
+ * values are scheduled on the PMU together and can be read with a single
+ * read(). Kernel-mode counting is excluded for the hardware events so the
+ * default perf_event_paranoid setting is sufficient; context switches are
+ * dropped from the group if the kernel refuses them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include "perf_counters.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define PERF_MAX_THREADS 16
+
+/* Per-stage aggregate */
+typedef struct {
+    const char* name;
+    uint64_t samples;
+    uint64_t totals[PERF_NUM_COUNTERS];
+} PerfStage;
+
+/* Per-thread counter group */
+typedef struct {
+    int fds[PERF_NUM_COUNTERS];
+    int slot[PERF_NUM_COUNTERS];    // Position in group read, -1 if not opened
+    int nr;                         // Counters in group
+} PerfGroup;
+
+static const char* counter_names[PERF_NUM_COUNTERS] = {
+    "cycles", "instructions", "cache_misses", "context_switches"
+};
+
+static volatile int g_perf_enabled = 0;
+static PerfStage g_stages[PERF_MAX_STAGES];
+static int g_stage_count = 0;
+static uint64_t g_stages_dropped = 0;
+static PerfGroup* g_groups[PERF_MAX_THREADS];
+static int g_group_count = 0;
+static pthread_mutex_t g_perf_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread PerfGroup* t_group = NULL;
+static __thread int t_group_failed = 0;
+
+static int perf_event_open(struct perf_event_attr* attr, pid_t pid, int cpu, int group_fd,
+                           unsigned long flags) {
+    return (int)syscall(SYS_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+static int open_counter(uint32_t type, uint64_t config, int group_fd, int exclude_kernel) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd < 0 ? 1 : 0;   // Leader starts the whole group
+    attr.exclude_kernel = exclude_kernel;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return perf_event_open(&attr, 0, -1, group_fd, 0);
+}
+
+/**
+ * Open the calling thread's counter group
+ */
+static PerfGroup* get_thread_group(void) {
+    if (t_group) return t_group;
+    if (t_group_failed) return NULL;
+
+    PerfGroup* group = (PerfGroup*)calloc(1, sizeof(PerfGroup));
+    if (!group) {
+        t_group_failed = 1;
+        return NULL;
+    }
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        group->fds[i] = -1;
+        group->slot[i] = -1;
+    }
+
+    group->fds[PERF_CYCLES] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, 1);
+    if (group->fds[PERF_CYCLES] < 0) {
+        LOG_ERR("Perf: Cannot open cycle counter (%s) - sampling unavailable on this thread\n",
+                strerror(errno));
+        free(group);
+        t_group_failed = 1;
+        return NULL;
+    }
+    int leader = group->fds[PERF_CYCLES];
+    group->slot[PERF_CYCLES] = group->nr++;
+
+    // Group members; slot order must match the order they are added
+    const uint32_t types[PERF_NUM_COUNTERS] = {
+        0, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+    };
+    const uint64_t configs[PERF_NUM_COUNTERS] = {
+        0, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES
+    };
+    for (int i = PERF_INSTRUCTIONS; i < PERF_NUM_COUNTERS; i++) {
+        // Context switches happen in the kernel, so they cannot exclude it
+        int exclude_kernel = types[i] == PERF_TYPE_HARDWARE;
+        group->fds[i] = open_counter(types[i], configs[i], leader, exclude_kernel);
+        if (group->fds[i] >= 0) {
+            group->slot[i] = group->nr++;
+        } else {
+            LOG("Perf: Counter %s unavailable (%s)\n", counter_names[i], strerror(errno));
+        }
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    pthread_mutex_lock(&g_perf_mutex);
+    if (g_group_count < PERF_MAX_THREADS) {
+        g_groups[g_group_count++] = group;
+    }
+    pthread_mutex_unlock(&g_perf_mutex);
+
+    t_group = group;
+    return group;
+}
+
+int Perf_Init(int enabled) {
+    g_perf_enabled = 0;
+    if (!enabled) return 0;
+
+    // Probe on the calling (pipeline) thread so failures are logged at startup
+    g_perf_enabled = 1;
+    if (!get_thread_group()) {
+        g_perf_enabled = 0;
+        return 0;
+    }
+
+    LOG("Perf: Hardware counter sampling enabled\n");
+    return 1;
+}
+
+int Perf_Enabled(void) {
+    return g_perf_enabled;
+}
+
+void Perf_Read(PerfSample* sample) {
+    sample->valid = 0;
+    if (!g_perf_enabled) return;
+
+    PerfGroup* group = get_thread_group();
+    if (!group) return;
+
+    uint64_t buf[1 + PERF_NUM_COUNTERS];
+    ssize_t n = read(group->fds[PERF_CYCLES], buf, sizeof(buf));
+    if (n < (ssize_t)sizeof(uint64_t) || buf[0] != (uint64_t)group->nr) return;
+
+    for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+        sample->values[i] = group->slot[i] >= 0 ? buf[1 + group->slot[i]] : 0;
+    }
+    sample->valid = 1;
+}
+
+void Perf_Accumulate(const char* stage, const PerfSample* start) {
+    if (!stage || !start || !start->valid) return;
+
+    PerfSample end;
+    Perf_Read(&end);
+    if (!end.valid) return;
+
+    pthread_mutex_lock(&g_perf_mutex);
+    PerfStage* entry = NULL;
+    for (int i = 0; i < g_stage_count; i++) {
+        if (g_stages[i].name == stage || strcmp(g_stages[i].name, stage) == 0) {
+            entry = &g_stages[i];
+            break;
+        }
+    }
+    if (!entry && g_stage_count < PERF_MAX_STAGES) {
+        entry = &g_stages[g_stage_count++];
+        entry->name = stage;
+    }
+    if (entry) {
+        entry->samples++;
+        for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+            entry->totals[i] += end.values[i] - start->values[i];
+        }
+    } else {
+        g_stages_dropped++;
+    }
+    pthread_mutex_unlock(&g_perf_mutex);
+}
+
+cJSON* Perf_Stats_JSON(void) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", g_perf_enabled);
+    if (!g_perf_enabled) return json;
+
+    cJSON* stages = cJSON_CreateObject();
+    pthread_mutex_lock(&g_perf_mutex);
+    for (int i = 0; i < g_stage_count; i++) {
+        PerfStage* st = &g_stages[i];
+        if (st->samples == 0) continue;
+
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddNumberToObject(item, "samples", (double)st->samples);
+        for (int c = 0; c < PERF_NUM_COUNTERS; c++) {
+            cJSON_AddNumberToObject(item, counter_names[c],
+                                    (double)st->totals[c] / (double)st->samples);
+        }
+
+        // Derived ratios: low IPC with high MPKI points at memory-bound work
+        double cycles = (double)st->totals[PERF_CYCLES];
+        double instructions = (double)st->totals[PERF_INSTRUCTIONS];
+        cJSON_AddNumberToObject(item, "ipc", cycles > 0 ? instructions / cycles : 0);
+        cJSON_AddNumberToObject(item, "cache_mpki", instructions > 0 ?
+                                (double)st->totals[PERF_CACHE_MISSES] * 1000.0 / instructions : 0);
+        cJSON_AddItemToObject(stages, st->name, item);
+    }
+    cJSON_AddNumberToObject(json, "stages_dropped", (double)g_stages_dropped);
+    pthread_mutex_unlock(&g_perf_mutex);
+
+    cJSON_AddItemToObject(json, "stages", stages);
+    return json;
+}
+
+void Perf_Reset(void) {
+    pthread_mutex_lock(&g_perf_mutex);
+    memset(g_stages, 0, sizeof(g_stages));
+    g_stage_count = 0;
+    g_stages_dropped = 0;
+    pthread_mutex_unlock(&g_perf_mutex);
+}
+
+void Perf_Cleanup(void) {
+    g_perf_enabled = 0;
+
+    pthread_mutex_lock(&g_perf_mutex);
+    for (int g = 0; g < g_group_count; g++) {
+        for (int i = 0; i < PERF_NUM_COUNTERS; i++) {
+            if (g_groups[g]->fds[i] >= 0) close(g_groups[g]->fds[i]);
+        }
+        free(g_groups[g]);
+        g_groups[g] = NULL;
+    }
+    g_group_count = 0;
+    pthread_mutex_unlock(&g_perf_mutex);
+
+    t_group = NULL;
+    t_group_failed = 0;
+}
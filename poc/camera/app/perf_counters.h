@@ -0,0 +1,82 @@
+/**
+ * perf_counters.h
+ *
+ * Optional hardware performance counters for Axis I.S. POC
+ * Samples cycles, instructions, cache misses and context switches with a
+ * perf_event_open counter group per pipeline thread and aggregates the
+ * deltas per pipeline stage (trace span name)
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdint.h>
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERF_MAX_STAGES 32
+
+typedef enum {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_CONTEXT_SWITCHES,
+    PERF_NUM_COUNTERS
+} PerfCounter;
+
+/* Counter snapshot taken at stage start */
+typedef struct {
+    uint64_t values[PERF_NUM_COUNTERS];
+    int valid;
+} PerfSample;
+
+/**
+ * Initialize performance counter sampling
+ * @param enabled 0 leaves sampling off (Perf_Enabled() returns 0)
+ * @return 1 if sampling is active
+ */
+int Perf_Init(int enabled);
+
+/**
+ * Check whether sampling is active
+ */
+int Perf_Enabled(void);
+
+/**
+ * Read the calling thread's counters
+ * Opens the thread's counter group on first use
+ * @param sample Output snapshot (valid=0 if counters are unavailable)
+ */
+void Perf_Read(PerfSample* sample);
+
+/**
+ * Read counters again and add the delta since start to a stage
+ * @param stage Static stage name
+ * @param start Snapshot taken with Perf_Read() at stage start
+ */
+void Perf_Accumulate(const char* stage, const PerfSample* start);
+
+/**
+ * Get per-stage aggregates as JSON
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Perf_Stats_JSON(void);
+
+/**
+ * Clear accumulated stage statistics
+ */
+void Perf_Reset(void);
+
+/**
+ * Disable sampling and close the calling thread's counters
+ */
+void Perf_Cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERF_COUNTERS_H */
@@ -0,0 +1,262 @@
+/**
+ * result_cache.c
+ *
+ * Per-object result cache implementation for Axis I.S. POC
+ *
+ * Crops are described by a 32x32 luma thumbnail (2x2 samples per cell):
+ * an 8x9 difference hash for identity and the mean absolute Laplacian for
+ * sharpness. An empty result (model ran, found nothing) is cached too.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "result_cache.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define THUMB_SIZE 32
+
+typedef struct {
+    int valid;
+    int used;                       // Matched this frame
+    CacheKey key;                   // Latest look (hash and position follow the object)
+    float area;                     // Crop the results came from
+    float sharpness;
+    int64_t computed_us;
+    int64_t seen_us;
+    CascadeResult results[RESULT_CACHE_MAX_RESULTS];
+    int count;
+} CacheEntry;
+
+struct ResultCache {
+    CacheEntry* entries;
+    int capacity;
+    int64_t max_age_us;
+    float grow_ratio;
+    float sharper_ratio;
+    int hash_distance;
+
+    // Statistics
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t expired;
+    uint64_t refreshed;             // Larger or sharper crop
+    uint64_t evictions;
+};
+
+static float config_float(cJSON* config, const char* key, float def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsNumber(item) ? (float)item->valuedouble : def;
+}
+
+static int config_int(cJSON* config, const char* key, int def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsNumber(item) ? item->valueint : def;
+}
+
+ResultCache* ResultCache_Create(cJSON* config) {
+    if (!config) return NULL;
+    cJSON* enabled = cJSON_GetObjectItem(config, "enabled");
+    if (enabled && !cJSON_IsTrue(enabled)) return NULL;
+
+    ResultCache* cache = (ResultCache*)calloc(1, sizeof(ResultCache));
+    if (!cache) {
+        LOG_ERR("ResultCache: Failed to allocate context\n");
+        return NULL;
+    }
+
+    cache->capacity = config_int(config, "entries", 32);
+    if (cache->capacity < 1) cache->capacity = 1;
+    cache->max_age_us = (int64_t)config_int(config, "max_age_ms", 5000) * 1000;
+    cache->grow_ratio = config_float(config, "grow_ratio", 1.5f);
+    cache->sharper_ratio = config_float(config, "sharper_ratio", 1.3f);
+    cache->hash_distance = config_int(config, "hash_distance", 10);
+
+    cache->entries = (CacheEntry*)calloc((size_t)cache->capacity, sizeof(CacheEntry));
+    if (!cache->entries) {
+        LOG_ERR("ResultCache: Failed to allocate %d entries\n", cache->capacity);
+        free(cache);
+        return NULL;
+    }
+    return cache;
+}
+
+void ResultCache_Key(const FrameView* luma, const int pixels[4], CacheKey* key) {
+    if (!key) return;
+    uint8_t thumb[THUMB_SIZE][THUMB_SIZE];
+    memset(key, 0, sizeof(CacheKey));
+    key->track = -1;
+    if (!luma || !luma->data || pixels[2] <= 0 || pixels[3] <= 0) return;
+
+    key->area = (float)pixels[2] * (float)pixels[3] / ((float)luma->width * (float)luma->height);
+    key->x = ((float)pixels[0] + (float)pixels[2] / 2.0f) / (float)luma->width;
+    key->y = ((float)pixels[1] + (float)pixels[3] / 2.0f) / (float)luma->height;
+
+    // Thumbnail: mean of 2x2 samples per cell
+    for (int ty = 0; ty < THUMB_SIZE; ty++) {
+        for (int tx = 0; tx < THUMB_SIZE; tx++) {
+            int sum = 0;
+            for (int sy = 0; sy < 2; sy++) {
+                for (int sx = 0; sx < 2; sx++) {
+                    int x = pixels[0] + (int)(((float)tx + 0.25f + 0.5f * (float)sx) * (float)pixels[2] / THUMB_SIZE);
+                    int y = pixels[1] + (int)(((float)ty + 0.25f + 0.5f * (float)sy) * (float)pixels[3] / THUMB_SIZE);
+                    if (x >= (int)luma->width) x = (int)luma->width - 1;
+                    if (y >= (int)luma->height) y = (int)luma->height - 1;
+                    sum += luma->data[(size_t)y * luma->stride + (size_t)x];
+                }
+            }
+            thumb[ty][tx] = (uint8_t)(sum / 4);
+        }
+    }
+
+    // Difference hash: 8 rows of 9 column means, each bit "left brighter than right"
+    for (int r = 0; r < 8; r++) {
+        int means[9];
+        int y0 = r * THUMB_SIZE / 8, y1 = (r + 1) * THUMB_SIZE / 8;
+        for (int c = 0; c < 9; c++) {
+            int x0 = c * THUMB_SIZE / 9, x1 = (c + 1) * THUMB_SIZE / 9;
+            int sum = 0;
+            for (int y = y0; y < y1; y++) {
+                for (int x = x0; x < x1; x++) sum += thumb[y][x];
+            }
+            means[c] = sum / ((y1 - y0) * (x1 - x0));
+        }
+        for (int c = 0; c < 8; c++) {
+            if (means[c] > means[c + 1]) key->hash |= 1ull << (r * 8 + c);
+        }
+    }
+
+    int total = 0;
+    for (int y = 1; y < THUMB_SIZE - 1; y++) {
+        for (int x = 1; x < THUMB_SIZE - 1; x++) {
+            total += abs(4 * thumb[y][x] - thumb[y - 1][x] - thumb[y + 1][x] -
+                         thumb[y][x - 1] - thumb[y][x + 1]);
+        }
+    }
+    key->sharpness = (float)total / (float)((THUMB_SIZE - 2) * (THUMB_SIZE - 2));
+}
+
+static int same_place(const CacheKey* a, const CacheKey* b) {
+    float reach = a->area > b->area ? a->area : b->area;
+    // Centre moved by no more than about two box sizes
+    float limit = 4.0f * reach + 0.01f;
+    float dx = a->x - b->x, dy = a->y - b->y;
+    return dx * dx + dy * dy <= limit;
+}
+
+CacheStatus ResultCache_Lookup(ResultCache* cache, const CacheKey* key, int64_t now_us, int* entry,
+                               const CascadeResult** results, int* count, int32_t* age_ms) {
+    *entry = -1;
+    if (!cache || !key) return RESULT_CACHE_MISS;
+
+    int best = -1;
+    int best_distance = 65;
+    for (int i = 0; i < cache->capacity; i++) {
+        CacheEntry* e = &cache->entries[i];
+        if (!e->valid || e->used || e->key.class_id != key->class_id) continue;
+        if (key->track >= 0 || e->key.track >= 0) {
+            if (e->key.track == key->track) {
+                best = i;
+                break;
+            }
+            continue;
+        }
+        int distance = __builtin_popcountll(e->key.hash ^ key->hash);
+        if (distance <= cache->hash_distance && distance < best_distance && same_place(&e->key, key)) {
+            best = i;
+            best_distance = distance;
+        }
+    }
+    if (best < 0) {
+        cache->misses++;
+        return RESULT_CACHE_MISS;
+    }
+
+    CacheEntry* e = &cache->entries[best];
+    e->used = 1;
+    e->seen_us = now_us;
+    e->key = *key;
+    *entry = best;
+
+    if (now_us - e->computed_us > cache->max_age_us) {
+        cache->expired++;
+        return RESULT_CACHE_STALE;
+    }
+    if (key->area > e->area * cache->grow_ratio || key->sharpness > e->sharpness * cache->sharper_ratio) {
+        cache->refreshed++;
+        return RESULT_CACHE_STALE;
+    }
+
+    cache->hits++;
+    if (results) *results = e->results;
+    if (count) *count = e->count;
+    if (age_ms) *age_ms = (int32_t)((now_us - e->computed_us) / 1000);
+    return RESULT_CACHE_HIT;
+}
+
+void ResultCache_Store(ResultCache* cache, int entry, const CacheKey* key, int64_t now_us,
+                       const CascadeResult* results, int count) {
+    if (!cache || !key) return;
+
+    if (entry < 0 || entry >= cache->capacity) {
+        // Free entry, else the one seen longest ago
+        entry = 0;
+        for (int i = 0; i < cache->capacity; i++) {
+            if (!cache->entries[i].valid) {
+                entry = i;
+                break;
+            }
+            if (cache->entries[i].seen_us < cache->entries[entry].seen_us) entry = i;
+        }
+        if (cache->entries[entry].valid) cache->evictions++;
+    }
+
+    CacheEntry* e = &cache->entries[entry];
+    e->valid = 1;
+    e->used = 1;
+    e->key = *key;
+    e->area = key->area;
+    e->sharpness = key->sharpness;
+    e->computed_us = now_us;
+    e->seen_us = now_us;
+    e->count = count < RESULT_CACHE_MAX_RESULTS ? count : RESULT_CACHE_MAX_RESULTS;
+    if (e->count > 0) memcpy(e->results, results, (size_t)e->count * sizeof(CascadeResult));
+}
+
+void ResultCache_End_Frame(ResultCache* cache) {
+    if (!cache) return;
+    for (int i = 0; i < cache->capacity; i++) cache->entries[i].used = 0;
+}
+
+cJSON* ResultCache_Stats_JSON(ResultCache* cache) {
+    cJSON* json = cJSON_CreateObject();
+    cJSON_AddBoolToObject(json, "enabled", cache != NULL);
+    if (!cache) return json;
+
+    int valid = 0;
+    for (int i = 0; i < cache->capacity; i++) valid += cache->entries[i].valid;
+    uint64_t lookups = cache->hits + cache->misses + cache->expired + cache->refreshed;
+    cJSON_AddNumberToObject(json, "entries", valid);
+    cJSON_AddNumberToObject(json, "capacity", cache->capacity);
+    cJSON_AddNumberToObject(json, "hits", (double)cache->hits);
+    cJSON_AddNumberToObject(json, "misses", (double)cache->misses);
+    cJSON_AddNumberToObject(json, "expired", (double)cache->expired);
+    cJSON_AddNumberToObject(json, "refreshed", (double)cache->refreshed);
+    cJSON_AddNumberToObject(json, "evictions", (double)cache->evictions);
+    cJSON_AddNumberToObject(json, "hit_rate", lookups ? (double)cache->hits / (double)lookups : 0);
+    return json;
+}
+
+void ResultCache_Destroy(ResultCache* cache) {
+    if (!cache) return;
+    free(cache->entries);
+    free(cache);
+}
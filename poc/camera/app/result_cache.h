@@ -0,0 +1,110 @@
+/**
+ * result_cache.h
+ *
+ * Per-object result cache for second-stage models, Axis I.S. POC
+ * Plate text, vehicle colour or attributes do not change from frame to
+ * frame for the same object. A cascade stage with a cache looks each crop
+ * up first and only runs the model when the object is new, its crop got
+ * clearly larger or sharper than the one the cached result came from, or
+ * the result has expired.
+ *
+ * Objects are matched by track id when a tracker supplies one
+ * (Cascade_Set_Tracks), otherwise by a 64-bit difference hash of the crop's
+ * luma, gated by class and position.
+ *
+ * Pipeline thread only.
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <stdint.h>
+#include "cJSON.h"
+#include "frame_views.h"
+#include "cascade.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RESULT_CACHE_MAX_RESULTS 4      // Results kept per object
+
+typedef struct ResultCache ResultCache;
+
+/* What an object looks like this frame */
+typedef struct {
+    int track;                      // Tracker id, -1 without a tracker
+    int class_id;                   // Parent class
+    uint64_t hash;                  // Difference hash of the crop luma
+    float sharpness;                // Mean absolute Laplacian of the crop luma
+    float area;                     // Crop area, frame-normalized
+    float x, y;                     // Crop centre, frame-normalized
+} CacheKey;
+
+typedef enum {
+    RESULT_CACHE_MISS = 0,          // Unknown object
+    RESULT_CACHE_HIT,               // Cached results are good
+    RESULT_CACHE_STALE              // Known, but expired or a better crop - run again
+} CacheStatus;
+
+/**
+ * Create a cache
+ * @param config Stage "cache" object, NULL or "enabled": false for none
+ * @return Cache pointer, NULL when disabled
+ *
+ * Config keys:
+ *   enabled        Cache results (default true)
+ *   entries        Objects remembered (default 32, least recently seen evicted)
+ *   max_age_ms     Results expire after this long (default 5000)
+ *   grow_ratio     Re-run when the crop area grows by this factor (default 1.5)
+ *   sharper_ratio  Re-run when the crop is this much sharper (default 1.3)
+ *   hash_distance  Largest hash Hamming distance for the same object (default 10)
+ */
+ResultCache* ResultCache_Create(cJSON* config);
+
+/**
+ * Describe a crop - hash and sharpness from a 32x32 luma thumbnail
+ * @param luma Full-resolution luma of the frame the crop is cut from
+ * @param pixels Crop as x, y, width, height in luma pixels
+ * @param key Output; track and class_id are left to the caller
+ */
+void ResultCache_Key(const FrameView* luma, const int pixels[4], CacheKey* key);
+
+/**
+ * Look an object up (each entry matches at most one object per frame)
+ * @param entry Output: entry index to pass to ResultCache_Store(), -1 on a miss
+ * @param results Output on a hit: cached results (crop-normalized boxes)
+ * @param count Output on a hit: result count
+ * @param age_ms Output on a hit: age of the results
+ */
+CacheStatus ResultCache_Lookup(ResultCache* cache, const CacheKey* key, int64_t now_us, int* entry,
+                               const CascadeResult** results, int* count, int32_t* age_ms);
+
+/**
+ * Store fresh results for an object
+ * @param entry Index from ResultCache_Lookup(), -1 for a new object
+ */
+void ResultCache_Store(ResultCache* cache, int entry, const CacheKey* key, int64_t now_us,
+                       const CascadeResult* results, int count);
+
+/**
+ * End of frame - entries may match again
+ */
+void ResultCache_End_Frame(ResultCache* cache);
+
+/**
+ * Get cache statistics as JSON (hits, misses, refreshes, evictions)
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* ResultCache_Stats_JSON(ResultCache* cache);
+
+/**
+ * Free the cache
+ */
+void ResultCache_Destroy(ResultCache* cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESULT_CACHE_H */
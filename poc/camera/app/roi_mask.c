@@ -0,0 +1,202 @@
+/**
+ * roi_mask.c
+ *
+ * Inference region of interest and exclusion zones implementation for
+ * Axis I.S. POC
+ *
+ * The mask is a resolution x resolution bitset over the analytics frame;
+ * a cell is set when its centre lies inside an include polygon (even-odd
+ * rule) and inside no exclude polygon.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "roi_mask.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define ROI_DEFAULT_RESOLUTION 128
+#define ROI_MAX_POINTS 64           // Per polygon
+
+typedef struct {
+    float x[ROI_MAX_POINTS];
+    float y[ROI_MAX_POINTS];
+    int count;
+} Polygon;
+
+struct RoiMask {
+    uint32_t* bits;
+    int resolution;
+    int anchor_bottom;
+    int crop;
+    float bounds[4];                // Include bounding box, normalized x, y, width, height
+};
+
+/**
+ * Parse [[x, y], ...] - at least three points, clamped to the frame
+ */
+static int parse_polygon(cJSON* json, Polygon* polygon) {
+    polygon->count = 0;
+    if (!cJSON_IsArray(json)) return 0;
+
+    cJSON* point;
+    cJSON_ArrayForEach(point, json) {
+        if (polygon->count >= ROI_MAX_POINTS || !cJSON_IsArray(point) ||
+            cJSON_GetArraySize(point) != 2) {
+            return 0;
+        }
+        cJSON* x = cJSON_GetArrayItem(point, 0);
+        cJSON* y = cJSON_GetArrayItem(point, 1);
+        if (!cJSON_IsNumber(x) || !cJSON_IsNumber(y)) return 0;
+
+        float px = (float)x->valuedouble, py = (float)y->valuedouble;
+        polygon->x[polygon->count] = px < 0.0f ? 0.0f : px > 1.0f ? 1.0f : px;
+        polygon->y[polygon->count] = py < 0.0f ? 0.0f : py > 1.0f ? 1.0f : py;
+        polygon->count++;
+    }
+    return polygon->count >= 3;
+}
+
+static int inside(const Polygon* polygon, float x, float y) {
+    int in = 0;
+    for (int i = 0, j = polygon->count - 1; i < polygon->count; j = i++) {
+        if ((polygon->y[i] > y) != (polygon->y[j] > y) &&
+            x < (polygon->x[j] - polygon->x[i]) * (y - polygon->y[i]) /
+                (polygon->y[j] - polygon->y[i]) + polygon->x[i]) {
+            in = !in;
+        }
+    }
+    return in;
+}
+
+/**
+ * Set (value 1) or clear (value 0) every cell whose centre is in the polygon
+ */
+static void rasterize(RoiMask* roi, const Polygon* polygon, int value) {
+    int n = roi->resolution;
+    for (int cy = 0; cy < n; cy++) {
+        float y = ((float)cy + 0.5f) / (float)n;
+        for (int cx = 0; cx < n; cx++) {
+            if (!inside(polygon, ((float)cx + 0.5f) / (float)n, y)) continue;
+            int bit = cy * n + cx;
+            if (value) {
+                roi->bits[bit >> 5] |= 1u << (bit & 31);
+            } else {
+                roi->bits[bit >> 5] &= ~(1u << (bit & 31));
+            }
+        }
+    }
+}
+
+RoiMask* Roi_Init(cJSON* config) {
+    cJSON* include = config ? cJSON_GetObjectItem(config, "include") : NULL;
+    cJSON* exclude = config ? cJSON_GetObjectItem(config, "exclude") : NULL;
+    int includes = cJSON_IsArray(include) ? cJSON_GetArraySize(include) : 0;
+    int excludes = cJSON_IsArray(exclude) ? cJSON_GetArraySize(exclude) : 0;
+    if (includes == 0 && excludes == 0) return NULL;
+
+    RoiMask* roi = (RoiMask*)calloc(1, sizeof(RoiMask));
+    if (!roi) {
+        LOG_ERR("ROI: Failed to allocate mask\n");
+        return NULL;
+    }
+
+    cJSON* item = cJSON_GetObjectItem(config, "resolution");
+    roi->resolution = item && cJSON_IsNumber(item) ? item->valueint : ROI_DEFAULT_RESOLUTION;
+    if (roi->resolution < 8) roi->resolution = 8;
+    if (roi->resolution > 1024) roi->resolution = 1024;
+    item = cJSON_GetObjectItem(config, "anchor");
+    roi->anchor_bottom = item && cJSON_IsString(item) && strcmp(item->valuestring, "bottom") == 0;
+    item = cJSON_GetObjectItem(config, "crop");
+    roi->crop = !item || cJSON_IsTrue(item);
+
+    size_t cells = (size_t)roi->resolution * (size_t)roi->resolution;
+    roi->bits = (uint32_t*)calloc((cells + 31) / 32, sizeof(uint32_t));
+    if (!roi->bits) {
+        LOG_ERR("ROI: Failed to allocate mask\n");
+        free(roi);
+        return NULL;
+    }
+
+    Polygon polygon;
+    float x0 = 1.0f, y0 = 1.0f, x1 = 0.0f, y1 = 0.0f;
+    if (includes == 0) {
+        memset(roi->bits, 0xff, (cells + 31) / 32 * sizeof(uint32_t));
+        x0 = y0 = 0.0f;
+        x1 = y1 = 1.0f;
+    }
+    for (int i = 0; i < includes; i++) {
+        if (!parse_polygon(cJSON_GetArrayItem(include, i), &polygon)) {
+            LOG_ERR("ROI: include[%d] is not a polygon of 3-%d [x, y] points\n", i, ROI_MAX_POINTS);
+            Roi_Cleanup(roi);
+            return NULL;
+        }
+        rasterize(roi, &polygon, 1);
+        for (int p = 0; p < polygon.count; p++) {
+            if (polygon.x[p] < x0) x0 = polygon.x[p];
+            if (polygon.x[p] > x1) x1 = polygon.x[p];
+            if (polygon.y[p] < y0) y0 = polygon.y[p];
+            if (polygon.y[p] > y1) y1 = polygon.y[p];
+        }
+    }
+    for (int i = 0; i < excludes; i++) {
+        if (!parse_polygon(cJSON_GetArrayItem(exclude, i), &polygon)) {
+            LOG_ERR("ROI: exclude[%d] is not a polygon of 3-%d [x, y] points\n", i, ROI_MAX_POINTS);
+            Roi_Cleanup(roi);
+            return NULL;
+        }
+        rasterize(roi, &polygon, 0);
+    }
+
+    roi->bounds[0] = x0;
+    roi->bounds[1] = y0;
+    roi->bounds[2] = x1 > x0 ? x1 - x0 : 0.0f;
+    roi->bounds[3] = y1 > y0 ? y1 - y0 : 0.0f;
+
+    size_t set = 0;
+    for (size_t i = 0; i < (cells + 31) / 32; i++) set += (size_t)__builtin_popcount(roi->bits[i]);
+    LOG("ROI: %d include / %d exclude polygon(s), %.0f%% of the frame active, crop %.2f,%.2f %.2fx%.2f%s\n",
+        includes, excludes, 100.0 * (double)set / (double)cells, roi->bounds[0], roi->bounds[1],
+        roi->bounds[2], roi->bounds[3], roi->crop ? "" : " (not cropping)");
+    return roi;
+}
+
+int Roi_Crop(const RoiMask* roi, float out[4]) {
+    if (!roi || !roi->crop || !out) return 0;
+    if (roi->bounds[2] <= 0.0f || roi->bounds[3] <= 0.0f) return 0;
+    // Nothing to save when the box is (nearly) the whole frame
+    if (roi->bounds[2] * roi->bounds[3] > 0.95f) return 0;
+    memcpy(out, roi->bounds, sizeof(roi->bounds));
+    return 1;
+}
+
+int Roi_Allows(const RoiMask* roi, const Detection* det) {
+    if (!roi || !det) return 1;
+
+    float x = det->x;
+    float y = roi->anchor_bottom ? det->y + det->height / 2.0f : det->y;
+    int n = roi->resolution;
+    int cx = (int)(x * (float)n);
+    int cy = (int)(y * (float)n);
+    if (cx < 0) cx = 0;
+    if (cx >= n) cx = n - 1;
+    if (cy < 0) cy = 0;
+    if (cy >= n) cy = n - 1;
+
+    int bit = cy * n + cx;
+    return (roi->bits[bit >> 5] >> (bit & 31)) & 1u;
+}
+
+void Roi_Cleanup(RoiMask* roi) {
+    if (!roi) return;
+    free(roi->bits);
+    free(roi);
+}
@@ -0,0 +1,62 @@
+/**
+ * roi_mask.h
+ *
+ * Inference region of interest and exclusion zones for Axis I.S. POC
+ * Per-camera polygons in normalized analytics-frame coordinates: include
+ * polygons bound what is worth looking at, exclude polygons cut out sky,
+ * walls, the housing, a flag that moves in the wind. The include polygons'
+ * bounding box becomes the inference crop; detections are then checked
+ * against a bitmap rasterized once at init, one bit lookup per box.
+ */
+
+#ifndef ROI_MASK_H
+#define ROI_MASK_H
+
+#include "cJSON.h"
+#include "module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RoiMask RoiMask;
+
+/**
+ * Build the mask from config
+ * @param config "roi" object from the detection module config
+ * @return Mask pointer, NULL when no polygons are configured (or invalid)
+ *
+ * Config keys:
+ *   include     Array of polygons, each an array of [x, y] points in 0-1
+ *               (default: whole frame)
+ *   exclude     Array of polygons removed from the included area
+ *   anchor      Point of a box tested against the mask: "center" (default)
+ *               or "bottom" (bottom centre - where people and vehicles stand)
+ *   resolution  Mask cells along each side (default 128)
+ *   crop        Infer only the include bounding box (default true)
+ */
+RoiMask* Roi_Init(cJSON* config);
+
+/**
+ * Inference crop - bounding box of the include polygons
+ * @param out x, y, width, height in normalized frame coordinates
+ * @return 1 if inference should be cropped, 0 for the full frame
+ */
+int Roi_Crop(const RoiMask* roi, float out[4]);
+
+/**
+ * Check a detection against the mask (O(1))
+ * @return 1 if its anchor point lies in the included, non-excluded area
+ */
+int Roi_Allows(const RoiMask* roi, const Detection* det);
+
+/**
+ * Free the mask
+ */
+void Roi_Cleanup(RoiMask* roi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ROI_MASK_H */
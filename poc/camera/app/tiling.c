@@ -0,0 +1,394 @@
+/**
+ * tiling.c
+ *
+ * Tiled high-resolution inference implementation for Axis I.S. POC
+ *
+ * Layout: the grid covers the part of the high-resolution frame the
+ * analytics frame shows (or its region of interest). Tiles are square
+ * (aspect kept at model input), evenly spaced so the first and last touch
+ * the edges, and never overlap less than configured. A detection is kept
+ * by the tile holding its centre inside the analytics frame; duplicates
+ * from overlapping tiles and from the full-frame pass are removed by NMS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include "tiling.h"
+#include "trace.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+typedef struct {
+    int box[4];                     // x, y, width, height in high-resolution pixels
+    float activity;                 // Changed fraction of the motion grid under it
+} Tile;
+
+struct Tiling {
+    LarodContext* larod;
+
+    // Configuration
+    int cols;                       // 0 for automatic
+    int rows;
+    int tile_size;
+    float overlap;
+    int every_n;
+    float nms_iou;
+    float nms_ios;
+    int adaptive;
+    int motion_level;
+    int motion_delta;
+    float motion_threshold;
+    int refresh_every;
+
+    float region[4];                // Part of the analytics frame tiled, normalized
+
+    Tile tiles[TILING_MAX_TILES];
+    int tile_count;
+
+    // Motion grid of the previous run
+    uint8_t* prev_gray;
+    unsigned int prev_width;
+    unsigned int prev_height;
+
+    // Statistics
+    uint64_t frames;
+    uint64_t runs;
+    uint64_t misses;                // No high-resolution frame
+    uint64_t tiles_run;
+    uint64_t tiles_skipped;
+    uint64_t zero_copy;             // Tiles staged by a larod crop job
+    uint64_t cpu_crops;
+    uint64_t added;
+};
+
+static float config_float(cJSON* config, const char* key, float def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsNumber(item) ? (float)item->valuedouble : def;
+}
+
+static int config_int(cJSON* config, const char* key, int def) {
+    cJSON* item = cJSON_GetObjectItem(config, key);
+    return item && cJSON_IsNumber(item) ? item->valueint : def;
+}
+
+Tiling* Tiling_Init(cJSON* config, LarodContext* larod) {
+    cJSON* enabled = config ? cJSON_GetObjectItem(config, "enabled") : NULL;
+    if (!enabled || !cJSON_IsTrue(enabled) || !larod) return NULL;
+
+    Tiling* tiling = (Tiling*)calloc(1, sizeof(Tiling));
+    if (!tiling) {
+        LOG_ERR("Tiling: Failed to allocate context\n");
+        return NULL;
+    }
+
+    tiling->larod = larod;
+    tiling->cols = config_int(config, "cols", 0);
+    tiling->rows = config_int(config, "rows", 0);
+    tiling->tile_size = config_int(config, "tile_size", (int)larod->input_width);
+    tiling->overlap = config_float(config, "overlap", 0.2f);
+    tiling->every_n = config_int(config, "every_n", 1);
+    tiling->nms_iou = config_float(config, "nms_iou", 0.5f);
+    tiling->nms_ios = config_float(config, "nms_ios", 0.8f);
+    cJSON* adaptive = cJSON_GetObjectItem(config, "adaptive");
+    tiling->adaptive = adaptive && cJSON_IsTrue(adaptive);
+    tiling->motion_level = config_int(config, "motion_level", 3);
+    tiling->motion_delta = config_int(config, "motion_delta", 25);
+    tiling->motion_threshold = config_float(config, "motion_threshold", 0.01f);
+    tiling->refresh_every = config_int(config, "refresh_every", 15);
+    tiling->region[2] = 1.0f;
+    tiling->region[3] = 1.0f;
+
+    if (tiling->overlap < 0.0f) tiling->overlap = 0.0f;
+    if (tiling->overlap > 0.5f) tiling->overlap = 0.5f;
+    if (tiling->every_n < 1) tiling->every_n = 1;
+    if (tiling->motion_level < 0) tiling->motion_level = 0;
+    if (tiling->motion_level > VIEWS_MAX_LEVEL) tiling->motion_level = VIEWS_MAX_LEVEL;
+
+    if (tiling->tile_size < 32 || tiling->cols < 0 || tiling->rows < 0 ||
+        tiling->cols > TILING_MAX_TILES || tiling->rows > TILING_MAX_TILES ||
+        (tiling->cols && tiling->rows && tiling->cols * tiling->rows > TILING_MAX_TILES)) {
+        LOG_ERR("Tiling: Invalid grid (tile_size %d, %dx%d, at most %d tiles)\n",
+                tiling->tile_size, tiling->cols, tiling->rows, TILING_MAX_TILES);
+        free(tiling);
+        return NULL;
+    }
+
+    LOG("Tiling: %s grid of %dpx tiles, overlap %.2f, every %d frame(s)%s\n",
+        tiling->cols && tiling->rows ? "fixed" : "automatic", tiling->tile_size,
+        tiling->overlap, tiling->every_n, tiling->adaptive ? ", motion-gated" : "");
+    return tiling;
+}
+
+/**
+ * Tiles needed along a side of length span at tile side size
+ */
+static int tiles_along(int span, int size, float overlap) {
+    if (span <= size) return 1;
+    float step = (float)size * (1.0f - overlap);
+    int count = 1;
+    while ((float)size + step * (float)(count - 1) < (float)span) count++;
+    return count;
+}
+
+/**
+ * Lay the grid over region (x, y, width, height in high-resolution pixels)
+ */
+static void layout(Tiling* tiling, const int region[4]) {
+    int width = region[2], height = region[3];
+    int size = tiling->tile_size;
+    int cols = tiling->cols, rows = tiling->rows;
+
+    if (!cols || !rows) {
+        // Grow tiles until the grid fits (the model then sees them downscaled),
+        // or until they are as large as the region allows
+        int last = 0;
+        for (;;) {
+            if (size > width) size = width;
+            if (size > height) size = height;
+            cols = tiling->cols ? tiling->cols : tiles_along(width, size, tiling->overlap);
+            rows = tiling->rows ? tiling->rows : tiles_along(height, size, tiling->overlap);
+            if (cols * rows <= TILING_MAX_TILES || size == last) break;
+            last = size;
+            size += size / 4;
+        }
+        // A fixed column count over the limit still leaves one row
+        if (cols > TILING_MAX_TILES) cols = TILING_MAX_TILES;
+        if (cols * rows > TILING_MAX_TILES) rows = TILING_MAX_TILES / cols;
+        if (rows < 1) rows = 1;
+    } else {
+        // Fixed grid: tiles just large enough to cover the region with the overlap
+        int need_w = (int)((float)width / ((float)cols - tiling->overlap * (float)(cols - 1)) + 0.5f);
+        int need_h = (int)((float)height / ((float)rows - tiling->overlap * (float)(rows - 1)) + 0.5f);
+        size = need_w > need_h ? need_w : need_h;
+        if (size > width) size = width;
+        if (size > height) size = height;
+    }
+
+    tiling->tile_count = 0;
+    for (int r = 0; r < rows; r++) {
+        int y = region[1] + (rows > 1 ? r * (height - size) / (rows - 1) : (height - size) / 2);
+        for (int c = 0; c < cols; c++) {
+            int x = region[0] + (cols > 1 ? c * (width - size) / (cols - 1) : (width - size) / 2);
+            Tile* tile = &tiling->tiles[tiling->tile_count++];
+            tile->box[0] = x;
+            tile->box[1] = y;
+            tile->box[2] = size;
+            tile->box[3] = size;
+            tile->activity = 1.0f;
+        }
+    }
+}
+
+/**
+ * Score each tile by the changed fraction of the motion grid under it
+ * @return 1 if the tiles were scored, 0 when there is no previous grid yet
+ */
+static int score_motion(Tiling* tiling, const HiResFrame* frame) {
+    FrameView gray;
+    if (!Views_Gray(frame->views, tiling->motion_level, &gray)) return 0;
+
+    int scored = 0;
+    if (tiling->prev_gray && tiling->prev_width == gray.width && tiling->prev_height == gray.height) {
+        int shift = tiling->motion_level;
+        for (int i = 0; i < tiling->tile_count; i++) {
+            Tile* tile = &tiling->tiles[i];
+            unsigned int x0 = (unsigned int)tile->box[0] >> shift;
+            unsigned int y0 = (unsigned int)tile->box[1] >> shift;
+            unsigned int x1 = (unsigned int)(tile->box[0] + tile->box[2]) >> shift;
+            unsigned int y1 = (unsigned int)(tile->box[1] + tile->box[3]) >> shift;
+            if (x1 > gray.width) x1 = gray.width;
+            if (y1 > gray.height) y1 = gray.height;
+
+            unsigned int changed = 0, total = 0;
+            for (unsigned int y = y0; y < y1; y++) {
+                const uint8_t* row = gray.data + (size_t)y * gray.stride;
+                const uint8_t* prev = tiling->prev_gray + (size_t)y * gray.width;
+                for (unsigned int x = x0; x < x1; x++) {
+                    if (abs((int)row[x] - (int)prev[x]) > tiling->motion_delta) changed++;
+                }
+                total += x1 > x0 ? x1 - x0 : 0;
+            }
+            tile->activity = total ? (float)changed / (float)total : 0.0f;
+        }
+        scored = 1;
+    }
+
+    // Keep this grid for the next run
+    size_t size = (size_t)gray.width * gray.height;
+    if (!tiling->prev_gray || tiling->prev_width != gray.width || tiling->prev_height != gray.height) {
+        free(tiling->prev_gray);
+        tiling->prev_gray = (uint8_t*)malloc(size);
+        if (!tiling->prev_gray) return scored;
+        tiling->prev_width = gray.width;
+        tiling->prev_height = gray.height;
+    }
+    for (unsigned int y = 0; y < gray.height; y++) {
+        memcpy(tiling->prev_gray + (size_t)y * gray.width, gray.data + (size_t)y * gray.stride,
+               gray.width);
+    }
+    return scored;
+}
+
+/**
+ * Stage one tile as model input - larod crop job, else CPU crop
+ */
+static int stage_tile(Tiling* tiling, const HiResFrame* frame, const Tile* tile) {
+    LarodContext* larod = tiling->larod;
+    if (Larod_Stage_Crop(larod, frame->fd, frame->offset, frame->width, frame->height, tile->box)) {
+        tiling->zero_copy++;
+        return 1;
+    }
+
+    FrameView crop;
+    if (!Views_Crop(frame->views, tile->box[0], tile->box[1], tile->box[2], tile->box[3],
+                    larod->input_width, larod->input_height, 1, &crop)) {
+        return 0;
+    }
+    if (!Larod_Stage_Input(larod, crop.data, crop.size)) return 0;
+    tiling->cpu_crops++;
+    return 1;
+}
+
+static float overlap_area(const Detection* a, const Detection* b) {
+    float x0 = a->x - a->width / 2.0f, x1 = a->x + a->width / 2.0f;
+    float y0 = a->y - a->height / 2.0f, y1 = a->y + a->height / 2.0f;
+    float bx0 = b->x - b->width / 2.0f, bx1 = b->x + b->width / 2.0f;
+    float by0 = b->y - b->height / 2.0f, by1 = b->y + b->height / 2.0f;
+    float w = (x1 < bx1 ? x1 : bx1) - (x0 > bx0 ? x0 : bx0);
+    float h = (y1 < by1 ? y1 : by1) - (y0 > by0 ? y0 : by0);
+    return w > 0.0f && h > 0.0f ? w * h : 0.0f;
+}
+
+static int by_confidence(const void* a, const void* b) {
+    float ca = ((const Detection*)a)->confidence, cb = ((const Detection*)b)->confidence;
+    return ca < cb ? 1 : ca > cb ? -1 : 0;
+}
+
+/**
+ * Greedy class-wise NMS, highest confidence first
+ * @return Detections kept (compacted to the front)
+ */
+static int suppress(Tiling* tiling, Detection* detections, int count) {
+    qsort(detections, (size_t)count, sizeof(Detection), by_confidence);
+
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        Detection* candidate = &detections[i];
+        int duplicate = 0;
+        for (int k = 0; k < kept && !duplicate; k++) {
+            Detection* keeper = &detections[k];
+            if (keeper->class_id != candidate->class_id) continue;
+            float inter = overlap_area(keeper, candidate);
+            if (inter <= 0.0f) continue;
+            float area_a = keeper->width * keeper->height;
+            float area_b = candidate->width * candidate->height;
+            float smaller = area_a < area_b ? area_a : area_b;
+            duplicate = inter / (area_a + area_b - inter) > tiling->nms_iou ||
+                        (smaller > 0.0f && inter / smaller > tiling->nms_ios);
+        }
+        if (!duplicate) detections[kept++] = *candidate;
+    }
+    return kept;
+}
+
+void Tiling_Set_Region(Tiling* tiling, const float region[4]) {
+    if (!tiling || !region) return;
+    memcpy(tiling->region, region, sizeof(tiling->region));
+}
+
+int Tiling_Run(Tiling* tiling, FrameData* frame, Detection* detections, int count,
+               int capacity, TilingResult* result) {
+    if (result) memset(result, 0, sizeof(TilingResult));
+    if (!tiling || !frame || !detections) return count;
+    if (tiling->frames++ % (uint64_t)tiling->every_n != 0) return count;
+
+    HiResFrame hr;
+    if (!frame->hires || !HiRes_Get_Frame(frame->hires, frame->capture_us, &hr)) {
+        tiling->misses++;
+        return count;
+    }
+
+    int region[4];
+    HiRes_Map_Box(frame->hires, &hr, tiling->region[0] + tiling->region[2] / 2.0f,
+                  tiling->region[1] + tiling->region[3] / 2.0f, tiling->region[2],
+                  tiling->region[3], region);
+    if (region[2] <= 0 || region[3] <= 0) return count;
+    layout(tiling, region);
+
+    int refresh = !tiling->adaptive || (tiling->refresh_every > 0 &&
+                  tiling->runs % (uint64_t)tiling->refresh_every == 0);
+    if (tiling->adaptive && !score_motion(tiling, &hr)) refresh = 1;
+    tiling->runs++;
+
+    int input_count = count;
+    float time_ms = 0.0f;
+    int tiles_run = 0, tiles_skipped = 0;
+    TraceSpan span = Trace_Begin("tiling");
+    for (int i = 0; i < tiling->tile_count; i++) {
+        const Tile* tile = &tiling->tiles[i];
+        if (!refresh && tile->activity < tiling->motion_threshold) {
+            tiles_skipped++;
+            continue;
+        }
+        if (!stage_tile(tiling, &hr, tile)) continue;
+
+        LarodResult* tile_result = Larod_Run_Staged(tiling->larod);
+        if (!tile_result) continue;
+        tiles_run++;
+        time_ms += tile_result->inference_time_ms;
+
+        float size_x = (float)tile->box[2], size_y = (float)tile->box[3];
+        for (int d = 0; d < tile_result->num_detections && count < capacity; d++) {
+            const Detection* det = &tile_result->detections[d];
+            float box[4] = {
+                (float)tile->box[0] + (det->x - det->width / 2.0f) * size_x,
+                (float)tile->box[1] + (det->y - det->height / 2.0f) * size_y,
+                det->width * size_x,
+                det->height * size_y
+            };
+            Detection mapped = *det;
+            HiRes_Unmap_Box(frame->hires, &hr, box, &mapped.x, &mapped.y,
+                            &mapped.width, &mapped.height);
+            // Outside the analytics frame (margin of the high-resolution frame)
+            if (mapped.x < 0.0f || mapped.x > 1.0f || mapped.y < 0.0f || mapped.y > 1.0f) continue;
+            detections[count++] = mapped;
+        }
+        Larod_Free_Result(tile_result);
+    }
+
+    count = suppress(tiling, detections, count);
+    Trace_End(&span);
+
+    tiling->tiles_run += (uint64_t)tiles_run;
+    tiling->tiles_skipped += (uint64_t)tiles_skipped;
+    if (count > input_count) tiling->added += (uint64_t)(count - input_count);
+
+    if (result) {
+        result->tiles_run = tiles_run;
+        result->tiles_skipped = tiles_skipped;
+        result->added = count - input_count;
+        result->time_ms = time_ms;
+    }
+    return count;
+}
+
+void Tiling_Cleanup(Tiling* tiling) {
+    if (!tiling) return;
+
+    LOG("Tiling: cleanup: Runs=%llu Tiles=%llu Skipped=%llu ZeroCopy=%llu CPU=%llu Added=%llu Misses=%llu\n",
+        (unsigned long long)tiling->runs, (unsigned long long)tiling->tiles_run,
+        (unsigned long long)tiling->tiles_skipped, (unsigned long long)tiling->zero_copy,
+        (unsigned long long)tiling->cpu_crops, (unsigned long long)tiling->added,
+        (unsigned long long)tiling->misses);
+
+    free(tiling->prev_gray);
+    free(tiling);
+}
@@ -0,0 +1,91 @@
+/**
+ * tiling.h
+ *
+ * Tiled high-resolution inference for Axis I.S. POC
+ * At model size a distant person is a few pixels. Tiling cuts a grid of
+ * overlapping model-sized tiles from the high-resolution frame matched to
+ * the analytics frame, runs the detector on each, maps the results back to
+ * analytics-frame coordinates and merges them with the full-frame pass
+ * using class-wise NMS across tiles.
+ *
+ * Tiles go to the model through larod crop jobs on the frame's dma-buf
+ * (Larod_Stage_Crop); backends that cannot crop get a CPU crop from the
+ * high-resolution view cache instead. The adaptive mode only runs tiles
+ * whose cells of a coarse motion grid changed since the previous run.
+ *
+ * Pipeline thread only.
+ */
+
+#ifndef TILING_H
+#define TILING_H
+
+#include "cJSON.h"
+#include "module.h"
+#include "larod_handler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TILING_MAX_TILES 12         // CPU crops each take a view cache entry
+
+typedef struct Tiling Tiling;
+
+/* Outcome of one Tiling_Run() */
+typedef struct {
+    int tiles_run;
+    int tiles_skipped;              // No motion under the tile
+    int added;                      // Detections kept after NMS, net of the input
+    float time_ms;                  // Staging + inference for every tile
+} TilingResult;
+
+/**
+ * Set up tiling
+ * @param config "tiling" object from the detection module config
+ * @param larod Inference context the tiles run on (shared with the full-frame pass)
+ * @return Tiling pointer, NULL when disabled or invalid
+ *
+ * Config keys:
+ *   enabled           Run tiles (default false)
+ *   cols, rows        Grid size (default: fewest model-sized tiles with overlap)
+ *   tile_size         Tile side in high-resolution pixels (default: model input width)
+ *   overlap           Minimum overlap between neighbouring tiles, 0-0.5 (default 0.2)
+ *   every_n           Tile every Nth frame (default 1)
+ *   nms_iou           Suppress same-class boxes above this IoU (default 0.5)
+ *   nms_ios           ... or above this intersection over the smaller box (default 0.8),
+ *                     catching objects cut in two by a tile edge
+ *   adaptive          Only run tiles with motion (default false)
+ *   motion_level      Gray pyramid level of the motion grid (default 3)
+ *   motion_delta      Luma change counted as motion (default 25)
+ *   motion_threshold  Fraction of changed pixels that wakes a tile (default 0.01)
+ *   refresh_every     Every Nth run tiles everything (default 15, 0 never)
+ */
+Tiling* Tiling_Init(cJSON* config, LarodContext* larod);
+
+/**
+ * Only tile a part of the analytics frame (the inference region of interest)
+ * @param region x, y, width, height normalized to the analytics frame
+ */
+void Tiling_Set_Region(Tiling* tiling, const float region[4]);
+
+/**
+ * Run the tiles for a frame and merge their detections
+ * @param detections Full-frame detections in, merged detections out
+ * @param count Detections at input
+ * @param capacity Room at detections
+ * @param result Per-run counters (may be NULL)
+ * @return New detection count
+ */
+int Tiling_Run(Tiling* tiling, FrameData* frame, Detection* detections, int count,
+               int capacity, TilingResult* result);
+
+/**
+ * Free the tiling state
+ */
+void Tiling_Cleanup(Tiling* tiling);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TILING_H */
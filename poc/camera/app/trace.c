@@ -0,0 +1,258 @@
+/**
+ * trace.c
+ *
+ * Pipeline trace span implementation for Axis I.S. POC
+ *
+ * Each recording thread owns a ring buffer and is the only writer to it,
+ * so recording a span is two clock reads and a store - no locks. The HTTP
+ * thread reads rings concurrently and discards any entries that were
+ * overwritten while it was copying.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "trace.h"
+
+/* Undefine system LOG macros */
+#ifdef LOG_ERR
+#undef LOG_ERR
+#endif
+
+#define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
+#define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
+
+#define TRACE_RING_MASK (TRACE_RING_SIZE - 1)
+
+/* Recorded span */
+typedef struct {
+    const char* name;
+    int64_t start_us;
+    int32_t dur_us;
+    int32_t frame_id;
+} TraceEvent;
+
+/* Per-thread span ring */
+typedef struct {
+    TraceEvent events[TRACE_RING_SIZE];
+    uint64_t head;              // Total spans written (owner writes, readers load)
+    int tid;
+    const char* thread_name;
+} TraceRing;
+
+static TraceRing* g_rings[TRACE_MAX_THREADS];
+static int g_ring_count = 0;
+static pthread_mutex_t g_rings_mutex = PTHREAD_MUTEX_INITIALIZER;
+static volatile int g_trace_enabled = 0;
+static Trace_Observer g_observer = NULL;
+static void* g_observer_data = NULL;
+
+static __thread TraceRing* t_ring = NULL;
+static __thread int t_ring_failed = 0;
+static __thread int t_frame_id = -1;
+
+int64_t Trace_Now_Us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/**
+ * Get (or lazily register) the calling thread's ring
+ */
+static TraceRing* get_thread_ring(void) {
+    if (t_ring) return t_ring;
+    if (t_ring_failed) return NULL;
+
+    TraceRing* ring = (TraceRing*)calloc(1, sizeof(TraceRing));
+    if (!ring) {
+        t_ring_failed = 1;
+        return NULL;
+    }
+    ring->tid = (int)syscall(SYS_gettid);
+
+    pthread_mutex_lock(&g_rings_mutex);
+    if (g_ring_count >= TRACE_MAX_THREADS) {
+        pthread_mutex_unlock(&g_rings_mutex);
+        LOG_ERR("Trace: Thread limit reached, tid %d will not be traced\n", ring->tid);
+        free(ring);
+        t_ring_failed = 1;
+        return NULL;
+    }
+    g_rings[g_ring_count++] = ring;
+    pthread_mutex_unlock(&g_rings_mutex);
+
+    t_ring = ring;
+    return ring;
+}
+
+int Trace_Init(int enabled) {
+    g_trace_enabled = enabled ? 1 : 0;
+    LOG("Trace: Initialized (enabled=%d, %d spans/thread)\n", g_trace_enabled, TRACE_RING_SIZE);
+    return 1;
+}
+
+void Trace_Set_Enabled(int enabled) {
+    g_trace_enabled = enabled ? 1 : 0;
+}
+
+void Trace_Set_Thread_Name(const char* name) {
+    TraceRing* ring = get_thread_ring();
+    if (ring) ring->thread_name = name;
+}
+
+void Trace_Set_Frame(int frame_id) {
+    t_frame_id = frame_id;
+}
+
+TraceSpan Trace_Begin(const char* name) {
+    TraceSpan span;
+    span.name = name;
+    span.start_us = g_trace_enabled ? Trace_Now_Us() : 0;
+    span.perf.valid = 0;
+    if (Perf_Enabled()) {
+        Perf_Read(&span.perf);
+    }
+    return span;
+}
+
+void Trace_End(TraceSpan* span) {
+    if (!span) return;
+
+    if (span->perf.valid) {
+        Perf_Accumulate(span->name, &span->perf);
+        span->perf.valid = 0;
+    }
+    if (span->start_us == 0) return;
+
+    TraceRing* ring = get_thread_ring();
+    if (!ring) return;
+
+    int64_t end_us = Trace_Now_Us();
+    uint64_t head = ring->head;
+
+    TraceEvent* ev = &ring->events[head & TRACE_RING_MASK];
+    ev->name = span->name;
+    ev->start_us = span->start_us;
+    ev->dur_us = (int32_t)(end_us - span->start_us);
+    ev->frame_id = t_frame_id;
+
+    // Publish the entry only after it is fully written
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    if (g_observer) {
+        g_observer(span->name, span->start_us, ev->dur_us, g_observer_data);
+    }
+    span->start_us = 0;
+}
+
+void Trace_Set_Observer(Trace_Observer observer, void* user_data) {
+    g_observer_data = user_data;
+    g_observer = observer;
+}
+
+/**
+ * Copy a consistent snapshot of a ring's recent events
+ * @return Number of valid events copied into out (oldest first)
+ */
+static int snapshot_ring(TraceRing* ring, TraceEvent* out) {
+    uint64_t head_before = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t first = head_before > TRACE_RING_SIZE ? head_before - TRACE_RING_SIZE : 0;
+
+    for (uint64_t i = first; i < head_before; i++) {
+        out[i - first] = ring->events[i & TRACE_RING_MASK];
+    }
+
+    // Entries the writer may have overwritten during the copy are dropped
+    uint64_t head_after = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t oldest_safe = head_after >= TRACE_RING_SIZE ? head_after - TRACE_RING_SIZE + 1 : 0;
+    uint64_t skip = oldest_safe > first ? oldest_safe - first : 0;
+    uint64_t count = head_before - first;
+
+    if (skip >= count) return 0;
+    if (skip > 0) {
+        memmove(out, out + skip, (count - skip) * sizeof(TraceEvent));
+    }
+    return (int)(count - skip);
+}
+
+cJSON* Trace_Export_JSON(int seconds) {
+    if (seconds <= 0) seconds = 10;
+
+    TraceEvent* events = (TraceEvent*)malloc(TRACE_RING_SIZE * sizeof(TraceEvent));
+    if (!events) {
+        LOG_ERR("Trace: Failed to allocate export buffer\n");
+        return NULL;
+    }
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON* trace_events = cJSON_CreateArray();
+    cJSON_AddItemToObject(root, "traceEvents", trace_events);
+    cJSON_AddStringToObject(root, "displayTimeUnit", "ms");
+
+    int pid = (int)getpid();
+    int64_t since_us = Trace_Now_Us() - (int64_t)seconds * 1000000;
+
+    pthread_mutex_lock(&g_rings_mutex);
+    int ring_count = g_ring_count;
+    pthread_mutex_unlock(&g_rings_mutex);
+
+    for (int r = 0; r < ring_count; r++) {
+        TraceRing* ring = g_rings[r];
+
+        // Thread name metadata event
+        cJSON* meta = cJSON_CreateObject();
+        cJSON_AddStringToObject(meta, "name", "thread_name");
+        cJSON_AddStringToObject(meta, "ph", "M");
+        cJSON_AddNumberToObject(meta, "pid", pid);
+        cJSON_AddNumberToObject(meta, "tid", ring->tid);
+        cJSON* meta_args = cJSON_CreateObject();
+        cJSON_AddStringToObject(meta_args, "name", ring->thread_name ? ring->thread_name : "thread");
+        cJSON_AddItemToObject(meta, "args", meta_args);
+        cJSON_AddItemToArray(trace_events, meta);
+
+        int count = snapshot_ring(ring, events);
+        for (int i = 0; i < count; i++) {
+            TraceEvent* ev = &events[i];
+            if (ev->start_us < since_us || !ev->name) continue;
+
+            cJSON* item = cJSON_CreateObject();
+            cJSON_AddStringToObject(item, "name", ev->name);
+            cJSON_AddStringToObject(item, "ph", "X");
+            cJSON_AddNumberToObject(item, "ts", (double)ev->start_us);
+            cJSON_AddNumberToObject(item, "dur", ev->dur_us);
+            cJSON_AddNumberToObject(item, "pid", pid);
+            cJSON_AddNumberToObject(item, "tid", ring->tid);
+            if (ev->frame_id >= 0) {
+                cJSON* args = cJSON_CreateObject();
+                cJSON_AddNumberToObject(args, "frame", ev->frame_id);
+                cJSON_AddItemToObject(item, "args", args);
+            }
+            cJSON_AddItemToArray(trace_events, item);
+        }
+    }
+
+    free(events);
+    return root;
+}
+
+void Trace_Cleanup(void) {
+    g_trace_enabled = 0;
+
+    pthread_mutex_lock(&g_rings_mutex);
+    for (int i = 0; i < g_ring_count; i++) {
+        free(g_rings[i]);
+        g_rings[i] = NULL;
+    }
+    g_ring_count = 0;
+    pthread_mutex_unlock(&g_rings_mutex);
+
+    // Only the calling thread's cached pointer can be reset here
+    t_ring = NULL;
+    t_ring_failed = 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * trace.h
+ *
+ * Lightweight pipeline trace spans for Axis I.S. POC
+ * Spans are timed with a monotonic clock, stored in per-thread rings and
+ * exported on demand in Chrome trace_event format (chrome://tracing, Perfetto)
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "cJSON.h"
+#include "perf_counters.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_RING_SIZE 4096    // Spans kept per thread (must be power of two)
+#define TRACE_MAX_THREADS 16    // Threads that can record spans
+
+/* Called on every closed span, on the thread that closed it */
+typedef void (*Trace_Observer)(const char* name, int64_t start_us, int32_t dur_us, void* user_data);
+
+/* Open span - lives on the caller's stack */
+typedef struct {
+    const char* name;           // Must be a static string (stored by pointer)
+    int64_t start_us;           // 0 when tracing is disabled
+    PerfSample perf;            // Counter snapshot when perf sampling is on
+} TraceSpan;
+
+/**
+ * Initialize tracing
+ * @param enabled 1 to record spans, 0 to make Trace_Begin/Trace_End no-ops
+ * @return 1 on success
+ */
+int Trace_Init(int enabled);
+
+/**
+ * Enable or disable span recording at runtime
+ */
+void Trace_Set_Enabled(int enabled);
+
+/**
+ * Monotonic timestamp in microseconds
+ */
+int64_t Trace_Now_Us(void);
+
+/**
+ * Name the calling thread in exported traces
+ * @param name Static string
+ */
+void Trace_Set_Thread_Name(const char* name);
+
+/**
+ * Tag subsequent spans on the calling thread with a frame ID
+ */
+void Trace_Set_Frame(int frame_id);
+
+/**
+ * Open a span
+ * @param name Static string identifying the stage
+ */
+TraceSpan Trace_Begin(const char* name);
+
+/**
+ * Close a span and record it into the calling thread's ring
+ * When perf sampling is enabled the counter delta is also added to the
+ * stage named after the span
+ */
+void Trace_End(TraceSpan* span);
+
+/**
+ * Register a span observer (host benchmark harness)
+ * @param observer Callback, NULL to remove
+ */
+void Trace_Set_Observer(Trace_Observer observer, void* user_data);
+
+/**
+ * Export recorded spans as Chrome trace_event JSON
+ * @param seconds Only include spans that started within the last N seconds
+ * @return cJSON object on success, NULL on failure
+ *
+ * IMPORTANT: Caller must call cJSON_Delete() when done
+ */
+cJSON* Trace_Export_JSON(int seconds);
+
+/**
+ * Cleanup tracing resources
+ */
+void Trace_Cleanup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_H */
@@ -2,13 +2,23 @@
  * vdo_handler.c
  *
  * VDO stream implementation for Axis I.S. POC
+ *
+ * Mode negotiation prefers formats the model consumes as-is (interleaved or
+ * planar RGB from the image pipeline) so no CPU colour conversion is
+ * needed, and always requests the model size so the camera's scaler does
+ * the resize. YUV (NV12) at the model size is the fallback every channel
+ * supports.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include <syslog.h>
 #include "vdo_handler.h"
 #include "vdo-error.h"
+#include "vdo-channel.h"
+#include "ACAP.h"
 
 /* Undefine system LOG macros */
 #ifdef LOG_ERR
@@ -18,7 +28,152 @@
 #define LOG(fmt, args...) { syslog(LOG_INFO, fmt, ## args); printf(fmt, ## args); }
 #define LOG_ERR(fmt, args...) { syslog(3, fmt, ## args); fprintf(stderr, fmt, ## args); }
 
-VdoContext* Vdo_Init(unsigned int width, unsigned int height, unsigned int fps) {
+size_t Vdo_Frame_Size(VdoFormat format, unsigned int width, unsigned int height) {
+    switch (format) {
+        case VDO_FORMAT_YUV: return (size_t)width * height * 3 / 2;
+        case VDO_FORMAT_RGB:
+        case VDO_FORMAT_PLANAR_RGB: return (size_t)width * height * 3;
+        default: return 0;
+    }
+}
+
+const char* Vdo_Format_Name(VdoFormat format) {
+    switch (format) {
+        case VDO_FORMAT_YUV: return "yuv";
+        case VDO_FORMAT_RGB: return "rgb";
+        case VDO_FORMAT_PLANAR_RGB: return "planar_rgb";
+        default: return "unsupported";
+    }
+}
+
+VdoFormat Vdo_Format_From_Name(const char* name) {
+    if (!name) return VDO_FORMAT_NONE;
+    if (strcmp(name, "yuv") == 0 || strcmp(name, "nv12") == 0) return VDO_FORMAT_YUV;
+    if (strcmp(name, "rgb") == 0) return VDO_FORMAT_RGB;
+    if (strcmp(name, "planar_rgb") == 0) return VDO_FORMAT_PLANAR_RGB;
+    return VDO_FORMAT_NONE;
+}
+
+/**
+ * Read one VAPIX parameter value ("root.Group.Name=value")
+ */
+static int vapix_param(const char* name, char* value, size_t size) {
+    char request[160];
+    snprintf(request, sizeof(request), "param.cgi?action=list&group=%s", name);
+    char* response = ACAP_VAPIX_Get(request);
+    if (!response) return 0;
+
+    int ok = 0;
+    const char* eq = strchr(response, '=');
+    if (eq) {
+        size_t len = strcspn(eq + 1, "\r\n");
+        if (len > 0 && len < size) {
+            memcpy(value, eq + 1, len);
+            value[len] = '\0';
+            ok = 1;
+        }
+    }
+    free(response);
+    return ok;
+}
+
+/**
+ * Describe how the sensor's capture mode maps onto the requested size
+ */
+static void describe_sensor(unsigned int width, unsigned int height, char* out, size_t size) {
+    char aspect[32] = "";
+    char capture_mode[32] = "";
+    vapix_param("root.ImageSource.I0.Sensor.AspectRatio", aspect, sizeof(aspect));
+    vapix_param("root.ImageSource.I0.CaptureMode", capture_mode, sizeof(capture_mode));
+
+    unsigned int aw = 0, ah = 0;
+    if (sscanf(aspect, "%u:%u", &aw, &ah) != 2 || aw == 0 || ah == 0) {
+        snprintf(out, size, "sensor aspect unknown");
+        return;
+    }
+    const char* mode = capture_mode[0] ? capture_mode : "?";
+    if ((uint64_t)aw * height == (uint64_t)ah * width) {
+        snprintf(out, size, "sensor %s (capture mode %s) matches model aspect", aspect, mode);
+    } else {
+        snprintf(out, size, "sensor %s (capture mode %s) scaled to %ux%u by the camera",
+                 aspect, mode, width, height);
+    }
+}
+
+int Vdo_Negotiate(unsigned int width, unsigned int height, const VdoFormat* formats, int count,
+                  VdoFormat model_format, VdoMode* mode) {
+    if (!mode) return 0;
+
+    *mode = (VdoMode){ .width = width, .height = height, .format = VDO_FORMAT_YUV };
+
+    char sensor[96];
+    describe_sensor(width, height, sensor, sizeof(sensor));
+
+    GError* error = NULL;
+    VdoChannel* channel = vdo_channel_get(VDO_CHANNEL, &error);
+    if (!channel) {
+        snprintf(mode->reason, sizeof(mode->reason), "channel query failed (%s), yuv fallback; %s",
+                 error ? error->message : "unknown error", sensor);
+        if (error) g_error_free(error);
+        LOG("VDO: Stream mode yuv %ux%u - %s\n", width, height, mode->reason);
+        return 0;
+    }
+
+    // Formats passed over, for the reason string
+    char skipped[96] = "";
+    size_t skipped_len = 0;
+    int chosen = 0;
+
+    for (int i = 0; i < count && !chosen; i++) {
+        VdoFormat format = formats[i];
+        if (Vdo_Frame_Size(format, width, height) == 0) continue;
+
+        VdoMap* filter = vdo_map_new();
+        vdo_map_set_uint32(filter, "format", format);
+        VdoResolutionSet* set = vdo_channel_get_resolutions(channel, filter, &error);
+        g_object_unref(filter);
+        if (error) {
+            g_error_free(error);
+            error = NULL;
+        }
+
+        // Exact size listed, or at least a larger size the scaler can come down from
+        int native = 0;
+        int fits = 0;
+        for (gsize r = 0; set && r < set->count; r++) {
+            const VdoResolution* res = &set->resolutions[r];
+            if (res->width == width && res->height == height) native = 1;
+            if (res->width >= width && res->height >= height) fits = 1;
+        }
+        g_free(set);
+
+        if (!native && !fits) {
+            if (skipped_len < sizeof(skipped)) {
+                skipped_len += snprintf(skipped + skipped_len, sizeof(skipped) - skipped_len,
+                                        "%s not offered, ", Vdo_Format_Name(format));
+            }
+            continue;
+        }
+
+        mode->format = format;
+        mode->native = native;
+        chosen = 1;
+    }
+    g_object_unref(channel);
+
+    mode->direct = mode->format == model_format;
+    snprintf(mode->reason, sizeof(mode->reason), "%s%s%s, %s; %s",
+             skipped, chosen ? "" : "yuv fallback, ",
+             mode->native ? "native size" : "scaled by the camera",
+             mode->direct ? "feeds the model directly" : "model input needs conversion",
+             sensor);
+
+    LOG("VDO: Stream mode %s %ux%u - %s\n", Vdo_Format_Name(mode->format), width, height, mode->reason);
+    return 1;
+}
+
+VdoContext* Vdo_Init(unsigned int width, unsigned int height, VdoFormat format,
+                     unsigned int fps, unsigned int buffer_count) {
     VdoContext* ctx = (VdoContext*)calloc(1, sizeof(VdoContext));
     if (!ctx) {
         LOG_ERR("Failed to allocate VDO context\n");
@@ -27,7 +182,9 @@ VdoContext* Vdo_Init(unsigned int width, unsigned int height, unsigned int fps)
 
     ctx->width = width;
     ctx->height = height;
+    ctx->format = format;
     ctx->fps = fps;
+    ctx->buffer_count = buffer_count;
 
     GError* error = NULL;
 
@@ -35,9 +192,10 @@ VdoContext* Vdo_Init(unsigned int width, unsigned int height, unsigned int fps)
     VdoMap* settings = vdo_map_new();
     vdo_map_set_uint32(settings, "width", width);
     vdo_map_set_uint32(settings, "height", height);
-    vdo_map_set_uint32(settings, "format", VDO_FORMAT_YUV);
+    vdo_map_set_uint32(settings, "format", format);
     vdo_map_set_uint32(settings, "framerate", fps);
-    vdo_map_set_string(settings, "channel", "1");  // Primary channel
+    vdo_map_set_uint32(settings, "buffer.count", buffer_count);
+    vdo_map_set_string(settings, "channel", "1");  // Primary channel (VDO_CHANNEL)
 
     // Create VDO stream
     ctx->stream = vdo_stream_new(settings, NULL, &error);
@@ -65,7 +223,8 @@ VdoContext* Vdo_Init(unsigned int width, unsigned int height, unsigned int fps)
         return NULL;
     }
 
-    LOG("VDO stream initialized: %ux%u @ %u FPS\n", width, height, fps);
+    LOG("VDO stream initialized: %s %ux%u @ %u FPS, %u buffers\n", Vdo_Format_Name(format),
+        width, height, fps, buffer_count);
     return ctx;
 }
 
@@ -97,6 +256,11 @@ VdoBuffer* Vdo_Get_Frame(VdoContext* ctx) {
     return buffer;
 }
 
+int64_t Vdo_Buffer_Timestamp_Us(VdoBuffer* buffer) {
+    VdoFrame* frame = buffer ? vdo_buffer_get_frame(buffer) : NULL;
+    return frame ? (int64_t)vdo_frame_get_timestamp(frame) : 0;
+}
+
 void Vdo_Release_Frame(VdoContext* ctx, VdoBuffer* buffer) {
     if (!ctx || !ctx->stream || !buffer) {
         LOG_ERR("Invalid parameters to Vdo_Release_Frame\n");
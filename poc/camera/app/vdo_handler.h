@@ -2,12 +2,15 @@
  * vdo_handler.h
  *
  * VDO (Video Data Object) stream handler for Axis I.S. POC
- * Provides zero-copy frame capture from Axis camera sensor
+ * Provides zero-copy frame capture from Axis camera sensor, in the stream
+ * format and resolution negotiated for the model
  */
 
 #ifndef VDO_HANDLER_H
 #define VDO_HANDLER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <glib.h>
 #include "vdo-types.h"
 #include "vdo-frame.h"
@@ -17,24 +20,76 @@
 extern "C" {
 #endif
 
+#define VDO_CHANNEL 1               // Primary channel
+
+/* Stream mode chosen by Vdo_Negotiate() */
+typedef struct {
+    unsigned int width;
+    unsigned int height;
+    VdoFormat format;
+    int native;                 // Channel lists width x height for this format
+    int direct;                 // Frames match the model input layout (no conversion)
+    char reason[192];
+} VdoMode;
+
 /* VDO context structure */
 typedef struct {
     VdoStream* stream;
     unsigned int width;
     unsigned int height;
+    VdoFormat format;
     unsigned int fps;
+    unsigned int buffer_count;
     unsigned int frames_captured;
     unsigned int frames_dropped;
 } VdoContext;
 
+/**
+ * Choose the cheapest stream that feeds the model
+ * Reads the sensor aspect ratio and capture mode over VAPIX and asks the
+ * channel which resolutions it offers in each format. The first offered
+ * format in preference order wins, at width x height - the camera's
+ * scaler does the resize and aspect handling. The mode and the reason for
+ * it are logged.
+ * @param width Model input width
+ * @param height Model input height
+ * @param formats Formats in order of preference
+ * @param count Entries in formats
+ * @param model_format Layout the model consumes (VDO_FORMAT_RGB or VDO_FORMAT_PLANAR_RGB)
+ * @param mode Output: chosen mode, YUV at width x height when nothing else is offered
+ * @return 1 if the channel could be queried, 0 if the mode is the fallback
+ */
+int Vdo_Negotiate(unsigned int width, unsigned int height, const VdoFormat* formats, int count,
+                  VdoFormat model_format, VdoMode* mode);
+
 /**
  * Initialize VDO stream
  * @param width Target frame width
  * @param height Target frame height
+ * @param format VDO_FORMAT_YUV (NV12), VDO_FORMAT_RGB or VDO_FORMAT_PLANAR_RGB
  * @param fps Target frames per second
+ * @param buffer_count Stream buffers (buffer.count) - frames that can be held at once
  * @return VdoContext pointer on success, NULL on failure
  */
-VdoContext* Vdo_Init(unsigned int width, unsigned int height, unsigned int fps);
+VdoContext* Vdo_Init(unsigned int width, unsigned int height, VdoFormat format,
+                     unsigned int fps, unsigned int buffer_count);
+
+/**
+ * Bytes in one uncompressed frame of the given format
+ * @return Frame size, 0 for compressed or unsupported formats
+ */
+size_t Vdo_Frame_Size(VdoFormat format, unsigned int width, unsigned int height);
+
+/**
+ * Format name for logs, metrics and config ("yuv", "rgb", "planar_rgb")
+ */
+const char* Vdo_Format_Name(VdoFormat format);
+
+/**
+ * Parse a format name as used in config
+ * @return Format, VDO_FORMAT_NONE if unknown
+ */
+VdoFormat Vdo_Format_From_Name(const char* name);
 
 /**
  * Get next frame from VDO stream
@@ -45,6 +100,12 @@ VdoContext* Vdo_Init(unsigned int width, unsigned int height, unsigned int fps);
  */
 VdoBuffer* Vdo_Get_Frame(VdoContext* ctx);
 
+/**
+ * Capture timestamp of a buffer (VDO clock, shared by every stream)
+ * @return Microseconds, 0 if the buffer carries no frame info
+ */
+int64_t Vdo_Buffer_Timestamp_Us(VdoBuffer* buffer);
+
 /**
  * Release frame buffer back to VDO
  * @param ctx VDO context